@@ -0,0 +1,160 @@
+#include "aotTest.h"
+#include "tacTestUtil.h"
+#include "../runtime/cppEmitter.h"
+#include "../errorHandler/errorHandler.h"
+#include <cstring>
+#include <filesystem>
+
+#ifdef SIGNALLANG_AOT
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+void AotTest::runAll() {
+    testEmittedSource();
+    testMatchesInterpreter();
+    testCacheHit();
+    testStateAcrossBatch();
+    testStatesReadEachOther();
+    testGuardStopsBatch();
+    testSizeLimit();
+    testUntrustedCache();
+    cout << "All AotKernel tests completed.\n";
+}
+
+void AotTest::testEmittedSource() {
+    string src = CppEmitter::emit(mixedProgram("0.1"));
+    assertTrue(src.find("extern \"C\" size_t signal_rows(") != string::npos &&
+                   src.find("extern \"C\" size_t signal_columns(") != string::npos,
+               "both entry points have C linkage");
+    assertTrue(src.find("0x1.999999999999ap-4") != string::npos, "constants spelled exactly as hex floats");
+    assertTrue(src.find("std::fma(") != string::npos && src.find("(float)") != string::npos,
+               "FMA and F32 rounding are explicit");
+}
+
+void AotTest::testMatchesInterpreter() {
+    Interpreter ref(mixedProgram("0.1"));
+    AotKernel aot(mixedProgram("0.1"));
+    if (!aot.compiled()) cout << "(aot fallback: " << aot.fallbackReason() << ")\n";
+    const size_t n = 50, ni = ref.inputNames().size(), no = ref.outputNames().size();
+    vector<double> in(n * ni), expect(n * no), got(n * no);
+    for (size_t k = 0; k < in.size(); ++k) in[k] = 0.75 + 0.37 * (double)(k % 11) - (k % 3 == 0 ? 2.0 : 0.0);
+    for (size_t s = 0; s < n; ++s) ref.run(&in[s * ni], &expect[s * no]);
+    aot.runBatch(in.data(), got.data(), n);
+    assertTrue(memcmp(got.data(), expect.data(), got.size() * sizeof(double)) == 0, "rows bitwise equal to the interpreter");
+
+    vector<double> inCols(n * ni), outCols(n * no);
+    vector<const double *> inPtr(ni);
+    vector<double *> outPtr(no);
+    for (size_t k = 0; k < ni; ++k) inPtr[k] = &inCols[k * n];
+    for (size_t k = 0; k < no; ++k) outPtr[k] = &outCols[k * n];
+    for (size_t s = 0; s < n; ++s)
+        for (size_t k = 0; k < ni; ++k) inCols[k * n + s] = in[s * ni + k];
+    aot.runColumns(inPtr.data(), outPtr.data(), n);
+    bool same = true;
+    for (size_t s = 0; s < n; ++s)
+        for (size_t k = 0; k < no; ++k) same = same && memcmp(&outCols[k * n + s], &expect[s * no + k], sizeof(double)) == 0;
+    assertTrue(same, "columns bitwise equal to the interpreter");
+}
+
+void AotTest::testCacheHit() {
+    AotKernel first(mixedProgram("0.1"));
+    AotKernel second(mixedProgram("0.1"));
+    assertTrue(!second.compiled() || (second.cacheHit() && second.sharedObject() == first.sharedObject()),
+               "unchanged program loads the cached shared object");
+}
+
+void AotTest::testStateAcrossBatch() {
+    ErrorHandler err;
+    SymbolTable sym(&err);
+    SymbolEntry acc("acc", "variable", "float");
+    acc.is_state = true;
+    sym.insert(acc);
+    // acc = acc + x
+    vector<TacInst> tac = {inst(TACOp::ADD, "t0", "acc", "x"), inst(TACOp::ASSIGN, "acc", "t0")};
+    AotKernel aot(tac, &sym);
+    double x[] = {1.0, 2.0, 3.0}, y[3];
+    aot.runBatch(x, y, 3);
+    assertTrue(y[0] == 1.0 && y[1] == 3.0 && y[2] == 6.0, "running sum carried across samples");
+    aot.run(x, y);
+    assertTrue(y[0] == 7.0, "and across calls");
+    aot.reset();
+    aot.run(x, y);
+    assertTrue(y[0] == 1.0, "reset clears state");
+}
+
+void AotTest::testStatesReadEachOther() {
+    assertTrue(statesReadEachOther<AotKernel>(), "state updates read the previous sample's values of other state");
+}
+
+void AotTest::testGuardStopsBatch() {
+    TacInst g = guard(TACOp::GUARD_NONZERO, "d");
+    AotKernel aot({g, inst(TACOp::DIV, "y", "n", "d")});
+    double rows[] = {1, 1, 2, 1, 0, 1, 4, 1}, out[4] = {0, 0, 0, 0}; // (d, n), d is read first
+    string msg;
+    int at = -1;
+    try {
+        aot.runBatch(rows, out, 4);
+    } catch (const RuntimeError &e) {
+        msg = e.what();
+        at = e.inst;
+    }
+    assertTrue(at == 0 && msg.find("d is 0.0 (sample 2)") != string::npos, "failing guard reports value and sample");
+    assertTrue(out[0] == 1.0 && out[1] == 0.5 && out[2] == 0.0, "rows before the failure were written");
+}
+
+void AotTest::testSizeLimit() {
+    AotOptions options = AotOptions::defaults();
+    options.maxInstructions = 4;
+    AotKernel aot(mixedProgram("0.1"), nullptr, options);
+    Interpreter ref(mixedProgram("0.1"));
+    double in[] = {1.0, 2.0}, out[3], expect[3];
+    aot.run(in, out);
+    ref.run(in, expect);
+    assertTrue(!aot.compiled() && aot.fallbackReason().find("too large") != string::npos &&
+                   memcmp(out, expect, sizeof out) == 0,
+               "oversized program stays on the interpreter");
+}
+
+void AotTest::testUntrustedCache() {
+#ifdef SIGNALLANG_AOT
+    namespace fs = std::filesystem;
+    error_code ec;
+    const fs::path root = fs::temp_directory_path(ec) / ("signallang-aot-test-" + to_string(getpid()));
+    fs::create_directories(root / "real", ec);
+    fs::create_symlink(root / "real", root / "link", ec);
+    Interpreter ref(mixedProgram("0.1"));
+    double in[] = {1.0, 2.0}, out[3], expect[3];
+    ref.run(in, expect);
+
+    AotOptions options = AotOptions::defaults();
+    options.cacheDir = (root / "link").string();
+    AotKernel viaLink(mixedProgram("0.1"), nullptr, options);
+    viaLink.run(in, out);
+    assertTrue(!viaLink.compiled() && viaLink.fallbackReason().find("symbolic link") != string::npos &&
+                   memcmp(out, expect, sizeof out) == 0,
+               "symlinked cache directory falls back to the interpreter");
+
+    options.cacheDir = (root / "real").string();
+    AotKernel built(mixedProgram("0.1"), nullptr, options);
+    if (built.compiled()) {
+        fs::permissions(built.sharedObject(), fs::perms::all, ec);
+        AotKernel planted(mixedProgram("0.1"), nullptr, options);
+        assertTrue(!planted.compiled() && planted.fallbackReason().find("writable by other users") != string::npos,
+                   "world-writable cached object is not loaded");
+        fs::permissions(built.sharedObject(), fs::perms::owner_all, ec);
+        fs::permissions(options.cacheDir, fs::perms::all, ec);
+        AotKernel shared(mixedProgram("0.1"), nullptr, options);
+        assertTrue(shared.compiled(), "cache directory we own is made private again");
+    }
+    fs::remove_all(root, ec);
+#endif
+}
+
+void AotTest::assertTrue(bool condition, const std::string& testName) {
+    if (condition)
+        std::cout << "[PASS] " << testName << "\n";
+    else
+        std::cout << "[FAIL] " << testName << "\n";
+}
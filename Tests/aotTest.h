@@ -0,0 +1,26 @@
+#ifndef AOTTEST_H
+#define AOTTEST_H
+
+#include "../runtime/aotKernel.h"
+#include <iostream>
+
+class AotTest {
+public:
+    // Run all test cases for CppEmitter and AotKernel
+    void runAll();
+
+private:
+    void testEmittedSource();
+    void testMatchesInterpreter();
+    void testCacheHit();
+    void testStateAcrossBatch();
+    void testStatesReadEachOther();
+    void testGuardStopsBatch();
+    void testSizeLimit();
+    void testUntrustedCache();
+
+    // Helper to show test results
+    void assertTrue(bool condition, const std::string& testName);
+};
+
+#endif // AOTTEST_H
@@ -0,0 +1,197 @@
+#include "batchInterpreterTest.h"
+#include "tacTestUtil.h"
+#include "../errorHandler/errorHandler.h"
+#include <cstring>
+
+using namespace std;
+
+void BatchInterpreterTest::runAll() {
+    testMatchesInterpreter();
+    testConstantsStayScalar();
+    testStateRunsPerSample();
+    testGuardNamesSample();
+    testGuardReportsLowestRow();
+    testShapes();
+    cout << "All BatchInterpreter tests completed.\n";
+}
+
+void BatchInterpreterTest::testMatchesInterpreter() {
+    // y = (a + 2.5) * b - a / b; z = f32(y * a); recycled temps, one F32 op
+    TacInst z = inst(TACOp::MUL, "z", "y", "a");
+    z.prec = TacPrecision::F32;
+    vector<TacInst> tac = {
+        inst(TACOp::LOAD_CONST, "t0", "2.5"),
+        inst(TACOp::ADD, "t1", "a", "t0"),
+        inst(TACOp::MUL, "t0", "t1", "b"),
+        inst(TACOp::DIV, "t1", "a", "b"),
+        inst(TACOp::SUB, "t2", "t0", "t1"),
+        inst(TACOp::ASSIGN, "y", "t2"),
+        z,
+    };
+    Interpreter ref(tac);
+    BatchInterpreter batch(tac, nullptr, 16); // several blocks and a partial tail
+    const size_t n = 37;
+    vector<double> rows(n * 2), got(n * 2), expect(n * 2);
+    for (size_t s = 0; s < n; ++s) { rows[2 * s] = 0.1 * s - 1.0; rows[2 * s + 1] = 1.0 + 0.37 * s; }
+    for (size_t s = 0; s < n; ++s) ref.run(&rows[2 * s], &expect[2 * s]);
+    batch.runRows(rows.data(), got.data(), n);
+    assertTrue(batch.columnar(), "stateless program runs column-wise");
+    assertTrue(memcmp(got.data(), expect.data(), got.size() * sizeof(double)) == 0,
+               "row-major batch is bitwise equal to the interpreter");
+
+    vector<double> a(n), b(n), y(n), zc(n);
+    for (size_t s = 0; s < n; ++s) { a[s] = rows[2 * s]; b[s] = rows[2 * s + 1]; }
+    const double *in[] = {a.data(), b.data()};
+    double *out[] = {y.data(), zc.data()};
+    batch.run(in, out, n);
+    bool same = true;
+    for (size_t s = 0; s < n; ++s) same = same && y[s] == expect[2 * s] && zc[s] == expect[2 * s + 1];
+    assertTrue(same, "columnar batch is bitwise equal to the interpreter");
+}
+
+void BatchInterpreterTest::testConstantsStayScalar() {
+    // t0 = 2; t1 = 3; t2 = t0 * t1; t3 = x * t2; y = t3
+    vector<TacInst> tac = {
+        inst(TACOp::LOAD_CONST, "t0", "2.0"),
+        inst(TACOp::LOAD_CONST, "t1", "3.0"),
+        inst(TACOp::MUL, "t2", "t0", "t1"),
+        inst(TACOp::MUL, "t3", "x", "t2"),
+        inst(TACOp::ASSIGN, "y", "t3"),
+    };
+    BatchInterpreter batch(tac);
+    assertTrue(batch.code().size() == 1 && batch.code()[0].form == BatchInterpreter::VS && batch.code()[0].imm == 6.0,
+               "constants folded into one column-by-scalar multiply");
+    assertTrue(batch.scratchColumns() == 0, "result computed straight into the output column");
+    double x[] = {1.0, -2.0}, y[2];
+    const double *in[] = {x};
+    double *out[] = {y};
+    batch.run(in, out, 2);
+    assertTrue(y[0] == 6.0 && y[1] == -12.0, "y = 6x");
+}
+
+void BatchInterpreterTest::testStateRunsPerSample() {
+    ErrorHandler err;
+    SymbolTable sym(&err);
+    SymbolEntry acc("acc", "variable", "float");
+    acc.is_state = true;
+    sym.insert(acc);
+    // acc = acc + x
+    vector<TacInst> tac = {inst(TACOp::ADD, "t0", "acc", "x"), inst(TACOp::ASSIGN, "acc", "t0")};
+    BatchInterpreter batch(tac, &sym);
+    double x[] = {1.0, 2.0, 3.0}, y[3];
+    batch.runRows(x, y, 3);
+    assertTrue(!batch.columnar(), "state forces sample-by-sample execution");
+    assertTrue(y[0] == 1.0 && y[1] == 3.0 && y[2] == 6.0, "running sum carried across samples");
+}
+
+void BatchInterpreterTest::testGuardNamesSample() {
+    TacInst g = guard(TACOp::GUARD_NONZERO, "d");
+    BatchInterpreter batch({g, inst(TACOp::DIV, "y", "n", "d")}, nullptr, 4);
+    double rows[] = {1, 1, 2, 1, 4, 1, 8, 1, 16, 1, 0, 1, 2, 1}, out[7]; // (d, n), d is read first
+    string msg;
+    int at = -1;
+    try {
+        batch.runRows(rows, out, 7);
+    } catch (const RuntimeError &e) {
+        msg = e.what();
+        at = e.inst;
+    }
+    assertTrue(at == 0 && msg.find("(sample 5)") != string::npos, "failing guard reports its TAC index and sample");
+}
+
+void BatchInterpreterTest::testGuardReportsLowestRow() {
+    // the second guard instruction fails on an earlier row than the first
+    vector<TacInst> tac = {guard(TACOp::GUARD_NONZERO, "d"), inst(TACOp::DIV, "y", "n", "d"),
+                           guard(TACOp::GUARD_NONZERO, "e"), inst(TACOp::DIV, "z", "n", "e")};
+    BatchInterpreter batch(tac, nullptr, 8);
+    double d[] = {1, 2, 4, 8, 16, 0, 1, 1}, n[] = {1, 1, 1, 1, 1, 1, 1, 1}, e[] = {1, 1, 0, 1, 1, 1, 1, 1};
+    double y[8], z[8];
+    const double *in[] = {d, n, e};
+    double *out[] = {y, z};
+    string msg;
+    int at = -1;
+    try {
+        batch.run(in, out, 8);
+    } catch (const RuntimeError &ex) {
+        msg = ex.what();
+        at = ex.inst;
+    }
+    assertTrue(at == 2 && msg.find("(sample 2)") != string::npos, "guard failure reports the lowest failing row");
+    assertTrue(y[0] == 1.0 && y[1] == 0.5 && z[0] == 1.0 && z[1] == 1.0, "rows before the failing sample are written");
+
+    // a tie on one row goes to the first guard, as in the reference Interpreter
+    e[2] = 1;
+    e[5] = 0;
+    at = -1;
+    try {
+        batch.run(in, out, 8);
+    } catch (const RuntimeError &ex) {
+        msg = ex.what();
+        at = ex.inst;
+    }
+    Interpreter ref(tac);
+    int refAt = -1;
+    try {
+        ref.run({{"d", 0.0}, {"n", 1.0}, {"e", 0.0}});
+    } catch (const RuntimeError &ex) {
+        refAt = ex.inst;
+    }
+    assertTrue(at == 0 && refAt == 0 && msg.find("(sample 5)") != string::npos,
+               "same-row failures report the first guard");
+
+    // row-major staging writes the same rows
+    double rows[24], outRows[16];
+    for (size_t s = 0; s < 8; ++s) {
+        rows[s * 3] = d[s];
+        rows[s * 3 + 1] = n[s];
+        rows[s * 3 + 2] = e[s];
+    }
+    for (double &v : outRows) v = -1;
+    try {
+        batch.runRows(rows, outRows, 8);
+    } catch (const RuntimeError &) {
+    }
+    assertTrue(outRows[8] == 1.0 / 16 && outRows[10] == -1, "runRows writes only rows before the failure");
+}
+
+void BatchInterpreterTest::testShapes() {
+    auto k = [](const string &dest, const string &v) { return inst(TACOp::LOAD_CONST, dest, v); };
+    vector<TacInst> tac = {
+        // p = x * 0.75 + 0.25; q = 0.5 - x * 3.0
+        k("c0", "0.75"), inst(TACOp::MUL, "t0", "x", "c0"), k("c1", "0.25"), inst(TACOp::ADD, "p", "t0", "c1"),
+        k("c2", "3.0"), inst(TACOp::MUL, "t1", "x", "c2"), k("c3", "0.5"), inst(TACOp::SUB, "q", "c3", "t1"),
+        // r = (x - 0.5) * 1.5; u = (y + 0.1) * 3.0
+        inst(TACOp::SUB, "t2", "x", "c3"), k("c4", "1.5"), inst(TACOp::MUL, "r", "t2", "c4"),
+        k("c5", "0.1"), inst(TACOp::ADD, "t3", "y", "c5"), inst(TACOp::MUL, "u", "t3", "c2"),
+        // v = x * 0.5 - y * 0.25; w = y * y
+        inst(TACOp::MUL, "t4", "x", "c3"), inst(TACOp::MUL, "t5", "y", "c1"), inst(TACOp::SUB, "v", "t4", "t5"),
+        inst(TACOp::MUL, "w", "y", "y"),
+        // t6 is read twice, so it stays a column of its own
+        inst(TACOp::MUL, "t6", "x", "c2"), inst(TACOp::ADD, "s0", "t6", "c1"), inst(TACOp::ADD, "s1", "t6", "c4"),
+    };
+    BatchInterpreter batch(tac, nullptr, 16);
+    int shapes[5] = {0, 0, 0, 0, 0};
+    for (const auto &op : batch.code()) ++shapes[op.shape];
+    assertTrue(shapes[BatchInterpreter::AXPB] == 2 && shapes[BatchInterpreter::XMOG] == 2 &&
+                   shapes[BatchInterpreter::AXBY] == 1 && shapes[BatchInterpreter::SQR] == 1 &&
+                   shapes[BatchInterpreter::NO_SHAPE] == 3,
+               "statements matched onto shape kernels");
+
+    Interpreter ref(tac);
+    const size_t n = 29, ni = ref.inputNames().size(), no = ref.outputNames().size();
+    vector<double> rows(n * ni), got(n * no), expect(n * no);
+    for (size_t s = 0; s < rows.size(); ++s) rows[s] = 0.5 - 0.25 * (double)(s % 7) + (s % 5 == 0 ? 1e-3 : 0.0);
+    rows[0] = -0.0;
+    rows[1] = -0.1; // y + 0.1 is zero
+    for (size_t s = 0; s < n; ++s) ref.run(&rows[s * ni], &expect[s * no]);
+    batch.runRows(rows.data(), got.data(), n);
+    assertTrue(memcmp(got.data(), expect.data(), got.size() * sizeof(double)) == 0,
+               "shape kernels are bitwise equal to the interpreter, signed zeros included");
+}
+
+void BatchInterpreterTest::assertTrue(bool condition, const std::string& testName) {
+    if (condition)
+        std::cout << "[PASS] " << testName << "\n";
+    else
+        std::cout << "[FAIL] " << testName << "\n";
+}
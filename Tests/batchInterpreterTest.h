@@ -0,0 +1,24 @@
+#ifndef BATCHINTERPRETERTEST_H
+#define BATCHINTERPRETERTEST_H
+
+#include "../runtime/batchInterpreter.h"
+#include <iostream>
+
+class BatchInterpreterTest {
+public:
+    // Run all test cases for BatchInterpreter
+    void runAll();
+
+private:
+    void testMatchesInterpreter();
+    void testConstantsStayScalar();
+    void testStateRunsPerSample();
+    void testGuardNamesSample();
+    void testGuardReportsLowestRow();
+    void testShapes();
+
+    // Helper to show test results
+    void assertTrue(bool condition, const std::string& testName);
+};
+
+#endif // BATCHINTERPRETERTEST_H
@@ -0,0 +1,133 @@
+#include "bytecodeTest.h"
+#include "tacTestUtil.h"
+#include <cstring>
+#include <algorithm>
+
+using namespace std;
+
+// Opcodes of bc in order.
+static vector<BcOp> opcodes(const Bytecode &bc) {
+    vector<BcOp> ops;
+    for (size_t pc = 0; pc < bc.code.size(); pc += 1 + Bytecode::operandBytes((BcOp)bc.code[pc]))
+        ops.push_back((BcOp)bc.code[pc]);
+    return ops;
+}
+
+static bool has(const Bytecode &bc, BcOp op) {
+    vector<BcOp> ops = opcodes(bc);
+    return find(ops.begin(), ops.end(), op) != ops.end();
+}
+
+// Both VM loops agree bit for bit with the reference Interpreter on a few samples.
+static bool sameAsInterpreter(const vector<TacInst> &tac, const Bytecode &bc) {
+    Interpreter ref(tac);
+    VM vm(bc), vmSwitch(bc);
+    const size_t ni = bc.inputs.size(), no = bc.outputs.size();
+    vector<double> in(ni), expect(no), got(no), gotSwitch(no);
+    for (int s = 0; s < 20; ++s) {
+        for (size_t k = 0; k < ni; ++k) in[k] = 0.3 * s - 1.7 + 0.11 * (double)k;
+        ref.run(in.data(), expect.data());
+        vm.run(in.data(), got.data());
+        vmSwitch.runSwitch(in.data(), gotSwitch.data());
+        if (memcmp(got.data(), expect.data(), no * sizeof(double)) != 0) return false;
+        if (memcmp(gotSwitch.data(), expect.data(), no * sizeof(double)) != 0) return false;
+    }
+    return true;
+}
+
+void BytecodeTest::runAll() {
+    testImmediates();
+    testSuperinstructions();
+    testConstantStillNeeded();
+    testPairCounts();
+    testSignedZeroConstants();
+    cout << "All Bytecode tests completed.\n";
+}
+
+void BytecodeTest::testImmediates() {
+    // y = 3.0 / x - 0.5; z = 2.0 - x
+    vector<TacInst> tac = {
+        inst(TACOp::LOAD_CONST, "t0", "3.0"), inst(TACOp::DIV, "t1", "t0", "x"),
+        inst(TACOp::LOAD_CONST, "t2", "0.5"), inst(TACOp::SUB, "y", "t1", "t2"),
+        inst(TACOp::LOAD_CONST, "t3", "2.0"), inst(TACOp::SUB, "z", "t3", "x"),
+    };
+    Bytecode bc = Bytecode::compile(tac);
+    assertTrue(!has(bc, BcOp::LOAD_CONST) && has(bc, BcOp::RDIV_IMM) && has(bc, BcOp::SUB_IMM) &&
+                   has(bc, BcOp::RSUB_IMM),
+               "constant operands become immediates and their loads disappear");
+    assertTrue(sameAsInterpreter(tac, bc), "immediate forms match the interpreter");
+}
+
+void BytecodeTest::testSuperinstructions() {
+    // y = a * 0.5 + b; z = b - a * 0.25; w = a - b (through a temporary)
+    vector<TacInst> tac = {
+        inst(TACOp::LOAD_CONST, "t0", "0.5"), inst(TACOp::MUL, "t1", "a", "t0"), inst(TACOp::ADD, "y", "t1", "b"),
+        inst(TACOp::LOAD_CONST, "t2", "0.25"), inst(TACOp::MUL, "t3", "a", "t2"), inst(TACOp::SUB, "z", "b", "t3"),
+        inst(TACOp::SUB, "t4", "a", "b"), inst(TACOp::ASSIGN, "w", "t4"),
+    };
+    Bytecode bc = Bytecode::compile(tac);
+    assertTrue(opcodes(bc) == vector<BcOp>{BcOp::MUL_IMM_ADD, BcOp::MUL_IMM_RSUB, BcOp::SUB_MOVE, BcOp::HALT},
+               "dependent pairs fuse into superinstructions");
+    assertTrue(sameAsInterpreter(tac, bc), "superinstructions match the interpreter");
+
+    BcOptions plain;
+    plain.immediates = false;
+    plain.superinstructions = false;
+    assertTrue(sameAsInterpreter(tac, Bytecode::compile(tac, nullptr, plain)) &&
+                   opcodes(Bytecode::compile(tac, nullptr, plain)).size() == tac.size() + 1,
+               "options turn both off");
+}
+
+void BytecodeTest::testConstantStillNeeded() {
+    // t0 feeds a multiply as an immediate and is also read by an F32 add; c is an
+    // output holding a constant
+    TacInst f = inst(TACOp::ADD, "y", "x", "t0");
+    f.prec = TacPrecision::F32;
+    vector<TacInst> tac = {
+        inst(TACOp::LOAD_CONST, "t0", "0.1"), inst(TACOp::MUL, "z", "x", "t0"), f,
+        inst(TACOp::LOAD_CONST, "c", "4.0"),
+    };
+    Bytecode bc = Bytecode::compile(tac);
+    vector<BcOp> ops = opcodes(bc);
+    assertTrue(count(ops.begin(), ops.end(), BcOp::LOAD_CONST) == 2, "loads stay when the frame still needs them");
+    assertTrue(sameAsInterpreter(tac, bc), "and the results are unchanged");
+}
+
+void BytecodeTest::testPairCounts() {
+    vector<TacInst> tac = {
+        inst(TACOp::MUL, "t0", "a", "b"), inst(TACOp::ADD, "t1", "t0", "a"),
+        inst(TACOp::MUL, "t2", "a", "b"), inst(TACOp::ADD, "y", "a", "b"),
+    };
+    map<pair<BcOp, BcOp>, size_t> counts;
+    Bytecode::compile(tac).countPairs(counts);
+    assertTrue(counts.size() == 1 && counts[{BcOp::MUL, BcOp::ADD}] == 1, "only dependent pairs are counted");
+}
+
+void BytecodeTest::testSignedZeroConstants() {
+    // a = 0; b = -0; c = 0; r = x + 0; q = x + -0 -- the pool must keep both zeros apart
+    vector<TacInst> tac = {
+        inst(TACOp::LOAD_CONST, "a", "0"),    inst(TACOp::LOAD_CONST, "b", "-0"),  inst(TACOp::LOAD_CONST, "c", "0"),
+        inst(TACOp::LOAD_CONST, "t0", "0.0"), inst(TACOp::ADD, "r", "x", "t0"),
+        inst(TACOp::LOAD_CONST, "t1", "-0.0"), inst(TACOp::ADD, "q", "x", "t1"),
+    };
+    Bytecode bc = Bytecode::compile(tac);
+    assertTrue(bc.consts.size() == 2, "one pool entry per zero sign");
+    Interpreter ref(tac);
+    VM vm(bc), vmSwitch(bc);
+    bool same = true;
+    for (double x : {-0.0, 0.0}) {
+        double expect[5], got[5], gotSwitch[5];
+        ref.run(&x, expect);
+        vm.run(&x, got);
+        vmSwitch.runSwitch(&x, gotSwitch);
+        same = same && memcmp(got, expect, sizeof got) == 0 && memcmp(gotSwitch, expect, sizeof got) == 0;
+    }
+    assertTrue(same, "signed zeros match the interpreter bit for bit");
+}
+
+void BytecodeTest::assertTrue(bool condition, const std::string& testName) {
+    if (condition)
+        std::cout << "[PASS] " << testName << "\n";
+    else
+        std::cout << "[FAIL] " << testName << "\n";
+}
@@ -0,0 +1,23 @@
+#ifndef BYTECODETEST_H
+#define BYTECODETEST_H
+
+#include "../runtime/vm.h"
+#include <iostream>
+
+class BytecodeTest {
+public:
+    // Run all test cases for Bytecode lowering and the VM
+    void runAll();
+
+private:
+    void testImmediates();
+    void testSuperinstructions();
+    void testConstantStillNeeded();
+    void testPairCounts();
+    void testSignedZeroConstants();
+
+    // Helper to show test results
+    void assertTrue(bool condition, const std::string& testName);
+};
+
+#endif // BYTECODETEST_H
@@ -0,0 +1,106 @@
+#include "costModelTest.h"
+#include "tacTestUtil.h"
+
+using namespace std;
+
+static TargetModel target(const string &name) {
+    TargetModel t;
+    TargetModel::byName(name, t);
+    return t;
+}
+
+// n independent operations dest_i = a_i op b_i
+static vector<TacInst> independent(TACOp op, int n) {
+    vector<TacInst> tac;
+    for (int i = 0; i < n; ++i) {
+        string k = to_string(i);
+        tac.push_back(inst(op, "y" + k, "a" + k, "b" + k));
+    }
+    return tac;
+}
+
+void CostModelTest::runAll() {
+    testTargets();
+    testOutOfOrderBounds();
+    testInOrderIssue();
+    testCountsAndFrame();
+    testAllocation();
+    cout << "All CostModel tests completed.\n";
+}
+
+void CostModelTest::testTargets() {
+    TargetModel t;
+    bool all = true;
+    for (const auto &name : TargetModel::names()) all = all && TargetModel::byName(name, t) && t.name == name;
+    assertTrue(all && !TargetModel::byName("vax", t), "every listed target loads, unknown ones do not");
+    LatencyTable lat = target("x86-64").latencies();
+    assertTrue(lat.of(TACOp::DIV) == 14 && lat.of(TACOp::LOAD_CONST) == 5, "latencies handed to the scheduler");
+    // the generic target is the scheduler's own single-issue model
+    vector<TacInst> tac = {inst(TACOp::DIV, "t0", "a", "b"), inst(TACOp::ADD, "y", "t0", "c")};
+    assertTrue(CostModel::estimate(tac, target("generic")).cyclesPerSample == InstructionScheduler::estimateCycles(tac),
+               "generic agrees with the scheduler's estimate");
+}
+
+void CostModelTest::testOutOfOrderBounds() {
+    const TargetModel x86 = target("x86-64");
+    // latency bound: divide then a dependent add, 14 + 4
+    vector<TacInst> chain = {inst(TACOp::DIV, "t0", "a", "b"), inst(TACOp::ADD, "y", "t0", "c")};
+    CostEstimate e = CostModel::estimate(chain, x86);
+    assertTrue(e.criticalPath == 18 && e.resourceBound == 4.5 && e.cyclesPerSample == 18, "div -> add: 18 cycles");
+    // throughput bound: eight independent divides keep the divider busy 8 * 4 cycles
+    e = CostModel::estimate(independent(TACOp::DIV, 8), x86);
+    assertTrue(e.criticalPath == 14 && e.resourceBound == 32 && e.cyclesPerSample == 32, "8 divides: 32 cycles");
+    // issue bound: 40 copies at four per cycle
+    e = CostModel::estimate(independent(TACOp::ASSIGN, 40), x86);
+    assertTrue(e.issueBound == 10 && e.cyclesPerSample == 10, "40 copies: issue bound 10 cycles");
+}
+
+void CostModelTest::testInOrderIssue() {
+    const TargetModel a53 = target("cortex-a53");
+    // two independent adds: dual issue, but one FP pipeline per cycle -> 1 + 4
+    CostEstimate e = CostModel::estimate(independent(TACOp::ADD, 2), a53);
+    assertTrue(e.cyclesPerSample == 5, "two independent adds: 5 cycles");
+    vector<TacInst> chain = {inst(TACOp::ADD, "t0", "a", "b"), inst(TACOp::MUL, "y", "t0", "c")};
+    assertTrue(CostModel::estimate(chain, a53).cyclesPerSample == 8, "add -> mul waits for the add: 8 cycles");
+    // the divide is not pipelined: the second one issues 19 cycles after the first
+    assertTrue(CostModel::estimate(independent(TACOp::DIV, 2), a53).cyclesPerSample == 19 + 22,
+               "two divides: 41 cycles");
+}
+
+void CostModelTest::testCountsAndFrame() {
+    vector<TacInst> tac = mixedProgram();
+    CostEstimate e = CostModel::estimate(tac, target("x86-64"));
+    assertTrue(e.instructions == 8 && e.opCounts[TACOp::MUL] == 2 && e.opCounts[TACOp::FMA] == 1 &&
+                   e.opCounts[TACOp::DIV] == 1 && e.opCounts[TACOp::LOAD_CONST] == 1,
+               "instruction mix counted by opcode");
+    // a, b, t0, t1, t2, y, z, w
+    assertTrue(e.frameSlots == 8 && e.frameBytes == 64, "one 8-byte slot per distinct name");
+    assertTrue(CostModel::estimate({}, target("x86-64")).cyclesPerSample == 0, "empty program costs nothing");
+}
+
+void CostModelTest::testAllocation() {
+    const TargetModel x86 = target("x86-64");
+    vector<TacInst> copy = {inst(TACOp::ASSIGN, "y", "a")};
+    RegAllocResult coalesced;
+    coalesced.insts.resize(1);
+    coalesced.insts[0].coalesced = true;
+    CostEstimate e = CostModel::estimate(copy, x86, &coalesced);
+    assertTrue(e.instructions == 0 && e.cyclesPerSample == 0, "coalesced move is free");
+
+    vector<TacInst> add = {inst(TACOp::ADD, "y", "a", "b")};
+    RegAllocResult spilled;
+    spilled.insts.resize(1);
+    spilled.insts[0].arg1.kind = Location::SLOT;
+    spilled.insts[0].dest.kind = Location::SLOT;
+    spilled.spillSlots = 2;
+    e = CostModel::estimate(add, x86, &spilled);
+    assertTrue(e.criticalPath == 5 + 4 && e.resourceBound == 0.5 + 2 * 0.5 && e.spillBytes == 16,
+               "reload latency, spill traffic and spill bytes charged");
+}
+
+void CostModelTest::assertTrue(bool condition, const std::string& testName) {
+    if (condition)
+        std::cout << "[PASS] " << testName << "\n";
+    else
+        std::cout << "[FAIL] " << testName << "\n";
+}
@@ -0,0 +1,23 @@
+#ifndef COSTMODELTEST_H
+#define COSTMODELTEST_H
+
+#include "../tac/costModel.h"
+#include <iostream>
+
+class CostModelTest {
+public:
+    // Run all test cases for TargetModel and CostModel
+    void runAll();
+
+private:
+    void testTargets();
+    void testOutOfOrderBounds();
+    void testInOrderIssue();
+    void testCountsAndFrame();
+    void testAllocation();
+
+    // Helper to show test results
+    void assertTrue(bool condition, const std::string& testName);
+};
+
+#endif // COSTMODELTEST_H
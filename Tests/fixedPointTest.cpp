@@ -0,0 +1,236 @@
+#include "fixedPointTest.h"
+#include "tacTestUtil.h"
+#include "../runtime/aotKernel.h"
+#include "../errorHandler/errorHandler.h"
+#include <cmath>
+#include <cstring>
+#include <cstdlib>
+#include <fstream>
+#include <algorithm>
+
+#ifdef SIGNALLANG_AOT
+#include <dlfcn.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+// y = (a - 0.3) * b + a / c; z = fma(a, b, y) - b * b
+static vector<TacInst> rangedProgram() {
+    return {
+        inst(TACOp::LOAD_CONST, "t0", "0.3"),  inst(TACOp::SUB, "t1", "a", "t0"), inst(TACOp::MUL, "t2", "t1", "b"),
+        inst(TACOp::DIV, "t3", "a", "c"),      inst(TACOp::ADD, "t4", "t2", "t3"), inst(TACOp::ASSIGN, "y", "t4"),
+        inst(TACOp::FMA, "t5", "a", "b", "y"), inst(TACOp::MUL, "t6", "b", "b"),   inst(TACOp::SUB, "z", "t5", "t6"),
+    };
+}
+
+static map<string, Interval> mixedRanges() {
+    return {{"a", Interval(-1.0, 1.0)}, {"b", Interval(0.0, 4.0)}, {"c", Interval(0.5, 2.0)}};
+}
+
+// n samples inside the declared ranges of kernel's inputs
+static vector<double> samplesInRange(const FixedPointKernel &k, const map<string, Interval> &ranges, size_t n) {
+    vector<double> in;
+    unsigned seed = 5;
+    for (size_t s = 0; s < n; ++s)
+        for (const auto &name : k.inputNames()) {
+            seed = seed * 1103515245u + 12345u;
+            const Interval &r = ranges.at(name);
+            in.push_back(r.lo + (r.hi - r.lo) * ((seed >> 16) & 0x7fff) / 32767.0);
+        }
+    return in;
+}
+
+void FixedPointTest::runAll() {
+    testFormatsFromRanges();
+    testWithinErrorBound();
+    testSaturation();
+    testStateBound();
+    testColumnsMatchRows();
+    testGuardSampleInColumns();
+    testUndeclaredInput();
+    testEmittedC();
+    cout << "All FixedPointKernel tests completed.\n";
+}
+
+void FixedPointTest::testFormatsFromRanges() {
+    vector<TacInst> tac = {inst(TACOp::ADD, "y", "x", "z")};
+    map<string, Interval> ranges = {{"x", Interval(-1.0, 1.0)}, {"z", Interval(0.0, 0.25)}};
+    FixedPointKernel q15(tac, nullptr, ranges);
+    FixedPointOptions wide;
+    wide.bits = 32;
+    FixedPointKernel q31(tac, nullptr, ranges, wide);
+    assertTrue(q15.compiled() && q15.inputFrac(0) == 14 && q15.inputFrac(1) == 16 && q15.outputFrac(0) == 14,
+               "Q15 formats keep the most fraction bits the range allows");
+    assertTrue(q31.compiled() && q31.inputFrac(0) == 30 && FixedPointKernel::formatName(30, 32) == "Q1.30",
+               "Q31 formats follow the same rule");
+}
+
+void FixedPointTest::testWithinErrorBound() {
+    const map<string, Interval> ranges = mixedRanges();
+    Interpreter ref(rangedProgram());
+    bool within = true;
+    double bound15 = 0, bound31 = 0;
+    for (int bits : {16, 32}) {
+        FixedPointOptions options;
+        options.bits = bits;
+        FixedPointKernel fx(rangedProgram(), nullptr, ranges, options);
+        if (!fx.compiled()) { within = false; break; }
+        const size_t n = 2000, ni = fx.inputNames().size(), no = fx.outputNames().size();
+        vector<double> in = samplesInRange(fx, ranges, n), expect(n * no), got(n * no);
+        for (size_t s = 0; s < n; ++s) ref.run(&in[s * ni], &expect[s * no]);
+        fx.runBatch(in.data(), got.data(), n);
+        for (size_t s = 0; s < n; ++s)
+            for (size_t k = 0; k < no; ++k) within = within && fabs(got[s * no + k] - expect[s * no + k]) <= fx.outputError()[k];
+        (bits == 16 ? bound15 : bound31) = *max_element(fx.outputError().begin(), fx.outputError().end());
+    }
+    assertTrue(within, "outputs stay within the reported worst-case error");
+    assertTrue(bound15 < 0.05 && bound31 < bound15 * 1e-3, "Q31 bounds are far tighter than Q15 bounds");
+}
+
+void FixedPointTest::testSaturation() {
+    // y = x * 2.0 - 1.0, x declared in [-1, 1]
+    vector<TacInst> tac = {inst(TACOp::LOAD_CONST, "t0", "2.0"), inst(TACOp::MUL, "t1", "x", "t0"),
+                           inst(TACOp::LOAD_CONST, "t2", "1.0"), inst(TACOp::SUB, "y", "t1", "t2")};
+    FixedPointKernel fx(tac, nullptr, {{"x", Interval(-1.0, 1.0)}});
+    double high = 0, low = 0, x = 40.0;
+    fx.run(&x, &high);
+    x = -40.0;
+    fx.run(&x, &low);
+    assertTrue(high == 1.0 && low == -3.0, "inputs are clamped to their declared range");
+
+    // Q1.14 spans [-2, 2), wider than x's range: 2x - 1 at x = -2 is -5, below y's Q2.13
+    int16_t in[] = {-32768, 32767}, out[] = {0, 0};
+    const int16_t *ip = in;
+    int16_t *op = out;
+    fx.runInteger(&ip, &op, 2);
+    assertTrue(out[0] == -32768 && out[1] > 0, "integer results saturate instead of wrapping");
+}
+
+void FixedPointTest::testStateBound() {
+    ErrorHandler err;
+    SymbolTable sym(&err);
+    SymbolEntry s("s", "variable", "float");
+    s.is_state = true;
+    sym.insert(s);
+    // s = s * 0.75 + x * 0.25
+    vector<TacInst> tac = {inst(TACOp::LOAD_CONST, "t0", "0.75"), inst(TACOp::MUL, "t1", "s", "t0"),
+                           inst(TACOp::LOAD_CONST, "t2", "0.25"), inst(TACOp::MUL, "t3", "x", "t2"),
+                           inst(TACOp::ADD, "t4", "t1", "t3"),    inst(TACOp::ASSIGN, "s", "t4")};
+    map<string, Interval> ranges = {{"x", Interval(-1.0, 1.0)}, {"s", Interval(-1.0, 1.0)}};
+    FixedPointKernel fx(tac, &sym, ranges);
+    Interpreter ref(tac, &sym);
+    bool within = fx.compiled() && fx.outputError()[0] < 1e-3;
+    for (size_t k = 0; k < 5000 && within; ++k) {
+        double x = sin(0.01 * (double)k) * (k % 7 == 0 ? 1.0 : 0.9), y, expect;
+        fx.run(&x, &y);
+        ref.run(&x, &expect);
+        within = fabs(y - expect) <= fx.outputError()[0];
+    }
+    assertTrue(within, "state error converges and stays within its bound over a long stream");
+}
+
+void FixedPointTest::testColumnsMatchRows() {
+    const map<string, Interval> ranges = mixedRanges();
+    bool same = true;
+    for (int bits : {16, 32}) {
+        FixedPointOptions options;
+        options.bits = bits;
+        FixedPointKernel fx(rangedProgram(), nullptr, ranges, options);
+        const size_t n = 1001, ni = fx.inputNames().size(), no = fx.outputNames().size();
+        vector<double> in = samplesInRange(fx, ranges, n), rows(n * no), inCols(n * ni), outCols(n * no);
+        vector<const double *> ip(ni);
+        vector<double *> op(no);
+        for (size_t k = 0; k < ni; ++k) ip[k] = &inCols[k * n];
+        for (size_t k = 0; k < no; ++k) op[k] = &outCols[k * n];
+        for (size_t s = 0; s < n; ++s)
+            for (size_t k = 0; k < ni; ++k) inCols[k * n + s] = in[s * ni + k];
+        fx.runBatch(in.data(), rows.data(), n);
+        fx.runColumns(ip.data(), op.data(), n);
+        for (size_t s = 0; s < n; ++s)
+            for (size_t k = 0; k < no; ++k) same = same && rows[s * no + k] == outCols[k * n + s];
+    }
+    assertTrue(same, "column kernels (int16 SIMD for Q15) are bitwise equal to the scalar path");
+}
+
+void FixedPointTest::testGuardSampleInColumns() {
+    // c = 2e-5 is in range but quantizes to 0 in Q15, so the guard fires on the integer
+    // columns; the sample is past the first column block and is named by its batch index
+    vector<TacInst> tac = {guard(TACOp::GUARD_NONZERO, "c"), inst(TACOp::DIV, "y", "a", "c")};
+    const map<string, Interval> ranges = {{"a", Interval(-2e-5, 2e-5)}, {"c", Interval(2e-5, 2.0)}};
+    FixedPointKernel fx(tac, nullptr, ranges);
+    const size_t n = 700;
+    vector<double> c(n, 1.0), a(n, 1e-5), y(n);
+    c[601] = 2e-5;
+    const double *in[] = {c.data(), a.data()};
+    double *out[] = {y.data()};
+    string msg;
+    try {
+        fx.runColumns(in, out, n);
+    } catch (const RuntimeError &e) {
+        msg = e.what();
+    }
+    assertTrue(fx.compiled() && msg == "division by zero: c is 0.0 (sample 601)",
+               "runColumns names a failing guard's sample by its batch index");
+}
+
+void FixedPointTest::testUndeclaredInput() {
+    map<string, Interval> ranges = mixedRanges();
+    ranges.erase("c");
+    FixedPointKernel fx(rangedProgram(), nullptr, ranges);
+    Interpreter ref(rangedProgram());
+    double in[] = {0.5, 2.0, 0.25}, got[2], expect[2];
+    fx.run(in, got);
+    ref.run(in, expect);
+    assertTrue(!fx.compiled() && fx.fallbackReason().find("'c'") != string::npos &&
+                   memcmp(got, expect, sizeof got) == 0,
+               "an input without a declared range falls back to the interpreter");
+}
+
+void FixedPointTest::testEmittedC() {
+    FixedPointKernel fx(rangedProgram(), nullptr, mixedRanges());
+    const string src = fx.emitC();
+    assertTrue(src.find("#include <stdint.h>") != string::npos && src.find("double") == string::npos &&
+                   src.find("int signal_fixed(const int16_t *in, int16_t *out, int16_t *state)") != string::npos,
+               "emitted C is integer-only");
+#ifdef SIGNALLANG_AOT
+    // build it with the host compiler and compare against the kernel's integer path
+    const AotOptions host = AotOptions::defaults();
+    const string base = "/tmp/signallang-fixed-test-" + to_string(getpid());
+    ofstream(base + ".c") << src;
+    const string cmd = host.compiler + " -x c++ -O2 -fPIC -shared -o " + base + ".so " + base + ".c > /dev/null 2>&1";
+    void *handle = system(cmd.c_str()) == 0 ? dlopen((base + ".so").c_str(), RTLD_NOW | RTLD_LOCAL) : nullptr;
+    typedef int (*Fn)(const int16_t *, int16_t *, int16_t *);
+    Fn fn = handle ? reinterpret_cast<Fn>(dlsym(handle, "signal_fixed")) : nullptr;
+    if (!fn) {
+        cout << "(emitted C not built: " << host.compiler << " unavailable)\n";
+    } else {
+        const size_t n = 500, ni = fx.inputNames().size(), no = fx.outputNames().size();
+        vector<double> in = samplesInRange(fx, mixedRanges(), n);
+        vector<int16_t> q(n * ni), cols(n * ni), outCols(n * no), row(no);
+        vector<const int16_t *> ip(ni);
+        vector<int16_t *> op(no);
+        for (size_t k = 0; k < ni; ++k) ip[k] = &cols[k * n];
+        for (size_t k = 0; k < no; ++k) op[k] = &outCols[k * n];
+        for (size_t s = 0; s < n; ++s)
+            for (size_t k = 0; k < ni; ++k) q[s * ni + k] = cols[k * n + s] = (int16_t)fx.quantize(k, in[s * ni + k]);
+        fx.runInteger(ip.data(), op.data(), n);
+        bool same = true;
+        for (size_t s = 0; s < n; ++s) {
+            same = same && fn(&q[s * ni], row.data(), nullptr) == -1;
+            for (size_t k = 0; k < no; ++k) same = same && row[k] == outCols[k * n + s];
+        }
+        assertTrue(same, "emitted C is bitwise equal to the kernel");
+    }
+    if (handle) dlclose(handle);
+    remove((base + ".c").c_str());
+    remove((base + ".so").c_str());
+#endif
+}
+
+void FixedPointTest::assertTrue(bool condition, const std::string& testName) {
+    if (condition)
+        std::cout << "[PASS] " << testName << "\n";
+    else
+        std::cout << "[FAIL] " << testName << "\n";
+}
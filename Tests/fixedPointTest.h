@@ -0,0 +1,26 @@
+#ifndef FIXEDPOINTTEST_H
+#define FIXEDPOINTTEST_H
+
+#include "../runtime/fixedPoint.h"
+#include <iostream>
+
+class FixedPointTest {
+public:
+    // Run all test cases for FixedPointKernel
+    void runAll();
+
+private:
+    void testFormatsFromRanges();
+    void testWithinErrorBound();
+    void testSaturation();
+    void testStateBound();
+    void testColumnsMatchRows();
+    void testGuardSampleInColumns();
+    void testUndeclaredInput();
+    void testEmittedC();
+
+    // Helper to show test results
+    void assertTrue(bool condition, const std::string& testName);
+};
+
+#endif // FIXEDPOINTTEST_H
@@ -0,0 +1,107 @@
+#include "floatModeTest.h"
+#include "tacTestUtil.h"
+#include "../runtime/interpreter.h"
+#include "../runtime/tieredKernel.h"
+#include "../tac/passManager.h"
+#include "../errorHandler/errorHandler.h"
+#include <algorithm>
+
+using namespace std;
+
+void FloatModeTest::runAll() {
+    testFlushScope();
+    testTieredDenormals();
+    testReassociation();
+    testFastMathPipeline();
+    cout << "All float mode tests completed.\n";
+}
+
+void FloatModeTest::testFlushScope() {
+    if (!DenormalScope::supported()) {
+        assertTrue(!DenormalScope::flushing(), "no float control register: scopes are no-ops");
+        return;
+    }
+    volatile double tiny = 1e-300, scale = 1e-10; // product 1e-310 is subnormal
+    const bool before = tiny * scale != 0.0 && !DenormalScope::flushing();
+    bool inside, nested;
+    {
+        DenormalScope flush(DenormalMode::FLUSH);
+        inside = tiny * scale == 0.0 && DenormalScope::flushing();
+        {
+            DenormalScope again(DenormalMode::FLUSH);
+            DenormalScope keep(DenormalMode::PRESERVE);
+        }
+        nested = DenormalScope::flushing();
+    }
+    assertTrue(before && inside, "FLUSH scope turns a subnormal product into zero");
+    assertTrue(nested && tiny * scale != 0.0 && !DenormalScope::flushing(),
+               "inner scopes keep the outer setting; leaving restores gradual underflow");
+}
+
+void FloatModeTest::testTieredDenormals() {
+    // y = x * 1e-10
+    vector<TacInst> tac = {inst(TACOp::LOAD_CONST, "t0", "1e-10"), inst(TACOp::MUL, "y", "x", "t0")};
+    TierCompiler compiler;
+    TierOptions flush, keep;
+    flush.denormals = DenormalMode::FLUSH;
+    TieredKernel flushed(tac, nullptr, compiler, flush), kept(tac, nullptr, compiler, keep);
+    double x = 1e-300, a = -1, b = -1;
+    flushed.run(&x, &a);
+    kept.run(&x, &b);
+    const bool expectFlush = DenormalScope::supported();
+    assertTrue((a == 0.0) == expectFlush && b != 0.0 && !DenormalScope::flushing(),
+               "denormal mode is per program and ends with the batch");
+}
+
+void FloatModeTest::testReassociation() {
+    // y = (((a + 1) + b) + 2) + c
+    vector<TacInst> tac = {
+        inst(TACOp::LOAD_CONST, "t0", "1.0"), inst(TACOp::ADD, "t1", "a", "t0"), inst(TACOp::ADD, "t2", "t1", "b"),
+        inst(TACOp::LOAD_CONST, "t3", "2.0"), inst(TACOp::ADD, "t4", "t2", "t3"), inst(TACOp::ADD, "t5", "t4", "c"),
+        inst(TACOp::ASSIGN, "y", "t5"),
+    };
+    vector<TacInst> fast = tac;
+    ReassocStats st = Reassociator::run(fast);
+    assertTrue(st.chains == 1 && st.folded == 1 && st.depthBefore == 4 && st.depthAfter == 2,
+               "chain of five operands: constants folded, depth 4 -> 2");
+
+    Interpreter exact(tac), reassociated(fast);
+    double in[3] = {3.0, -5.0, 11.0}, expect = 0, got = 0;
+    exact.run(in, &expect);
+    reassociated.run(in, &got);
+    assertTrue(got == expect && got == 12.0, "reassociated chain computes the same sum");
+
+    // a program variable in the middle ends the chain: nothing to rewrite
+    vector<TacInst> split = {inst(TACOp::ADD, "s", "a", "b"), inst(TACOp::ADD, "t0", "s", "c"),
+                             inst(TACOp::ADD, "y", "t0", "d")};
+    assertTrue(Reassociator::run(split).chains == 0, "chains stop at program variables");
+}
+
+void FloatModeTest::testFastMathPipeline() {
+    // nx = x / r; ny = y / r
+    vector<TacInst> tac = {inst(TACOp::DIV, "nx", "x", "r"), inst(TACOp::DIV, "ny", "y", "r")};
+    ErrorHandler err;
+    SymbolTable sym(&err);
+    auto divisions = [](const vector<TacInst> &code) {
+        return count_if(code.begin(), code.end(), [](const TacInst &i) { return i.op == TACOp::DIV; });
+    };
+
+    vector<TacInst> strict = tac, fast = tac;
+    PassManager strictPm(OptLevel::O1), fastPm(OptLevel::O1);
+    fastPm.setPrecision(PrecisionMode::STRICT);
+    fastPm.setMathProfile(MathProfile::FASTMATH);
+    strictPm.run(strict, sym);
+    fastPm.run(fast, sym);
+    assertTrue(fastPm.has("reassociate") && !strictPm.has("reassociate"), "fastmath adds the reassociation pass");
+    assertTrue(divisions(strict) == 2 && divisions(fast) == 1, "fastmath multiplies by one reciprocal of r");
+
+    fastPm.setMathProfile(MathProfile::STRICT);
+    assertTrue(!fastPm.has("reassociate"), "switching back to STRICT removes it");
+}
+
+void FloatModeTest::assertTrue(bool condition, const std::string& testName) {
+    if (condition)
+        std::cout << "[PASS] " << testName << "\n";
+    else
+        std::cout << "[FAIL] " << testName << "\n";
+}
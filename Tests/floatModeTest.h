@@ -0,0 +1,23 @@
+#ifndef FLOATMODETEST_H
+#define FLOATMODETEST_H
+
+#include "../runtime/floatEnv.h"
+#include "../tac/reassociate.h"
+#include <iostream>
+
+class FloatModeTest {
+public:
+    // Run all test cases for DenormalScope and the fastmath profile
+    void runAll();
+
+private:
+    void testFlushScope();
+    void testTieredDenormals();
+    void testReassociation();
+    void testFastMathPipeline();
+
+    // Helper to show test results
+    void assertTrue(bool condition, const std::string& testName);
+};
+
+#endif // FLOATMODETEST_H
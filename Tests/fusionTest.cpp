@@ -0,0 +1,118 @@
+#include "fusionTest.h"
+#include "tacTestUtil.h"
+#include "../errorHandler/errorHandler.h"
+#include <cmath>
+
+using namespace std;
+
+static int countOp(const vector<TacInst> &tac, TACOp op) {
+    int n = 0;
+    for (const auto &i : tac) n += i.op == op;
+    return n;
+}
+
+// y = y * k + x, with y a state variable
+static vector<TacInst> onePole(const string &k) {
+    return {inst(TACOp::LOAD_CONST, "t0", k), inst(TACOp::MUL, "t1", "y", "t0"), inst(TACOp::ADD, "t2", "t1", "x"),
+            inst(TACOp::ASSIGN, "y", "t2")};
+}
+
+void FusionTest::runAll() {
+    testSharedSubexpressions();
+    testGuardsOncePerValue();
+    testSignedZeroConstantsKept();
+    testStatePerProgram();
+    testStateCopyOutlivesUpdate();
+    testPrecisionKept();
+    cout << "All ProgramFuser tests completed.\n";
+}
+
+void FusionTest::testSharedSubexpressions() {
+    // A: y = (a + b) * c;  B: z = (b + a) * c - a
+    FusedModule m = ProgramFuser::fuse({
+        {"A", {inst(TACOp::ADD, "t0", "a", "b"), inst(TACOp::MUL, "t1", "t0", "c"), inst(TACOp::ASSIGN, "y", "t1")},
+         {}},
+        {"B", {inst(TACOp::ADD, "t0", "b", "a"), inst(TACOp::MUL, "t1", "t0", "c"), inst(TACOp::SUB, "t2", "t1", "a"),
+               inst(TACOp::ASSIGN, "z", "t2")}, {}},
+    });
+    assertTrue(m.inputs == vector<string>({"a", "b", "c"}) && m.state.empty(), "inputs shared across programs");
+    assertTrue(countOp(m.tac, TACOp::ADD) == 1 && countOp(m.tac, TACOp::MUL) == 1 && m.sharedValues == 2,
+               "commuted a + b and the product computed once");
+    map<string, double> out = Interpreter(m.tac).run(map<string, double>{{"a", 1.5}, {"b", 2.0}, {"c", -3.0}});
+    assertTrue(m.outputs["A"]["y"] == "A.y" && out["A.y"] == -10.5 && out["B.z"] == -12.0, "outputs published per program");
+}
+
+void FusionTest::testGuardsOncePerValue() {
+    // both programs divide by d behind a guard
+    vector<TacInst> prog = {guard(TACOp::GUARD_NONZERO, "d"), inst(TACOp::DIV, "t0", "n", "d"), inst(TACOp::ASSIGN, "q", "t0")};
+    FusedModule m = ProgramFuser::fuse({{"A", prog, {}}, {"B", prog, {}}});
+    assertTrue(countOp(m.tac, TACOp::GUARD_NONZERO) == 1 && countOp(m.tac, TACOp::DIV) == 1, "one guard, one division");
+}
+
+void FusionTest::testSignedZeroConstantsKept() {
+    // A: y = x * 0.0;  B: z = x * -0.0
+    FusedModule m = ProgramFuser::fuse({
+        {"A", {inst(TACOp::LOAD_CONST, "t0", "0.0"), inst(TACOp::MUL, "y", "x", "t0")}, {}},
+        {"B", {inst(TACOp::LOAD_CONST, "t0", "-0.0"), inst(TACOp::MUL, "z", "x", "t0")}, {}},
+    });
+    map<string, double> out = Interpreter(m.tac).run(map<string, double>{{"x", 2.0}});
+    assertTrue(countOp(m.tac, TACOp::MUL) == 2 && !std::signbit(out["A.y"]) && std::signbit(out["B.z"]),
+               "0.0 and -0.0 are different values");
+}
+
+void FusionTest::testStatePerProgram() {
+    // two one-pole filters, both with a state variable y
+    FusedModule m = ProgramFuser::fuse({{"A", onePole("0.5"), {"y"}}, {"B", onePole("0.25"), {"y"}}});
+    assertTrue(m.inputs == vector<string>({"x"}) && m.state == vector<string>({"A.y", "B.y"}),
+               "state read from A.y and B.y, not a shared channel y");
+
+    ErrorHandler err;
+    SymbolTable sym(&err), symA(&err), symB(&err);
+    declareState(sym, {"A.y", "B.y"});
+    declareState(symA, {"y"});
+    declareState(symB, {"y"});
+    Interpreter fused(m.tac, &sym), a(onePole("0.5"), &symA), b(onePole("0.25"), &symB);
+    bool same = true;
+    for (double x : {1.0, 2.0, -4.0, 0.5}) {
+        map<string, double> got = fused.run(map<string, double>{{"x", x}});
+        same = same && got["A.y"] == a.run(map<string, double>{{"x", x}})["y"] &&
+               got["B.y"] == b.run(map<string, double>{{"x", x}})["y"];
+    }
+    assertTrue(same, "each filter keeps its own state");
+}
+
+void FusionTest::testStateCopyOutlivesUpdate() {
+    // w = y; y = x; q = w + 1 -- w still holds the previous y after y is published
+    vector<TacInst> prog = {inst(TACOp::ASSIGN, "w", "y"), inst(TACOp::ASSIGN, "y", "x"),
+                            inst(TACOp::LOAD_CONST, "t0", "1.0"), inst(TACOp::ADD, "t1", "w", "t0"),
+                            inst(TACOp::ASSIGN, "q", "t1")};
+    FusedModule m = ProgramFuser::fuse({{"A", prog, {}}});
+    assertTrue(m.state == vector<string>({"A.y"}), "read-then-redefined name is carried even without a symbol");
+    map<string, double> out = Interpreter(m.tac).run(map<string, double>{{"x", 5.0}, {"A.y", 2.0}});
+    assertTrue(out["A.y"] == 5.0 && out["A.w"] == 2.0 && out["A.q"] == 3.0, "copies read the previous value");
+}
+
+void FusionTest::testPrecisionKept() {
+    // A: y = f32(a * b), w = f32(y) + 0.1;  B: z = a * b, v = z + 0.1 -- same text, different values
+    vector<TacInst> a = {inst(TACOp::MUL, "y", "a", "b"), inst(TACOp::ASSIGN, "t0", "a"),
+                         inst(TACOp::LOAD_CONST, "t1", "0.1"), inst(TACOp::ADD, "w", "t0", "t1")};
+    a[0].prec = a[1].prec = a[2].prec = TacPrecision::F32;
+    vector<TacInst> b = {inst(TACOp::MUL, "z", "a", "b"), inst(TACOp::ASSIGN, "t0", "a"),
+                         inst(TACOp::LOAD_CONST, "t1", "0.1"), inst(TACOp::ADD, "v", "t0", "t1")};
+    FusedModule m = ProgramFuser::fuse({{"A", a, {}}, {"B", b, {}}});
+    assertTrue(countOp(m.tac, TACOp::MUL) == 2 && countOp(m.tac, TACOp::LOAD_CONST) == 2 && m.sharedValues == 0,
+               "F32 and F64 versions of an expression are not merged");
+
+    const map<string, double> in = {{"a", 1.1}, {"b", 3.3}};
+    map<string, double> out = Interpreter(m.tac).run(in), ra = Interpreter(a).run(in), rb = Interpreter(b).run(in);
+    assertTrue(out["A.y"] == ra["y"] && out["A.w"] == ra["w"] && out["B.z"] == rb["z"] && out["B.v"] == rb["v"] &&
+                   out["A.w"] != out["B.v"],
+               "F32 copies keep their rounding");
+}
+
+void FusionTest::assertTrue(bool condition, const std::string& testName) {
+    if (condition)
+        std::cout << "[PASS] " << testName << "\n";
+    else
+        std::cout << "[FAIL] " << testName << "\n";
+}
@@ -0,0 +1,24 @@
+#ifndef FUSIONTEST_H
+#define FUSIONTEST_H
+
+#include "../tac/fusion.h"
+#include <iostream>
+
+class FusionTest {
+public:
+    // Run all test cases for ProgramFuser
+    void runAll();
+
+private:
+    void testSharedSubexpressions();
+    void testGuardsOncePerValue();
+    void testSignedZeroConstantsKept();
+    void testStatePerProgram();
+    void testStateCopyOutlivesUpdate();
+    void testPrecisionKept();
+
+    // Helper to show test results
+    void assertTrue(bool condition, const std::string& testName);
+};
+
+#endif // FUSIONTEST_H
@@ -0,0 +1,109 @@
+#include "guardsTest.h"
+#include "tacTestUtil.h"
+
+using namespace std;
+
+static int count(const vector<TacInst> &tac, TACOp op, const string &arg = "") {
+    int n = 0;
+    for (const auto &i : tac) n += i.op == op && (arg.empty() || i.arg1 == arg);
+    return n;
+}
+
+// y = a / b
+static vector<TacInst> quotient() {
+    return {inst(TACOp::DIV, "t0", "a", "b"), inst(TACOp::ASSIGN, "y", "t0")};
+}
+
+void GuardsTest::runAll() {
+    testProvenDivisors();
+    testUnknownDivisor();
+    testOutputs();
+    testSameValueGuardedOnce();
+    testRedefinedDivisor();
+    testIdempotent();
+    cout << "All GuardInserter tests completed.\n";
+}
+
+void GuardsTest::testProvenDivisors() {
+    vector<TacInst> tac = quotient();
+    GuardStats st = GuardInserter::insert(tac, {{"a", Interval(-1, 1)}, {"b", Interval(0.5, 2)}});
+    assertTrue(st.candidates == 2 && st.emitted == 0 && st.eliminated == 2 && tac.size() == 2,
+               "b in [0.5, 2] and a bounded: no guards");
+
+    // b + 1 with b in [0, 1] is at least 1
+    tac = {inst(TACOp::LOAD_CONST, "t0", "1.0"), inst(TACOp::ADD, "t1", "b", "t0"), inst(TACOp::DIV, "t2", "a", "t1"),
+           inst(TACOp::ASSIGN, "y", "t2")};
+    st = GuardInserter::insert(tac, {{"a", Interval(-1, 1)}, {"b", Interval(0, 1)}});
+    assertTrue(st.emitted == 0, "divisor proven non-zero through arithmetic");
+}
+
+void GuardsTest::testUnknownDivisor() {
+    vector<TacInst> tac = quotient();
+    GuardStats st = GuardInserter::insert(tac, {{"a", Interval(-1, 1)}, {"b", Interval(-1, 1)}});
+    assertTrue(tac[0].op == TACOp::GUARD_NONZERO && tac[0].arg1 == "b" && tac[1].op == TACOp::DIV,
+               "divisor range through zero: guard right before the division");
+    bool threw = false;
+    try {
+        Interpreter(tac).run(map<string, double>{{"a", 1.0}, {"b", 0.0}});
+    } catch (const RuntimeError &) {
+        threw = true;
+    }
+    assertTrue(threw && Interpreter(tac).run(map<string, double>{{"a", 1.0}, {"b", 4.0}})["y"] == 0.25,
+               "fires on b = 0 only");
+    assertTrue(st.emitted == count(tac, TACOp::GUARD_NONZERO) + count(tac, TACOp::GUARD_FINITE),
+               "stats count what was emitted");
+}
+
+void GuardsTest::testOutputs() {
+    // y = a * a; z = y * y -- with a unbounded both outputs may overflow
+    vector<TacInst> tac = {inst(TACOp::MUL, "y", "a", "a"), inst(TACOp::MUL, "z", "y", "y")};
+    GuardStats st = GuardInserter::insert(tac, {});
+    assertTrue(st.candidates == 2 && count(tac, TACOp::GUARD_FINITE) == 2, "unranged outputs checked for finiteness");
+    assertTrue(tac[2].op == TACOp::GUARD_FINITE && tac[2].arg1 == "y" && tac[3].arg1 == "z",
+               "after the last instruction, in order of definition");
+
+    tac = {inst(TACOp::MUL, "y", "a", "a"), inst(TACOp::MUL, "z", "y", "y")};
+    st = GuardInserter::insert(tac, {{"a", Interval(-1e200, 1e200)}});
+    assertTrue(count(tac, TACOp::GUARD_FINITE, "y") == 1 && count(tac, TACOp::GUARD_FINITE, "z") == 1,
+               "a * a can overflow for |a| up to 1e200");
+    tac = {inst(TACOp::MUL, "y", "a", "a"), inst(TACOp::MUL, "z", "y", "y")};
+    st = GuardInserter::insert(tac, {{"a", Interval(-1e50, 1e50)}});
+    assertTrue(st.emitted == 0 && st.eliminated == 2, "and cannot for |a| up to 1e50");
+}
+
+void GuardsTest::testSameValueGuardedOnce() {
+    // x / b, y / b, z / b: one guard on b
+    vector<TacInst> tac = {inst(TACOp::DIV, "p", "x", "b"), inst(TACOp::DIV, "q", "y", "b"),
+                           inst(TACOp::DIV, "r", "z", "b")};
+    map<string, Interval> in = {{"x", Interval(0, 1)}, {"y", Interval(0, 1)}, {"z", Interval(0, 1)},
+                                {"b", Interval(0, 1)}};
+    GuardStats st = GuardInserter::insert(tac, in);
+    assertTrue(count(tac, TACOp::GUARD_NONZERO) == 1 && tac[0].op == TACOp::GUARD_NONZERO,
+               "one guard for three divisions by the same b");
+    assertTrue(st.candidates == 6 && st.eliminated == st.candidates - st.emitted, "the other two count as eliminated");
+}
+
+void GuardsTest::testRedefinedDivisor() {
+    // p = x / b; b = b - 1; q = x / b -- the new b is a different value
+    vector<TacInst> tac = {inst(TACOp::DIV, "p", "x", "b"), inst(TACOp::LOAD_CONST, "t0", "1.0"),
+                           inst(TACOp::SUB, "b", "b", "t0"), inst(TACOp::DIV, "q", "x", "b")};
+    GuardInserter::insert(tac, {{"x", Interval(0, 1)}, {"b", Interval(0, 2)}});
+    assertTrue(count(tac, TACOp::GUARD_NONZERO, "b") == 2 && tac[4].op == TACOp::GUARD_NONZERO,
+               "each definition of b is guarded before its division");
+}
+
+void GuardsTest::testIdempotent() {
+    vector<TacInst> tac = quotient();
+    map<string, Interval> in = {{"a", Interval(-1, 1)}, {"b", Interval(-1, 1)}};
+    GuardInserter::insert(tac, in);
+    vector<TacInst> once = tac;
+    GuardStats st = GuardInserter::insert(tac, in);
+    assertTrue(st.emitted == 0 && tac.size() == once.size(), "running twice adds no guards");
+}
+
+void GuardsTest::assertTrue(bool condition, const std::string& testName) {
+    if (condition)
+        std::cout << "[PASS] " << testName << "\n";
+    else
+        std::cout << "[FAIL] " << testName << "\n";
+}
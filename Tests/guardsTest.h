@@ -0,0 +1,24 @@
+#ifndef GUARDSTEST_H
+#define GUARDSTEST_H
+
+#include "../tac/guards.h"
+#include <iostream>
+
+class GuardsTest {
+public:
+    // Run all test cases for GuardInserter
+    void runAll();
+
+private:
+    void testProvenDivisors();
+    void testUnknownDivisor();
+    void testOutputs();
+    void testSameValueGuardedOnce();
+    void testRedefinedDivisor();
+    void testIdempotent();
+
+    // Helper to show test results
+    void assertTrue(bool condition, const std::string& testName);
+};
+
+#endif // GUARDSTEST_H
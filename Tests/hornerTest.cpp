@@ -0,0 +1,120 @@
+#include "hornerTest.h"
+#include "tacTestUtil.h"
+#include <cmath>
+
+using namespace std;
+
+static int count(const vector<TacInst> &tac, TACOp op) {
+    int n = 0;
+    for (const auto &i : tac) n += i.op == op;
+    return n;
+}
+
+// y = 2*x*x*x - 3*x*x + 0.5*x + 1, six multiplies in source order
+static vector<TacInst> cubic() {
+    return {
+        inst(TACOp::LOAD_CONST, "t0", "2.0"), inst(TACOp::MUL, "t1", "t0", "x"),   inst(TACOp::MUL, "t2", "t1", "x"),
+        inst(TACOp::MUL, "t3", "t2", "x"),    inst(TACOp::LOAD_CONST, "t4", "3.0"), inst(TACOp::MUL, "t5", "t4", "x"),
+        inst(TACOp::MUL, "t6", "t5", "x"),    inst(TACOp::SUB, "t7", "t3", "t6"),   inst(TACOp::LOAD_CONST, "t8", "0.5"),
+        inst(TACOp::MUL, "t9", "t8", "x"),    inst(TACOp::ADD, "t10", "t7", "t9"),  inst(TACOp::LOAD_CONST, "t11", "1.0"),
+        inst(TACOp::ADD, "t12", "t10", "t11"), inst(TACOp::ASSIGN, "y", "t12"),
+    };
+}
+
+// Rewritten program agrees with the source to a few ulp over x in [-2, 2].
+static bool close(const vector<TacInst> &a, const vector<TacInst> &b, map<string, double> in = {}) {
+    for (double x = -2.0; x <= 2.0; x += 0.375) {
+        in["x"] = x;
+        double ya = Interpreter(a).run(in)["y"], yb = Interpreter(b).run(in)["y"];
+        if (fabs(ya - yb) > 1e-14 * max(1.0, fabs(ya))) return false;
+    }
+    return true;
+}
+
+void HornerTest::runAll() {
+    testHorner();
+    testEstrin();
+    testFma();
+    testSymbolicCoefficients();
+    testNotCheaper();
+    testRedefinedVariable();
+    cout << "All PolynomialRewriter tests completed.\n";
+}
+
+void HornerTest::testHorner() {
+    vector<TacInst> tac = cubic();
+    PolyStats st = PolynomialRewriter::run(tac, PolyForm::HORNER);
+    assertTrue(st.polynomials == 1 && st.mulsBefore == 6 && st.mulsAfter == 3 && count(tac, TACOp::MUL) == 3,
+               "cubic: 6 multiplies -> 3");
+    assertTrue(close(cubic(), tac), "same values to rounding");
+    // the root keeps its name (t12, read by y = t12); everything else is a fresh temp
+    const int nextBefore = nextTempIndex(cubic());
+    bool fresh = tac[tac.size() - 2].dest == "t12" && tac.back().dest == "y";
+    for (size_t i = 0; i + 2 < tac.size(); ++i) fresh = fresh && stoi(tac[i].dest.substr(1)) >= nextBefore;
+    assertTrue(fresh, "root keeps its name, new code uses fresh temps");
+}
+
+void HornerTest::testEstrin() {
+    vector<TacInst> tac = cubic();
+    PolyStats st = PolynomialRewriter::run(tac, PolyForm::ESTRIN);
+    bool square = false;
+    for (const auto &i : tac) square = square || (i.op == TACOp::MUL && i.arg1 == "x" && i.arg2 == "x");
+    assertTrue(st.polynomials == 1 && st.mulsAfter == 4 && square, "(1 + 0.5x) + (-3 + 2x) * x^2: 6 multiplies -> 4");
+    assertTrue(close(cubic(), tac), "same values to rounding");
+}
+
+void HornerTest::testFma() {
+    vector<TacInst> tac = cubic();
+    PolyStats st = PolynomialRewriter::run(tac, PolyForm::HORNER, true);
+    assertTrue(st.fmas == 3 && count(tac, TACOp::FMA) == 3 && count(tac, TACOp::MUL) == 0, "every step one FMA");
+    assertTrue(close(cubic(), tac), "same values to rounding");
+}
+
+void HornerTest::testSymbolicCoefficients() {
+    // y = a*x*x + b*x + c: coefficients are inputs
+    vector<TacInst> src = {
+        inst(TACOp::MUL, "t0", "a", "x"), inst(TACOp::MUL, "t1", "t0", "x"), inst(TACOp::MUL, "t2", "b", "x"),
+        inst(TACOp::ADD, "t3", "t1", "t2"), inst(TACOp::ADD, "t4", "t3", "c"), inst(TACOp::ASSIGN, "y", "t4"),
+    };
+    vector<TacInst> tac = src;
+    PolyStats st = PolynomialRewriter::run(tac, PolyForm::HORNER);
+    assertTrue(st.polynomials == 1 && st.mulsBefore == 3 && st.mulsAfter == 2, "(a*x + b)*x + c");
+    assertTrue(close(src, tac, {{"a", 1.5}, {"b", -0.25}, {"c", 3.0}}), "same values to rounding");
+}
+
+void HornerTest::testNotCheaper() {
+    // y = x*x*x + 1: no middle terms, Horner would need as many multiplies
+    vector<TacInst> tac = {inst(TACOp::MUL, "t0", "x", "x"), inst(TACOp::MUL, "t1", "t0", "x"),
+                           inst(TACOp::LOAD_CONST, "t2", "1.0"), inst(TACOp::ADD, "t3", "t1", "t2"),
+                           inst(TACOp::ASSIGN, "y", "t3")};
+    size_t before = tac.size();
+    PolyStats st = PolynomialRewriter::run(tac, PolyForm::HORNER);
+    assertTrue(st.polynomials == 0 && tac.size() == before, "left alone when not strictly cheaper");
+    vector<TacInst> linear = {inst(TACOp::MUL, "t0", "a", "x"), inst(TACOp::ADD, "y", "t0", "b")};
+    assertTrue(PolynomialRewriter::run(linear, PolyForm::ESTRIN).polynomials == 0, "degree 1 is left alone");
+}
+
+void HornerTest::testRedefinedVariable() {
+    // t0 = x*x; x = q; t1 = t0*x + t0 -- the first x is gone by the root, nothing may read it there
+    vector<TacInst> src = {
+        inst(TACOp::MUL, "t0", "x", "x"), inst(TACOp::ASSIGN, "x", "q"), inst(TACOp::MUL, "t1", "t0", "x"),
+        inst(TACOp::MUL, "t2", "t1", "x"), inst(TACOp::ADD, "t3", "t2", "t0"), inst(TACOp::ASSIGN, "y", "t3"),
+    };
+    vector<TacInst> tac = src;
+    PolynomialRewriter::run(tac, PolyForm::HORNER);
+    bool same = true;
+    for (double x : {0.5, -2.0})
+        for (double q : {3.0, -1.25}) {
+            map<string, double> in = {{"x", x}, {"q", q}};
+            double want = Interpreter(src).run(in)["y"], got = Interpreter(tac).run(in)["y"];
+            same = same && fabs(want - got) <= 1e-14 * max(1.0, fabs(want));
+        }
+    assertTrue(same, "values of x from before its redefinition are not read after it");
+}
+
+void HornerTest::assertTrue(bool condition, const std::string& testName) {
+    if (condition)
+        std::cout << "[PASS] " << testName << "\n";
+    else
+        std::cout << "[FAIL] " << testName << "\n";
+}
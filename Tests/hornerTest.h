@@ -0,0 +1,24 @@
+#ifndef HORNERTEST_H
+#define HORNERTEST_H
+
+#include "../tac/horner.h"
+#include <iostream>
+
+class HornerTest {
+public:
+    // Run all test cases for PolynomialRewriter
+    void runAll();
+
+private:
+    void testHorner();
+    void testEstrin();
+    void testFma();
+    void testSymbolicCoefficients();
+    void testNotCheaper();
+    void testRedefinedVariable();
+
+    // Helper to show test results
+    void assertTrue(bool condition, const std::string& testName);
+};
+
+#endif // HORNERTEST_H
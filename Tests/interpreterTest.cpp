@@ -0,0 +1,108 @@
+#include "interpreterTest.h"
+#include "tacTestUtil.h"
+#include "../errorHandler/errorHandler.h"
+#include <cmath>
+
+using namespace std;
+
+void InterpreterTest::runAll() {
+    testArithmetic();
+    testRecycledTemps();
+    testStatePersists();
+    testFloat32AndFma();
+    testGuardsThrow();
+    testProfilerHook();
+    cout << "All Interpreter tests completed.\n";
+}
+
+void InterpreterTest::testArithmetic() {
+    // y = (a + 2.5) * b - a / b
+    vector<TacInst> tac = {
+        inst(TACOp::LOAD_CONST, "t0", "2.5"),
+        inst(TACOp::ADD, "t1", "a", "t0"),
+        inst(TACOp::MUL, "t0", "t1", "b"),
+        inst(TACOp::DIV, "t1", "a", "b"),
+        inst(TACOp::SUB, "t2", "t0", "t1"),
+        inst(TACOp::ASSIGN, "y", "t2"),
+    };
+    Interpreter in(tac);
+    assertTrue(in.inputNames().size() == 2 && in.inputNames()[0] == "a", "inputs in first-read order");
+    assertTrue(in.outputNames().size() == 1 && in.outputNames()[0] == "y", "single output y");
+    map<string, double> out = in.run(map<string, double>{{"a", 1.5}, {"b", 4.0}});
+    assertTrue(out["y"] == (1.5 + 2.5) * 4.0 - 1.5 / 4.0, "y computed exactly as in double");
+}
+
+void InterpreterTest::testRecycledTemps() {
+    // a temp redefined in the middle must not clobber the earlier value's readers
+    vector<TacInst> tac = {
+        inst(TACOp::MUL, "t0", "x", "x"),
+        inst(TACOp::ASSIGN, "sq", "t0"),
+        inst(TACOp::ADD, "t0", "x", "x"),
+        inst(TACOp::ASSIGN, "dbl", "t0"),
+    };
+    Interpreter in(tac);
+    vector<double> out;
+    in.run(vector<double>{3.0}, out);
+    assertTrue(out.size() == 2 && out[0] == 9.0 && out[1] == 6.0, "recycled temp gives sq=9 dbl=6");
+    assertTrue(in.frameSlots() == 4, "one frame slot per distinct name");
+}
+
+void InterpreterTest::testStatePersists() {
+    ErrorHandler err;
+    SymbolTable sym(&err);
+    SymbolEntry acc("acc", "variable", "float");
+    acc.is_state = true;
+    sym.insert(acc);
+    // acc = acc + x
+    vector<TacInst> tac = {inst(TACOp::ADD, "t0", "acc", "x"), inst(TACOp::ASSIGN, "acc", "t0")};
+    Interpreter in(tac, &sym);
+    assertTrue(in.inputNames().size() == 1 && in.stateNames().size() == 1, "acc is state, x is input");
+    vector<double> out;
+    in.run(vector<double>{1.0}, out);
+    in.run(vector<double>{2.0}, out);
+    assertTrue(out[0] == 3.0, "state carried to the next sample");
+    in.reset();
+    in.run(vector<double>{2.0}, out);
+    assertTrue(out[0] == 2.0, "reset clears state");
+}
+
+void InterpreterTest::testFloat32AndFma() {
+    TacInst d = inst(TACOp::DIV, "q", "a", "b");
+    d.prec = TacPrecision::F32;
+    TacInst f = inst(TACOp::FMA, "r", "a", "b", "c");
+    Interpreter in({d, f});
+    map<string, double> out = in.run(map<string, double>{{"a", 1.0}, {"b", 3.0}, {"c", -1.0 / 3.0}});
+    assertTrue(out["q"] == (double)(1.0f / 3.0f), "F32 division rounds to float");
+    assertTrue(out["r"] == std::fma(1.0, 3.0, -1.0 / 3.0), "FMA rounds once");
+}
+
+void InterpreterTest::testGuardsThrow() {
+    TacInst g = guard(TACOp::GUARD_NONZERO, "d");
+    Interpreter in({g, inst(TACOp::DIV, "y", "n", "d")});
+    bool threw = false;
+    try {
+        in.run(map<string, double>{{"n", 1.0}, {"d", 0.0}});
+    } catch (const RuntimeError &e) {
+        threw = e.inst == 0;
+    }
+    assertTrue(threw, "failing GUARD_NONZERO throws RuntimeError at the guard");
+    assertTrue(in.run(map<string, double>{{"n", 1.0}, {"d", 4.0}})["y"] == 0.25, "passing guard runs on");
+}
+
+void InterpreterTest::testProfilerHook() {
+    vector<TacInst> tac = {inst(TACOp::MUL, "t0", "x", "gain"), inst(TACOp::ASSIGN, "y", "t0")};
+    Interpreter in(tac);
+    ValueProfiler prof(tac);
+    in.setProfiler(&prof);
+    for (int s = 0; s < 200; ++s) in.run(map<string, double>{{"x", (double)s}, {"gain", 2.0}});
+    map<string, double> stable = prof.stableInputs();
+    assertTrue(prof.samples() == 200, "profiler counts every sample");
+    assertTrue(stable.size() == 1 && stable["gain"] == 2.0, "constant gain found stable, x not");
+}
+
+void InterpreterTest::assertTrue(bool condition, const std::string& testName) {
+    if (condition)
+        std::cout << "[PASS] " << testName << "\n";
+    else
+        std::cout << "[FAIL] " << testName << "\n";
+}
@@ -0,0 +1,24 @@
+#ifndef INTERPRETERTEST_H
+#define INTERPRETERTEST_H
+
+#include "../runtime/interpreter.h"
+#include <iostream>
+
+class InterpreterTest {
+public:
+    // Run all test cases for Interpreter
+    void runAll();
+
+private:
+    void testArithmetic();
+    void testRecycledTemps();
+    void testStatePersists();
+    void testFloat32AndFma();
+    void testGuardsThrow();
+    void testProfilerHook();
+
+    // Helper to show test results
+    void assertTrue(bool condition, const std::string& testName);
+};
+
+#endif // INTERPRETERTEST_H
@@ -0,0 +1,104 @@
+#include "invarianceTest.h"
+#include "tacTestUtil.h"
+#include "../errorHandler/errorHandler.h"
+
+using namespace std;
+
+// prologue followed by body gives the same outputs as tac on every sample
+static bool splitMatches(const vector<TacInst> &tac, const StreamSplit &s, const SymbolTable *sym,
+                         const vector<map<string, double>> &samples) {
+    vector<TacInst> joined = s.prologue;
+    joined.insert(joined.end(), s.body.begin(), s.body.end());
+    Interpreter ref(tac, sym), got(joined, sym);
+    for (const auto &in : samples)
+        if (ref.run(in) != got.run(in)) return false;
+    return true;
+}
+
+void InvarianceTest::runAll() {
+    testClassify();
+    testStateStaysInBody();
+    testRecycledTempRenamed();
+    testVariableRestoredPerSample();
+    testLoadTimeGuardHoisted();
+    cout << "All InvarianceAnalyzer tests completed.\n";
+}
+
+void InvarianceTest::testClassify() {
+    ErrorHandler err;
+    SymbolTable sym(&err);
+    // y = x * (g * 2.0)
+    vector<TacInst> tac = {inst(TACOp::LOAD_CONST, "t0", "2.0"), inst(TACOp::MUL, "t1", "g", "t0"),
+                           inst(TACOp::MUL, "t2", "x", "t1"), inst(TACOp::ASSIGN, "y", "t2")};
+    vector<Variance> v = InvarianceAnalyzer::classify(tac, sym, {"g"});
+    assertTrue(v == vector<Variance>({Variance::CONSTANT, Variance::LOAD_TIME, Variance::PER_SAMPLE, Variance::PER_SAMPLE}),
+               "constant, load-time, per-sample");
+    SymbolEntry g("g", "parameter", "float");
+    sym.insert(g);
+    assertTrue(InvarianceAnalyzer::classify(tac, sym)[1] == Variance::LOAD_TIME, "symbol kind parameter is load-time");
+
+    StreamSplit s = InvarianceAnalyzer::split(tac, sym);
+    assertTrue(s.hoisted == 2 && s.prologue.size() == 2 && s.body.size() == 2, "two instructions hoisted");
+    assertTrue(splitMatches(tac, s, &sym, {{{"x", 1.5}, {"g", 3.0}}, {{"x", -0.0}, {"g", 3.0}}}), "split is equivalent");
+}
+
+void InvarianceTest::testStateStaysInBody() {
+    ErrorHandler err;
+    SymbolTable sym(&err);
+    declareState(sym, {"acc"});
+    // acc = 0.5 * 2.0; y = acc + x -- acc's definition is constant but feeds the next sample
+    vector<TacInst> tac = {inst(TACOp::LOAD_CONST, "t0", "0.5"), inst(TACOp::LOAD_CONST, "t1", "2.0"),
+                           inst(TACOp::MUL, "t2", "t0", "t1"),   inst(TACOp::ASSIGN, "acc", "t2"),
+                           inst(TACOp::ADD, "t3", "acc", "x"),   inst(TACOp::ASSIGN, "y", "t3")};
+    vector<Variance> v = InvarianceAnalyzer::classify(tac, sym);
+    assertTrue(v[2] == Variance::CONSTANT && v[3] == Variance::PER_SAMPLE && v[4] == Variance::PER_SAMPLE,
+               "state definition and its readers are per-sample");
+    StreamSplit s = InvarianceAnalyzer::split(tac, sym);
+    assertTrue(s.hoisted == 3 && splitMatches(tac, s, &sym, {{{"x", 1.0}}, {{"x", 2.0}}}), "constants hoisted, state kept");
+}
+
+void InvarianceTest::testRecycledTempRenamed() {
+    ErrorHandler err;
+    SymbolTable sym(&err);
+    // t0 = g * g (load-time); t1 = x * t0; t0 = x + 1 (per-sample); y = t1 + t0
+    vector<TacInst> tac = {inst(TACOp::MUL, "t0", "g", "g"), inst(TACOp::MUL, "t1", "x", "t0"),
+                           inst(TACOp::LOAD_CONST, "t2", "1.0"), inst(TACOp::ADD, "t0", "x", "t2"),
+                           inst(TACOp::ADD, "t3", "t1", "t0"),  inst(TACOp::ASSIGN, "y", "t3")};
+    StreamSplit s = InvarianceAnalyzer::split(tac, sym, {"g"});
+    assertTrue(s.prologue[0].dest == "t4" && s.body[0].arg2 == "t4", "hoisted temp gets a fresh name");
+    assertTrue(splitMatches(tac, s, &sym, {{{"x", 2.0}, {"g", 3.0}}, {{"x", -1.0}, {"g", 0.5}}}),
+               "the per-sample t0 does not clobber it");
+}
+
+void InvarianceTest::testVariableRestoredPerSample() {
+    ErrorHandler err;
+    SymbolTable sym(&err);
+    // k = g * 2; y = x * k; k = x; z = k
+    vector<TacInst> tac = {inst(TACOp::LOAD_CONST, "t0", "2.0"), inst(TACOp::MUL, "t1", "g", "t0"),
+                           inst(TACOp::ASSIGN, "k", "t1"),       inst(TACOp::MUL, "t2", "x", "k"),
+                           inst(TACOp::ASSIGN, "y", "t2"),       inst(TACOp::ASSIGN, "k", "x"),
+                           inst(TACOp::ASSIGN, "z", "k")};
+    StreamSplit s = InvarianceAnalyzer::split(tac, sym, {"g"});
+    bool restored = false;
+    for (const auto &i : s.body) restored = restored || (i.op == TACOp::ASSIGN && i.dest == "k" && isTempName(i.arg1));
+    assertTrue(restored, "k is restored from its hoisted copy each sample");
+    assertTrue(splitMatches(tac, s, &sym, {{{"x", 5.0}, {"g", 3.0}}, {{"x", -2.0}, {"g", 3.0}}}), "y and z unchanged");
+}
+
+void InvarianceTest::testLoadTimeGuardHoisted() {
+    ErrorHandler err;
+    SymbolTable sym(&err);
+    // check g != 0; y = x / g
+    vector<TacInst> tac = {guard(TACOp::GUARD_NONZERO, "g"), inst(TACOp::DIV, "t0", "x", "g"),
+                           guard(TACOp::GUARD_FINITE, "t0"), inst(TACOp::ASSIGN, "y", "t0")};
+    StreamSplit s = InvarianceAnalyzer::split(tac, sym, {"g"});
+    assertTrue(s.prologue.size() == 1 && s.prologue[0].op == TACOp::GUARD_NONZERO, "guard on a parameter runs once");
+    assertTrue(s.body.size() == 3 && s.body[1].op == TACOp::GUARD_FINITE, "guard on a sample value stays per sample");
+}
+
+void InvarianceTest::assertTrue(bool condition, const std::string& testName) {
+    if (condition)
+        std::cout << "[PASS] " << testName << "\n";
+    else
+        std::cout << "[FAIL] " << testName << "\n";
+}
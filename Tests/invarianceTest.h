@@ -0,0 +1,23 @@
+#ifndef INVARIANCETEST_H
+#define INVARIANCETEST_H
+
+#include "../tac/invariance.h"
+#include <iostream>
+
+class InvarianceTest {
+public:
+    // Run all test cases for InvarianceAnalyzer
+    void runAll();
+
+private:
+    void testClassify();
+    void testStateStaysInBody();
+    void testRecycledTempRenamed();
+    void testVariableRestoredPerSample();
+    void testLoadTimeGuardHoisted();
+
+    // Helper to show test results
+    void assertTrue(bool condition, const std::string& testName);
+};
+
+#endif // INVARIANCETEST_H
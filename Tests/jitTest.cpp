@@ -0,0 +1,86 @@
+#include "jitTest.h"
+#include "tacTestUtil.h"
+#include "../errorHandler/errorHandler.h"
+#include <cstring>
+
+using namespace std;
+
+// Run n samples through both and compare bit for bit.
+static bool sameAsInterpreter(const vector<TacInst> &tac, int regs, size_t n) {
+    Interpreter ref(tac);
+    JitKernel jit(tac, nullptr, regs);
+    const size_t ni = ref.inputNames().size(), no = ref.outputNames().size();
+    vector<double> in(n * ni), expect(n * no), got(n * no);
+    for (size_t k = 0; k < in.size(); ++k) in[k] = 0.75 + 0.37 * (double)(k % 11) - (k % 3 == 0 ? 2.0 : 0.0);
+    for (size_t s = 0; s < n; ++s) ref.run(&in[s * ni], &expect[s * no]);
+    jit.runBatch(in.data(), got.data(), n);
+    return memcmp(got.data(), expect.data(), got.size() * sizeof(double)) == 0;
+}
+
+void JitTest::runAll() {
+    testMatchesInterpreter();
+    testSpills();
+    testStateAcrossBatch();
+    testStatesReadEachOther();
+    testGuardStopsBatch();
+    cout << "All JitKernel tests completed.\n";
+}
+
+void JitTest::testMatchesInterpreter() {
+    JitKernel jit(mixedProgram());
+    assertTrue(jit.compiled() == JitKernel::available() || jit.fallbackReason() == "CPU lacks FMA3",
+               "native code wherever the JIT is available");
+    assertTrue(sameAsInterpreter(mixedProgram(), JitKernel::XMM_REGS, 50), "batch bitwise equal to the interpreter");
+}
+
+void JitTest::testSpills() {
+    JitKernel jit(mixedProgram(), nullptr, 1);
+    assertTrue(!jit.compiled() || jit.allocation().spillCount > 0, "one register forces spills");
+    assertTrue(sameAsInterpreter(mixedProgram(), 1, 50), "spilled values read back from the frame");
+}
+
+void JitTest::testStateAcrossBatch() {
+    ErrorHandler err;
+    SymbolTable sym(&err);
+    SymbolEntry acc("acc", "variable", "float");
+    acc.is_state = true;
+    sym.insert(acc);
+    // acc = acc + x
+    vector<TacInst> tac = {inst(TACOp::ADD, "t0", "acc", "x"), inst(TACOp::ASSIGN, "acc", "t0")};
+    JitKernel jit(tac, &sym);
+    double x[] = {1.0, 2.0, 3.0}, y[3];
+    jit.runBatch(x, y, 3);
+    assertTrue(y[0] == 1.0 && y[1] == 3.0 && y[2] == 6.0, "running sum carried across samples");
+    jit.run(x, y);
+    assertTrue(y[0] == 7.0, "and across calls");
+    jit.reset();
+    jit.run(x, y);
+    assertTrue(y[0] == 1.0, "reset clears state");
+}
+
+void JitTest::testStatesReadEachOther() {
+    assertTrue(statesReadEachOther<JitKernel>(), "state updates read the previous sample's values of other state");
+}
+
+void JitTest::testGuardStopsBatch() {
+    TacInst g = guard(TACOp::GUARD_NONZERO, "d");
+    JitKernel jit({g, inst(TACOp::DIV, "y", "n", "d")});
+    double rows[] = {1, 1, 2, 1, 0, 1, 4, 1}, out[4] = {0, 0, 0, 0}; // (d, n), d is read first
+    string msg;
+    int at = -1;
+    try {
+        jit.runBatch(rows, out, 4);
+    } catch (const RuntimeError &e) {
+        msg = e.what();
+        at = e.inst;
+    }
+    assertTrue(at == 0 && msg.find("d is 0.0 (sample 2)") != string::npos, "failing guard reports value and sample");
+    assertTrue(out[0] == 1.0 && out[1] == 0.5 && out[2] == 0.0, "rows before the failure were written");
+}
+
+void JitTest::assertTrue(bool condition, const std::string& testName) {
+    if (condition)
+        std::cout << "[PASS] " << testName << "\n";
+    else
+        std::cout << "[FAIL] " << testName << "\n";
+}
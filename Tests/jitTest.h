@@ -0,0 +1,23 @@
+#ifndef JITTEST_H
+#define JITTEST_H
+
+#include "../runtime/jit.h"
+#include <iostream>
+
+class JitTest {
+public:
+    // Run all test cases for JitKernel
+    void runAll();
+
+private:
+    void testMatchesInterpreter();
+    void testSpills();
+    void testStateAcrossBatch();
+    void testStatesReadEachOther();
+    void testGuardStopsBatch();
+
+    // Helper to show test results
+    void assertTrue(bool condition, const std::string& testName);
+};
+
+#endif // JITTEST_H
@@ -0,0 +1,145 @@
+#include "partialEvalTest.h"
+#include "tacTestUtil.h"
+#include "../errorHandler/errorHandler.h"
+#include <cmath>
+#include <cstring>
+
+using namespace std;
+
+void PartialEvalTest::runAll() {
+    testFoldsChains();
+    testKeepsNonFinite();
+    testSignedZero();
+    testRecycledTemp();
+    testBindParameters();
+    testBoundParameterRedefined();
+    testF32Folds();
+    cout << "All PartialEvaluator tests completed.\n";
+}
+
+void PartialEvalTest::testFoldsChains() {
+    // y = (2 * 3 + 1) * x
+    vector<TacInst> tac = {
+        inst(TACOp::LOAD_CONST, "t0", "2.0"), inst(TACOp::LOAD_CONST, "t1", "3.0"), inst(TACOp::MUL, "t2", "t0", "t1"),
+        inst(TACOp::LOAD_CONST, "t3", "1.0"), inst(TACOp::ADD, "t4", "t2", "t3"),   inst(TACOp::MUL, "t5", "t4", "x"),
+        inst(TACOp::ASSIGN, "y", "t5"),
+    };
+    FoldStats st = ConstantFolder::fold(tac);
+    assertTrue(st.folded == 2 && tac[4].op == TACOp::LOAD_CONST && tac[4].arg1Literal == "7.0", "2 * 3 + 1 folds to 7.0");
+    assertTrue(tac[5].op == TACOp::MUL && tac[6].op == TACOp::ASSIGN, "operations on x stay");
+}
+
+void PartialEvalTest::testKeepsNonFinite() {
+    // y = 1 / 0; z = 1e308 * 10
+    vector<TacInst> tac = {
+        inst(TACOp::LOAD_CONST, "t0", "1.0"), inst(TACOp::LOAD_CONST, "t1", "0.0"), inst(TACOp::DIV, "y", "t0", "t1"),
+        inst(TACOp::LOAD_CONST, "t2", "1e308"), inst(TACOp::LOAD_CONST, "t3", "10.0"), inst(TACOp::MUL, "z", "t2", "t3"),
+    };
+    FoldStats st = ConstantFolder::fold(tac);
+    assertTrue(st.folded == 0 && tac[2].op == TACOp::DIV && tac[5].op == TACOp::MUL, "division by zero and overflow stay");
+}
+
+void PartialEvalTest::testSignedZero() {
+    // y = 0 * -1; z = x - y
+    vector<TacInst> tac = {
+        inst(TACOp::LOAD_CONST, "t0", "0.0"), inst(TACOp::LOAD_CONST, "t1", "-1.0"), inst(TACOp::MUL, "y", "t0", "t1"),
+        inst(TACOp::SUB, "z", "x", "y"),
+    };
+    ConstantFolder::fold(tac);
+    assertTrue(tac[2].op == TACOp::LOAD_CONST && std::signbit(literalValue(tac[2].arg1Literal)), "0 * -1 folds to -0.0");
+    map<string, double> out = Interpreter(tac).run(map<string, double>{{"x", -0.0}});
+    assertTrue(out["y"] == 0.0 && std::signbit(out["y"]) && !std::signbit(out["z"]), "and -0 - -0 is +0 at run time");
+}
+
+void PartialEvalTest::testRecycledTemp() {
+    // t0 = 4; a = t0 * t0; t0 = x; b = t0 * t0
+    vector<TacInst> tac = {
+        inst(TACOp::LOAD_CONST, "t0", "4.0"), inst(TACOp::MUL, "a", "t0", "t0"),
+        inst(TACOp::ASSIGN, "t0", "x"),       inst(TACOp::MUL, "b", "t0", "t0"),
+    };
+    FoldStats st = ConstantFolder::fold(tac);
+    assertTrue(st.folded == 1 && tac[1].op == TACOp::LOAD_CONST && tac[3].op == TACOp::MUL,
+               "redefinition of t0 ends its known value");
+}
+
+void PartialEvalTest::testBindParameters() {
+    ErrorHandler err;
+    SymbolTable sym(&err);
+    // y = x * gain + offset * gain; z = gain
+    vector<TacInst> tac = {
+        inst(TACOp::MUL, "t0", "x", "gain"), inst(TACOp::MUL, "t1", "offset", "gain"), inst(TACOp::ADD, "t2", "t0", "t1"),
+        inst(TACOp::ASSIGN, "y", "t2"),      inst(TACOp::ASSIGN, "z", "gain"),
+    };
+    FoldStats st;
+    vector<TacInst> spec = PartialEvaluator::specialize(tac, sym, {{"gain", 2.0}, {"offset", 0.5}}, &st);
+    bool readsParam = false;
+    for (const auto &i : spec)
+        for (const auto &u : usesOf(i)) readsParam = readsParam || u == "gain" || u == "offset";
+    assertTrue(!readsParam && st.bound == 4, "every parameter use bound");
+    assertTrue(spec[0].op == TACOp::ADD && spec[1].op == TACOp::LOAD_CONST && spec[1].arg1Literal == "1.0",
+               "x * 2 becomes x + x, offset * gain folds to 1.0");
+    assertTrue(st.folded == 2 && st.simplified == 1, "two folds and one identity rewrite, each counted once");
+    bool same = true;
+    for (double x : {-1.5, 0.0, 3.25}) {
+        map<string, double> want = Interpreter(tac).run(map<string, double>{{"x", x}, {"gain", 2.0}, {"offset", 0.5}});
+        same = same && Interpreter(spec).run(map<string, double>{{"x", x}}) == want;
+    }
+    assertTrue(same, "same outputs as binding at run time");
+}
+
+void PartialEvalTest::testBoundParameterRedefined() {
+    ErrorHandler err;
+    SymbolTable sym(&err);
+    // y = x * k; k = x; z = k * 3
+    vector<TacInst> tac = {
+        inst(TACOp::MUL, "t0", "x", "k"), inst(TACOp::ASSIGN, "y", "t0"), inst(TACOp::ASSIGN, "k", "x"),
+        inst(TACOp::LOAD_CONST, "t1", "3.0"), inst(TACOp::MUL, "t2", "k", "t1"), inst(TACOp::ASSIGN, "z", "t2"),
+    };
+    vector<TacInst> spec = PartialEvaluator::specialize(tac, sym, {{"k", 5.0}});
+    map<string, double> out = Interpreter(spec).run(map<string, double>{{"x", 2.0}});
+    assertTrue(out["y"] == 10.0 && out["z"] == 6.0 && out["k"] == 2.0, "uses after the redefinition read the new k");
+}
+
+void PartialEvalTest::testF32Folds() {
+    // t1 = 3.14 (f32); c = t1 -- c holds 3.14 rounded to float32, not the double literal
+    vector<TacInst> copy = {inst(TACOp::LOAD_CONST, "t1", "3.14"), inst(TACOp::ASSIGN, "c", "t1")};
+    copy[0].prec = TacPrecision::F32;
+    vector<TacInst> folded = copy;
+    ConstantFolder::fold(folded);
+    const double want = Interpreter(copy).run(map<string, double>{})["c"];
+    assertTrue(folded[1].op == TACOp::LOAD_CONST && literalValue(folded[1].arg1Literal) == (double)(float)3.14 &&
+                   Interpreter(folded).run(map<string, double>{})["c"] == want,
+               "F32 literal is rounded when folded");
+
+    // every op on float32 operands (and an F64 op reading an F32 value) folds to what runs
+    bool same = true;
+    int folds = 0;
+    for (TACOp op : {TACOp::ADD, TACOp::SUB, TACOp::MUL, TACOp::DIV, TACOp::FMA})
+        for (const char *k : {"0.1", "3.14", "16777217.0", "1e-7"})
+            for (bool f32Const : {false, true}) {
+                vector<TacInst> tac = {inst(TACOp::LOAD_CONST, "t0", k), inst(TACOp::LOAD_CONST, "t1", "0.3"),
+                                       inst(op, "t2", "t0", "t1", "t0"), inst(TACOp::ADD, "y", "t2", "t0"),
+                                       inst(TACOp::MUL, "z", "x", "t2")};
+                tac[0].prec = f32Const ? TacPrecision::F32 : TacPrecision::F64;
+                tac[2].prec = TacPrecision::F32;
+                vector<TacInst> fast = tac;
+                folds += ConstantFolder::fold(fast).folded;
+                ErrorHandler err;
+                SymbolTable sym(&err);
+                vector<TacInst> spec = PartialEvaluator::specialize(tac, sym, {{"x", 0.7}});
+                const map<string, double> in = {{"x", 0.7}};
+                map<string, double> ref = Interpreter(tac).run(in), a = Interpreter(fast).run(in),
+                                    b = Interpreter(spec).run(in);
+                for (const char *o : {"y", "z"})
+                    same = same && memcmp(&ref[o], &a[o], sizeof(double)) == 0 &&
+                           memcmp(&ref[o], &b[o], sizeof(double)) == 0;
+            }
+    assertTrue(folds == 5 * 4 * 2 * 2 && same, "F32 folds are bitwise equal to the unfolded program");
+}
+
+void PartialEvalTest::assertTrue(bool condition, const std::string& testName) {
+    if (condition)
+        std::cout << "[PASS] " << testName << "\n";
+    else
+        std::cout << "[FAIL] " << testName << "\n";
+}
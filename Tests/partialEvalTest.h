@@ -0,0 +1,25 @@
+#ifndef PARTIALEVALTEST_H
+#define PARTIALEVALTEST_H
+
+#include "../tac/partialEval.h"
+#include <iostream>
+
+class PartialEvalTest {
+public:
+    // Run all test cases for ConstantFolder and PartialEvaluator
+    void runAll();
+
+private:
+    void testFoldsChains();
+    void testKeepsNonFinite();
+    void testSignedZero();
+    void testRecycledTemp();
+    void testBindParameters();
+    void testBoundParameterRedefined();
+    void testF32Folds();
+
+    // Helper to show test results
+    void assertTrue(bool condition, const std::string& testName);
+};
+
+#endif // PARTIALEVALTEST_H
@@ -0,0 +1,126 @@
+#include "passManagerTest.h"
+#include "tacTestUtil.h"
+#include "../errorHandler/errorHandler.h"
+#include <chrono>
+
+using namespace std;
+
+static int count(const vector<TacInst> &tac, TACOp op) {
+    int n = 0;
+    for (const auto &i : tac) n += i.op == op;
+    return n;
+}
+
+// y = x * 1 + x / 2; dead = x * x; z = a / r + b / r
+static vector<TacInst> sample() {
+    return {
+        inst(TACOp::LOAD_CONST, "t0", "1.0"), inst(TACOp::MUL, "t1", "x", "t0"), inst(TACOp::LOAD_CONST, "t2", "2.0"),
+        inst(TACOp::DIV, "t3", "x", "t2"),    inst(TACOp::ADD, "t4", "t1", "t3"), inst(TACOp::ASSIGN, "y", "t4"),
+        inst(TACOp::MUL, "t5", "x", "x"),     inst(TACOp::DIV, "t6", "a", "r"),   inst(TACOp::DIV, "t7", "b", "r"),
+        inst(TACOp::ADD, "t8", "t6", "t7"),   inst(TACOp::ASSIGN, "z", "t8"),
+    };
+}
+
+static const map<string, double> INPUTS = {{"x", 3.0}, {"a", 1.0}, {"b", 2.0}, {"r", 3.0}};
+
+void PassManagerTest::runAll() {
+    testParseLevel();
+    testPipelines();
+    testLevelsKeepOutputs();
+    testBudgetSkipsExpensive();
+    testFastmath();
+    cout << "All PassManager tests completed.\n";
+}
+
+void PassManagerTest::testParseLevel() {
+    OptLevel lvl = OptLevel::O0;
+    bool all = true;
+    for (OptLevel want : {OptLevel::O0, OptLevel::O1, OptLevel::O2, OptLevel::O3})
+        all = all && PassManager::parseLevel(PassManager::levelToString(want), lvl) && lvl == want;
+    assertTrue(all, "-O0 to -O3 round-trip");
+    assertTrue(!PassManager::parseLevel("-O4", lvl) && !PassManager::parseLevel("O2", lvl) && lvl == OptLevel::O3,
+               "unknown flags rejected, level untouched");
+}
+
+void PassManagerTest::testPipelines() {
+    PassManager o0(OptLevel::O0), o1(OptLevel::O1), o2(OptLevel::O2), o3(OptLevel::O3);
+    assertTrue(!o0.has("peephole") && !o0.has("dce"), "-O0 runs nothing");
+    assertTrue(o1.has("peephole") && o1.has("dce") && o1.has("reciprocal") && !o1.has("sched"), "-O1 does not schedule");
+    assertTrue(!o2.has("sched") && !o2.has("peephole+dce*"), "-O2 does not schedule unless asked");
+    assertTrue(o3.has("peephole+dce*") && !o3.has("sched"), "-O3 iterates peephole/DCE");
+    o2.add(PassManager::schedulePass(false));
+    assertTrue(o2.has("sched"), "--sched adds scheduling");
+}
+
+void PassManagerTest::testLevelsKeepOutputs() {
+    ErrorHandler err;
+    SymbolTable sym(&err);
+    const map<string, double> want = Interpreter(sample()).run(INPUTS);
+    vector<size_t> sizes;
+    bool same = true;
+    for (OptLevel lvl : {OptLevel::O0, OptLevel::O1, OptLevel::O2, OptLevel::O3}) {
+        vector<TacInst> tac = sample();
+        PassManager pm(lvl);
+        pm.run(tac, sym);
+        sizes.push_back(tac.size());
+        same = same && Interpreter(tac).run(INPUTS) == want;
+        if (lvl == OptLevel::O1)
+            assertTrue(count(tac, TACOp::DIV) == 2 && count(tac, TACOp::MUL) == 1,
+                       "-O1: x * 1 gone, x / 2 a multiply, a / r and b / r exact divisions");
+    }
+    assertTrue(sizes[0] == sample().size() && sizes[1] < sizes[0] && sizes[3] <= sizes[1], "higher levels do not grow");
+    assertTrue(same, "every level computes the same outputs");
+}
+
+void PassManagerTest::testBudgetSkipsExpensive() {
+    ErrorHandler err;
+    SymbolTable sym(&err);
+    // a cheap pass that spends 2 ms, then the -O3 passes under a 1 ms budget
+    PassManager pm(OptLevel::O0);
+    pm.add({"spin", false, [](vector<TacInst> &, PassContext &) {
+        auto t0 = chrono::steady_clock::now();
+        while (chrono::steady_clock::now() - t0 < chrono::milliseconds(2)) {}
+    }});
+    pm.add(PassManager::fixpointPass());
+    pm.add(PassManager::dcePass());
+    pm.add(PassManager::schedulePass(true));
+    pm.setBudgetMs(1.0);
+    OptReport report;
+    vector<TacInst> tac = sample();
+    pm.run(tac, sym, &report);
+    const auto &d = pm.decisions();
+    assertTrue(d.size() == 4 && d[0].ran && !d[1].ran && d[2].ran && !d[3].ran,
+               "expensive passes skipped once the budget is spent, cheap ones still run");
+    assertTrue(d[1].reason.find("compile budget") != string::npos && pm.elapsedMs() >= 2.0, "skip reason recorded");
+    bool noted = false;
+    for (const auto &n : report.notes()) noted = noted || (n.pass == "passes" && n.message.rfind("skipped sched", 0) == 0);
+    assertTrue(noted, "and written to the report");
+
+    pm.setBudgetMs(0);
+    pm.run(tac, sym);
+    bool allRan = true;
+    for (const auto &dd : pm.decisions()) allRan = allRan && dd.ran;
+    assertTrue(allRan, "no budget: everything runs");
+}
+
+void PassManagerTest::testFastmath() {
+    ErrorHandler err;
+    SymbolTable sym(&err);
+    PassManager pm(OptLevel::O1);
+    pm.setMathProfile(MathProfile::FASTMATH);
+    assertTrue(pm.has("reassociate"), "fastmath adds reassociation");
+    vector<TacInst> tac = sample();
+    pm.run(tac, sym);
+    assertTrue(count(tac, TACOp::DIV) == 1, "and a / r, b / r share one reciprocal");
+    pm.setMathProfile(MathProfile::STRICT);
+    PassManager o0(OptLevel::O0);
+    o0.setMathProfile(MathProfile::FASTMATH);
+    assertTrue(!pm.has("reassociate") && !o0.has("reassociate"), "removed again for STRICT, never at -O0");
+}
+
+void PassManagerTest::assertTrue(bool condition, const std::string& testName) {
+    if (condition)
+        std::cout << "[PASS] " << testName << "\n";
+    else
+        std::cout << "[FAIL] " << testName << "\n";
+}
@@ -0,0 +1,23 @@
+#ifndef PASSMANAGERTEST_H
+#define PASSMANAGERTEST_H
+
+#include "../tac/passManager.h"
+#include <iostream>
+
+class PassManagerTest {
+public:
+    // Run all test cases for PassManager
+    void runAll();
+
+private:
+    void testParseLevel();
+    void testPipelines();
+    void testLevelsKeepOutputs();
+    void testBudgetSkipsExpensive();
+    void testFastmath();
+
+    // Helper to show test results
+    void assertTrue(bool condition, const std::string& testName);
+};
+
+#endif // PASSMANAGERTEST_H
@@ -0,0 +1,173 @@
+#include "peepholeTest.h"
+#include "tacTestUtil.h"
+#include "../tac/tacInfo.h"
+#include <sstream>
+#include <cmath>
+
+using namespace std;
+
+// Bitwise equal outputs of two programs over x in {-0, +0, -1.5, 3, inf, nan}.
+static bool sameBits(const vector<TacInst> &a, const vector<TacInst> &b) {
+    for (double x : {-0.0, 0.0, -1.5, 3.0, (double)INFINITY, (double)NAN}) {
+        map<string, double> ra = Interpreter(a).run(map<string, double>{{"x", x}});
+        map<string, double> rb = Interpreter(b).run(map<string, double>{{"x", x}});
+        if (ra.size() != rb.size()) return false;
+        for (const auto &o : ra)
+            if (!rb.count(o.first) || memcmp(&o.second, &rb[o.first], sizeof(double)) != 0) return false;
+    }
+    return true;
+}
+
+// k loaded into t0, then dest = x op t0 (or t0 op x)
+static vector<TacInst> withConst(TACOp op, const string &k, bool constFirst) {
+    return {inst(TACOp::LOAD_CONST, "t0", k),
+            constFirst ? inst(op, "y", "t0", "x") : inst(op, "y", "x", "t0")};
+}
+
+void PeepholeTest::runAll() {
+    testRuleOrder();
+    testIdentities();
+    testInexactLeftAlone();
+    testFoldCascade();
+    testSelfCopy();
+    testSelfCopyKeepsOutputs();
+    testNonFiniteNotFolded();
+    testF32Folds();
+    cout << "All PeepholeOptimizer tests completed.\n";
+}
+
+void PeepholeTest::testRuleOrder() {
+    vector<string> names = PeepholeOptimizer::ruleNames();
+    assertTrue(names.size() == 12 && names.front() == "fold-add" && names.back() == "2-mul",
+               "twelve rules, folds first");
+    PeepholeStats st;
+    st.fired["mul-by-2"] = 3;
+    st.total = 3;
+    ostringstream out;
+    PeepholeOptimizer::print(st, out);
+    assertTrue(out.str().find("  fold-add: 0\n") != string::npos && out.str().find("  mul-by-2: 3\n") != string::npos,
+               "print lists rules that never fired");
+}
+
+void PeepholeTest::testIdentities() {
+    struct Case { TACOp op; const char *k; bool constFirst; const char *rule; TACOp becomes; };
+    const Case cases[] = {
+        {TACOp::MUL, "1.0", false, "mul-by-1", TACOp::ASSIGN}, {TACOp::MUL, "1.0", true, "1-mul", TACOp::ASSIGN},
+        {TACOp::DIV, "1.0", false, "div-by-1", TACOp::ASSIGN}, {TACOp::SUB, "0.0", false, "sub-0", TACOp::ASSIGN},
+        {TACOp::MUL, "2.0", false, "mul-by-2", TACOp::ADD},    {TACOp::MUL, "2.0", true, "2-mul", TACOp::ADD},
+    };
+    for (const auto &c : cases) {
+        vector<TacInst> tac = withConst(c.op, c.k, c.constFirst);
+        vector<TacInst> before = tac;
+        PeepholeStats st = PeepholeOptimizer::run(tac);
+        bool rewritten = st.total == 1 && st.fired[c.rule] == 1 && tac.back().op == c.becomes &&
+                         tac.back().arg1 == "x" && (c.becomes == TACOp::ASSIGN || tac.back().arg2 == "x");
+        assertTrue(rewritten && sameBits(before, tac), string(c.rule) + " fires and is bitwise exact");
+    }
+}
+
+void PeepholeTest::testInexactLeftAlone() {
+    // x + 0 turns -0 into +0, x - -0 likewise, x * 0 keeps NaN and inf; none may fire
+    vector<vector<TacInst>> progs = {withConst(TACOp::ADD, "0.0", false), withConst(TACOp::ADD, "0.0", true),
+                                     withConst(TACOp::SUB, "-0.0", false), withConst(TACOp::MUL, "0.0", false),
+                                     withConst(TACOp::SUB, "0.0", true)};
+    bool untouched = true;
+    for (auto &tac : progs) {
+        TACOp op = tac.back().op;
+        untouched = untouched && PeepholeOptimizer::run(tac).total == 0 && tac.back().op == op;
+    }
+    assertTrue(untouched, "x + 0, x - -0, x * 0 and 0 - x are not rewritten");
+}
+
+void PeepholeTest::testFoldCascade() {
+    // t2 = 2 * 3; t3 = t2 + 2; y = t3; z = y * x -- folds ripple into y and stop at x
+    vector<TacInst> tac = {
+        inst(TACOp::LOAD_CONST, "t0", "2.0"), inst(TACOp::LOAD_CONST, "t1", "3.0"), inst(TACOp::MUL, "t2", "t0", "t1"),
+        inst(TACOp::ADD, "t3", "t2", "t0"),   inst(TACOp::ASSIGN, "y", "t3"),       inst(TACOp::MUL, "z", "y", "x"),
+    };
+    PeepholeStats st = PeepholeOptimizer::run(tac);
+    assertTrue(st.fired["fold-mul"] == 1 && st.fired["fold-add"] == 1 && st.fired["fold-copy"] == 1 && st.total == 3,
+               "every firing counted by rule");
+    assertTrue(tac[4].op == TACOp::LOAD_CONST && tac[4].arg1Literal == "8.0" && tac[5].op == TACOp::MUL,
+               "y folds to 8.0, z stays a multiply");
+    assertTrue(st.visited < 2 * (int)tac.size() + 2 * st.total, "one worklist pass: only readers are revisited");
+}
+
+void PeepholeTest::testSelfCopy() {
+    // x = a; x = x; t0 = 1; y = x * t0 -- the copy goes, y reads x directly
+    vector<TacInst> tac = {inst(TACOp::ASSIGN, "x", "a"), inst(TACOp::ASSIGN, "x", "x"),
+                           inst(TACOp::LOAD_CONST, "t0", "1.0"), inst(TACOp::MUL, "y", "x", "t0")};
+    vector<TacInst> before = tac;
+    PeepholeStats st = PeepholeOptimizer::run(tac);
+    assertTrue(st.fired["self-copy"] == 1 && st.fired["mul-by-1"] == 1 && tac.size() == 3 &&
+                   tac.back().op == TACOp::ASSIGN && tac.back().arg1 == "x",
+               "self-copy dropped, y = x");
+    bool same = true;
+    for (double a : {-0.0, 2.5, (double)NAN}) {
+        map<string, double> ra = Interpreter(before).run(map<string, double>{{"a", a}});
+        map<string, double> rb = Interpreter(tac).run(map<string, double>{{"a", a}});
+        same = same && ra.size() == rb.size() && memcmp(&ra["x"], &rb["x"], sizeof(double)) == 0 &&
+               memcmp(&ra["y"], &rb["y"], sizeof(double)) == 0;
+    }
+    assertTrue(same, "x and y unchanged");
+}
+
+void PeepholeTest::testSelfCopyKeepsOutputs() {
+    // x = x is x's only definition: dropping it would take x out of the outputs
+    vector<TacInst> tac = {inst(TACOp::ASSIGN, "x", "x"), inst(TACOp::ASSIGN, "x", "x"),
+                           inst(TACOp::ADD, "y", "x", "x")};
+    const vector<string> outputs = describeInterface(tac).outputs;
+    PeepholeStats st = PeepholeOptimizer::run(tac);
+    assertTrue(st.fired["self-copy"] == 1 && describeInterface(tac).outputs == outputs &&
+                   outputs == vector<string>({"x", "y"}),
+               "a variable's last self-copy is kept, the output set is unchanged");
+
+    vector<TacInst> temps = {inst(TACOp::MUL, "t0", "a", "a"), inst(TACOp::ASSIGN, "t0", "t0"),
+                             inst(TACOp::ASSIGN, "y", "t0")};
+    assertTrue(PeepholeOptimizer::run(temps).fired["self-copy"] == 1 && temps.size() == 2,
+               "temp self-copies are dropped");
+}
+
+void PeepholeTest::testNonFiniteNotFolded() {
+    // y = 1e308 * 10; z = 1 / 0 -- folding would bake inf into the program
+    vector<TacInst> tac = {
+        inst(TACOp::LOAD_CONST, "t0", "1e308"), inst(TACOp::LOAD_CONST, "t1", "10.0"), inst(TACOp::MUL, "y", "t0", "t1"),
+        inst(TACOp::LOAD_CONST, "t2", "1.0"),   inst(TACOp::LOAD_CONST, "t3", "0.0"),  inst(TACOp::DIV, "z", "t2", "t3"),
+    };
+    PeepholeStats st = PeepholeOptimizer::run(tac);
+    assertTrue(st.total == 0 && tac[2].op == TACOp::MUL && tac[5].op == TACOp::DIV, "overflow and 1 / 0 stay");
+}
+
+void PeepholeTest::testF32Folds() {
+    // folds compute in float32, from float32-rounded constants, as the backends do
+    bool same = true;
+    int folds = 0;
+    for (TACOp op : {TACOp::ADD, TACOp::SUB, TACOp::MUL, TACOp::DIV, TACOp::ASSIGN})
+        for (const char *k : {"0.1", "3.14", "16777217.0", "1e-7"})
+            for (bool f32Const : {false, true}) {
+                vector<TacInst> tac = {inst(TACOp::LOAD_CONST, "t0", k), inst(TACOp::LOAD_CONST, "t1", "0.3"),
+                                       inst(op, "t2", "t0", op == TACOp::ASSIGN ? "" : "t1"),
+                                       inst(TACOp::ADD, "y", "t2", "t0"), inst(TACOp::MUL, "z", "x", "t2")};
+                tac[0].prec = f32Const ? TacPrecision::F32 : TacPrecision::F64;
+                tac[2].prec = TacPrecision::F32;
+                vector<TacInst> before = tac;
+                PeepholeStats st = PeepholeOptimizer::run(tac);
+                folds += st.total;
+                same = same && sameBits(before, tac);
+            }
+    assertTrue(folds == 5 * 4 * 2 * 2 && same, "F32 folds are bitwise equal to the unfolded program");
+
+    // y = y (f32) rounds y: not a no-op
+    vector<TacInst> round = {inst(TACOp::MUL, "y", "x", "x"), inst(TACOp::ASSIGN, "y", "y")};
+    round[1].prec = TacPrecision::F32;
+    vector<TacInst> before = round;
+    PeepholeStats st = PeepholeOptimizer::run(round);
+    assertTrue(st.total == 0 && round.size() == 2 && sameBits(before, round), "F32 self-copy is kept");
+}
+
+void PeepholeTest::assertTrue(bool condition, const std::string& testName) {
+    if (condition)
+        std::cout << "[PASS] " << testName << "\n";
+    else
+        std::cout << "[FAIL] " << testName << "\n";
+}
@@ -0,0 +1,26 @@
+#ifndef PEEPHOLETEST_H
+#define PEEPHOLETEST_H
+
+#include "../tac/peephole.h"
+#include <iostream>
+
+class PeepholeTest {
+public:
+    // Run all test cases for PeepholeOptimizer
+    void runAll();
+
+private:
+    void testRuleOrder();
+    void testIdentities();
+    void testInexactLeftAlone();
+    void testFoldCascade();
+    void testSelfCopy();
+    void testSelfCopyKeepsOutputs();
+    void testNonFiniteNotFolded();
+    void testF32Folds();
+
+    // Helper to show test results
+    void assertTrue(bool condition, const std::string& testName);
+};
+
+#endif // PEEPHOLETEST_H
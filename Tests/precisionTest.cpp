@@ -0,0 +1,95 @@
+#include "precisionTest.h"
+#include "tacTestUtil.h"
+#include <cmath>
+#include <limits>
+
+using namespace std;
+
+static const double INF = numeric_limits<double>::infinity();
+
+void PrecisionTest::runAll() {
+    testIntervals();
+    testRangesFollowTac();
+    testDemotionWithinBound();
+    testUnknownInputsStayDouble();
+    testOperandsOutsideFloat();
+    cout << "All precision tests completed.\n";
+}
+
+void PrecisionTest::testIntervals() {
+    Interval sum = intervalAdd(Interval(1.0, 2.0), Interval(-3.0, 0.5));
+    assertTrue(sum.lo <= -2.0 && sum.hi >= 2.5 && sum.lo > -2.0001 && !sum.mayBeNaN, "sum widened outward by an ulp");
+    Interval q = intervalDiv(Interval(1.0, 2.0), Interval(-1.0, 1.0));
+    assertTrue(!q.isFinite() && !q.mayBeNaN, "divisor range through zero: unbounded but not NaN");
+    assertTrue(intervalDiv(Interval(0.0, 1.0), Interval(-1.0, 1.0)).mayBeNaN, "0 / 0 may be NaN");
+    assertTrue(intervalMul(Interval(0.0, 1.0), Interval(1.0, INF)).mayBeNaN, "0 * inf may be NaN");
+    assertTrue(intervalAdd(Interval(0.0, INF), Interval(-INF, 0.0)).mayBeNaN, "inf + -inf may be NaN");
+    assertTrue(Interval::point(NAN).mayBeNaN && Interval(-0.0, 0.0).containsZero() &&
+                   Interval(-3.0, -1.0).minAbs() == 1.0,
+               "point, containsZero and minAbs");
+}
+
+void PrecisionTest::testRangesFollowTac() {
+    // t0 is reused: its second definition must not inherit the first one's range
+    vector<TacInst> tac = {
+        inst(TACOp::LOAD_CONST, "t0", "2.0"), inst(TACOp::MUL, "t1", "x", "t0"),
+        inst(TACOp::LOAD_CONST, "t0", "-1.0"), inst(TACOp::FMA, "y", "t1", "t0", "x"),
+    };
+    RangeInfo info = RangeAnalysis::analyze(tac, {{"x", Interval(-1.0, 3.0)}});
+    assertTrue(info.result[1].lo <= -2.0 && info.result[1].hi >= 6.0 && info.result[1].hi < 6.001, "x * 2 in [-2, 6]");
+    assertTrue(info.arg2[3].lo == -1.0 && info.arg2[3].hi == -1.0, "reused temp read at its latest definition");
+    assertTrue(info.arg3[3].lo == -1.0 && info.result[3].isFinite(), "FMA addend and result tracked");
+    assertTrue(!RangeAnalysis::analyze(tac, {}).result[3].isFinite(), "undeclared input is unknown");
+}
+
+void PrecisionTest::testDemotionWithinBound() {
+    // y = (a + k) * b - a / b; z = f32(y * a); w = fma(a, b, y)
+    vector<TacInst> tac = mixedProgram();
+    const map<string, Interval> ranges = {{"a", Interval(-1.0, 1.0)}, {"b", Interval(1.0, 4.0)}};
+    PrecisionResult loose = PrecisionAnalyzer::demote(tac, ranges, 1e-3);
+    bool within = true;
+    Interpreter demoted(tac), exact(mixedProgram());
+    for (int s = 0; s <= 40; ++s) {
+        double in[2] = {-1.0 + 0.05 * s, 1.0 + 0.075 * s}, got[3], expect[3];
+        demoted.run(in, got);
+        exact.run(in, expect);
+        for (int k = 0; k < 3; ++k)
+            within = within && fabs(got[k] - expect[k]) <= loose.outputError[demoted.outputNames()[k]];
+    }
+    assertTrue(loose.demoted == loose.total, "loose bound: everything demoted");
+    assertTrue(within, "observed error within the reported bound");
+
+    tac = mixedProgram();
+    PrecisionResult tight = PrecisionAnalyzer::demote(tac, ranges, 1e-9);
+    bool met = true;
+    for (const auto &o : tight.outputError) met = met && o.second <= 1e-9;
+    assertTrue(tight.demoted < tight.total && met, "tight bound: promotes back to double until every output fits");
+}
+
+void PrecisionTest::testUnknownInputsStayDouble() {
+    vector<TacInst> tac = mixedProgram();
+    PrecisionResult res = PrecisionAnalyzer::demote(tac, {{"a", Interval(-1.0, 1.0)}}, 1e-3);
+    bool readsB = false;
+    for (const auto &i : tac) {
+        vector<string> uses = usesOf(i);
+        if (find(uses.begin(), uses.end(), "b") != uses.end()) readsB = readsB || i.prec == TacPrecision::F32;
+    }
+    assertTrue(!readsB && res.demoted < res.total, "nothing reading an unranged input is demoted");
+}
+
+void PrecisionTest::testOperandsOutsideFloat() {
+    // y = a * b and w = fma(a, b, c) are small, but b does not fit in float32
+    vector<TacInst> tac = {inst(TACOp::MUL, "y", "a", "b"), inst(TACOp::FMA, "w", "a", "b", "c")};
+    const map<string, Interval> ranges = {
+        {"a", Interval(1e-300, 2e-300)}, {"b", Interval(1e300, 2e300)}, {"c", Interval(0.0, 1.0)}};
+    PrecisionAnalyzer::demote(tac, ranges, 1e300);
+    assertTrue(tac[0].prec == TacPrecision::F64 && tac[1].prec == TacPrecision::F64,
+               "second operand out of float32 range keeps the instruction in double");
+}
+
+void PrecisionTest::assertTrue(bool condition, const std::string& testName) {
+    if (condition)
+        std::cout << "[PASS] " << testName << "\n";
+    else
+        std::cout << "[FAIL] " << testName << "\n";
+}
@@ -0,0 +1,23 @@
+#ifndef PRECISIONTEST_H
+#define PRECISIONTEST_H
+
+#include "../tac/precision.h"
+#include <iostream>
+
+class PrecisionTest {
+public:
+    // Run all test cases for RangeAnalysis and PrecisionAnalyzer
+    void runAll();
+
+private:
+    void testIntervals();
+    void testRangesFollowTac();
+    void testDemotionWithinBound();
+    void testUnknownInputsStayDouble();
+    void testOperandsOutsideFloat();
+
+    // Helper to show test results
+    void assertTrue(bool condition, const std::string& testName);
+};
+
+#endif // PRECISIONTEST_H
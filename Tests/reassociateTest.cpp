@@ -0,0 +1,125 @@
+#include "reassociateTest.h"
+#include "tacTestUtil.h"
+#include "../tac/scheduler.h"
+#include "../tac/dce.h"
+#include "../errorHandler/errorHandler.h"
+
+using namespace std;
+
+// y = ((((((a * b) * c) * d) * e) * f) * g) * h
+static vector<TacInst> mulChain() {
+    return {
+        inst(TACOp::MUL, "t0", "a", "b"),  inst(TACOp::MUL, "t1", "t0", "c"), inst(TACOp::MUL, "t2", "t1", "d"),
+        inst(TACOp::MUL, "t3", "t2", "e"), inst(TACOp::MUL, "t4", "t3", "f"), inst(TACOp::MUL, "t5", "t4", "g"),
+        inst(TACOp::MUL, "y", "t5", "h"),
+    };
+}
+
+static map<string, double> run(const vector<TacInst> &tac, const map<string, double> &inputs) {
+    Interpreter interp(tac);
+    return interp.run(inputs);
+}
+
+void ReassociateTest::runAll() {
+    testBalancedMulChain();
+    testShortChainKept();
+    testSharedTempEndsChain();
+    testPrecisionEndsChain();
+    testReusedNameCopied();
+    testNonFiniteFoldKept();
+    cout << "All Reassociator tests completed.\n";
+}
+
+void ReassociateTest::testBalancedMulChain() {
+    vector<TacInst> tac = mulChain();
+    OptReport report;
+    ReassocStats st = Reassociator::run(tac, &report);
+    assertTrue(st.chains == 1 && st.folded == 0 && st.depthBefore == 7 && st.depthAfter == 3,
+               "eight-operand product: depth 7 -> 3");
+    // the old links are left for DCE, as in the pass pipeline
+    ErrorHandler err;
+    SymbolTable sym(&err);
+    vector<TacInst> live = tac;
+    DeadCodeEliminator::eliminate(live, sym);
+    assertTrue(live.size() == 7 &&
+                   InstructionScheduler::estimateCycles(live) < InstructionScheduler::estimateCycles(mulChain()),
+               "after DCE the balanced tree has a shorter critical path");
+    // powers of two multiply exactly in any order
+    const map<string, double> in = {{"a", 2},    {"b", 0.5}, {"c", -4}, {"d", 8},
+                                    {"e", 0.25}, {"f", 1},   {"g", -2}, {"h", 16}};
+    assertTrue(run(tac, in).at("y") == run(mulChain(), in).at("y"), "product unchanged");
+    assertTrue(report.notes().size() == 2 &&
+                   report.notes()[0].message.find("y: * chain of 8 operands, depth 7 -> 3") == 0,
+               "report names the chain and its depths");
+}
+
+void ReassociateTest::testShortChainKept() {
+    // (a + b) + c is already as shallow as three operands get
+    vector<TacInst> tac = {inst(TACOp::ADD, "t0", "a", "b"), inst(TACOp::ADD, "y", "t0", "c")};
+    const vector<TacInst> before = tac;
+    ReassocStats st = Reassociator::run(tac);
+    bool same = tac.size() == before.size();
+    for (size_t i = 0; same && i < tac.size(); ++i)
+        same = tac[i].op == before[i].op && tac[i].dest == before[i].dest && tac[i].arg1 == before[i].arg1 &&
+               tac[i].arg2 == before[i].arg2;
+    assertTrue(st.chains == 0 && same, "three-operand chain without constants is left alone");
+}
+
+void ReassociateTest::testSharedTempEndsChain() {
+    // t1 is read twice, so it is a leaf of y's chain and a chain of its own is too short
+    vector<TacInst> tac = {
+        inst(TACOp::ADD, "t0", "a", "b"), inst(TACOp::ADD, "t1", "t0", "c"), inst(TACOp::ADD, "t2", "t1", "d"),
+        inst(TACOp::ADD, "t3", "t2", "e"), inst(TACOp::ADD, "y", "t3", "t1"),
+    };
+    ReassocStats st = Reassociator::run(tac);
+    assertTrue(st.chains == 1 && st.depthBefore == 3 && st.depthAfter == 2, "shared temp is a leaf, not a link");
+    const map<string, double> in = {{"a", 1}, {"b", 2}, {"c", 3}, {"d", 4}, {"e", 5}};
+    assertTrue(run(tac, in).at("y") == 21.0, "shared value still feeds both readers");
+}
+
+void ReassociateTest::testPrecisionEndsChain() {
+    vector<TacInst> tac = {
+        inst(TACOp::ADD, "t0", "a", "b"), inst(TACOp::ADD, "t1", "t0", "c"), inst(TACOp::ADD, "t2", "t1", "d"),
+        inst(TACOp::ADD, "y", "t2", "e"),
+    };
+    tac[1].prec = TacPrecision::F32; // a float32 link between two double adds
+    ReassocStats st = Reassociator::run(tac);
+    assertTrue(st.chains == 0, "a chain does not cross a precision change");
+}
+
+void ReassociateTest::testReusedNameCopied() {
+    // the leaf t9 is redefined before the chain ends: its first value must be kept
+    vector<TacInst> tac = {
+        inst(TACOp::MUL, "t9", "p", "q"), inst(TACOp::ADD, "t0", "t9", "a"), inst(TACOp::ADD, "t1", "t0", "b"),
+        inst(TACOp::MUL, "t9", "p", "p"), inst(TACOp::ADD, "t2", "t1", "c"), inst(TACOp::ADD, "y", "t2", "t9"),
+    };
+    const vector<TacInst> before = tac;
+    ReassocStats st = Reassociator::run(tac);
+    int copies = 0;
+    for (size_t i = 0; i < tac.size(); ++i)
+        if (tac[i].op == TACOp::ASSIGN && tac[i].arg1 == "t9") {
+            copies++;
+            assertTrue(i > 0 && tac[i - 1].dest == "t9" && tac[i - 1].arg2 == "q", "copy follows the first definition");
+        }
+    const map<string, double> in = {{"p", 3}, {"q", 5}, {"a", 1}, {"b", 2}, {"c", 4}};
+    assertTrue(st.chains == 1 && copies == 1 && run(tac, in).at("y") == run(before, in).at("y"),
+               "reused leaf name is read through a copy");
+}
+
+void ReassociateTest::testNonFiniteFoldKept() {
+    // 1e300 * 1e300 overflows, so the constants are not combined
+    vector<TacInst> tac = {
+        inst(TACOp::LOAD_CONST, "t0", "1e300"), inst(TACOp::MUL, "t1", "a", "t0"),
+        inst(TACOp::LOAD_CONST, "t2", "1e300"), inst(TACOp::MUL, "t3", "t1", "t2"),
+        inst(TACOp::MUL, "y", "t3", "b"),
+    };
+    ReassocStats st = Reassociator::run(tac);
+    assertTrue(st.chains == 0 && tac.size() == 5, "constants folding to infinity are left in place");
+}
+
+void ReassociateTest::assertTrue(bool condition, const std::string& testName) {
+    if (condition)
+        std::cout << "[PASS] " << testName << "\n";
+    else
+        std::cout << "[FAIL] " << testName << "\n";
+}
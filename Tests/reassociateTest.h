@@ -0,0 +1,24 @@
+#ifndef REASSOCIATETEST_H
+#define REASSOCIATETEST_H
+
+#include "../tac/reassociate.h"
+#include <iostream>
+
+class ReassociateTest {
+public:
+    // Run all test cases for Reassociator
+    void runAll();
+
+private:
+    void testBalancedMulChain();
+    void testShortChainKept();
+    void testSharedTempEndsChain();
+    void testPrecisionEndsChain();
+    void testReusedNameCopied();
+    void testNonFiniteFoldKept();
+
+    // Helper to show test results
+    void assertTrue(bool condition, const std::string& testName);
+};
+
+#endif // REASSOCIATETEST_H
@@ -0,0 +1,123 @@
+#include "reciprocalTest.h"
+#include "tacTestUtil.h"
+#include <cmath>
+
+using namespace std;
+
+static int count(const vector<TacInst> &tac, TACOp op) {
+    int n = 0;
+    for (const auto &i : tac) n += i.op == op;
+    return n;
+}
+
+// x / 4, y / 3, z / 4 with the constants loaded into t0 and t1
+static vector<TacInst> constantDivisors() {
+    return {
+        inst(TACOp::LOAD_CONST, "t0", "4.0"), inst(TACOp::DIV, "x2", "x", "t0"),
+        inst(TACOp::LOAD_CONST, "t1", "3.0"), inst(TACOp::DIV, "y2", "y", "t1"),
+        inst(TACOp::LOAD_CONST, "t0", "4.0"), inst(TACOp::DIV, "z2", "z", "t0"),
+    };
+}
+
+// x / r, y / r, z / r
+static vector<TacInst> sharedDivisor() {
+    return {inst(TACOp::DIV, "x2", "x", "r"), inst(TACOp::DIV, "y2", "y", "r"), inst(TACOp::DIV, "z2", "z", "r")};
+}
+
+void ReciprocalTest::runAll() {
+    testStrictPowerOfTwo();
+    testStrictKeepsOtherDivisors();
+    testRelaxedSharedDivisor();
+    testRegionEndsAtRedefinition();
+    testZeroAndNonFiniteDivisors();
+    cout << "All ReciprocalHoister tests completed.\n";
+}
+
+void ReciprocalTest::testStrictPowerOfTwo() {
+    vector<TacInst> tac = constantDivisors();
+    ReciprocalStats st = ReciprocalHoister::run(tac, PrecisionMode::STRICT);
+    assertTrue(st.divisors == 1 && st.rewritten == 2 && count(tac, TACOp::DIV) == 1,
+               "both divisions by 4 become multiplies, the one by 3 stays");
+    bool quarter = false;
+    for (const auto &i : tac) quarter = quarter || (i.op == TACOp::LOAD_CONST && i.arg1Literal == "0.25");
+    assertTrue(quarter, "one folded reciprocal 0.25");
+
+    // exact, so bitwise equal for every input, subnormal results included
+    Interpreter before(constantDivisors()), after(tac);
+    bool exact = true;
+    for (double v : {1.0, -7.5, 1e-310, 3.0e300, -0.0, (double)INFINITY}) {
+        map<string, double> in = {{"x", v}, {"y", v}, {"z", v / 3}};
+        map<string, double> a = before.run(in), b = after.run(in);
+        for (const auto &o : a) exact = exact && memcmp(&o.second, &b[o.first], sizeof(double)) == 0;
+    }
+    assertTrue(exact, "bitwise equal to the divisions");
+}
+
+void ReciprocalTest::testStrictKeepsOtherDivisors() {
+    vector<TacInst> tac = sharedDivisor();
+    ReciprocalStats st = ReciprocalHoister::run(tac, PrecisionMode::STRICT);
+    assertTrue(st.rewritten == 0 && tac.size() == 3 && count(tac, TACOp::DIV) == 3, "variable divisors stay in STRICT");
+}
+
+void ReciprocalTest::testRelaxedSharedDivisor() {
+    vector<TacInst> tac = sharedDivisor();
+    tac.insert(tac.begin(), inst(TACOp::ADD, "t3", "x", "y")); // the new temps must not reuse t3
+    tac.push_back(inst(TACOp::ASSIGN, "w", "t3"));
+    ReciprocalStats st = ReciprocalHoister::run(tac, PrecisionMode::RELAXED);
+    assertTrue(st.divisors == 1 && st.rewritten == 3 && count(tac, TACOp::DIV) == 1 && count(tac, TACOp::MUL) == 3,
+               "one 1/r shared by three multiplies");
+    int t3Defs = 0;
+    for (const auto &i : tac) t3Defs += i.dest == "t3";
+    assertTrue(t3Defs == 1, "reciprocal temps are fresh");
+
+    // two roundings: within 1.5 ulp of the quotient
+    Interpreter after(tac);
+    bool close = true;
+    for (double r : {3.0, -7.0, 0.1, 1e-300}) {
+        map<string, double> in = {{"x", 1.0}, {"y", 2.0 / 3}, {"z", -5e-10}, {"r", r}};
+        map<string, double> got = after.run(in);
+        for (const char *o : {"x", "y", "z"}) {
+            double q = in[o] / r;
+            close = close && fabs(got[string(o) + "2"] - q) <= 1.5 * (nextafter(fabs(q), INFINITY) - fabs(q));
+        }
+    }
+    assertTrue(close, "results within 1.5 ulp of x / r");
+
+    vector<TacInst> single = {inst(TACOp::DIV, "y", "x", "r")};
+    assertTrue(ReciprocalHoister::run(single, PrecisionMode::RELAXED).rewritten == 0, "a lone division is left alone");
+    assertTrue(ReciprocalHoister::run(single, PrecisionMode::RELAXED, nullptr, 1).rewritten == 1,
+               "unless minDivisions allows it");
+}
+
+void ReciprocalTest::testRegionEndsAtRedefinition() {
+    // a / r; b / r; r = r + 1; c / r -- the last division sees another r
+    vector<TacInst> tac = {
+        inst(TACOp::DIV, "y1", "a", "r"), inst(TACOp::DIV, "y2", "b", "r"), inst(TACOp::LOAD_CONST, "t0", "1.0"),
+        inst(TACOp::ADD, "r", "r", "t0"), inst(TACOp::DIV, "y3", "c", "r"),
+    };
+    vector<TacInst> before = tac;
+    ReciprocalStats st = ReciprocalHoister::run(tac, PrecisionMode::RELAXED);
+    assertTrue(st.divisors == 1 && st.rewritten == 2 && tac.back().op == TACOp::DIV,
+               "division after the redefinition keeps its own divisor");
+    map<string, double> in = {{"a", 1.0}, {"b", 2.0}, {"c", 4.0}, {"r", 4.0}};
+    assertTrue(Interpreter(tac).run(in) == Interpreter(before).run(in), "y3 = c / (r + 1)");
+}
+
+void ReciprocalTest::testZeroAndNonFiniteDivisors() {
+    // 1/0, 1/-0 and 1/1e-310 are infinite; dividing by them is not multiplying
+    for (const char *c : {"0.0", "-0.0", "1e-310"}) {
+        vector<TacInst> tac = {inst(TACOp::LOAD_CONST, "t0", c), inst(TACOp::DIV, "y", "x", "t0")};
+        ReciprocalStats st = ReciprocalHoister::run(tac, PrecisionMode::RELAXED);
+        assertTrue(st.rewritten == 0 && tac[1].op == TACOp::DIV, string("division by ") + c + " stays");
+    }
+    vector<TacInst> tac = {inst(TACOp::LOAD_CONST, "t0", "3.0"), inst(TACOp::DIV, "y", "x", "t0")};
+    ReciprocalHoister::run(tac, PrecisionMode::RELAXED);
+    assertTrue(count(tac, TACOp::DIV) == 0, "RELAXED folds 1/3 for a constant divisor");
+}
+
+void ReciprocalTest::assertTrue(bool condition, const std::string& testName) {
+    if (condition)
+        std::cout << "[PASS] " << testName << "\n";
+    else
+        std::cout << "[FAIL] " << testName << "\n";
+}
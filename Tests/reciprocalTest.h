@@ -0,0 +1,23 @@
+#ifndef RECIPROCALTEST_H
+#define RECIPROCALTEST_H
+
+#include "../tac/reciprocal.h"
+#include <iostream>
+
+class ReciprocalTest {
+public:
+    // Run all test cases for ReciprocalHoister
+    void runAll();
+
+private:
+    void testStrictPowerOfTwo();
+    void testStrictKeepsOtherDivisors();
+    void testRelaxedSharedDivisor();
+    void testRegionEndsAtRedefinition();
+    void testZeroAndNonFiniteDivisors();
+
+    // Helper to show test results
+    void assertTrue(bool condition, const std::string& testName);
+};
+
+#endif // RECIPROCALTEST_H
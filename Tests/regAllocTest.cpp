@@ -0,0 +1,115 @@
+#include "regAllocTest.h"
+#include "tacTestUtil.h"
+#include <cmath>
+
+using namespace std;
+
+// Execute tac on the allocated register file and frame slots; true when every output
+// equals the Interpreter's. A register shared by two live values shows up here.
+static bool allocationComputes(const vector<TacInst> &tac, const RegAllocResult &res, const map<string, double> &inputs) {
+    vector<double> regs(res.numRegs, 0.0), slots(res.spillSlots, 0.0);
+    auto cell = [&](const Location &l) -> double & { return l.kind == Location::REG ? regs[l.index] : slots[l.index]; };
+    for (const auto &p : res.inputs) cell(p.second) = inputs.at(p.first);
+    for (size_t i = 0; i < tac.size(); ++i) {
+        const TacInst &t = tac[i];
+        const InstAlloc &a = res.insts[i];
+        if (t.dest.empty() || a.coalesced) continue;
+        double x = a.arg1.kind == Location::NONE ? 0.0 : cell(a.arg1);
+        double y = a.arg2.kind == Location::NONE ? 0.0 : cell(a.arg2);
+        double v = t.op == TACOp::LOAD_CONST ? literalValue(t.arg1Literal)
+                 : t.op == TACOp::ASSIGN     ? x
+                 : t.op == TACOp::ADD        ? x + y
+                 : t.op == TACOp::SUB        ? x - y
+                 : t.op == TACOp::MUL        ? x * y
+                 : t.op == TACOp::DIV        ? x / y
+                                             : std::fma(x, y, cell(a.arg3));
+        cell(a.dest) = v;
+    }
+    map<string, double> expect = Interpreter(tac).run(inputs);
+    for (const auto &p : expect)
+        if (!res.outputs.count(p.first) || cell(res.outputs.at(p.first)) != p.second) return false;
+    return true;
+}
+
+// y = ((a + b) * (a - b) + c * d) / (a * d - b * c), many temps live at once
+static vector<TacInst> wideProgram() {
+    return {
+        inst(TACOp::ADD, "t0", "a", "b"),   inst(TACOp::SUB, "t1", "a", "b"),   inst(TACOp::MUL, "t2", "c", "d"),
+        inst(TACOp::MUL, "t3", "a", "d"),   inst(TACOp::MUL, "t4", "b", "c"),   inst(TACOp::MUL, "t5", "t0", "t1"),
+        inst(TACOp::ADD, "t6", "t5", "t2"), inst(TACOp::SUB, "t7", "t3", "t4"), inst(TACOp::DIV, "t8", "t6", "t7"),
+        inst(TACOp::ASSIGN, "y", "t8"),
+    };
+}
+
+static const map<string, double> WIDE_INPUTS = {{"a", 1.5}, {"b", -0.25}, {"c", 3.0}, {"d", 0.5}};
+
+void RegAllocTest::runAll() {
+    testNoSpillsWhenRegistersSuffice();
+    testRecycledNamesAreSeparateValues();
+    testCoalescedMoves();
+    testSpillsStayCorrect();
+    testLiveInRedefined();
+    cout << "All RegisterAllocator tests completed.\n";
+}
+
+void RegAllocTest::testNoSpillsWhenRegistersSuffice() {
+    RegAllocResult res = RegisterAllocator::allocate(wideProgram(), 16);
+    assertTrue(res.spillCount == 0 && res.spillSlots == 0 && res.spillReloads == 0, "16 registers: no spills");
+    assertTrue(res.inputs.size() == 4 && res.outputs.size() == 1 && res.outputs.count("y"), "live-ins and live-out");
+    assertTrue(allocationComputes(wideProgram(), res, WIDE_INPUTS), "allocated program computes y");
+}
+
+void RegAllocTest::testRecycledNamesAreSeparateValues() {
+    // t0 holds x*x, then x+x; the first value must survive until sq reads it
+    vector<TacInst> tac = {
+        inst(TACOp::MUL, "t0", "x", "x"), inst(TACOp::ASSIGN, "sq", "t0"),
+        inst(TACOp::ADD, "t0", "x", "x"), inst(TACOp::ASSIGN, "dbl", "t0"),
+    };
+    RegAllocResult res = RegisterAllocator::allocate(tac, 2);
+    int t0Values = 0;
+    for (const auto &li : res.intervals) t0Values += li.name == "t0";
+    assertTrue(t0Values == 2, "each definition of t0 is its own interval");
+    assertTrue(allocationComputes(tac, res, {{"x", 3.0}}), "sq = 9, dbl = 6 on two registers");
+}
+
+void RegAllocTest::testCoalescedMoves() {
+    RegAllocResult res = RegisterAllocator::allocate(wideProgram(), 16);
+    assertTrue(res.coalescedMoves == 1 && res.insts.back().coalesced && res.insts.back().dest == res.insts.back().arg1,
+               "y = t8 shares t8's register");
+    // the source is still read afterwards: no coalescing
+    vector<TacInst> tac = {inst(TACOp::MUL, "t0", "x", "x"), inst(TACOp::ASSIGN, "y", "t0"),
+                           inst(TACOp::ADD, "z", "t0", "x")};
+    res = RegisterAllocator::allocate(tac, 16);
+    assertTrue(res.coalescedMoves == 0 && allocationComputes(tac, res, {{"x", -2.0}}), "live source keeps its own register");
+}
+
+void RegAllocTest::testSpillsStayCorrect() {
+    bool ok = true;
+    for (int regs = 1; regs <= 5; ++regs) {
+        RegAllocResult res = RegisterAllocator::allocate(wideProgram(), regs);
+        ok = ok && allocationComputes(wideProgram(), res, WIDE_INPUTS);
+        for (const auto &li : res.intervals) ok = ok && (li.loc.kind != Location::REG || li.loc.index < regs);
+    }
+    RegAllocResult two = RegisterAllocator::allocate(wideProgram(), 2);
+    assertTrue(two.spillCount > 0 && two.spillStores > 0 && two.spillReloads > 0, "two registers force spills");
+    assertTrue(ok, "1 to 5 registers: every value in range and y unchanged");
+    assertTrue(RegisterAllocator::allocate(wideProgram(), 0).numRegs == 1, "at least one register");
+}
+
+void RegAllocTest::testLiveInRedefined() {
+    // x = x * 2; y = x + 1: the incoming x and the new x are different values
+    vector<TacInst> tac = {
+        inst(TACOp::LOAD_CONST, "t0", "2.0"), inst(TACOp::MUL, "t1", "x", "t0"), inst(TACOp::ASSIGN, "x", "t1"),
+        inst(TACOp::LOAD_CONST, "t2", "1.0"), inst(TACOp::ADD, "t3", "x", "t2"), inst(TACOp::ASSIGN, "y", "t3"),
+    };
+    RegAllocResult res = RegisterAllocator::allocate(tac, 2);
+    assertTrue(res.inputs.count("x") && res.outputs.count("x") && res.outputs.count("y"), "x is both live-in and live-out");
+    assertTrue(allocationComputes(tac, res, {{"x", 4.0}}), "x = 8, y = 9");
+}
+
+void RegAllocTest::assertTrue(bool condition, const std::string& testName) {
+    if (condition)
+        std::cout << "[PASS] " << testName << "\n";
+    else
+        std::cout << "[FAIL] " << testName << "\n";
+}
@@ -0,0 +1,23 @@
+#ifndef REGALLOCTEST_H
+#define REGALLOCTEST_H
+
+#include "../tac/regAlloc.h"
+#include <iostream>
+
+class RegAllocTest {
+public:
+    // Run all test cases for RegisterAllocator
+    void runAll();
+
+private:
+    void testNoSpillsWhenRegistersSuffice();
+    void testRecycledNamesAreSeparateValues();
+    void testCoalescedMoves();
+    void testSpillsStayCorrect();
+    void testLiveInRedefined();
+
+    // Helper to show test results
+    void assertTrue(bool condition, const std::string& testName);
+};
+
+#endif // REGALLOCTEST_H
@@ -0,0 +1,111 @@
+#include "schedulerTest.h"
+#include "tacTestUtil.h"
+
+using namespace std;
+
+// Same outputs before and after scheduling on one sample.
+static bool sameOutputs(const vector<TacInst> &before, const vector<TacInst> &after, const map<string, double> &in) {
+    return Interpreter(before).run(in) == Interpreter(after).run(in);
+}
+
+// Position of the first op in tac that writes dest (any dest when empty).
+static int indexOf(const vector<TacInst> &tac, TACOp op, const string &dest = "") {
+    for (size_t i = 0; i < tac.size(); ++i)
+        if (tac[i].op == op && (dest.empty() || tac[i].dest == dest)) return (int)i;
+    return -1;
+}
+
+// y = a / b + c; z = d * e + f -- parse order waits on the division before starting z
+static vector<TacInst> divThenIndependent() {
+    return {
+        inst(TACOp::DIV, "t0", "a", "b"), inst(TACOp::ADD, "t1", "t0", "c"), inst(TACOp::ASSIGN, "y", "t1"),
+        inst(TACOp::MUL, "t0", "d", "e"), inst(TACOp::ADD, "t1", "t0", "f"), inst(TACOp::ASSIGN, "z", "t1"),
+    };
+}
+
+static const map<string, double> INPUTS = {{"a", 3.0}, {"b", 7.0}, {"c", 0.5}, {"d", -2.0}, {"e", 1.25}, {"f", 4.0}};
+
+void SchedulerTest::runAll() {
+    testEstimate();
+    testHidesDivideLatency();
+    testNeverSlower();
+    testVariableOrderKept();
+    testGuardBeforeDivision();
+    testLiveInTempsKept();
+    cout << "All InstructionScheduler tests completed.\n";
+}
+
+void SchedulerTest::testEstimate() {
+    // div (14) then a dependent add (4): 18 cycles; two independent adds: 1 + 4
+    vector<TacInst> chain = {inst(TACOp::DIV, "t0", "a", "b"), inst(TACOp::ADD, "y", "t0", "c")};
+    vector<TacInst> pair = {inst(TACOp::ADD, "y", "a", "b"), inst(TACOp::ADD, "z", "c", "d")};
+    assertTrue(InstructionScheduler::estimateCycles(chain) == 18, "dependent chain adds latencies");
+    assertTrue(InstructionScheduler::estimateCycles(pair) == 5, "independent instructions issue back to back");
+    assertTrue(InstructionScheduler::estimateCycles({}) == 0, "empty program costs nothing");
+}
+
+void SchedulerTest::testHidesDivideLatency() {
+    vector<TacInst> tac = divThenIndependent();
+    ScheduleStats st = InstructionScheduler::schedule(tac, LatencyTable::defaults(), 2);
+    assertTrue(st.cyclesAfter < st.cyclesBefore && st.cyclesAfter == InstructionScheduler::estimateCycles(tac),
+               "fewer estimated cycles after scheduling");
+    assertTrue(indexOf(tac, TACOp::ASSIGN, "z") < indexOf(tac, TACOp::ASSIGN, "y"), "z completes inside the divide");
+    assertTrue(st.tempsAfter <= 2 && sameOutputs(divThenIndependent(), tac, INPUTS), "two temps, same outputs");
+}
+
+void SchedulerTest::testNeverSlower() {
+    vector<TacInst> tac = {inst(TACOp::MUL, "t0", "a", "b"), inst(TACOp::ADD, "t1", "t0", "c"), inst(TACOp::ASSIGN, "y", "t1")};
+    vector<TacInst> before = tac;
+    ScheduleStats st = InstructionScheduler::schedule(tac);
+    bool same = tac.size() == before.size();
+    for (size_t i = 0; same && i < tac.size(); ++i) same = tac[i].dest == before[i].dest && tac[i].arg1 == before[i].arg1;
+    assertTrue(same && st.cyclesAfter == st.cyclesBefore, "a pure chain is left alone");
+}
+
+void SchedulerTest::testVariableOrderKept() {
+    // y = x / b; x = c; z = x * 2 -- y must read the incoming x, z the new one
+    vector<TacInst> tac = {
+        inst(TACOp::DIV, "t0", "x", "b"),     inst(TACOp::ASSIGN, "y", "t0"), inst(TACOp::ASSIGN, "x", "c"),
+        inst(TACOp::LOAD_CONST, "t1", "2.0"), inst(TACOp::MUL, "t2", "x", "t1"), inst(TACOp::ASSIGN, "z", "t2"),
+    };
+    vector<TacInst> before = tac;
+    InstructionScheduler::schedule(tac, LatencyTable::defaults(), 4);
+    assertTrue(indexOf(tac, TACOp::DIV) < indexOf(tac, TACOp::ASSIGN, "x") &&
+                   sameOutputs(before, tac, {{"x", 6.0}, {"b", 4.0}, {"c", -1.0}}),
+               "anti and output dependences on variables hold");
+}
+
+void SchedulerTest::testGuardBeforeDivision() {
+    // independent work first in parse order, then check d != 0; q = n / d
+    vector<TacInst> tac = {
+        inst(TACOp::MUL, "t0", "a", "a"), inst(TACOp::MUL, "t1", "t0", "a"), inst(TACOp::ASSIGN, "y", "t1"),
+        guard(TACOp::GUARD_NONZERO, "d"), inst(TACOp::DIV, "t2", "n", "d"),  inst(TACOp::ASSIGN, "q", "t2"),
+    };
+    InstructionScheduler::schedule(tac, LatencyTable::defaults(), 4);
+    const int g = indexOf(tac, TACOp::GUARD_NONZERO);
+    assertTrue(g >= 0 && g < indexOf(tac, TACOp::DIV), "the division never moves above its guard");
+}
+
+void SchedulerTest::testLiveInTempsKept() {
+    // t1 comes from outside the block (a stream prologue); re-minimizing must not hand
+    // its number to d * e, which now starts inside the divide
+    vector<TacInst> tac = {
+        inst(TACOp::DIV, "t0", "a", "b"), inst(TACOp::ADD, "t2", "t0", "c"), inst(TACOp::ASSIGN, "y", "t2"),
+        inst(TACOp::MUL, "t0", "d", "e"), inst(TACOp::MUL, "t2", "t0", "t1"), inst(TACOp::ASSIGN, "z", "t2"),
+    };
+    vector<TacInst> before = tac;
+    ScheduleStats st = InstructionScheduler::schedule(tac, LatencyTable::defaults(), 2);
+    bool redefined = false;
+    for (const auto &i : tac) redefined = redefined || i.dest == "t1";
+    assertTrue(st.cyclesAfter < st.cyclesBefore && !redefined, "reordered, and no instruction defines the live-in t1");
+    assertTrue(st.tempsAfter == 2 &&
+                   sameOutputs(before, tac, {{"a", 1.0}, {"b", 4.0}, {"c", 3.0}, {"d", 5.0}, {"e", 0.5}, {"t1", -2.0}}),
+               "outputs unchanged");
+}
+
+void SchedulerTest::assertTrue(bool condition, const std::string& testName) {
+    if (condition)
+        std::cout << "[PASS] " << testName << "\n";
+    else
+        std::cout << "[FAIL] " << testName << "\n";
+}
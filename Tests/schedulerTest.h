@@ -0,0 +1,24 @@
+#ifndef SCHEDULERTEST_H
+#define SCHEDULERTEST_H
+
+#include "../tac/scheduler.h"
+#include <iostream>
+
+class SchedulerTest {
+public:
+    // Run all test cases for InstructionScheduler
+    void runAll();
+
+private:
+    void testEstimate();
+    void testHidesDivideLatency();
+    void testNeverSlower();
+    void testVariableOrderKept();
+    void testGuardBeforeDivision();
+    void testLiveInTempsKept();
+
+    // Helper to show test results
+    void assertTrue(bool condition, const std::string& testName);
+};
+
+#endif // SCHEDULERTEST_H
@@ -0,0 +1,291 @@
+#include "simdKernelsTest.h"
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+using namespace std;
+
+// Unaligned starts and lengths around every vector width, so both the peeled head
+// and the (masked) tail run.
+static const size_t OFFSETS[] = {0, 1, 3};
+static const size_t LENGTHS[] = {0, 1, 2, 3, 5, 7, 8, 9, 15, 16, 17, 31, 33, 64, 67};
+static const size_t MAX_N = 67 + 3;
+
+// Operands cycle through NaN, infinities, signed zeros, subnormals and ordinary
+// values; a and b are out of phase so every pair of specials meets.
+template <class T> static vector<T> operands(int phase) {
+    const T inf = numeric_limits<T>::infinity(), nan = numeric_limits<T>::quiet_NaN();
+    const T tiny = numeric_limits<T>::denorm_min(), big = numeric_limits<T>::max();
+    const T special[] = {nan, inf, -inf, (T)0.0, (T)-0.0, tiny, -tiny, big, (T)-1.0, (T)0.1, (T)3.0, (T)-2.5e-3};
+    const size_t ns = sizeof(special) / sizeof(special[0]);
+    vector<T> v(MAX_N);
+    for (size_t i = 0; i < MAX_N; ++i) v[i] = special[(i * (phase + 1) + phase) % ns];
+    return v;
+}
+
+// Same value bit for bit; any two NaNs compare equal, since a NaN's payload depends
+// on which operand the hardware propagates.
+template <class T> static bool same(T x, T y) {
+    if (std::isnan(x) || std::isnan(y)) return std::isnan(x) && std::isnan(y);
+    return memcmp(&x, &y, sizeof(T)) == 0;
+}
+template <class T> static bool same(const T *x, const T *y, size_t n) {
+    for (size_t i = 0; i < n; ++i)
+        if (!same(x[i], y[i])) return false;
+    return true;
+}
+
+template <class T> static T apply(int op, T a, T b) {
+    switch (op) {
+        case 0: return a + b;
+        case 1: return a - b;
+        case 2: return a * b;
+        default: return a / b;
+    }
+}
+
+template <class T> struct Ops; // kernels of one element type in a table
+template <> struct Ops<double> {
+    static auto vv(const SimdKernelTable &t, int op) { return t.f64vv[op]; }
+    static auto vs(const SimdKernelTable &t, int op) { return t.f64vs[op]; }
+    static auto sv(const SimdKernelTable &t, int op) { return t.f64sv[op]; }
+    static auto axpb(const SimdKernelTable &t) { return t.f64axpb; }
+    static auto xmog(const SimdKernelTable &t) { return t.f64xmog; }
+    static auto axby(const SimdKernelTable &t) { return t.f64axby; }
+    static auto sqr(const SimdKernelTable &t) { return t.f64sqr; }
+};
+template <> struct Ops<float> {
+    static auto vv(const SimdKernelTable &t, int op) { return t.f32vv[op]; }
+    static auto vs(const SimdKernelTable &t, int op) { return t.f32vs[op]; }
+    static auto sv(const SimdKernelTable &t, int op) { return t.f32sv[op]; }
+    static auto axpb(const SimdKernelTable &t) { return t.f32axpb; }
+    static auto xmog(const SimdKernelTable &t) { return t.f32xmog; }
+    static auto axby(const SimdKernelTable &t) { return t.f32axby; }
+    static auto sqr(const SimdKernelTable &t) { return t.f32sqr; }
+};
+
+// Scalar constants used by the vector-scalar forms and the shapes.
+template <class T> static vector<T> scalars() {
+    const T inf = numeric_limits<T>::infinity();
+    return {(T)2.5, (T)-0.0, (T)0.0, inf, -inf, numeric_limits<T>::quiet_NaN(), numeric_limits<T>::denorm_min()};
+}
+
+// Runs every binary kernel of table t on every offset/length; the results must equal
+// ref(op, form, a, b, s, i) element for element and leave the destination's
+// surroundings untouched.
+template <class T, class Ref> static bool binaryMatches(const SimdKernelTable &t, Ref ref) {
+    const vector<T> a = operands<T>(0), b = operands<T>(1);
+    const T guardValue = (T)12345.0;
+    for (int op = 0; op < 4; ++op)
+        for (size_t off : OFFSETS)
+            for (size_t n : LENGTHS) {
+                if (off + n > MAX_N) continue;
+                for (int form = 0; form < 3; ++form)
+                    for (T s : scalars<T>()) {
+                        vector<T> d(MAX_N + 1, guardValue);
+                        if (form == 0) Ops<T>::vv(t, op)(d.data() + off, a.data() + off, b.data() + off, n);
+                        else if (form == 1) Ops<T>::vs(t, op)(d.data() + off, a.data() + off, s, n);
+                        else Ops<T>::sv(t, op)(d.data() + off, s, b.data() + off, n);
+                        for (size_t i = 0; i <= MAX_N; ++i) {
+                            const bool inside = i >= off && i < off + n;
+                            if (!same(d[i], inside ? ref(op, form, a[i], b[i], s) : guardValue)) return false;
+                        }
+                        if (form == 0) break; // no scalar operand
+                    }
+            }
+    return true;
+}
+
+// Same for the statement shapes, against table r.
+template <class T> static bool shapesMatch(const SimdKernelTable &t, const SimdKernelTable &r) {
+    const vector<T> x = operands<T>(2), y = operands<T>(3);
+    const vector<T> ks = scalars<T>();
+    for (size_t off : OFFSETS)
+        for (size_t n : LENGTHS) {
+            if (off + n > MAX_N) continue;
+            vector<T> d(MAX_N), e(MAX_N);
+            Ops<T>::sqr(t)(d.data() + off, x.data() + off, n);
+            Ops<T>::sqr(r)(e.data() + off, x.data() + off, n);
+            if (!same(d.data() + off, e.data() + off, n)) return false;
+            for (T p : ks)
+                for (T q : ks) {
+                    Ops<T>::axpb(t)(d.data() + off, x.data() + off, p, q, n);
+                    Ops<T>::axpb(r)(e.data() + off, x.data() + off, p, q, n);
+                    if (!same(d.data() + off, e.data() + off, n)) return false;
+                    Ops<T>::xmog(t)(d.data() + off, x.data() + off, p, q, n);
+                    Ops<T>::xmog(r)(e.data() + off, x.data() + off, p, q, n);
+                    if (!same(d.data() + off, e.data() + off, n)) return false;
+                    Ops<T>::axby(t)(d.data() + off, x.data() + off, p, y.data() + off, q, n);
+                    Ops<T>::axby(r)(e.data() + off, x.data() + off, p, y.data() + off, q, n);
+                    if (!same(d.data() + off, e.data() + off, n)) return false;
+                }
+        }
+    return true;
+}
+
+template <class T> static T roundTwice(T x, T a, T b) {
+    volatile T p = x * a; // no contraction into an FMA
+    return p + b;
+}
+
+void SimdKernelsTest::runAll() {
+    testScalarMatchesIeee();
+    testLevelsMatchScalar();
+    testShapesMatchScalar();
+    testInPlace();
+    testQ15MatchesScalar();
+    cout << "All SimdKernels tests completed.\n";
+}
+
+void SimdKernelsTest::testScalarMatchesIeee() {
+    const SimdKernelTable &t = SimdKernels::table(SimdLevel::SCALAR);
+    auto ref64 = [](int op, int form, double a, double b, double s) {
+        return form == 0 ? apply(op, a, b) : form == 1 ? apply(op, a, s) : apply(op, s, b);
+    };
+    auto ref32 = [](int op, int form, float a, float b, float s) {
+        return form == 0 ? apply(op, a, b) : form == 1 ? apply(op, a, s) : apply(op, s, b);
+    };
+    assertTrue(binaryMatches<double>(t, ref64) && binaryMatches<float>(t, ref32),
+               "scalar kernels compute IEEE results and stay within their range");
+
+    // signed zeros: the shapes round after each operation and keep the sign
+    double d[4], x[4] = {-0.0, 0.0, -0.0, 1e300};
+    t.f64axpb(d, x, 1.0, -0.0, 4);
+    bool ok = signbit(d[0]) && !signbit(d[1]) && signbit(d[2]) && same(d[3], roundTwice(1e300, 1.0, -0.0));
+    t.f64axpb(d, x, 1e10, -1e300, 4);
+    ok = ok && same(d[3], roundTwice(1e300, 1e10, -1e300)) && isinf(d[3]);
+    t.f64sqr(d, x, 4);
+    ok = ok && !signbit(d[0]) && d[0] == 0.0 && isinf(d[3]);
+    t.f64xmog(d, x, 0.0, -1.0, 4);
+    ok = ok && !signbit(d[0]) && signbit(d[1]);
+    assertTrue(ok, "scalar shapes keep signed zeros and overflow like two roundings");
+}
+
+void SimdKernelsTest::testLevelsMatchScalar() {
+    const SimdKernelTable &r = SimdKernels::table(SimdLevel::SCALAR);
+    int checked = 0;
+    for (int l = 1; l < (int)SimdLevel::COUNT; ++l) {
+        const SimdLevel level = (SimdLevel)l;
+        if (!SimdKernels::supported(level)) continue;
+        const SimdKernelTable &t = SimdKernels::table(level);
+        auto ref64 = [&r](int op, int form, double a, double b, double s) {
+            double d;
+            if (form == 0) r.f64vv[op](&d, &a, &b, 1);
+            else if (form == 1) r.f64vs[op](&d, &a, s, 1);
+            else r.f64sv[op](&d, s, &b, 1);
+            return d;
+        };
+        auto ref32 = [&r](int op, int form, float a, float b, float s) {
+            float d;
+            if (form == 0) r.f32vv[op](&d, &a, &b, 1);
+            else if (form == 1) r.f32vs[op](&d, &a, s, 1);
+            else r.f32sv[op](&d, s, &b, 1);
+            return d;
+        };
+        assertTrue(t.level == level && binaryMatches<double>(t, ref64) && binaryMatches<float>(t, ref32),
+                   SimdKernels::levelName(level) + " binary kernels equal scalar, heads and tails included");
+        ++checked;
+    }
+    if (checked == 0) cout << "  (no SIMD level supported here; only the scalar table was checked)\n";
+}
+
+void SimdKernelsTest::testShapesMatchScalar() {
+    const SimdKernelTable &r = SimdKernels::table(SimdLevel::SCALAR);
+    for (int l = 1; l < (int)SimdLevel::COUNT; ++l) {
+        const SimdLevel level = (SimdLevel)l;
+        if (!SimdKernels::supported(level)) continue;
+        const SimdKernelTable &t = SimdKernels::table(level);
+        assertTrue(shapesMatch<double>(t, r) && shapesMatch<float>(t, r),
+                   SimdKernels::levelName(level) + " shape kernels equal scalar");
+    }
+    // and the scalar shapes are two roundings of the TAC they replace
+    const vector<double> x = operands<double>(2), y = operands<double>(3);
+    vector<double> d(MAX_N);
+    bool ok = true;
+    for (double p : scalars<double>())
+        for (double q : scalars<double>()) {
+            r.f64axpb(d.data(), x.data(), p, q, MAX_N);
+            for (size_t i = 0; i < MAX_N; ++i) ok = ok && same(d[i], roundTwice(x[i], p, q));
+            r.f64xmog(d.data(), x.data(), p, q, MAX_N);
+            for (size_t i = 0; i < MAX_N; ++i) ok = ok && same(d[i], (x[i] - p) * q);
+            r.f64axby(d.data(), x.data(), p, y.data(), q, MAX_N);
+            for (size_t i = 0; i < MAX_N; ++i) {
+                volatile double u = x[i] * p, v = y[i] * q;
+                ok = ok && same(d[i], u + v);
+            }
+        }
+    assertTrue(ok, "scalar shapes round like the separate TAC instructions");
+}
+
+void SimdKernelsTest::testInPlace() {
+    const SimdKernelTable &r = SimdKernels::table(SimdLevel::SCALAR);
+    const vector<double> a = operands<double>(0), b = operands<double>(1);
+    bool ok = true;
+    for (int l = 0; l < (int)SimdLevel::COUNT; ++l) {
+        if (!SimdKernels::supported((SimdLevel)l)) continue;
+        const SimdKernelTable &t = SimdKernels::table((SimdLevel)l);
+        for (int op = 0; op < 4; ++op)
+            for (size_t off : OFFSETS) {
+                const size_t n = MAX_N - off;
+                vector<double> d = a, e(MAX_N);
+                t.f64vv[op](d.data() + off, d.data() + off, b.data() + off, n);
+                r.f64vv[op](e.data() + off, a.data() + off, b.data() + off, n);
+                ok = ok && same(d.data() + off, e.data() + off, n);
+                d = b;
+                t.f64axby(d.data() + off, a.data() + off, 2.0, d.data() + off, -0.5, n);
+                r.f64axby(e.data() + off, a.data() + off, 2.0, b.data() + off, -0.5, n);
+                ok = ok && same(d.data() + off, e.data() + off, n);
+            }
+    }
+    assertTrue(ok, "destination may be one of the sources");
+}
+
+void SimdKernelsTest::testQ15MatchesScalar() {
+    const SimdKernelTable &r = SimdKernels::table(SimdLevel::SCALAR);
+    const int16_t edge[] = {-32768, -32767, -16384, -1, 0, 1, 2, 255, 16384, 32767};
+    vector<int16_t> a(MAX_N), b(MAX_N);
+    for (size_t i = 0; i < MAX_N; ++i) {
+        a[i] = edge[i % 10];
+        b[i] = edge[(i * 7 + 3) % 10];
+    }
+    const FxShift id = {INT32_MIN, INT32_MAX, 0, 0, 0, INT32_MIN, INT32_MAX};
+    const FxShift half = {INT32_MIN, INT32_MAX, 0, 1, 1, -32768, 32767};       // (v + 1) >> 1
+    const FxShift q15 = {INT32_MIN, INT32_MAX, 0, 1 << 14, 15, -32768, 32767}; // Q30 -> Q15
+    const FxShift up = {-1024, 1023, 5, 0, 0, -32768, 32767};                  // saturating << 5
+    for (int l = 1; l < (int)SimdLevel::COUNT; ++l) {
+        const SimdLevel level = (SimdLevel)l;
+        if (!SimdKernels::supported(level)) continue;
+        const SimdKernelTable &t = SimdKernels::table(level);
+        bool ok = true;
+        for (size_t off : OFFSETS)
+            for (size_t n : LENGTHS) {
+                if (off + n > MAX_N) continue;
+                vector<int16_t> d(MAX_N), e(MAX_N);
+                auto check = [&] { ok = ok && memcmp(d.data() + off, e.data() + off, n * sizeof(int16_t)) == 0; };
+                t.q15add(d.data() + off, a.data() + off, id, b.data() + off, id, half, n);
+                r.q15add(e.data() + off, a.data() + off, id, b.data() + off, id, half, n);
+                check();
+                t.q15sub(d.data() + off, a.data() + off, up, b.data() + off, id, half, n);
+                r.q15sub(e.data() + off, a.data() + off, up, b.data() + off, id, half, n);
+                check();
+                t.q15mul(d.data() + off, a.data() + off, b.data() + off, q15, n);
+                r.q15mul(e.data() + off, a.data() + off, b.data() + off, q15, n);
+                check();
+                t.q15move(d.data() + off, a.data() + off, up, n);
+                r.q15move(e.data() + off, a.data() + off, up, n);
+                check();
+                t.q15div(d.data() + off, a.data() + off, b.data() + off, 14, half, n);
+                r.q15div(e.data() + off, a.data() + off, b.data() + off, 14, half, n);
+                check();
+            }
+        assertTrue(ok, SimdKernels::levelName(level) + " Q15 kernels equal scalar, saturation and b == 0 included");
+    }
+}
+
+void SimdKernelsTest::assertTrue(bool condition, const std::string& testName) {
+    if (condition)
+        std::cout << "[PASS] " << testName << "\n";
+    else
+        std::cout << "[FAIL] " << testName << "\n";
+}
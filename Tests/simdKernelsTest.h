@@ -0,0 +1,23 @@
+#ifndef SIMDKERNELSTEST_H
+#define SIMDKERNELSTEST_H
+
+#include "../runtime/simdKernels.h"
+#include <iostream>
+
+class SimdKernelsTest {
+public:
+    // Run all test cases for SimdKernels
+    void runAll();
+
+private:
+    void testScalarMatchesIeee();
+    void testLevelsMatchScalar();
+    void testShapesMatchScalar();
+    void testInPlace();
+    void testQ15MatchesScalar();
+
+    // Helper to show test results
+    void assertTrue(bool condition, const std::string& testName);
+};
+
+#endif // SIMDKERNELSTEST_H
@@ -0,0 +1,93 @@
+#include "slicerTest.h"
+#include "tacTestUtil.h"
+#include "../errorHandler/errorHandler.h"
+
+using namespace std;
+
+// y = a * b; z = y / c (guarded); w = d + d
+static vector<TacInst> threeOutputs() {
+    return {
+        inst(TACOp::MUL, "t0", "a", "b"), inst(TACOp::ASSIGN, "y", "t0"),  guard(TACOp::GUARD_NONZERO, "c"),
+        inst(TACOp::DIV, "t1", "y", "c"), inst(TACOp::ASSIGN, "z", "t1"),  guard(TACOp::GUARD_NONZERO, "d"),
+        inst(TACOp::ADD, "t2", "d", "d"), inst(TACOp::ASSIGN, "w", "t2"),
+    };
+}
+
+static const map<string, double> INPUTS = {{"a", 2.0}, {"b", 3.0}, {"c", 4.0}, {"d", 5.0}};
+
+void SlicerTest::runAll() {
+    testKeepsDependencies();
+    testGuards();
+    testStateFixpoint();
+    testUnknownOutputs();
+    testCache();
+    cout << "All OutputSlicer tests completed.\n";
+}
+
+void SlicerTest::testKeepsDependencies() {
+    SliceStats st;
+    vector<TacInst> y = OutputSlicer::compute(threeOutputs(), {"y"}, nullptr, &st);
+    assertTrue(y.size() == 2 && st.instructionsBefore == 8 && st.instructionsAfter == 2, "y needs a * b only");
+    map<string, double> full = Interpreter(threeOutputs()).run(INPUTS);
+    map<string, double> z = Interpreter(OutputSlicer::compute(threeOutputs(), {"z"})).run(INPUTS);
+    assertTrue(z.size() == 2 && z["y"] == full["y"] && z["z"] == full["z"], "z pulls in y and keeps program order");
+    assertTrue(OutputSlicer::compute(threeOutputs(), {}).empty(), "nothing requested, nothing kept");
+}
+
+void SlicerTest::testGuards() {
+    vector<TacInst> z = OutputSlicer::compute(threeOutputs(), {"z"});
+    int onC = 0, onD = 0;
+    for (const auto &i : z) {
+        onC += i.op == TACOp::GUARD_NONZERO && i.arg1 == "c";
+        onD += i.op == TACOp::GUARD_NONZERO && i.arg1 == "d";
+    }
+    assertTrue(onC == 1 && onD == 0, "guard on c kept for z, guard on d dropped");
+    vector<TacInst> w = OutputSlicer::compute(threeOutputs(), {"w"});
+    assertTrue(w.size() == 3 && w[0].op == TACOp::GUARD_NONZERO, "guard on d kept for w");
+}
+
+void SlicerTest::testStateFixpoint() {
+    ErrorHandler err;
+    SymbolTable sym(&err);
+    declareState(sym, {"s1", "s2"});
+    // y = s1; s1 = s2; s2 = x; v = x * x -- y reads s1, s1 reads s2, so both updates stay
+    vector<TacInst> tac = {inst(TACOp::ASSIGN, "y", "s1"), inst(TACOp::ASSIGN, "s1", "s2"),
+                           inst(TACOp::ASSIGN, "s2", "x"), inst(TACOp::MUL, "v", "x", "x")};
+    SliceStats st;
+    vector<TacInst> y = OutputSlicer::compute(tac, {"y"}, &sym, &st);
+    assertTrue(st.stateAdded == 2 && y.size() == 3 && y.back().dest == "s2", "state chain pulled in to a fixpoint");
+    vector<TacInst> noSym = OutputSlicer::compute(tac, {"y"});
+    assertTrue(noSym.size() == 1, "without a symbol table s1 is just an input");
+}
+
+void SlicerTest::testUnknownOutputs() {
+    SliceStats st;
+    vector<TacInst> y = OutputSlicer::compute(threeOutputs(), {"y", "yy", "a"}, nullptr, &st);
+    assertTrue(y.size() == 2 && st.unknown == vector<string>({"a", "yy"}),
+               "misspelled names and inputs reported, not sliced for");
+
+    OutputSlicer slicer(threeOutputs());
+    slicer.slice({"y"}, &st);
+    assertTrue(st.unknown.empty(), "none for a clean request");
+    slicer.slice({"y", "bogus"}, &st);
+    assertTrue(slicer.cacheHits() == 1 && st.unknown == vector<string>({"bogus"}),
+               "reported on a cache hit too");
+}
+
+void SlicerTest::testCache() {
+    OutputSlicer slicer(threeOutputs());
+    const vector<TacInst> &a = slicer.slice({"y", "w"});
+    const vector<TacInst> &b = slicer.slice({"w", "y"});
+    assertTrue(&a == &b && slicer.cacheHits() == 1 && slicer.cacheMisses() == 1, "same set served from the cache");
+    slicer.slice({"z"});
+    assertTrue(slicer.cacheSize() == 2, "new set, new entry");
+    slicer.reset({inst(TACOp::ASSIGN, "y", "a")});
+    assertTrue(slicer.cacheSize() == 0 && slicer.slice({"y"}).size() == 1, "reset drops the cache");
+}
+
+void SlicerTest::assertTrue(bool condition, const std::string& testName) {
+    if (condition)
+        std::cout << "[PASS] " << testName << "\n";
+    else
+        std::cout << "[FAIL] " << testName << "\n";
+}
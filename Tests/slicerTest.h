@@ -0,0 +1,23 @@
+#ifndef SLICERTEST_H
+#define SLICERTEST_H
+
+#include "../tac/slicer.h"
+#include <iostream>
+
+class SlicerTest {
+public:
+    // Run all test cases for OutputSlicer
+    void runAll();
+
+private:
+    void testKeepsDependencies();
+    void testGuards();
+    void testStateFixpoint();
+    void testUnknownOutputs();
+    void testCache();
+
+    // Helper to show test results
+    void assertTrue(bool condition, const std::string& testName);
+};
+
+#endif // SLICERTEST_H
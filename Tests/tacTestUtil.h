@@ -0,0 +1,87 @@
+#ifndef TACTESTUTIL_H
+#define TACTESTUTIL_H
+
+#include "../tac/tac.h"
+#include "../symbolTable/symbolTable.h"
+#include "../runtime/interpreter.h"
+#include <vector>
+#include <string>
+#include <cstring>
+#include <initializer_list>
+
+/*
+ * Fixtures shared by the TAC pass and backend tests.
+ *  - inst() / guard() build single instructions.
+ *  - mixedProgram() exercises every arithmetic opcode, float32 and FMA.
+ *  - statesReadEachOther() checks a backend's state updates against the Interpreter.
+ */
+
+// Build one TAC instruction; LOAD_CONST takes its literal as a, FMA its addend as c.
+inline TacInst inst(TACOp op, const std::string &dest, const std::string &a = "", const std::string &b = "",
+                    const std::string &c = "") {
+    TacInst i;
+    i.op = op;
+    i.dest = dest;
+    if (op == TACOp::LOAD_CONST) i.arg1Literal = a;
+    else i.arg1 = a;
+    i.arg2 = b;
+    i.arg3 = c;
+    return i;
+}
+
+// Runtime check on one value (GUARD_NONZERO or GUARD_FINITE).
+inline TacInst guard(TACOp op, const std::string &arg) {
+    TacInst g;
+    g.op = op;
+    g.arg1 = arg;
+    return g;
+}
+
+// y = (a + k) * b - a / b; z = f32(y * a); w = fma(a, b, y)
+inline std::vector<TacInst> mixedProgram(const std::string &k = "2.5") {
+    TacInst z = inst(TACOp::MUL, "z", "y", "a");
+    z.prec = TacPrecision::F32;
+    return {
+        inst(TACOp::LOAD_CONST, "t0", k),
+        inst(TACOp::ADD, "t1", "a", "t0"),
+        inst(TACOp::MUL, "t0", "t1", "b"),
+        inst(TACOp::DIV, "t1", "a", "b"),
+        inst(TACOp::SUB, "t2", "t0", "t1"),
+        inst(TACOp::ASSIGN, "y", "t2"),
+        z,
+        inst(TACOp::FMA, "w", "a", "b", "y"),
+    };
+}
+
+// Declare names as float state variables in sym.
+inline void declareState(SymbolTable &sym, std::initializer_list<const char *> names) {
+    for (const char *name : names) {
+        SymbolEntry e(name, "variable", "float");
+        e.is_state = true;
+        sym.insert(e);
+    }
+}
+
+// Two-tap delay line y = z1 + z2; z2 = z1; z1 = x next to a swap tmp = s1; s1 = s2; s2 = tmp.
+// Three samples through Kernel and the Interpreter from the same starting state; true when
+// outputs and final state agree bit for bit and the state ended where it should.
+template <class Kernel> bool statesReadEachOther() {
+    ErrorHandler err;
+    SymbolTable sym(&err);
+    declareState(sym, {"z1", "z2", "s1", "s2"});
+    std::vector<TacInst> tac = {inst(TACOp::ADD, "t0", "z1", "z2"), inst(TACOp::ASSIGN, "y", "t0"),
+                                inst(TACOp::ASSIGN, "z2", "z1"),     inst(TACOp::ASSIGN, "z1", "x"),
+                                inst(TACOp::ASSIGN, "tmp", "s1"),    inst(TACOp::ASSIGN, "s1", "s2"),
+                                inst(TACOp::ASSIGN, "s2", "tmp")};
+    Kernel kernel(tac, &sym);
+    Interpreter ref(tac, &sym);
+    kernel.restoreState({0.0, 0.0, 1.0, 2.0});
+    ref.restoreState({0.0, 0.0, 1.0, 2.0});
+    double x[] = {1.0, 10.0, 100.0}, got[3 * 6], expect[3 * 6];
+    kernel.runBatch(x, got, 3);
+    for (int s = 0; s < 3; ++s) ref.run(&x[s], &expect[6 * s]);
+    return std::memcmp(got, expect, sizeof got) == 0 && kernel.saveState() == ref.saveState() &&
+           ref.saveState() == std::vector<double>({100.0, 10.0, 2.0, 1.0});
+}
+
+#endif // TACTESTUTIL_H
@@ -0,0 +1,85 @@
+#include "tieredKernelTest.h"
+#include "tacTestUtil.h"
+#include "../errorHandler/errorHandler.h"
+#include <cstring>
+
+using namespace std;
+
+void TieredKernelTest::runAll() {
+    testPromotion();
+    testStateSurvivesSwap();
+    testKernelOutlivedByJob();
+    cout << "All TieredKernel tests completed.\n";
+}
+
+void TieredKernelTest::testPromotion() {
+    // y = (a - b) * 0.5 + a / b
+    vector<TacInst> tac = {
+        inst(TACOp::SUB, "t0", "a", "b"), inst(TACOp::LOAD_CONST, "t1", "0.5"), inst(TACOp::MUL, "t2", "t0", "t1"),
+        inst(TACOp::DIV, "t3", "a", "b"), inst(TACOp::ADD, "y", "t2", "t3"),
+    };
+    TierCompiler compiler;
+    TierOptions options;
+    options.threshold = 3;
+    TieredKernel kernel(tac, nullptr, compiler, options);
+    Interpreter ref(tac);
+    double in[8] = {1.5, 0.25, 2.0, 3.0, -1.0, 0.75, 0.1, 0.3}, out[4], expect[4];
+    for (int s = 0; s < 4; ++s) ref.run(&in[2 * s], &expect[s]);
+
+    bool same = true;
+    for (int b = 0; b < 3; ++b) {
+        kernel.runBatch(in, out, 4);
+        same = same && memcmp(out, expect, sizeof out) == 0;
+    }
+    assertTrue(kernel.tier() == TieredKernel::Tier::COMPILING, "threshold reached: compiling in the background");
+    compiler.drain();
+    kernel.runBatch(in, out, 4);
+    same = same && memcmp(out, expect, sizeof out) == 0;
+    assertTrue(kernel.tier() == (JitKernel::available() ? TieredKernel::Tier::NATIVE : TieredKernel::Tier::VM),
+               "native tier adopted at the next batch");
+    assertTrue(same && kernel.invocations() == 4, "every tier matches the interpreter");
+}
+
+void TieredKernelTest::testStateSurvivesSwap() {
+    ErrorHandler err;
+    SymbolTable sym(&err);
+    SymbolEntry acc("acc", "variable", "float");
+    acc.is_state = true;
+    sym.insert(acc);
+    // acc = acc + x
+    vector<TacInst> tac = {inst(TACOp::ADD, "t0", "acc", "x"), inst(TACOp::ASSIGN, "acc", "t0")};
+    TierCompiler compiler;
+    TierOptions options;
+    options.threshold = 1;
+    TieredKernel kernel(tac, &sym, compiler, options);
+    double x[] = {1.0, 2.0}, y[2];
+    kernel.runBatch(x, y, 2);
+    compiler.drain();
+    kernel.runBatch(x, y, 2);
+    assertTrue(y[0] == 4.0 && y[1] == 6.0, "running sum carried into the native tier");
+    kernel.reset();
+    kernel.runBatch(x, y, 2);
+    assertTrue(y[0] == 1.0 && y[1] == 3.0, "reset clears it there");
+}
+
+void TieredKernelTest::testKernelOutlivedByJob() {
+    vector<TacInst> tac = {inst(TACOp::MUL, "y", "a", "a")};
+    TierCompiler compiler;
+    TierOptions options;
+    options.threshold = 1;
+    size_t before = compiler.compiled();
+    {
+        TieredKernel kernel(tac, nullptr, compiler, options);
+        double a = 3.0, y = 0.0;
+        kernel.run(&a, &y);
+    }
+    compiler.drain();
+    assertTrue(compiler.compiled() == before + 1, "a job whose kernel is gone still completes safely");
+}
+
+void TieredKernelTest::assertTrue(bool condition, const std::string& testName) {
+    if (condition)
+        std::cout << "[PASS] " << testName << "\n";
+    else
+        std::cout << "[FAIL] " << testName << "\n";
+}
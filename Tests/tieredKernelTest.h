@@ -0,0 +1,21 @@
+#ifndef TIEREDKERNELTEST_H
+#define TIEREDKERNELTEST_H
+
+#include "../runtime/tieredKernel.h"
+#include <iostream>
+
+class TieredKernelTest {
+public:
+    // Run all test cases for TieredKernel and TierCompiler
+    void runAll();
+
+private:
+    void testPromotion();
+    void testStateSurvivesSwap();
+    void testKernelOutlivedByJob();
+
+    // Helper to show test results
+    void assertTrue(bool condition, const std::string& testName);
+};
+
+#endif // TIEREDKERNELTEST_H
@@ -0,0 +1,161 @@
+#include "valueProfileTest.h"
+#include "tacTestUtil.h"
+#include "../errorHandler/errorHandler.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+using namespace std;
+
+// y = x * k + k
+static vector<TacInst> scaled() {
+    return {inst(TACOp::MUL, "t0", "x", "k"), inst(TACOp::ADD, "t1", "t0", "k"), inst(TACOp::ASSIGN, "y", "t1")};
+}
+
+void ValueProfileTest::runAll() {
+    testStableInputs();
+    testOperandsMustAgree();
+    testSelectComparesBits();
+    testBindingMustBeInput();
+    testStateNotProfiled();
+    testSignedZeroVotes();
+    testDeoptimize();
+    cout << "All ValueProfile tests completed.\n";
+}
+
+void ValueProfileTest::testStableInputs() {
+    ValueProfiler prof(scaled());
+    assertTrue(prof.operands().size() == 3, "x and both reads of k are profiled");
+    for (int s = 0; s < 200; ++s) prof.observeSample({{"x", s * 0.5}, {"k", s == 7 ? 2.0 : 3.0}});
+    map<string, double> stable = prof.stableInputs(0.99, 100);
+    assertTrue(prof.samples() == 200 && stable.size() == 1 && stable["k"] == 3.0, "k = 3 stable, x not");
+    assertTrue(prof.stableInputs(0.999, 100).empty(), "one outlier in 200 misses a 99.9% bar");
+    assertTrue(prof.stableInputs(0.99, 500).empty(), "too few samples");
+    prof.reset();
+    assertTrue(prof.samples() == 0 && prof.stableInputs(0.0, 0).count("k") && prof.operands()[1].since == 0,
+               "reset clears the votes");
+}
+
+void ValueProfileTest::testOperandsMustAgree() {
+    ValueProfiler prof(scaled());
+    // the two reads of k see different values through observe()
+    for (int s = 0; s < 200; ++s) {
+        prof.observe(0, 2, 3.0);
+        prof.observe(1, 2, 4.0);
+        prof.nextSample();
+    }
+    assertTrue(prof.stableInputs(0.99, 100).empty(), "operands voting for different values are not stable");
+    prof.observe(0, 1, 1.0); // x is arg1 of instruction 0: profiled
+    prof.observe(1, 1, 1.0); // t0 is defined by the program: ignored
+    assertTrue(prof.operands()[0].since == 1, "reads of program-defined names are ignored");
+}
+
+void ValueProfileTest::testSelectComparesBits() {
+    ErrorHandler err;
+    SymbolTable sym(&err);
+    SpecializedKernel kernel(scaled(), sym, {{"k", 0.0}});
+    const vector<string> &names = kernel.inputNames();
+    const size_t xi = find(names.begin(), names.end(), "x") - names.begin();
+    const size_t ki = find(names.begin(), names.end(), "k") - names.begin();
+    double row[2];
+    row[xi] = -3.0;
+    row[ki] = 0.0;
+    assertTrue(&kernel.select(row) == &kernel.specializedKernel(), "k == +0.0 selects the specialized kernel");
+    row[ki] = -0.0;
+    assertTrue(&kernel.select(row) == &kernel.genericKernel(), "-0.0 falls back to the generic kernel");
+
+    // the fallback matters: 3 * -0 + -0 is -0, 3 * +0 + +0 is +0
+    map<string, double> in = {{"x", 3.0}, {"k", -0.0}};
+    double want = Interpreter(kernel.genericKernel()).run(in)["y"];
+    double spec = Interpreter(kernel.specializedKernel()).run(in)["y"];
+    assertTrue(!std::signbit(spec) && std::signbit(want), "the +0.0 kernel would have returned +0 instead of -0");
+    assertTrue(kernel.specializedRuns() == 1 && kernel.genericRuns() == 1 && kernel.guardFailures() == 1,
+               "runs and guard failures counted");
+}
+
+void ValueProfileTest::testBindingMustBeInput() {
+    ErrorHandler err;
+    SymbolTable sym(&err);
+    SpecializedKernel kernel(scaled(), sym, {{"k", 2.0}});
+    map<string, double> in = {{"x", 5.0}, {"k", 2.0}};
+    assertTrue(Interpreter(kernel.specializedKernel()).run(in)["y"] == 12.0, "specialized y = 5 * 2 + 2");
+    bool threw = false;
+    try {
+        kernel.respecialize({{"k", 2.0}, {"unused", 1.0}});
+    } catch (const invalid_argument &) {
+        threw = true;
+    }
+    assertTrue(threw, "a binding the program never reads is rejected");
+}
+
+void ValueProfileTest::testStateNotProfiled() {
+    // delay line z = y; y = x with y state
+    ErrorHandler err;
+    SymbolTable sym(&err);
+    declareState(sym, {"y"});
+    vector<TacInst> tac = {inst(TACOp::ASSIGN, "z", "y"), inst(TACOp::ASSIGN, "y", "x")};
+    ValueProfiler prof(tac, &sym);
+    Interpreter profiled(tac, &sym);
+    profiled.setProfiler(&prof);
+    for (int s = 0; s < 100; ++s) profiled.run({{"x", 5.0}});
+    map<string, double> stable = prof.stableInputs(0.99, 100);
+    assertTrue(prof.operands().size() == 1 && stable.size() == 1 && stable.count("x"), "state y is not profiled");
+
+    // x = 5, 7, 5: the third sample selects the specialized kernel and must still see y = 7
+    SpecializedKernel kernel(tac, sym, stable);
+    Interpreter generic(kernel.genericKernel(), &sym), special(kernel.specializedKernel(), &sym);
+    bool same = true;
+    for (double x : {5.0, 7.0, 5.0}) {
+        const bool specialized = &kernel.select(&x) == &kernel.specializedKernel();
+        special.restoreState(generic.saveState());
+        double want = generic.run({{"x", x}})["z"];
+        if (specialized) same = same && special.run({{"x", x}})["z"] == want;
+    }
+    assertTrue(same && kernel.specializedRuns() == 2, "specialized kernel keeps the state update");
+
+    bool threw = false;
+    try {
+        kernel.respecialize({{"y", 5.0}});
+    } catch (const invalid_argument &) {
+        threw = true;
+    }
+    assertTrue(threw, "specializing on state is rejected");
+}
+
+void ValueProfileTest::testSignedZeroVotes() {
+    ValueProfiler prof(scaled());
+    for (int s = 0; s < 200; ++s) prof.observeSample({{"x", (double)s}, {"k", s % 2 ? 0.0 : -0.0}});
+    assertTrue(prof.stableInputs(0.99, 100).empty(), "+0.0 and -0.0 are different votes");
+}
+
+void ValueProfileTest::testDeoptimize() {
+    ErrorHandler err;
+    SymbolTable sym(&err);
+    DeoptPolicy policy;
+    policy.window = 10;
+    policy.maxFailureRate = 0.2;
+    SpecializedKernel kernel(scaled(), sym, {{"k", 2.0}}, policy);
+    const size_t ki = kernel.inputNames()[0] == "k" ? 0 : 1;
+    double row[2] = {1.0, 1.0};
+    for (int s = 0; s < 10; ++s) {
+        row[ki] = s < 8 ? 2.0 : 9.0; // 2 failures of 10: at the limit
+        kernel.select(row);
+    }
+    assertTrue(!kernel.deoptimized(), "20% failures in a window is tolerated");
+    for (int s = 0; s < 10; ++s) {
+        row[ki] = s < 7 ? 2.0 : 9.0;
+        kernel.select(row);
+    }
+    row[ki] = 2.0;
+    assertTrue(kernel.deoptimized() && &kernel.select(row) == &kernel.genericKernel(), "30% deoptimizes");
+    kernel.respecialize({{"k", 9.0}});
+    row[ki] = 9.0;
+    assertTrue(!kernel.deoptimized() && &kernel.select(row) == &kernel.specializedKernel(), "respecialize resumes");
+}
+
+void ValueProfileTest::assertTrue(bool condition, const std::string& testName) {
+    if (condition)
+        std::cout << "[PASS] " << testName << "\n";
+    else
+        std::cout << "[FAIL] " << testName << "\n";
+}
@@ -0,0 +1,25 @@
+#ifndef VALUEPROFILETEST_H
+#define VALUEPROFILETEST_H
+
+#include "../tac/valueProfile.h"
+#include <iostream>
+
+class ValueProfileTest {
+public:
+    // Run all test cases for ValueProfiler and SpecializedKernel
+    void runAll();
+
+private:
+    void testStableInputs();
+    void testOperandsMustAgree();
+    void testSelectComparesBits();
+    void testBindingMustBeInput();
+    void testStateNotProfiled();
+    void testSignedZeroVotes();
+    void testDeoptimize();
+
+    // Helper to show test results
+    void assertTrue(bool condition, const std::string& testName);
+};
+
+#endif // VALUEPROFILETEST_H
@@ -0,0 +1,727 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <chrono>
+#include <cstdio>
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <algorithm>
+#include <map>
+#include <memory>
+
+#include "../lexer/lexer.h"
+#include "../symbolTable/symbolTable.h"
+#include "../errorHandler/errorHandler.h"
+#include "../tac/tacGen.h"
+#include "../tac/dce.h"
+#include "../tac/passManager.h"
+#include "../tac/costModel.h"
+#include "../tac/scheduler.h"
+#include "../runtime/interpreter.h"
+#include "../runtime/bytecode.h"
+#include "../runtime/vm.h"
+#include "../runtime/batchInterpreter.h"
+#include "../runtime/simdKernels.h"
+#include "../runtime/jit.h"
+#include "../runtime/aotKernel.h"
+#include "../runtime/tieredKernel.h"
+#include "../runtime/fixedPoint.h"
+#include "../runtime/floatEnv.h"
+
+using namespace std;
+
+/*
+ * SignalBench
+ *  - ns/sample of every execution backend on the example programs and on large
+ *    generated programs, next to the static cost model's estimate.
+ *  - Every backend is diff-tested against the reference Interpreter on the same
+ *    samples before it is timed.
+ *  - --kernels instead reports GB/s of every SIMD kernel (the binary ops, then the
+ *    statement shapes) at every ISA level the CPU supports, over arrays of --n=N
+ *    elements (diff-tested against the scalar level on misaligned arrays with odd
+ *    tails first).
+ *  - --tiers replays a skewed stream of batches over many small programs and compares
+ *    the VM alone, a JIT kernel for every program built up front, and tiered
+ *    execution (VM first, JIT in the background once a program is hot).
+ *  - --fixed runs generated programs (inputs declared in [0.5, 1.5]) as Q15 and Q31
+ *    integer columns next to the float64 batch interpreter, with the SIMD level the
+ *    kernels run at (and its nominal lane counts), each output's worst-case error
+ *    bound and the largest error observed.
+ *  - --denormals runs a decaying-signal workload (a cascade of smoothers whose input
+ *    sinks through the subnormal range) on every row backend with gradual underflow
+ *    and with FTZ/DAZ, plus the AOT backend built with the fastmath profile.
+ *  - --pairs mines the corpus (the programs above, or the files given) for adjacent
+ *    bytecode pairs where the second instruction reads what the first wrote: the
+ *    candidates for VM superinstructions.
+ *  - --cost checks the static cost model against measurements: x86-64 cycle
+ *    estimates next to JIT ns/sample over the programs above plus more generated
+ *    sizes, with each program's error under a fitted ns/cycle (or --ghz) and the
+ *    Spearman rank correlation of estimate and measurement.
+ *  - --sched compiles every program at -O1 and runs it on the VM and the JIT in parse
+ *    order and after InstructionScheduler, next to the scheduler's cycle estimates.
+ *
+ *  usage: SignalBench [--ms=N] [--samples=N] [--ghz=F] [file.signal ...]
+ *         SignalBench --kernels [--n=N] [--ms=N]
+ *         SignalBench --tiers [--programs=N] [--batches=N]
+ *         SignalBench --fixed [--samples=N] [--ms=N]
+ *         SignalBench --denormals [--samples=N] [--ms=N]
+ *         SignalBench --pairs [--top=N] [file.signal ...]
+ *         SignalBench --sched [--samples=N] [--ms=N] [file.signal ...]
+ *         SignalBench --cost [--samples=N] [--ms=N] [--ghz=F] [file.signal ...]
+ */
+
+struct Program {
+    string name;
+    string source;
+};
+
+// Compiled program with the symbol table its TAC refers to.
+struct Compiled {
+    ErrorHandler err;
+    SymbolTable sym{&err};
+    vector<TacInst> tac;
+};
+
+static void compile(const string &source, Compiled &c, MathProfile math = MathProfile::STRICT,
+                    OptLevel level = OptLevel::O2) {
+    Lexer lexer(&c.sym, &c.err);
+    lexer.setSource(source);
+    c.sym.insert(SymbolEntry("in", "builtin", "float()->float", c.sym.currentScope(), -1));
+    c.sym.insert(SymbolEntry("out", "builtin", "void(float)", c.sym.currentScope(), -1));
+    TACGenerator gen(&lexer, &c.sym, &c.err);
+    gen.generate(c.tac);
+    DeadCodeEliminator::eliminate(c.tac, c.sym);
+    PassManager pm(level);
+    pm.setMathProfile(math);
+    pm.run(c.tac, c.sym);
+}
+
+static string readFile(const string &filename) {
+    ifstream in(filename);
+    stringstream buf;
+    buf << in.rdbuf();
+    return buf.str();
+}
+
+// Straight-line program of n statements over 8 inputs in [0.5, 1.5). Statements
+// read recent values and keep magnitudes near 1, so timings are not skewed by
+// overflow or subnormals.
+static string generate(int n, unsigned seed) {
+    auto rnd = [&seed]() { seed = seed * 1103515245u + 12345u; return (seed >> 16) & 0x7fff; };
+    ostringstream src;
+    auto input = [&]() { return "in" + to_string(rnd() % 8); };
+    auto value = [&](int i) {
+        if (i == 0 || rnd() % 4 == 0) return input();
+        return "v" + to_string(i - 1 - (int)(rnd() % min(i, 16)));
+    };
+    for (int i = 0; i < n; ++i) {
+        src << "v" << i << " = ";
+        switch (rnd() % 5) {
+            case 0: src << value(i) << " * 0.5 + " << value(i) << " * 0.25"; break;
+            case 1: src << value(i) << " - " << value(i) << " * 0.5"; break;
+            case 2: src << value(i) << " * " << input(); break;
+            case 3: src << value(i) << " / " << input(); break;
+            default: src << "(" << value(i) << " + " << value(i) << ") * 0.5"; break;
+        }
+        src << ";\n";
+    }
+    return src.str();
+}
+
+// Average ns per sample of all(), which runs the whole sample set, repeated for about ms.
+static double timeAll(const function<void()> &all, size_t samples, double ms) {
+    using clock = chrono::steady_clock;
+    all(); // warm up
+    size_t done = 0;
+    auto t0 = clock::now();
+    double elapsed = 0;
+    do {
+        all();
+        done += samples;
+        elapsed = chrono::duration<double, milli>(clock::now() - t0).count();
+    } while (elapsed < ms);
+    return elapsed * 1e6 / done;
+}
+
+// Average ns per sample of fn(sample), one call per sample.
+static double timeIt(const function<void(size_t)> &fn, size_t samples, double ms) {
+    return timeAll([&]() { for (size_t s = 0; s < samples; ++s) fn(s); }, samples, ms);
+}
+
+// One kernel's GB/s at every level, plus whether each level matched the scalar one.
+// call(table, d, x, y, m) runs the kernel on m elements; streams counts the arrays
+// it reads and writes.
+template <class S, class Call>
+static void benchLevels(const string &name, int streams, size_t n, double ms, Call call) {
+    vector<S> a(n + 8), b(n + 8), d(n + 8), expect(n + 8);
+    unsigned seed = 11;
+    for (size_t i = 0; i < a.size(); ++i) {
+        seed = seed * 1103515245u + 12345u;
+        a[i] = (S)(0.5 + ((seed >> 16) & 0x7fff) / 32768.0);
+        b[i] = (S)(1.5 - ((seed >> 8) & 0x7fff) / 32768.0);
+    }
+    // misaligned pointers and an odd length exercise peeling and tails
+    const size_t odd = n > 8 ? n - 3 : n;
+    call(SimdKernels::table(SimdLevel::SCALAR), expect.data() + 1, a.data() + 3, b.data() + 1, odd);
+    const double bytes = (double)streams * sizeof(S) * n;
+
+    printf("%-14s", name.c_str());
+    bool ok = true;
+    for (int l = 0; l < (int)SimdLevel::COUNT; ++l) {
+        if (!SimdKernels::supported((SimdLevel)l)) { printf(" %9s", "-"); continue; }
+        const SimdKernelTable &t = SimdKernels::table((SimdLevel)l);
+        fill(d.begin(), d.end(), (S)0);
+        call(t, d.data() + 1, a.data() + 3, b.data() + 1, odd);
+        ok = ok && memcmp(d.data() + 1, expect.data() + 1, odd * sizeof(S)) == 0;
+        double ns = timeAll([&]() { call(t, d.data(), a.data(), b.data(), n); }, 1, ms);
+        printf(" %9.1f", bytes / ns);
+    }
+    printf("%s\n", ok ? "" : "  MISMATCH");
+}
+
+template <class S, class Pick>
+static void benchKernel(const string &name, int op, int form, size_t n, double ms, Pick pick) {
+    benchLevels<S>(name, form == 0 ? 3 : 2, n, ms, [&](const SimdKernelTable &t, S *dst, const S *x, const S *y, size_t m) {
+        if (form == 0) pick(t).vv[op](dst, x, y, m);
+        else if (form == 1) pick(t).vs[op](dst, x, y[0], m);
+        else pick(t).sv[op](dst, x[0], y, m);
+    });
+}
+
+// The statement shapes, with constants that keep values near 1.
+template <class S, class Pick>
+static void benchShapes(const string &prefix, size_t n, double ms, Pick pick) {
+    benchLevels<S>(prefix + " axpb", 2, n, ms, [&](const SimdKernelTable &t, S *d, const S *x, const S *, size_t m) {
+        pick(t).axpb(d, x, (S)0.75, (S)0.25, m);
+    });
+    benchLevels<S>(prefix + " xmog", 2, n, ms, [&](const SimdKernelTable &t, S *d, const S *x, const S *, size_t m) {
+        pick(t).xmog(d, x, (S)0.5, (S)1.5, m);
+    });
+    benchLevels<S>(prefix + " axby", 3, n, ms, [&](const SimdKernelTable &t, S *d, const S *x, const S *y, size_t m) {
+        pick(t).axby(d, x, (S)0.5, y, (S)0.25, m);
+    });
+    benchLevels<S>(prefix + " sqr", 2, n, ms, [&](const SimdKernelTable &t, S *d, const S *x, const S *, size_t m) {
+        pick(t).sqr(d, x, m);
+    });
+}
+
+static int benchKernels(size_t n, double ms) {
+    struct F64 { void (*const *vv)(double *, const double *, const double *, size_t);
+                 void (*const *vs)(double *, const double *, double, size_t);
+                 void (*const *sv)(double *, double, const double *, size_t); };
+    struct F32 { void (*const *vv)(float *, const float *, const float *, size_t);
+                 void (*const *vs)(float *, const float *, float, size_t);
+                 void (*const *sv)(float *, float, const float *, size_t); };
+    printf("GB/s over %zu elements (best level here: %s)\n%-14s", n,
+           SimdKernels::levelName(SimdKernels::detect()).c_str(), "kernel");
+    for (int l = 0; l < (int)SimdLevel::COUNT; ++l) printf(" %9s", SimdKernels::levelName((SimdLevel)l).c_str());
+    printf("\n");
+    const char *ops[] = {"add", "sub", "mul", "div"}, *forms[] = {"vv", "vs", "sv"};
+    for (int form = 0; form < 3; ++form) {
+        for (int op = 0; op < 4; ++op) {
+            string name = string(ops[op]) + " " + forms[form];
+            benchKernel<double>("f64 " + name, op, form, n, ms,
+                                [](const SimdKernelTable &t) { return F64{t.f64vv, t.f64vs, t.f64sv}; });
+            benchKernel<float>("f32 " + name, op, form, n, ms,
+                               [](const SimdKernelTable &t) { return F32{t.f32vv, t.f32vs, t.f32sv}; });
+        }
+    }
+    struct Shapes64 { decltype(SimdKernelTable::f64axpb) axpb; decltype(SimdKernelTable::f64xmog) xmog;
+                      decltype(SimdKernelTable::f64axby) axby; decltype(SimdKernelTable::f64sqr) sqr; };
+    struct Shapes32 { decltype(SimdKernelTable::f32axpb) axpb; decltype(SimdKernelTable::f32xmog) xmog;
+                      decltype(SimdKernelTable::f32axby) axby; decltype(SimdKernelTable::f32sqr) sqr; };
+    benchShapes<double>("f64", n, ms, [](const SimdKernelTable &t) {
+        return Shapes64{t.f64axpb, t.f64xmog, t.f64axby, t.f64sqr};
+    });
+    benchShapes<float>("f32", n, ms, [](const SimdKernelTable &t) {
+        return Shapes32{t.f32axpb, t.f32xmog, t.f32axby, t.f32sqr};
+    });
+    return 0;
+}
+
+// Setup and stream time of three ways to run many programs, most batches going to
+// a few hot ones.
+static int benchTiers(size_t programs, size_t batches) {
+    using clock = chrono::steady_clock;
+    auto msSince = [](clock::time_point t0) { return chrono::duration<double, milli>(clock::now() - t0).count(); };
+    vector<unique_ptr<Compiled>> progs;
+    size_t maxOut = 0;
+    for (size_t p = 0; p < programs; ++p) {
+        progs.emplace_back(new Compiled);
+        compile(generate(20 + (int)(p % 40), 1000u + (unsigned)p), *progs.back());
+        maxOut = max(maxOut, Interpreter(progs.back()->tac, &progs.back()->sym).outputNames().size());
+    }
+    const size_t rows = 64;
+    vector<double> in(rows * 8), out(rows * maxOut);
+    unsigned seed = 3;
+    for (auto &v : in) { seed = seed * 1103515245u + 12345u; v = 0.5 + ((seed >> 16) & 0x7fff) / 32768.0; }
+    vector<size_t> order(batches); // program of each batch: cubed uniform, so low indices are hot
+    for (auto &o : order) {
+        seed = seed * 1103515245u + 12345u;
+        double u = ((seed >> 16) & 0x7fff) / 32768.0;
+        o = min(programs - 1, (size_t)(programs * u * u * u));
+    }
+
+    printf("%zu programs, %zu batches of %zu samples\n%-10s %10s %10s %10s %8s\n", programs, batches, rows, "strategy",
+           "setup ms", "stream ms", "total ms", "native");
+    auto report = [&](const char *name, double setup, double stream, size_t native) {
+        printf("%-10s %10.1f %10.1f %10.1f %8zu\n", name, setup, stream, setup + stream, native);
+    };
+    {
+        auto t0 = clock::now();
+        vector<unique_ptr<VM>> vms;
+        for (auto &c : progs) vms.emplace_back(new VM(Bytecode::compile(c->tac, &c->sym)));
+        double setup = msSince(t0);
+        t0 = clock::now();
+        for (size_t b : order) vms[b]->runBatch(in.data(), out.data(), rows);
+        report("vm", setup, msSince(t0), 0);
+    }
+    {
+        auto t0 = clock::now();
+        vector<unique_ptr<JitKernel>> jits;
+        for (auto &c : progs) jits.emplace_back(new JitKernel(c->tac, &c->sym));
+        double setup = msSince(t0);
+        t0 = clock::now();
+        for (size_t b : order) jits[b]->runBatch(in.data(), out.data(), rows);
+        report("jit", setup, msSince(t0), programs);
+    }
+    {
+        TierCompiler compiler;
+        auto t0 = clock::now();
+        vector<unique_ptr<TieredKernel>> tiered;
+        for (auto &c : progs) tiered.emplace_back(new TieredKernel(c->tac, &c->sym, compiler));
+        double setup = msSince(t0);
+        t0 = clock::now();
+        for (size_t b : order) tiered[b]->runBatch(in.data(), out.data(), rows);
+        double stream = msSince(t0);
+        size_t native = 0;
+        for (auto &t : tiered) native += t->tier() == TieredKernel::Tier::NATIVE;
+        report("tiered", setup, stream, native);
+    }
+    return 0;
+}
+
+// ns/sample of fixed-point integer columns against float64 columns, plus error bounds.
+static int benchFixed(size_t samples, double ms) {
+    // The level of the table the kernels actually use. Lane counts are what the ISA
+    // offers, not measured: the Q15 loops are vectorized by the compiler, and
+    // AVX-512F without BW has no 16-bit lanes, so int16 work stays at 256 bits.
+    const SimdLevel level = SimdKernels::best().level;
+    static const int int16Lanes[] = {1, 8, 16, 16}, f64Lanes[] = {1, 2, 4, 8};
+    printf("kernels: %s (nominal: %d int16 lanes, %d float64 lanes per vector)\n",
+           SimdKernels::levelName(level).c_str(), int16Lanes[(int)level], f64Lanes[(int)level]);
+    printf("%-16s %6s %10s %10s %10s %12s %12s %12s %12s\n", "program", "insts", "f64 ns", "q15 ns", "q31 ns",
+           "q15 bound", "q15 seen", "q31 bound", "q31 seen");
+    for (int n : {10, 100, 1000}) {
+        Compiled c;
+        compile(generate(n, 42u + n), c);
+        BatchInterpreter batch(c.tac, &c.sym);
+        Interpreter ref(c.tac, &c.sym);
+        map<string, Interval> ranges;
+        for (const auto &name : ref.inputNames()) ranges[name] = Interval(0.5, 1.5);
+        FixedPointOptions wide;
+        wide.bits = 32;
+        FixedPointKernel q15(c.tac, &c.sym, ranges), q31(c.tac, &c.sym, ranges, wide);
+        const string name = "generated-" + to_string(n);
+        if (!q15.compiled()) {
+            printf("%-16s %6zu  (fixed point: %s)\n", name.c_str(), c.tac.size(), q15.fallbackReason().c_str());
+            continue;
+        }
+        const size_t ni = ref.inputNames().size(), no = ref.outputNames().size();
+        vector<double> in(samples * ni), expect(samples * no);
+        unsigned seed = 7;
+        for (auto &v : in) { seed = seed * 1103515245u + 12345u; v = 0.5 + ((seed >> 16) & 0x7fff) / 32768.0; }
+        for (size_t s = 0; s < samples; ++s) ref.run(&in[s * ni], &expect[s * no]);
+
+        // the same samples as float64, int16 and int32 columns
+        vector<double> inCols(samples * ni), outCols(samples * no);
+        vector<int16_t> in15(samples * ni), out15(samples * no);
+        vector<int32_t> in31(samples * ni), out31(samples * no);
+        vector<const double *> ip(ni);
+        vector<double *> op(no);
+        vector<const int16_t *> ip15(ni);
+        vector<int16_t *> op15(no);
+        vector<const int32_t *> ip31(ni);
+        vector<int32_t *> op31(no);
+        for (size_t k = 0; k < ni; ++k) {
+            ip[k] = &inCols[k * samples];
+            ip15[k] = &in15[k * samples];
+            ip31[k] = &in31[k * samples];
+            for (size_t s = 0; s < samples; ++s) {
+                inCols[k * samples + s] = in[s * ni + k];
+                in15[k * samples + s] = (int16_t)q15.quantize(k, in[s * ni + k]);
+                in31[k * samples + s] = (int32_t)q31.quantize(k, in[s * ni + k]);
+            }
+        }
+        for (size_t k = 0; k < no; ++k) {
+            op[k] = &outCols[k * samples];
+            op15[k] = &out15[k * samples];
+            op31[k] = &out31[k * samples];
+        }
+
+        double tBatch = timeAll([&]() { batch.run(ip.data(), op.data(), samples); }, samples, ms);
+        double t15 = timeAll([&]() { q15.runInteger(ip15.data(), op15.data(), samples); }, samples, ms);
+        double t31 = timeAll([&]() { q31.runInteger(ip31.data(), op31.data(), samples); }, samples, ms);
+        double seen15 = 0, seen31 = 0;
+        for (size_t s = 0; s < samples; ++s)
+            for (size_t k = 0; k < no; ++k) {
+                seen15 = max(seen15, fabs(q15.dequantize(k, out15[k * samples + s]) - expect[s * no + k]));
+                seen31 = max(seen31, fabs(q31.dequantize(k, out31[k * samples + s]) - expect[s * no + k]));
+            }
+        const double bound15 = *max_element(q15.outputError().begin(), q15.outputError().end());
+        const double bound31 = *max_element(q31.outputError().begin(), q31.outputError().end());
+        printf("%-16s %6zu %10.1f %10.1f %10.1f %12.3g %12.3g %12.3g %12.3g%s\n", name.c_str(), c.tac.size(), tBatch,
+               t15, t31, bound15, seen15, bound31, seen31,
+               seen15 > bound15 || seen31 > bound31 ? "  BOUND EXCEEDED" : "");
+    }
+    return 0;
+}
+
+// Four one-pole smoothers in a row over x, each pole a state variable.
+static const char *const DECAYING = "s1 = s1 * 0.75 + x * 0.25;\n"
+                                    "s2 = s2 * 0.75 + s1 * 0.25;\n"
+                                    "s3 = s3 * 0.75 + s2 * 0.25;\n"
+                                    "s4 = s4 * 0.75 + s3 * 0.25;\n"
+                                    "y = s4 * 2.0 + s3 + s2 + s1;\n";
+
+// ns/sample of the decaying workload per backend, gradual underflow against FTZ/DAZ.
+static int benchDenormals(size_t samples, double ms) {
+    auto program = [](Compiled &c, MathProfile math) {
+        for (const char *name : {"s1", "s2", "s3", "s4"}) {
+            SymbolEntry e(name, "variable", "float");
+            e.is_state = true;
+            c.sym.insert(e);
+        }
+        compile(DECAYING, c, math);
+    };
+    Compiled c, fastC;
+    program(c, MathProfile::STRICT);
+    program(fastC, MathProfile::FASTMATH);
+
+    // x falls from 1e-300 by 2^-80 over the run: normal for the first ~30%, then
+    // subnormal, and zero for the last few samples
+    vector<double> in(samples);
+    for (size_t s = 0; s < samples; ++s) in[s] = 1e-300 * exp2(-80.0 * s / samples);
+    Interpreter ref(c.tac, &c.sym);
+    const size_t no = ref.outputNames().size(); // the four poles and y
+    vector<double> expect(samples * no), got(samples * no);
+    for (size_t s = 0; s < samples; ++s) ref.run(&in[s], &expect[s * no]);
+    size_t subnormal = count_if(expect.begin(), expect.end(), [](double v) { return fpclassify(v) == FP_SUBNORMAL; });
+    printf("%zu samples, %.0f%% of output values subnormal; FTZ/DAZ %s\n", samples, 100.0 * subnormal / expect.size(),
+           DenormalScope::supported() ? "available" : "not supported here (both columns preserve)");
+    printf("%-14s %12s %12s %9s %14s\n", "backend", "preserve ns", "flush ns", "speedup", "max |diff|");
+
+    Bytecode bc = Bytecode::compile(c.tac, &c.sym);
+    VM vm(bc);
+    JitKernel jit(c.tac, &c.sym);
+    AotKernel aot(c.tac, &c.sym), fastAot(fastC.tac, &fastC.sym, AotOptions::defaults(MathProfile::FASTMATH));
+    struct Backend {
+        const char *name;
+        bool ok;
+        function<void()> reset;
+        function<void(double *)> all; // every sample from the first, in order
+    };
+    vector<Backend> backends = {
+        {"interpreter", true, [&]() { ref.reset(); },
+         [&](double *out) { for (size_t s = 0; s < samples; ++s) ref.run(&in[s], &out[s * no]); }},
+        {"vm", true, [&]() { vm.reset(); }, [&](double *out) { vm.runBatch(in.data(), out, samples); }},
+        {"jit", jit.compiled(), [&]() { jit.reset(); }, [&](double *out) { jit.runBatch(in.data(), out, samples); }},
+        {"aot", aot.compiled(), [&]() { aot.reset(); }, [&](double *out) { aot.runBatch(in.data(), out, samples); }},
+        {"aot fastmath", fastAot.compiled(), [&]() { fastAot.reset(); },
+         [&](double *out) { fastAot.runBatch(in.data(), out, samples); }},
+    };
+    for (auto &b : backends) {
+        if (!b.ok) {
+            printf("%-14s %12s\n", b.name, "(unavailable)");
+            continue;
+        }
+        double t[2], diff = 0;
+        for (DenormalMode mode : {DenormalMode::PRESERVE, DenormalMode::FLUSH}) {
+            DenormalScope scope(mode);
+            t[(int)mode] = timeAll([&]() { b.reset(); b.all(got.data()); }, samples, ms);
+        }
+        // FTZ/DAZ only moves values near 2^-1022, so the difference stays that small
+        for (size_t k = 0; k < got.size(); ++k) diff = max(diff, fabs(got[k] - expect[k]));
+        printf("%-14s %12.1f %12.1f %8.1fx %14.3g\n", b.name, t[0], t[1], t[0] / t[1], diff);
+    }
+    return 0;
+}
+
+// Dependent opcode pairs over every program, most frequent first.
+static int minePairs(const vector<Program> &progs, size_t top) {
+    map<pair<BcOp, BcOp>, size_t> counts;
+    size_t insts = 0;
+    for (const auto &p : progs) {
+        Compiled c;
+        compile(p.source, c);
+        BcOptions plain;
+        plain.superinstructions = false;
+        Bytecode bc = Bytecode::compile(c.tac, &c.sym, plain);
+        bc.countPairs(counts);
+        for (size_t pc = 0; pc < bc.code.size(); pc += 1 + Bytecode::operandBytes((BcOp)bc.code[pc])) ++insts;
+    }
+    vector<pair<size_t, pair<BcOp, BcOp>>> ranked;
+    for (const auto &c : counts) ranked.push_back({c.second, c.first});
+    sort(ranked.begin(), ranked.end(), [](const auto &a, const auto &b) { return a.first > b.first; });
+    printf("%zu programs, %zu instructions\n%-30s %8s %7s\n", progs.size(), insts, "pair", "count", "share");
+    for (size_t i = 0; i < ranked.size() && i < top; ++i) {
+        string name = Bytecode::opName(ranked[i].second.first) + " -> " + Bytecode::opName(ranked[i].second.second);
+        printf("%-30s %8zu %6.1f%%\n", name.c_str(), ranked[i].first, 100.0 * ranked[i].first / insts);
+    }
+    return 0;
+}
+
+// Ranks of v (1 = smallest), ties sharing their average rank.
+static vector<double> ranks(const vector<double> &v) {
+    vector<size_t> order(v.size());
+    for (size_t i = 0; i < order.size(); ++i) order[i] = i;
+    sort(order.begin(), order.end(), [&](size_t a, size_t b) { return v[a] < v[b]; });
+    vector<double> r(v.size());
+    for (size_t i = 0; i < order.size();) {
+        size_t j = i;
+        while (j + 1 < order.size() && v[order[j + 1]] == v[order[i]]) ++j;
+        for (size_t k = i; k <= j; ++k) r[order[k]] = (i + j) / 2.0 + 1;
+        i = j + 1;
+    }
+    return r;
+}
+
+// Pearson correlation of the ranks of a and b.
+static double spearman(const vector<double> &a, const vector<double> &b) {
+    vector<double> ra = ranks(a), rb = ranks(b);
+    const double n = (double)a.size(), mean = (n + 1) / 2;
+    double sab = 0, saa = 0, sbb = 0;
+    for (size_t i = 0; i < a.size(); ++i) {
+        sab += (ra[i] - mean) * (rb[i] - mean);
+        saa += (ra[i] - mean) * (ra[i] - mean);
+        sbb += (rb[i] - mean) * (rb[i] - mean);
+    }
+    return saa > 0 && sbb > 0 ? sab / sqrt(saa * sbb) : 0.0;
+}
+
+// How well the x86-64 cost model tracks measured JIT time per sample.
+static int benchCost(const vector<Program> &progs, size_t sampleCount, double ms, double ghz) {
+    TargetModel target;
+    TargetModel::byName("x86-64", target);
+    vector<string> names;
+    vector<double> est, measured;
+    for (const auto &p : progs) {
+        Compiled c;
+        compile(p.source, c);
+        JitKernel jit(c.tac, &c.sym);
+        if (!jit.compiled()) {
+            printf("%-28s (jit: %s)\n", p.name.c_str(), jit.fallbackReason().c_str());
+            continue;
+        }
+        const size_t ni = jit.inputNames().size(), no = jit.outputNames().size();
+        const size_t samples = max<size_t>(16, min(sampleCount, (size_t)4000000 / (c.tac.size() + 1)));
+        vector<double> in(samples * ni), out(samples * no);
+        unsigned seed = 7;
+        for (auto &v : in) { seed = seed * 1103515245u + 12345u; v = 0.5 + ((seed >> 16) & 0x7fff) / 32768.0; }
+        names.push_back(p.name);
+        est.push_back(CostModel::estimate(c.tac, target).cyclesPerSample);
+        measured.push_back(timeAll([&]() { jit.runBatch(in.data(), out.data(), samples); }, samples, ms));
+    }
+    if (names.empty()) return 1;
+
+    // without a clock rate, the geometric mean of measured ns per estimated cycle, so
+    // small and large programs weigh the same in relative terms
+    double nsPerCycle = ghz > 0 ? 1.0 / ghz : 0;
+    if (nsPerCycle == 0) {
+        double logSum = 0;
+        for (size_t i = 0; i < est.size(); ++i) logSum += log(measured[i] / max(est[i], 1.0));
+        nsPerCycle = exp(logSum / est.size());
+    }
+    printf("%-28s %10s %12s %12s %9s\n", "program", "est.cyc", "predicted ns", "jit ns", "error");
+    double absErr = 0, worst = 0;
+    for (size_t i = 0; i < names.size(); ++i) {
+        const double predicted = est[i] * nsPerCycle, err = (predicted - measured[i]) / measured[i];
+        absErr += fabs(err);
+        worst = max(worst, fabs(err));
+        printf("%-28s %10.0f %12.1f %12.1f %+8.0f%%\n", names[i].c_str(), est[i], predicted, measured[i], 100 * err);
+    }
+    printf("%s %.3f ns/cycle; mean |error| %.0f%%, worst %.0f%%; Spearman rank correlation %.3f over %zu programs\n",
+           ghz > 0 ? "given" : "fitted", nsPerCycle, 100 * absErr / names.size(), 100 * worst,
+           spearman(est, measured), names.size());
+    return 0;
+}
+
+// ns/sample of the -O1 program in parse order and scheduled, on the VM and the JIT.
+static int benchSched(const vector<Program> &progs, size_t sampleCount, double ms) {
+    printf("%-28s %6s %14s %10s %12s %12s %12s %12s\n", "program", "insts", "est.cyc", "temps", "vm ns",
+           "vm sched ns", "jit ns", "jit sched ns");
+    for (const auto &p : progs) {
+        Compiled c;
+        compile(p.source, c, MathProfile::STRICT, OptLevel::O1);
+        vector<TacInst> sched = c.tac;
+        ScheduleStats st = InstructionScheduler::schedule(sched);
+        Interpreter ref(c.tac, &c.sym), refSched(sched, &c.sym);
+        VM vm(Bytecode::compile(c.tac, &c.sym)), vmSched(Bytecode::compile(sched, &c.sym));
+        JitKernel jit(c.tac, &c.sym), jitSched(sched, &c.sym);
+
+        const size_t ni = ref.inputNames().size(), no = ref.outputNames().size();
+        const size_t samples = max<size_t>(16, min(sampleCount, (size_t)4000000 / (c.tac.size() + 1)));
+        vector<double> in(samples * ni), inSched(samples * ni), expect(samples * no), got(samples * no), out(no);
+        unsigned seed = 7;
+        for (auto &v : in) { seed = seed * 1103515245u + 12345u; v = 0.5 + ((seed >> 16) & 0x7fff) / 32768.0; }
+        // scheduling changes the first-read order of inputs (and may the order of outputs),
+        // so the scheduled program is fed and checked by name
+        vector<size_t> inPos(ni), outPos(no);
+        for (size_t k = 0; k < ni; ++k)
+            inPos[k] = find(ref.inputNames().begin(), ref.inputNames().end(), refSched.inputNames()[k]) -
+                       ref.inputNames().begin();
+        for (size_t k = 0; k < no; ++k)
+            outPos[k] = find(ref.outputNames().begin(), ref.outputNames().end(), refSched.outputNames()[k]) -
+                        ref.outputNames().begin();
+        for (size_t s = 0; s < samples; ++s) {
+            for (size_t k = 0; k < ni; ++k) inSched[s * ni + k] = in[s * ni + inPos[k]];
+            ref.run(&in[s * ni], &expect[s * no]);
+        }
+        int mismatches = 0;
+        auto check = [&](const double *row, size_t s) {
+            for (size_t k = 0; k < no; ++k)
+                if (memcmp(&row[k], &expect[s * no + outPos[k]], sizeof(double)) != 0) return 1;
+            return 0;
+        };
+        for (size_t s = 0; s < samples; ++s) {
+            vmSched.run(&inSched[s * ni], out.data());
+            mismatches += check(out.data(), s);
+        }
+        jitSched.runBatch(inSched.data(), got.data(), samples);
+        for (size_t s = 0; s < samples; ++s) mismatches += check(&got[s * no], s);
+
+        double tVm = timeIt([&](size_t s) { vm.run(&in[s * ni], out.data()); }, samples, ms);
+        double tVmSched = timeIt([&](size_t s) { vmSched.run(&inSched[s * ni], out.data()); }, samples, ms);
+        double tJit = timeAll([&]() { jit.runBatch(in.data(), got.data(), samples); }, samples, ms);
+        double tJitSched = timeAll([&]() { jitSched.runBatch(inSched.data(), got.data(), samples); }, samples, ms);
+        string cyc = to_string(st.cyclesBefore) + " -> " + to_string(st.cyclesAfter);
+        string temps = to_string(st.tempsBefore) + " -> " + to_string(st.tempsAfter);
+        printf("%-28s %6zu %14s %10s %12.1f %12.1f %12.1f %12.1f", p.name.c_str(), c.tac.size(), cyc.c_str(),
+               temps.c_str(), tVm, tVmSched, tJit, tJitSched);
+        if (!jit.compiled()) printf("  (jit: %s)", jit.fallbackReason().c_str());
+        if (mismatches) printf("  MISMATCH x%d", mismatches);
+        printf("\n");
+    }
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    double ms = 200, ghz = 0;
+    size_t sampleCount = 1024, kernelN = 1024;
+    size_t top = 16;
+    size_t programs = 1000, batches = 50000;
+    bool kernels = false, pairs = false, tiers = false, fixed = false, denormals = false, sched = false, cost = false;
+    vector<Program> progs;
+    for (int a = 1; a < argc; ++a) {
+        string arg = argv[a];
+        if (arg.rfind("--ms=", 0) == 0) ms = stod(arg.substr(5));
+        else if (arg == "--kernels") kernels = true;
+        else if (arg == "--pairs") pairs = true;
+        else if (arg == "--tiers") tiers = true;
+        else if (arg == "--fixed") fixed = true;
+        else if (arg == "--denormals") denormals = true;
+        else if (arg == "--sched") sched = true;
+        else if (arg == "--cost") cost = true;
+        else if (arg.rfind("--programs=", 0) == 0) programs = max<size_t>(stoul(arg.substr(11)), 1);
+        else if (arg.rfind("--batches=", 0) == 0) batches = stoul(arg.substr(10));
+        else if (arg.rfind("--top=", 0) == 0) top = stoul(arg.substr(6));
+        else if (arg.rfind("--n=", 0) == 0) kernelN = stoul(arg.substr(4));
+        else if (arg.rfind("--samples=", 0) == 0) sampleCount = stoul(arg.substr(10));
+        else if (arg.rfind("--ghz=", 0) == 0) ghz = stod(arg.substr(6));
+        else progs.push_back({arg, readFile(arg)});
+    }
+    if (kernels) return benchKernels(max<size_t>(kernelN, 1), ms / 10);
+    if (tiers) return benchTiers(programs, batches);
+    if (fixed) return benchFixed(max<size_t>(sampleCount, 1), ms);
+    if (denormals) return benchDenormals(max<size_t>(sampleCount, 1), ms);
+    if (progs.empty()) {
+        for (const char *f : {"examples/example.signal", "examples/normalize.signal", "examples/poly.signal"}) {
+            string src = readFile(f);
+            if (!src.empty()) progs.push_back({f, src});
+        }
+    }
+    for (int n : {100, 1000, 10000}) progs.push_back({"generated-" + to_string(n), generate(n, 42u + n)});
+    if (cost)
+        for (int n : {10, 30, 300, 3000}) progs.push_back({"generated-" + to_string(n), generate(n, 42u + n)});
+    if (pairs) return minePairs(progs, top);
+    if (cost) return benchCost(progs, max<size_t>(sampleCount, 1), ms, ghz);
+    if (sched) return benchSched(progs, max<size_t>(sampleCount, 1), ms);
+
+    TargetModel target;
+    TargetModel::byName("x86-64", target);
+    printf("%-28s %6s %10s %12s %12s %12s %12s %12s %12s", "program", "insts", "est.cyc", "interp ns", "vm-switch ns",
+           "vm-threaded ns", "batch ns", "jit ns", "aot ns");
+    if (ghz > 0) printf(" %10s", "est ns");
+    printf("\n");
+
+    for (const auto &p : progs) {
+        Compiled c;
+        compile(p.source, c);
+        Interpreter ref(c.tac, &c.sym);
+        Bytecode bc = Bytecode::compile(c.tac, &c.sym);
+        VM vm(bc), vmSwitch(bc);
+        BatchInterpreter batch(c.tac, &c.sym);
+        JitKernel jit(c.tac, &c.sym);
+        AotKernel aot(c.tac, &c.sym);
+
+        const size_t ni = ref.inputNames().size(), no = ref.outputNames().size();
+        // fewer distinct samples for big programs so a timing round stays short
+        const size_t samples = max<size_t>(16, min(sampleCount, (size_t)4000000 / (c.tac.size() + 1)));
+        vector<double> in(samples * ni), out(no), expect(samples * no), got(no);
+        unsigned seed = 7;
+        for (auto &v : in) { seed = seed * 1103515245u + 12345u; v = 0.5 + ((seed >> 16) & 0x7fff) / 32768.0; }
+
+        // diff test (programs are stateless here, so sample order does not matter)
+        int mismatches = 0;
+        for (size_t s = 0; s < samples; ++s) {
+            ref.run(&in[s * ni], &expect[s * no]);
+            vm.run(&in[s * ni], got.data());
+            mismatches += memcmp(got.data(), &expect[s * no], no * sizeof(double)) != 0;
+            vmSwitch.runSwitch(&in[s * ni], got.data());
+            mismatches += memcmp(got.data(), &expect[s * no], no * sizeof(double)) != 0;
+        }
+        // the batch interpreter reads and writes columns
+        vector<double> inCols(samples * ni), outCols(samples * no);
+        vector<const double *> inPtr(ni);
+        vector<double *> outPtr(no);
+        for (size_t k = 0; k < ni; ++k) inPtr[k] = &inCols[k * samples];
+        for (size_t k = 0; k < no; ++k) outPtr[k] = &outCols[k * samples];
+        for (size_t s = 0; s < samples; ++s)
+            for (size_t k = 0; k < ni; ++k) inCols[k * samples + s] = in[s * ni + k];
+        batch.run(inPtr.data(), outPtr.data(), samples);
+        for (size_t s = 0; s < samples; ++s)
+            for (size_t k = 0; k < no; ++k)
+                mismatches += memcmp(&outCols[k * samples + s], &expect[s * no + k], sizeof(double)) != 0;
+        vector<double> jitOut(samples * no);
+        jit.runBatch(in.data(), jitOut.data(), samples);
+        mismatches += memcmp(jitOut.data(), expect.data(), jitOut.size() * sizeof(double)) != 0;
+        vector<double> aotCols(samples * no);
+        vector<double *> aotPtr(no);
+        for (size_t k = 0; k < no; ++k) aotPtr[k] = &aotCols[k * samples];
+        aot.runColumns(inPtr.data(), aotPtr.data(), samples);
+        mismatches += memcmp(aotCols.data(), outCols.data(), aotCols.size() * sizeof(double)) != 0;
+        vector<double> aotOut(samples * no);
+        aot.runBatch(in.data(), aotOut.data(), samples);
+        mismatches += memcmp(aotOut.data(), expect.data(), aotOut.size() * sizeof(double)) != 0;
+
+        double tRef = timeIt([&](size_t s) { ref.run(&in[s * ni], out.data()); }, samples, ms);
+        double tSw = timeIt([&](size_t s) { vmSwitch.runSwitch(&in[s * ni], out.data()); }, samples, ms);
+        double tVm = timeIt([&](size_t s) { vm.run(&in[s * ni], out.data()); }, samples, ms);
+        double tBatch = timeAll([&]() { batch.run(inPtr.data(), outPtr.data(), samples); }, samples, ms);
+        double tJit = timeAll([&]() { jit.runBatch(in.data(), jitOut.data(), samples); }, samples, ms);
+        double tAot = timeAll([&]() { aot.runBatch(in.data(), aotOut.data(), samples); }, samples, ms);
+        CostEstimate est = CostModel::estimate(c.tac, target);
+
+        printf("%-28s %6zu %10.0f %12.1f %12.1f %12.1f %12.1f %12.1f %12.1f", p.name.c_str(), c.tac.size(),
+               est.cyclesPerSample, tRef, tSw, tVm, tBatch, tJit, tAot);
+        if (!jit.compiled()) printf("  (jit: %s)", jit.fallbackReason().c_str());
+        if (!aot.compiled()) printf("  (aot: %s)", aot.fallbackReason().c_str());
+        else if (!aot.cacheHit()) printf("  (aot built in %.0f ms)", aot.compileMs());
+        if (ghz > 0) printf(" %10.1f", est.cyclesPerSample / ghz);
+        if (mismatches) printf("  MISMATCH x%d", mismatches);
+        printf("\n");
+    }
+    if (!VM::threaded()) printf("(built without computed goto: vm-threaded is the switch loop)\n");
+    return 0;
+}
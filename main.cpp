@@ -2,6 +2,11 @@
 #include <iomanip>
 #include <fstream>
 #include <sstream>
+#include <set>
+#include <map>
+#include <algorithm>
+#include <memory>
+#include <cstring>
 
 #include "lexer/lexer.h"
 #include "lexer/token.h"
@@ -11,6 +16,30 @@
 
 #include "tac/tacGen.h"
 #include "tac/dce.h"
+#include "tac/tacInfo.h"
+#include "tac/regAlloc.h"
+#include "tac/invariance.h"
+#include "tac/partialEval.h"
+#include "tac/fusion.h"
+#include "tac/scheduler.h"
+#include "tac/reciprocal.h"
+#include "tac/optReport.h"
+#include "tac/peephole.h"
+#include "tac/passManager.h"
+#include "tac/precision.h"
+#include "tac/guards.h"
+#include "tac/slicer.h"
+#include "tac/horner.h"
+#include "tac/costModel.h"
+#include "tac/valueProfile.h"
+#include "runtime/interpreter.h"
+#include "runtime/bytecode.h"
+#include "runtime/vm.h"
+#include "runtime/batchInterpreter.h"
+#include "runtime/jit.h"
+#include "runtime/aotKernel.h"
+#include "runtime/fixedPoint.h"
+#include "runtime/floatEnv.h"
 
 using namespace std;
 
@@ -42,18 +71,149 @@ string readFile(const string &filename) {
     return buffer.str();
 }
 
+// Program name used to prefix fused outputs: file name without directory/extension
+string programName(const string &filename) {
+    size_t slash = filename.find_last_of("/\\");
+    string base = slash == string::npos ? filename : filename.substr(slash + 1);
+    size_t dot = base.find('.');
+    return dot == string::npos ? base : base.substr(0, dot);
+}
+
+// Samples for --run: a CSV file whose header row names the inputs
+void readSamples(const string &filename, vector<string> &names, vector<vector<double>> &rows) {
+    stringstream in(readFile(filename));
+    string line;
+    auto split = [](const string &l) {
+        vector<string> cells;
+        stringstream ls(l);
+        for (string c; getline(ls, c, ',');) {
+            c.erase(0, c.find_first_not_of(" \t\r"));
+            c.erase(c.find_last_not_of(" \t\r") + 1);
+            cells.push_back(c);
+        }
+        return cells;
+    };
+    if (getline(in, line)) names = split(line);
+    while (getline(in, line)) {
+        if (line.find_first_not_of(" \t\r") == string::npos) continue;
+        vector<double> row;
+        for (const auto &c : split(line)) row.push_back(c.empty() ? 0.0 : stod(c));
+        row.resize(names.size(), 0.0);
+        rows.push_back(row);
+    }
+}
+
+// Quietly compile one more program down to TAC after DCE (used for --fuse)
+FusionInput compileQuiet(const string &filename) {
+    string source = readFile(filename);
+    ErrorHandler err;
+    SymbolTable sym(&err);
+    Lexer lexer(&sym, &err);
+    lexer.setSource(source);
+    sym.insert(SymbolEntry("in", "builtin", "float()->float", sym.currentScope(), -1));
+    sym.insert(SymbolEntry("out", "builtin", "void(float)", sym.currentScope(), -1));
+    TACGenerator tacGen(&lexer, &sym, &err);
+    vector<TacInst> tac;
+    tacGen.generate(tac);
+    DeadCodeEliminator::eliminate(tac, sym);
+    if (err.errorCount() > 0) {
+        cerr << "Warning: '" << filename << "' compiled with " << err.errorCount() << " error(s)\n";
+    }
+    return {programName(filename), tac, describeInterface(tac, &sym).state};
+}
+
 int main(int argc, char* argv[]) {
     cout << "=== SignalLang Compiler ===\n";
     cout << "(Lexer → Parser → TAC → Dead Code Elimination)\n\n";
 
     // ---- Step 1: Check command-line arguments ----
-    if (argc < 2) {
-        cerr << "Usage: " << argv[0] << " <source_file.signal>\n";
+    string filename;
+    int numRegs = RegisterAllocator::DEFAULT_REGS;
+    bool streamSplit = false;
+    set<string> params;
+    map<string, double> bindings;
+    vector<string> fuseFiles;
+    bool sched = false;
+    PrecisionMode precision = PrecisionMode::STRICT;
+    OptLevel optLevel = OptLevel::O1;
+    double budgetMs = 0;
+    map<string, Interval> inputRanges;
+    double f32Error = -1;
+    bool guards = false;
+    set<string> wantedOutputs;
+    bool polyRewrite = false, useFma = false;
+    PolyForm polyForm = PolyForm::HORNER;
+    TargetModel target;
+    TargetModel::byName("generic", target);
+    bool showCost = false;
+    string runFile;
+    bool profile = false;
+    bool showBytecode = false, useVm = false, useBatch = false, useJit = false, useAot = false;
+    int fixedBits = 0;
+    MathProfile math = MathProfile::STRICT;
+    DenormalMode denormals = DenormalMode::PRESERVE;
+    for (int a = 1; a < argc; ++a) {
+        string arg = argv[a];
+        if (arg.rfind("--regs=", 0) == 0) numRegs = stoi(arg.substr(7));
+        else if (PassManager::parseLevel(arg, optLevel)) {}
+        else if (arg.rfind("--compile-budget=", 0) == 0) budgetMs = stod(arg.substr(17));
+        else if (arg == "--stream") streamSplit = true;
+        else if (arg == "--sched") sched = true;
+        else if (arg == "--precision=relaxed") precision = PrecisionMode::RELAXED;
+        else if (arg == "--precision=strict") precision = PrecisionMode::STRICT;
+        else if (arg.rfind("--param=", 0) == 0) params.insert(arg.substr(8));
+        else if (arg.rfind("--range=", 0) == 0 && arg.find('=', 8) != string::npos) {
+            // --range=NAME=LO:HI declares the range of a sensor input
+            size_t eq = arg.find('=', 8), colon = arg.find(':', eq);
+            if (colon != string::npos)
+                inputRanges[arg.substr(8, eq - 8)] = Interval(stod(arg.substr(eq + 1, colon - eq - 1)),
+                                                              stod(arg.substr(colon + 1)));
+        }
+        else if (arg == "--guards") guards = true;
+        else if (arg == "--horner") { polyRewrite = true; polyForm = PolyForm::HORNER; }
+        else if (arg == "--estrin") { polyRewrite = true; polyForm = PolyForm::ESTRIN; }
+        else if (arg == "--fma") useFma = true;
+        else if (arg == "--cost") showCost = true;
+        else if (arg.rfind("--run=", 0) == 0) runFile = arg.substr(6);
+        else if (arg == "--profile") profile = true;
+        else if (arg == "--bytecode") showBytecode = true;
+        else if (arg == "--vm") useVm = true;
+        else if (arg == "--batch") useBatch = true;
+        else if (arg == "--jit") useJit = true;
+        else if (arg == "--aot") useAot = true;
+        else if (arg == "--fixed=q15") fixedBits = 16;
+        else if (arg == "--fixed=q31") fixedBits = 32;
+        else if (arg == "--fastmath") math = MathProfile::FASTMATH;
+        else if (arg.rfind("--denormals=", 0) == 0 && DenormalScope::parseMode(arg.substr(12), denormals)) {}
+        else if (arg.rfind("--target=", 0) == 0) {
+            if (!TargetModel::byName(arg.substr(9), target)) {
+                cerr << "Warning: unknown target '" << arg.substr(9) << "' (known:";
+                for (const auto &t : TargetModel::names()) cerr << " " << t;
+                cerr << "), using generic\n";
+                TargetModel::byName("generic", target);
+            }
+        }
+        else if (arg.rfind("--outputs=", 0) == 0) {
+            // --outputs=a,b,c compiles only what those outputs need
+            stringstream names(arg.substr(10));
+            for (string name; getline(names, name, ',');)
+                if (!name.empty()) wantedOutputs.insert(name);
+        }
+        else if (arg.rfind("--f32-error=", 0) == 0) f32Error = stod(arg.substr(12));
+        else if (arg.rfind("--fuse=", 0) == 0) fuseFiles.push_back(arg.substr(7));
+        else if (arg.rfind("--bind=", 0) == 0 && arg.find('=', 7) != string::npos) {
+            size_t eq = arg.find('=', 7);
+            bindings[arg.substr(7, eq - 7)] = stod(arg.substr(eq + 1));
+        }
+        else if (!arg.empty() && arg[0] != '-') filename = arg;
+        else cerr << "Warning: ignoring unknown option '" << arg << "'\n";
+    }
+    if (filename.empty()) {
+        cerr << "Usage: " << argv[0] << " <source_file.signal> [-O0|-O1|-O2|-O3] [--compile-budget=MS] [--regs=N] [--sched] [--precision=strict|relaxed] [--stream] [--param=NAME]... [--bind=NAME=VALUE]... [--fuse=FILE]... [--range=NAME=LO:HI]... [--f32-error=E] [--guards] [--outputs=A,B,...] [--horner|--estrin] [--fma] [--target=NAME] [--cost] [--run=SAMPLES.csv] [--profile] [--bytecode] [--vm] [--batch] [--jit] [--aot] [--fixed=q15|q31] [--fastmath] [--denormals=flush|preserve]\n";
         cerr << "Example: ./build/SensorLang examples/example.signal\n";
         return 1;
     }
 
-    string filename = argv[1];
     string source = readFile(filename);
 
     cout << "Loaded program: " << filename << "\n";
@@ -115,7 +275,316 @@ int main(int argc, char* argv[]) {
     TACGenerator::print(tac);
     cout << "\n";
 
-    // ---- Step 7: Final Outputs ----
+    OptReport report;
+
+    // ---- Step 7: Load-time specialization ----
+    if (!bindings.empty()) {
+        FoldStats fs;
+        tac = PartialEvaluator::specialize(tac, sym, bindings, &fs);
+        cout << "=== TAC (Specialized for";
+        for (const auto &b : bindings) cout << " " << b.first << "=" << b.second;
+        cout << ") ===\n";
+        TACGenerator::print(tac);
+        cout << "folded=" << fs.folded << " simplified=" << fs.simplified
+             << " parameter uses bound=" << fs.bound << "\n\n";
+    }
+
+    // ---- Step 8: Output slicing ----
+    if (!wantedOutputs.empty()) {
+        SliceStats ss;
+        OutputSlicer slicer(tac, &sym);
+        const vector<string> outputs = describeInterface(tac, &sym).outputs;
+        tac = slicer.slice(wantedOutputs, &ss);
+        if (!ss.unknown.empty()) {
+            cerr << "Warning: unknown output(s)";
+            for (const auto &o : ss.unknown) cerr << " '" << o << "'";
+            cerr << " (outputs:";
+            for (const auto &o : outputs) cerr << " " << o;
+            cerr << "), ignored\n";
+        }
+        cout << "=== TAC (Sliced for";
+        for (const auto &o : wantedOutputs) cout << " " << o;
+        cout << ") ===\n";
+        TACGenerator::print(tac);
+        cout << "kept " << ss.instructionsAfter << " of " << ss.instructionsBefore << " instructions\n\n";
+    }
+
+    // ---- Step 9: Polynomial rewriting ----
+    if (polyRewrite) {
+        PolyStats ps = PolynomialRewriter::run(tac, polyForm, useFma, &report);
+        cout << "=== TAC (" << (polyForm == PolyForm::HORNER ? "Horner" : "Estrin") << (useFma ? ", FMA" : "")
+             << ") ===\n";
+        TACGenerator::print(tac);
+        cout << "polynomials=" << ps.polynomials << " multiplies " << ps.mulsBefore << " -> " << ps.mulsAfter
+             << " (fma=" << ps.fmas << ")\n\n";
+    }
+
+    // ---- Step 10: Optimization pipeline ----
+    PassManager pm(optLevel);
+    pm.setPrecision(precision);
+    pm.setMathProfile(math);
+    pm.setNumRegs(numRegs);
+    pm.setBudgetMs(budgetMs);
+    pm.setLatencies(target.latencies());
+    // -O3 lets the scheduler use the whole register file
+    if (sched && !pm.has("sched")) pm.add(PassManager::schedulePass(optLevel == OptLevel::O3));
+    pm.run(tac, sym, &report);
+    cout << "=== TAC (" << PassManager::levelToString(optLevel) << ") ===\n";
+    TACGenerator::print(tac);
+    cout << "\n";
+
+    // ---- Step 11: Float32 demotion ----
+    if (f32Error > 0) {
+        PrecisionAnalyzer::demote(tac, inputRanges, f32Error, &report);
+        cout << "=== TAC (Precision, |error| <= " << f32Error << ") ===\n";
+        TACGenerator::print(tac);
+        cout << "\n";
+    }
+
+    // ---- Step 12: Runtime guards ----
+    if (guards) {
+        GuardInserter::insert(tac, inputRanges, &report);
+        cout << "=== TAC (Guarded) ===\n";
+        TACGenerator::print(tac);
+        cout << "\n";
+    }
+
+    // ---- Step 13: Register Allocation ----
+    cout << "=== Register Allocation (" << numRegs << " registers) ===\n";
+    RegAllocResult alloc = RegisterAllocator::allocate(tac, numRegs);
+    RegisterAllocator::print(tac, alloc);
+    cout << "\n";
+
+    // ---- Step 14: Cost estimate ----
+    if (showCost) {
+        cout << "=== Cost Estimate ===\n";
+        CostModel::print(CostModel::estimate(tac, target, &alloc));
+        cout << "\n";
+    }
+
+    // ---- Step 15: Bytecode ----
+    if (showBytecode) {
+        cout << "=== Bytecode ===\n";
+        try {
+            Bytecode::compile(tac, &sym).disassemble();
+        } catch (const length_error &e) {
+            cerr << "Error: " << e.what() << "\n";
+        }
+        cout << "\n";
+    }
+
+    // ---- Step 16: Fixed point ----
+    unique_ptr<FixedPointKernel> fixed;
+    if (fixedBits) {
+        FixedPointOptions options;
+        options.bits = fixedBits;
+        fixed.reset(new FixedPointKernel(tac, &sym, inputRanges, options));
+        cout << "=== Fixed Point (Q" << fixedBits - 1 << ") ===\n";
+        fixed->print();
+        cout << "\n";
+    }
+
+    // ---- Step 17: Execute samples ----
+    if (!runFile.empty()) {
+        vector<string> columns;
+        vector<vector<double>> rows;
+        readSamples(runFile, columns, rows);
+        DenormalScope denormalScope(denormals); // this thread runs every engine below
+
+        Interpreter interp(tac, &sym);
+        unique_ptr<VM> vm;
+        if (useVm) {
+            try {
+                vm.reset(new VM(Bytecode::compile(tac, &sym)));
+            } catch (const length_error &e) {
+                cerr << "Warning: " << e.what() << ", running on the interpreter\n";
+            }
+        }
+        unique_ptr<JitKernel> jit;
+        if (useJit) {
+            jit.reset(new JitKernel(tac, &sym));
+            cout << "=== JIT ===\n";
+            jit->print();
+            cout << "\n";
+        }
+        unique_ptr<AotKernel> aot;
+        if (useAot) {
+            aot.reset(new AotKernel(tac, &sym, AotOptions::defaults(math)));
+            cout << "=== AOT ===\n";
+            aot->print();
+            cout << "\n";
+        }
+        ValueProfiler profiler(tac, &sym);
+        if (profile) interp.setProfiler(&profiler);
+        for (const auto &name : interp.inputNames())
+            if (find(columns.begin(), columns.end(), name) == columns.end())
+                cerr << "Warning: input '" << name << "' missing from " << runFile << ", reading 0\n";
+
+        // --batch: the whole file at once, column by column
+        vector<double> batchOut;
+        if (useBatch) {
+            BatchInterpreter batch(tac, &sym);
+            cout << "=== Batch Plan ===\n";
+            batch.print();
+            cout << "\n";
+            const size_t ni = batch.inputNames().size(), no = batch.outputNames().size();
+            vector<double> batchIn(rows.size() * ni, 0.0);
+            for (size_t k = 0; k < ni; ++k) {
+                size_t c = find(columns.begin(), columns.end(), batch.inputNames()[k]) - columns.begin();
+                if (c < columns.size())
+                    for (size_t r = 0; r < rows.size(); ++r) batchIn[r * ni + k] = rows[r][c];
+            }
+            batchOut.resize(rows.size() * no);
+            try {
+                batch.runRows(batchIn.data(), batchOut.data(), rows.size());
+            } catch (const RuntimeError &e) {
+                cerr << "Warning: batch execution stopped (" << e.what() << "), running sample by sample\n";
+                batchOut.clear();
+            }
+        }
+
+        string engine = !batchOut.empty() ? "batch"
+                        : jit ? (jit->compiled() ? "JIT" : "interpreter, JIT fallback")
+                        : aot ? (aot->compiled() ? "AOT" : "interpreter, AOT fallback")
+                        : fixed ? (fixed->compiled() ? "fixed point" : "interpreter, fixed-point fallback")
+                        : vm ? (VM::threaded() ? "threaded VM" : "switch VM")
+                        : useVm ? "interpreter, VM fallback" : "interpreter";
+        if (DenormalScope::flushing()) engine += ", denormals flushed";
+        cout << "=== Execution (" << rows.size() << " samples, " << interp.frameSlots() << " frame slots, "
+             << engine << ") ===\n";
+        cout << "sample";
+        for (const auto &o : interp.outputNames()) cout << "," << o;
+        cout << "\n";
+        vector<map<string, double>> samples;
+        for (size_t r = 0; r < rows.size(); ++r) {
+            map<string, double> in;
+            for (size_t c = 0; c < columns.size(); ++c) in[columns[c]] = rows[r][c];
+            samples.push_back(in);
+            try {
+                vector<double> out(interp.outputNames().size());
+                if (!batchOut.empty()) {
+                    copy_n(&batchOut[r * out.size()], out.size(), out.begin());
+                    if (profile) interp.run(in);
+                } else if (jit) {
+                    vector<double> args;
+                    for (const auto &name : jit->inputNames()) args.push_back(in.count(name) ? in[name] : 0.0);
+                    jit->run(args.data(), out.data());
+                    if (profile) interp.run(in);
+                } else if (aot) {
+                    vector<double> args;
+                    for (const auto &name : aot->inputNames()) args.push_back(in.count(name) ? in[name] : 0.0);
+                    aot->run(args.data(), out.data());
+                    if (profile) interp.run(in);
+                } else if (fixed) {
+                    vector<double> args;
+                    for (const auto &name : fixed->inputNames()) args.push_back(in.count(name) ? in[name] : 0.0);
+                    fixed->run(args.data(), out.data());
+                    if (profile) interp.run(in);
+                } else if (vm) {
+                    vector<double> args;
+                    for (const auto &name : vm->bytecode().inputs) args.push_back(in.count(name) ? in[name] : 0.0);
+                    vm->run(args.data(), out.data());
+                    if (profile) interp.run(in); // the profiler hangs off the interpreter
+                } else {
+                    map<string, double> res = interp.run(in);
+                    for (size_t k = 0; k < out.size(); ++k) out[k] = res[interp.outputNames()[k]];
+                }
+                cout << r;
+                for (double v : out) cout << "," << v;
+                cout << "\n";
+            } catch (const RuntimeError &e) {
+                err.reportError(ErrorPhase::RUNTIME, "sample " + to_string(r) + ": " + e.what());
+            }
+        }
+        cout << "\n";
+
+        if (profile) {
+            cout << "=== Value Profile ===\n";
+            profiler.print();
+            map<string, double> stable = profiler.stableInputs(0.99, min<long long>(100, profiler.samples()));
+            if (!stable.empty()) {
+                // replay the samples through the guarded specialized kernel; every sample
+                // it is selected for is checked against the generic kernel from the same state
+                SpecializedKernel kernel(tac, sym, stable);
+                Interpreter generic(kernel.genericKernel(), &sym), special(kernel.specializedKernel(), &sym);
+                vector<double> row(kernel.inputNames().size());
+                size_t compared = 0, mismatched = 0;
+                for (const auto &in : samples) {
+                    for (size_t k = 0; k < row.size(); ++k) {
+                        auto it = in.find(kernel.inputNames()[k]);
+                        row[k] = it == in.end() ? 0.0 : it->second;
+                    }
+                    const bool specialized = &kernel.select(row.data()) == &kernel.specializedKernel();
+                    if (specialized) {
+                        vector<double> state, from = generic.saveState();
+                        for (const auto &name : special.stateNames()) {
+                            size_t k = find(generic.stateNames().begin(), generic.stateNames().end(), name) -
+                                       generic.stateNames().begin();
+                            state.push_back(k < from.size() ? from[k] : 0.0);
+                        }
+                        special.restoreState(state);
+                    }
+                    map<string, double> want;
+                    try {
+                        want = generic.run(in);
+                    } catch (const RuntimeError &) {
+                        continue; // already reported by the run above
+                    }
+                    if (!specialized) continue;
+                    compared++;
+                    try {
+                        map<string, double> got = special.run(in);
+                        for (const auto &o : want) {
+                            auto g = got.find(o.first);
+                            if (g == got.end() || memcmp(&g->second, &o.second, sizeof(double)) != 0) {
+                                mismatched++;
+                                break;
+                            }
+                        }
+                    } catch (const RuntimeError &) {
+                        mismatched++;
+                    }
+                }
+                cout << "-- specialized on stable inputs --\n";
+                TACGenerator::print(kernel.specializedKernel());
+                kernel.print();
+                cout << "specialized outputs bitwise equal to the generic run on " << compared - mismatched << "/"
+                     << compared << " samples\n";
+                if (mismatched)
+                    cerr << "Warning: specialized kernel differed from the generic one on " << mismatched
+                         << " sample(s)\n";
+            }
+            cout << "\n";
+        }
+    }
+
+    // ---- Step 18: Per-sample invariant hoisting ----
+    if (streamSplit) {
+        cout << "=== Streaming Split (prologue / per-sample body) ===\n";
+        vector<Variance> cls = InvarianceAnalyzer::classify(tac, sym, params);
+        for (size_t i = 0; i < tac.size(); ++i) {
+            cout << i << ":\t[" << InvarianceAnalyzer::varianceToString(cls[i]) << "]\t";
+            printTacLine(tac[i]);
+        }
+        InvarianceAnalyzer::print(InvarianceAnalyzer::split(tac, sym, params));
+        cout << "\n";
+    }
+
+    // ---- Step 19: Multi-program fusion ----
+    if (!fuseFiles.empty()) {
+        vector<FusionInput> progs;
+        progs.push_back({programName(filename), tac, describeInterface(tac, &sym).state});
+        for (const auto &f : fuseFiles) progs.push_back(compileQuiet(f));
+        cout << "=== Fused Module (" << progs.size() << " programs) ===\n";
+        ProgramFuser::print(ProgramFuser::fuse(progs));
+        cout << "\n";
+    }
+
+    // ---- Step 20: Final Outputs ----
+    cout << "=== Optimization Report ===\n";
+    report.print();
+    cout << "\n";
+
     cout << "=== Final Symbol Table ===\n";
     sym.dump();
 
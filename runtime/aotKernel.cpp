@@ -0,0 +1,206 @@
+#include "aotKernel.h"
+#include "cppEmitter.h"
+#include <filesystem>
+#include <fstream>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <algorithm>
+
+#ifdef SIGNALLANG_AOT
+#include <dlfcn.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#endif
+
+using namespace std;
+namespace fs = std::filesystem;
+
+AotOptions AotOptions::defaults(MathProfile math) {
+    AotOptions o;
+    const char *cxx = getenv("CXX");
+    o.compiler = cxx && *cxx ? cxx : "c++";
+    o.flags = math == MathProfile::FASTMATH ? "-std=c++17 -O3 -march=native -ffp-contract=fast -fassociative-math "
+                                              "-freciprocal-math -fno-signed-zeros -fno-trapping-math -fPIC -shared"
+                                            : "-std=c++17 -O3 -march=native -ffp-contract=off -fPIC -shared";
+    const char *dir = getenv("SIGNALLANG_AOT_CACHE");
+    if (dir && *dir) {
+        o.cacheDir = dir;
+    } else {
+        error_code ec;
+        fs::path tmp = fs::temp_directory_path(ec);
+        o.cacheDir = (ec ? string("/tmp") : tmp.string()) + "/signallang-aot";
+#ifdef SIGNALLANG_AOT
+        o.cacheDir += "-" + to_string(getuid()); // load() refuses it unless this user owns it
+#endif
+    }
+    return o;
+}
+
+static uint64_t fnv1a(const string &s) {
+    uint64_t h = 1469598103934665603ull;
+    for (unsigned char c : s) { h ^= c; h *= 1099511628211ull; }
+    return h;
+}
+
+static string shellQuote(const string &s) {
+    string q = "'";
+    for (char c : s) q += c == '\'' ? string("'\\''") : string(1, c);
+    return q + "'";
+}
+
+#ifdef SIGNALLANG_AOT
+// Why path cannot be trusted, or "" when it is ours: not a symbolic link, owned by this
+// user, and either a private (0700) directory or a file nobody else can write.
+static string untrusted(const string &path, bool dir) {
+    struct stat st;
+    if (lstat(path.c_str(), &st) != 0) return "cannot stat " + path;
+    if (S_ISLNK(st.st_mode)) return path + " is a symbolic link";
+    if (dir ? !S_ISDIR(st.st_mode) : !S_ISREG(st.st_mode))
+        return path + (dir ? " is not a directory" : " is not a regular file");
+    if (st.st_uid != getuid()) return path + " is owned by another user";
+    if (dir && (st.st_mode & 0777) != 0700) return path + " is not private (mode 0700)";
+    if (!dir && (st.st_mode & 022) != 0) return path + " is writable by other users";
+    return "";
+}
+#endif
+
+AotKernel::AotKernel(const vector<TacInst> &tac, const SymbolTable *sym, const AotOptions &options)
+    : fallback(tac, sym), src(CppEmitter::emit(tac, sym)) {
+    state.assign(fallback.stateNames().size(), 0.0);
+    if (tac.size() > options.maxInstructions)
+        reason = "program too large to compile (" + to_string(tac.size()) + " > " + to_string(options.maxInstructions) +
+                 " instructions)";
+    else
+        load(options);
+}
+
+AotKernel::~AotKernel() {
+#ifdef SIGNALLANG_AOT
+    if (handle) dlclose(handle);
+#endif
+}
+
+bool AotKernel::load(const AotOptions &options) {
+#ifdef SIGNALLANG_AOT
+    error_code ec;
+    fs::create_directories(options.cacheDir, ec);
+    if (ec) { reason = "cannot create " + options.cacheDir; return false; }
+    // the default directory name is predictable: another user may have created it first
+    if (!fs::is_symlink(options.cacheDir, ec)) fs::permissions(options.cacheDir, fs::perms::owner_all, ec);
+    reason = untrusted(options.cacheDir, true);
+    if (!reason.empty()) return false;
+
+    char key[17];
+    snprintf(key, sizeof key, "%016llx", (unsigned long long)fnv1a(options.compiler + "\n" + options.flags + "\n" + src));
+    const string base = options.cacheDir + "/kernel-" + key;
+    soPath = base + ".so";
+    hit = fs::exists(soPath, ec);
+    if (!hit) {
+        ofstream(base + ".cpp") << src;
+        const string tmp = soPath + ".tmp" + to_string(getpid());
+        const string cmd = options.compiler + " " + options.flags + " -o " + shellQuote(tmp) + " " +
+                           shellQuote(base + ".cpp") + " > " + shellQuote(base + ".log") + " 2>&1";
+        auto t0 = chrono::steady_clock::now();
+        int rc = system(cmd.c_str());
+        buildMs = chrono::duration<double, milli>(chrono::steady_clock::now() - t0).count();
+        if (rc != 0) {
+            fs::remove(tmp, ec);
+            reason = "compiler failed, see " + base + ".log";
+            return false;
+        }
+        fs::rename(tmp, soPath, ec); // atomic: other processes see all or nothing
+        if (ec) { reason = "cannot install " + soPath; return false; }
+    }
+
+    reason = untrusted(soPath, false);
+    if (!reason.empty()) return false;
+    handle = dlopen(soPath.c_str(), RTLD_NOW | RTLD_LOCAL);
+    if (!handle) { reason = string("dlopen failed: ") + dlerror(); return false; }
+    rows = reinterpret_cast<RowsFn>(dlsym(handle, "signal_rows"));
+    columns = reinterpret_cast<ColumnsFn>(dlsym(handle, "signal_columns"));
+    if (!rows || !columns) {
+        reason = "entry points missing from " + soPath;
+        rows = nullptr;
+        columns = nullptr;
+        return false;
+    }
+    return true;
+#else
+    (void)options;
+    reason = "no dynamic loading on this platform";
+    return false;
+#endif
+}
+
+void AotKernel::check(size_t done, size_t n, const Status &st, bool batch) const {
+    if (done >= n) return;
+    const TacInst &guard = fallback.program()[st.guard];
+    string what = guard.op == TACOp::GUARD_NONZERO ? "division by zero: " : "non-finite output: ";
+    throw RuntimeError(what + guard.arg1 + " is " + formatLiteral(st.value) +
+                           (batch ? " (sample " + to_string(done) + ")" : ""),
+                       st.guard);
+}
+
+void AotKernel::run(const double *inputs, double *outputs) {
+    if (!rows) { fallback.run(inputs, outputs); return; }
+    Status st;
+    check(rows(inputs, outputs, 1, state.data(), &st), 1, st, false);
+}
+
+void AotKernel::runBatch(const double *inputs, double *outputs, size_t n) {
+    const size_t ni = inputNames().size(), no = outputNames().size();
+    if (!rows) {
+        for (size_t s = 0; s < n; ++s) {
+            try {
+                fallback.run(inputs + s * ni, outputs + s * no);
+            } catch (const RuntimeError &e) {
+                throw RuntimeError(string(e.what()) + " (sample " + to_string(s) + ")", e.inst);
+            }
+        }
+        return;
+    }
+    Status st;
+    check(rows(inputs, outputs, n, state.data(), &st), n, st, true);
+}
+
+void AotKernel::runColumns(const double *const *inputs, double *const *outputs, size_t n) {
+    const size_t ni = inputNames().size(), no = outputNames().size();
+    if (!columns) {
+        vector<double> in(ni), out(no);
+        for (size_t s = 0; s < n; ++s) {
+            for (size_t k = 0; k < ni; ++k) in[k] = inputs[k][s];
+            try {
+                fallback.run(in.data(), out.data());
+            } catch (const RuntimeError &e) {
+                throw RuntimeError(string(e.what()) + " (sample " + to_string(s) + ")", e.inst);
+            }
+            for (size_t k = 0; k < no; ++k) outputs[k][s] = out[k];
+        }
+        return;
+    }
+    Status st;
+    check(columns(inputs, outputs, n, state.data(), &st), n, st, true);
+}
+
+void AotKernel::reset() {
+    fill(state.begin(), state.end(), 0.0);
+    fallback.reset();
+}
+
+vector<double> AotKernel::saveState() const { return rows ? state : fallback.saveState(); }
+
+void AotKernel::restoreState(const vector<double> &values) {
+    if (!rows) { fallback.restoreState(values); return; }
+    for (size_t k = 0; k < state.size() && k < values.size(); ++k) state[k] = values[k];
+}
+
+void AotKernel::print(ostream &out) const {
+    if (!rows) {
+        out << "interpreter fallback: " << reason << "\n";
+        return;
+    }
+    out << "shared object: " << soPath << " ("
+        << (hit ? string("cache hit") : "built in " + to_string((int)buildMs) + " ms") << ", "
+        << src.size() << " bytes of C++)\n";
+}
@@ -0,0 +1,99 @@
+#ifndef AOTKERNEL_H
+#define AOTKERNEL_H
+
+#include "interpreter.h"
+#include "../tac/reassociate.h"
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <iostream>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define SIGNALLANG_AOT 1
+#endif
+
+struct AotOptions {
+    std::string compiler; // $CXX, else "c++"
+    std::string flags;    // must keep -ffp-contract=off for bitwise results (STRICT)
+    std::string cacheDir; // $SIGNALLANG_AOT_CACHE, else <temp dir>/signallang-aot-<uid>
+    // Host compile time grows faster than linearly with the size of the one function
+    // we emit; larger programs stay on the interpreter.
+    size_t maxInstructions = 4000;
+
+    // FASTMATH lets the compiler contract, reassociate and use reciprocals; the kernel
+    // then no longer matches the Interpreter bit for bit.
+    static AotOptions defaults(MathProfile math = MathProfile::STRICT);
+};
+
+/*
+ * AotKernel
+ *  - Ahead-of-time backend: the program is emitted as C++ by CppEmitter, built into
+ *    a shared object by the system compiler and loaded with dlopen.
+ *  - Shared objects are cached as <cacheDir>/kernel-<hash>.so, keyed by a 64-bit
+ *    FNV-1a hash of compiler, flags and source, so an unchanged program is only
+ *    compiled once per machine. Builds go to a temporary name and are renamed into
+ *    place, so concurrent processes never load a half-written file.
+ *  - The default flags include -march=native; the cache is meant to be per machine.
+ *  - Nothing is loaded from a cache directory that is a symbolic link, belongs to
+ *    another user or is not mode 0700, nor from a shared object that is a link,
+ *    belongs to another user or is writable by others.
+ *  - Same calling convention and guard reporting as JitKernel. When the compiler or
+ *    the loader fails, the kernel runs on the reference Interpreter and
+ *    fallbackReason() says why (the compiler's output is kept next to the source).
+ */
+class AotKernel {
+public:
+    explicit AotKernel(const std::vector<TacInst> &tac, const SymbolTable *sym = nullptr,
+                       const AotOptions &options = AotOptions::defaults());
+    ~AotKernel();
+    AotKernel(const AotKernel &) = delete;
+    AotKernel &operator=(const AotKernel &) = delete;
+
+    bool compiled() const { return rows != nullptr; }
+    const std::string &fallbackReason() const { return reason; }
+    bool cacheHit() const { return hit; }
+    double compileMs() const { return buildMs; }
+    const std::string &source() const { return src; }
+    const std::string &sharedObject() const { return soPath; }
+
+    const std::vector<std::string> &inputNames() const { return fallback.inputNames(); }
+    const std::vector<std::string> &outputNames() const { return fallback.outputNames(); }
+
+    // inputs in inputNames() order; outputs written in outputNames() order.
+    void run(const double *inputs, double *outputs);
+    // n samples, rows stored one after another; on a failing guard the rows before it
+    // have been written.
+    void runBatch(const double *inputs, double *outputs, size_t n);
+    // Columnar: inputs[k] holds n values of input k, outputs[k] receives n values.
+    void runColumns(const double *const *inputs, double *const *outputs, size_t n);
+
+    void reset(); // zero state
+    // State values in the Interpreter's stateNames() order.
+    std::vector<double> saveState() const;
+    void restoreState(const std::vector<double> &values);
+    void print(std::ostream &out = std::cout) const;
+
+    struct Status {
+        int32_t guard;
+        int32_t pad;
+        double value;
+    };
+
+private:
+    typedef size_t (*RowsFn)(const double *in, double *out, size_t n, double *state, Status *st);
+    typedef size_t (*ColumnsFn)(const double *const *in, double *const *out, size_t n, double *state, Status *st);
+
+    Interpreter fallback;
+    std::string src, soPath, reason;
+    bool hit = false;
+    double buildMs = 0;
+    void *handle = nullptr;
+    RowsFn rows = nullptr;
+    ColumnsFn columns = nullptr;
+    std::vector<double> state;
+
+    bool load(const AotOptions &options);
+    void check(size_t done, size_t n, const Status &st, bool batch) const;
+};
+
+#endif // AOTKERNEL_H
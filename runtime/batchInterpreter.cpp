@@ -0,0 +1,507 @@
+#include "batchInterpreter.h"
+#include <map>
+#include <queue>
+#include <climits>
+#include <cmath>
+#include <algorithm>
+
+using namespace std;
+
+static double evaluate(TACOp op, bool f32, double a, double b, double c) {
+    if (f32) {
+        float x = (float)a, y = (float)b;
+        switch (op) {
+            case TACOp::ADD: return x + y;
+            case TACOp::SUB: return x - y;
+            case TACOp::MUL: return x * y;
+            case TACOp::DIV: return x / y;
+            case TACOp::FMA: return std::fmaf(x, y, (float)c);
+            default: return x;
+        }
+    }
+    switch (op) {
+        case TACOp::ADD: return a + b;
+        case TACOp::SUB: return a - b;
+        case TACOp::MUL: return a * b;
+        case TACOp::DIV: return a / b;
+        case TACOp::FMA: return std::fma(a, b, c);
+        default: return a;
+    }
+}
+
+namespace {
+// One immutable value of the program; a TAC name refers to a new value after each
+// definition, and a plain move makes the destination name refer to the same value.
+struct Value {
+    int input = -1;           // inputs: index in inputNames()
+    bool scalar = false;      // known while decoding
+    double imm = 0;
+    bool materialize = false; // scalar that is also needed as a column
+    int lastUse = -1;         // TAC index of the last read
+    bool computed = false;    // defined by a column instruction
+    int output = -1;          // computed straight into this output's column
+    int buffer = -1;
+    int constant = -1;
+};
+struct Pending {
+    TACOp op;
+    bool f32;
+    int dest, a, b, c; // value numbers
+    int inst;
+    BatchInterpreter::Shape shape = BatchInterpreter::NO_SHAPE; // x in a, y in b
+    double s1 = 0, s2 = 0;                                       // bound constants
+    bool absorbed = false;                                       // part of a later shape
+};
+} // namespace
+
+BatchInterpreter::BatchInterpreter(const vector<TacInst> &tac, const SymbolTable *sym, size_t blockSize)
+    : scalar(tac, sym), isColumnar(scalar.stateNames().empty()), simd(SimdKernels::best()) {
+    if (!isColumnar) return;
+    numInputs = (int)scalar.inputNames().size();
+
+    // ---- values: fold constants, rename moves ----
+    vector<Value> vals;
+    map<string, int> cur;
+    vector<Pending> pending;
+    auto newValue = [&]() { vals.emplace_back(); return (int)vals.size() - 1; };
+    auto newScalar = [&](double v) { int s = newValue(); vals[s].scalar = true; vals[s].imm = v; return s; };
+    auto use = [&](const string &name, int i) {
+        auto it = cur.find(name);
+        int v;
+        if (it == cur.end()) {
+            v = cur[name] = newValue();
+            vals[v].input = scalar.inputIndex(name);
+        } else {
+            v = it->second;
+        }
+        vals[v].lastUse = max(vals[v].lastUse, i);
+        return v;
+    };
+
+    for (int i = 0; i < (int)tac.size(); ++i) {
+        const TacInst &inst = tac[i];
+        const bool f32 = inst.prec == TacPrecision::F32;
+        Pending p{inst.op, f32, -1, -1, -1, -1, i};
+        switch (inst.op) {
+            case TACOp::LOAD_CONST: {
+                double v = literalValue(inst.arg1Literal);
+                cur[inst.dest] = newScalar(f32 ? (float)v : v);
+                continue;
+            }
+            case TACOp::ASSIGN: {
+                int a = use(inst.arg1, i);
+                if (vals[a].scalar) cur[inst.dest] = f32 ? newScalar((float)vals[a].imm) : a;
+                else if (!f32) cur[inst.dest] = a;
+                else { p.a = a; break; }
+                continue;
+            }
+            case TACOp::ADD:
+            case TACOp::SUB:
+            case TACOp::MUL:
+            case TACOp::DIV:
+                p.a = use(inst.arg1, i);
+                p.b = use(inst.arg2, i);
+                if (vals[p.a].scalar && vals[p.b].scalar) {
+                    cur[inst.dest] = newScalar(evaluate(inst.op, f32, vals[p.a].imm, vals[p.b].imm, 0));
+                    continue;
+                }
+                break;
+            case TACOp::FMA:
+                p.a = use(inst.arg1, i);
+                p.b = use(inst.arg2, i);
+                p.c = use(inst.arg3, i);
+                if (vals[p.a].scalar && vals[p.b].scalar && vals[p.c].scalar) {
+                    cur[inst.dest] = newScalar(evaluate(inst.op, f32, vals[p.a].imm, vals[p.b].imm, vals[p.c].imm));
+                    continue;
+                }
+                for (int v : {p.a, p.b, p.c}) if (vals[v].scalar) vals[v].materialize = true;
+                break;
+            case TACOp::GUARD_NONZERO:
+            case TACOp::GUARD_FINITE:
+                p.a = use(inst.arg1, i);
+                if (vals[p.a].scalar) vals[p.a].materialize = true;
+                pending.push_back(p);
+                continue;
+            default:
+                continue;
+        }
+        p.dest = cur[inst.dest] = newValue();
+        vals[p.dest].computed = true;
+        pending.push_back(p);
+    }
+
+    vector<int> outputVals;
+    for (const auto &name : scalar.outputNames()) {
+        int v = cur[name];
+        if (vals[v].scalar) vals[v].materialize = true;
+        if (vals[v].computed && vals[v].output < 0) vals[v].output = (int)outputVals.size();
+        outputVals.push_back(v);
+    }
+
+    // ---- shapes: one kernel for a statement of a common shape ----
+    vector<int> reads(vals.size(), 0), def(vals.size(), -1);
+    for (size_t k = 0; k < pending.size(); ++k) {
+        for (int v : {pending[k].a, pending[k].b, pending[k].c})
+            if (v >= 0) ++reads[v];
+        if (pending[k].dest >= 0) def[pending[k].dest] = (int)k;
+    }
+    for (int v : outputVals) ++reads[v];
+    auto known = [&](int v) { return vals[v].scalar && !std::isnan(vals[v].imm); };
+    // pending index of the F64 op defining v when nothing but the candidate root reads it
+    auto privateDef = [&](int v, TACOp op) {
+        if (vals[v].scalar || reads[v] != 1 || def[v] < 0) return -1;
+        const Pending &d = pending[def[v]];
+        return d.op == op && !d.f32 && d.shape == NO_SHAPE && !d.absorbed ? def[v] : -1;
+    };
+    // m is x * a with a constant
+    auto scaled = [&](const Pending &m, int &x, double &a) {
+        if (known(m.b) && !vals[m.a].scalar) { x = m.a; a = vals[m.b].imm; return true; }
+        if (known(m.a) && !vals[m.b].scalar) { x = m.b; a = vals[m.a].imm; return true; }
+        return false;
+    };
+    for (auto &r : pending) {
+        if (r.f32 || r.dest < 0) continue;
+        vector<int> parts;
+        int x = -1, y = -1;
+        double s1 = 0, s2 = 0;
+        if (r.op == TACOp::MUL && r.a == r.b && !vals[r.a].scalar) {
+            r.shape = SQR;
+            x = r.a;
+        } else if (r.op == TACOp::MUL && (known(r.a) != known(r.b))) {
+            // (x - o) * g, also (x + c) * g as (x - (-c)) * g
+            const int sum = known(r.b) ? r.a : r.b;
+            s2 = vals[known(r.b) ? r.b : r.a].imm;
+            for (TACOp op : {TACOp::SUB, TACOp::ADD}) {
+                const int k = privateDef(sum, op);
+                if (k < 0) continue;
+                const Pending &d = pending[k];
+                if (known(d.b) && !vals[d.a].scalar) { x = d.a; s1 = op == TACOp::SUB ? vals[d.b].imm : -vals[d.b].imm; }
+                else if (op == TACOp::ADD && known(d.a) && !vals[d.b].scalar) { x = d.b; s1 = -vals[d.a].imm; }
+                else continue;
+                r.shape = XMOG;
+                parts.push_back(k);
+                break;
+            }
+        } else if (r.op == TACOp::ADD || r.op == TACOp::SUB) {
+            const int ma = privateDef(r.a, TACOp::MUL), mb = privateDef(r.b, TACOp::MUL);
+            const double sign = r.op == TACOp::SUB ? -1.0 : 1.0;
+            if (ma >= 0 && mb >= 0 && ma != mb && scaled(pending[ma], x, s1) && scaled(pending[mb], y, s2)) {
+                r.shape = AXBY; // x * a + y * (+-b)
+                s2 *= sign;
+                parts = {ma, mb};
+            } else if (ma >= 0 && known(r.b) && scaled(pending[ma], x, s1)) {
+                r.shape = AXPB; // x * a +- b
+                s2 = sign * vals[r.b].imm;
+                parts = {ma};
+            } else if (mb >= 0 && known(r.a) && scaled(pending[mb], x, s1)) {
+                r.shape = AXPB; // b +- x * a == x * (+-a) + b
+                s1 *= sign;
+                s2 = vals[r.a].imm;
+                parts = {mb};
+            }
+        }
+        if (r.shape == NO_SHAPE) continue;
+        for (int k : parts) pending[k].absorbed = true;
+        r.a = x;
+        r.b = y;
+        r.s1 = s1;
+        r.s2 = s2;
+        for (int v : {x, y}) // the operands are now read at the root
+            if (v >= 0) vals[v].lastUse = max(vals[v].lastUse, r.inst);
+    }
+
+    // ---- columns: recycle a buffer once its value has been read for the last time ----
+    // (elementwise loops may write the column they read, so a value dying at p can
+    // hand its buffer to p's result)
+    vector<int> freeBuffers;
+    priority_queue<pair<int, int>, vector<pair<int, int>>, greater<pair<int, int>>> live; // (lastUse, value)
+    for (const auto &p : pending) {
+        while (!live.empty() && live.top().first <= p.inst) {
+            freeBuffers.push_back(vals[live.top().second].buffer);
+            live.pop();
+        }
+        if (p.dest < 0 || p.absorbed || vals[p.dest].output >= 0) continue;
+        int b;
+        if (!freeBuffers.empty()) { b = freeBuffers.back(); freeBuffers.pop_back(); }
+        else b = numBuffers++;
+        vals[p.dest].buffer = b;
+        live.push({vals[p.dest].lastUse, p.dest});
+    }
+    for (auto &v : vals) {
+        if (!v.scalar || !v.materialize) continue;
+        v.constant = numConsts++;
+        constValues.push_back(v.imm);
+    }
+    auto column = [&](int v) {
+        const Value &val = vals[v];
+        if (val.input >= 0) return val.input;
+        if (val.constant >= 0) return numInputs + numBuffers + val.constant;
+        if (val.output >= 0) return numInputs + scratchColumns() + val.output;
+        return numInputs + val.buffer;
+    };
+
+    for (const auto &p : pending) {
+        if (p.absorbed) continue;
+        ColOp op{p.op, p.f32, VV, -1, -1, -1, -1, 0.0, p.inst};
+        if (p.dest >= 0) op.dest = column(p.dest);
+        if (p.shape != NO_SHAPE) {
+            op.shape = p.shape;
+            op.a = column(p.a);
+            if (p.b >= 0) op.b = column(p.b);
+            op.imm = p.s1;
+            op.imm2 = p.s2;
+            ops.push_back(op);
+            continue;
+        }
+        const bool binary = p.op == TACOp::ADD || p.op == TACOp::SUB || p.op == TACOp::MUL || p.op == TACOp::DIV;
+        if (binary && vals[p.a].scalar) { op.form = SV; op.imm = vals[p.a].imm; }
+        else op.a = column(p.a);
+        if (binary && vals[p.b].scalar) { op.form = VS; op.imm = vals[p.b].imm; }
+        else if (p.b >= 0) op.b = column(p.b);
+        if (p.c >= 0) op.c = column(p.c);
+        ops.push_back(op);
+    }
+    for (size_t k = 0; k < outputVals.size(); ++k) {
+        int col = column(outputVals[k]);
+        if (col != numInputs + scratchColumns() + (int)k) outputCopies.push_back({(int)k, col});
+    }
+
+    // ---- block size and scratch ----
+    if (blockSize > 0) block = blockSize;
+    else while (block > 16 && (size_t)scratchColumns() * block * sizeof(double) > CACHE_BUDGET) block /= 2;
+    scratch.assign((size_t)scratchColumns() * block, 0.0);
+    cols.assign(numInputs + scratchColumns() + outputVals.size(), nullptr);
+    for (int k = 0; k < scratchColumns(); ++k) cols[numInputs + k] = scratch.data() + (size_t)k * block;
+    for (int k = 0; k < numConsts; ++k) fill_n(cols[numInputs + numBuffers + k], block, constValues[k]);
+}
+
+void BatchInterpreter::reset() { scalar.reset(); }
+
+void BatchInterpreter::guardFailed(const ColOp &op, double value, size_t sample) const {
+    string what = op.op == TACOp::GUARD_NONZERO ? "division by zero: " : "non-finite output: ";
+    throw RuntimeError(what + scalar.program()[op.inst].arg1 + " is " + formatLiteral(value) + " (sample " +
+                           to_string(sample) + ")",
+                       op.inst);
+}
+
+// ---- column kernels: one tight loop per instruction ----
+
+template <class F>
+static void binaryLoop(const BatchInterpreter::ColOp &op, double *const *cols, size_t n, F f);
+
+// F32 ops round their operands and result, on double columns
+template <class F>
+static void binaryF32(const BatchInterpreter::ColOp &op, double *const *cols, size_t n, F f) {
+    binaryLoop(op, cols, n, [f](double x, double y) { return (double)f((float)x, (float)y); });
+}
+
+static void binaryF64(const SimdKernelTable &k, const BatchInterpreter::ColOp &op, double *const *cols, size_t n) {
+    const int i = SimdKernels::opIndex(op.op);
+    switch (op.form) {
+        case BatchInterpreter::VV: k.f64vv[i](cols[op.dest], cols[op.a], cols[op.b], n); break;
+        case BatchInterpreter::VS: k.f64vs[i](cols[op.dest], cols[op.a], op.imm, n); break;
+        case BatchInterpreter::SV: k.f64sv[i](cols[op.dest], op.imm, cols[op.b], n); break;
+    }
+}
+
+template <class F>
+static void binaryLoop(const BatchInterpreter::ColOp &op, double *const *cols, size_t n, F f) {
+    double *d = cols[op.dest];
+    const double s = op.imm;
+    switch (op.form) {
+        case BatchInterpreter::VV: {
+            const double *a = cols[op.a], *b = cols[op.b];
+            for (size_t i = 0; i < n; ++i) d[i] = f(a[i], b[i]);
+            break;
+        }
+        case BatchInterpreter::VS: {
+            const double *a = cols[op.a];
+            for (size_t i = 0; i < n; ++i) d[i] = f(a[i], s);
+            break;
+        }
+        case BatchInterpreter::SV: {
+            const double *b = cols[op.b];
+            for (size_t i = 0; i < n; ++i) d[i] = f(s, b[i]);
+            break;
+        }
+    }
+}
+
+size_t BatchInterpreter::runBlock(const double *const *inputs, double *const *outputs, size_t n) {
+    double *const *c = cols.data();
+    // inputs are only ever read
+    for (int k = 0; k < numInputs; ++k) cols[k] = const_cast<double *>(inputs[k]);
+    const size_t outBase = numInputs + scratchColumns();
+    for (size_t k = 0; k + outBase < cols.size(); ++k) cols[outBase + k] = outputs[k];
+
+    // a failing guard does not stop the block: later guards are only checked on the
+    // rows before it, so the failure reported is the reference Interpreter's (lowest
+    // row, then first guard on that row)
+    size_t failRow = n;
+    failOp = nullptr;
+    for (const ColOp &op : ops) {
+        switch (op.shape) {
+            case AXPB: simd.f64axpb(c[op.dest], c[op.a], op.imm, op.imm2, n); continue;
+            case XMOG: simd.f64xmog(c[op.dest], c[op.a], op.imm, op.imm2, n); continue;
+            case AXBY: simd.f64axby(c[op.dest], c[op.a], op.imm, c[op.b], op.imm2, n); continue;
+            case SQR: simd.f64sqr(c[op.dest], c[op.a], n); continue;
+            default: break;
+        }
+        switch (op.op) {
+            case TACOp::ADD:
+            case TACOp::SUB:
+            case TACOp::MUL:
+            case TACOp::DIV:
+                if (!op.f32) binaryF64(simd, op, c, n);
+                else if (op.op == TACOp::ADD) binaryF32(op, c, n, [](float x, float y) { return x + y; });
+                else if (op.op == TACOp::SUB) binaryF32(op, c, n, [](float x, float y) { return x - y; });
+                else if (op.op == TACOp::MUL) binaryF32(op, c, n, [](float x, float y) { return x * y; });
+                else binaryF32(op, c, n, [](float x, float y) { return x / y; });
+                break;
+            case TACOp::FMA: {
+                double *d = c[op.dest];
+                const double *a = c[op.a], *b = c[op.b], *z = c[op.c];
+                if (op.f32) for (size_t i = 0; i < n; ++i) d[i] = std::fmaf((float)a[i], (float)b[i], (float)z[i]);
+                else for (size_t i = 0; i < n; ++i) d[i] = std::fma(a[i], b[i], z[i]);
+                break;
+            }
+            case TACOp::ASSIGN: { // only F32 moves survive decoding
+                double *d = c[op.dest];
+                const double *a = c[op.a];
+                for (size_t i = 0; i < n; ++i) d[i] = (float)a[i];
+                break;
+            }
+            case TACOp::GUARD_NONZERO: {
+                const double *a = c[op.a];
+                bool bad = false;
+                for (size_t i = 0; i < failRow; ++i) bad |= !(a[i] != 0.0) | (a[i] != a[i]);
+                if (bad)
+                    for (size_t i = 0; i < failRow; ++i)
+                        if (a[i] == 0.0 || std::isnan(a[i])) { failRow = i; failOp = &op; failValue = a[i]; break; }
+                break;
+            }
+            case TACOp::GUARD_FINITE: {
+                const double *a = c[op.a];
+                bool bad = false;
+                for (size_t i = 0; i < failRow; ++i) bad |= !(a[i] - a[i] == 0.0); // inf - inf and NaN are NaN
+                if (bad)
+                    for (size_t i = 0; i < failRow; ++i)
+                        if (!std::isfinite(a[i])) { failRow = i; failOp = &op; failValue = a[i]; break; }
+                break;
+            }
+            default:
+                break;
+        }
+    }
+
+    for (const auto &oc : outputCopies) copy_n(c[oc.second], n, outputs[oc.first]);
+    return failRow;
+}
+
+void BatchInterpreter::run(const double *const *inputs, double *const *outputs, size_t n) {
+    const size_t ni = inputNames().size(), no = outputNames().size();
+    if (!isColumnar) {
+        rowIn.resize(ni);
+        rowOut.resize(no);
+        for (size_t s = 0; s < n; ++s) {
+            for (size_t k = 0; k < ni; ++k) rowIn[k] = inputs[k][s];
+            try {
+                scalar.run(rowIn.data(), rowOut.data());
+            } catch (const RuntimeError &e) {
+                throw RuntimeError(string(e.what()) + " (sample " + to_string(s) + ")", e.inst);
+            }
+            for (size_t k = 0; k < no; ++k) outputs[k][s] = rowOut[k];
+        }
+        return;
+    }
+    vector<const double *> in(ni);
+    vector<double *> out(no);
+    for (size_t first = 0; first < n; first += block) {
+        for (size_t k = 0; k < ni; ++k) in[k] = inputs[k] + first;
+        for (size_t k = 0; k < no; ++k) out[k] = outputs[k] + first;
+        const size_t m = min(block, n - first), done = runBlock(in.data(), out.data(), m);
+        if (done < m) guardFailed(*failOp, failValue, first + done);
+    }
+}
+
+void BatchInterpreter::runRows(const double *inputs, double *outputs, size_t n) {
+    const size_t ni = inputNames().size(), no = outputNames().size();
+    if (!isColumnar) {
+        for (size_t s = 0; s < n; ++s) {
+            try {
+                scalar.run(inputs + s * ni, outputs + s * no);
+            } catch (const RuntimeError &e) {
+                throw RuntimeError(string(e.what()) + " (sample " + to_string(s) + ")", e.inst);
+            }
+        }
+        return;
+    }
+    // transpose each block through staging columns
+    rowIn.resize(ni * block);
+    rowOut.resize(no * block);
+    vector<const double *> in(ni);
+    vector<double *> out(no);
+    for (size_t k = 0; k < ni; ++k) in[k] = rowIn.data() + k * block;
+    for (size_t k = 0; k < no; ++k) out[k] = rowOut.data() + k * block;
+    for (size_t first = 0; first < n; first += block) {
+        const size_t m = min(block, n - first);
+        for (size_t s = 0; s < m; ++s)
+            for (size_t k = 0; k < ni; ++k) rowIn[k * block + s] = inputs[(first + s) * ni + k];
+        const size_t done = runBlock(in.data(), out.data(), m);
+        for (size_t s = 0; s < done; ++s)
+            for (size_t k = 0; k < no; ++k) outputs[(first + s) * no + k] = rowOut[k * block + s];
+        if (done < m) guardFailed(*failOp, failValue, first + done);
+    }
+}
+
+void BatchInterpreter::print(ostream &out) const {
+    if (!isColumnar) {
+        out << "not columnar: state carries values between samples (" << scalar.stateNames().size()
+            << " state names), blocks run sample by sample\n";
+        return;
+    }
+    auto col = [&](int id) {
+        if (id < numInputs) return scalar.inputNames()[id];
+        if (id < numInputs + numBuffers) return "c" + to_string(id - numInputs);
+        if (id < numInputs + scratchColumns()) return "#" + formatLiteral(constValues[id - numInputs - numBuffers]);
+        return outputNames()[id - numInputs - scratchColumns()];
+    };
+    for (size_t i = 0; i < ops.size(); ++i) {
+        const ColOp &op = ops[i];
+        string a = op.form == SV ? formatLiteral(op.imm) : col(op.a);
+        string b = op.form == VS ? formatLiteral(op.imm) : op.b >= 0 ? col(op.b) : "";
+        out << i << ":\t";
+        const string k1 = formatLiteral(op.imm), k2 = formatLiteral(op.imm2);
+        switch (op.shape) {
+            case AXPB: out << col(op.dest) << "[] = " << col(op.a) << " * " << k1 << " + " << k2 << "\t(axpb)"; break;
+            case XMOG: out << col(op.dest) << "[] = (" << col(op.a) << " - " << k1 << ") * " << k2 << "\t(xmog)"; break;
+            case AXBY:
+                out << col(op.dest) << "[] = " << col(op.a) << " * " << k1 << " + " << col(op.b) << " * " << k2
+                    << "\t(axby)";
+                break;
+            case SQR: out << col(op.dest) << "[] = " << col(op.a) << " * " << col(op.a) << "\t(sqr)"; break;
+            default: break;
+        }
+        if (op.shape != NO_SHAPE) {
+            out << "\t// ";
+            printTacLine(scalar.program()[op.inst], out);
+            continue;
+        }
+        switch (op.op) {
+            case TACOp::ADD: out << col(op.dest) << "[] = " << a << " + " << b; break;
+            case TACOp::SUB: out << col(op.dest) << "[] = " << a << " - " << b; break;
+            case TACOp::MUL: out << col(op.dest) << "[] = " << a << " * " << b; break;
+            case TACOp::DIV: out << col(op.dest) << "[] = " << a << " / " << b; break;
+            case TACOp::FMA: out << col(op.dest) << "[] = fma(" << a << ", " << b << ", " << col(op.c) << ")"; break;
+            case TACOp::ASSIGN: out << col(op.dest) << "[] = f32(" << a << ")"; break;
+            case TACOp::GUARD_NONZERO: out << "check " << a << "[] != 0"; break;
+            case TACOp::GUARD_FINITE: out << "check isfinite(" << a << "[])"; break;
+            default: out << "NOP";
+        }
+        out << "\t// ";
+        printTacLine(scalar.program()[op.inst], out);
+    }
+    for (const auto &oc : outputCopies) out << "copy " << outputNames()[oc.first] << "[] = " << col(oc.second) << "[]\n";
+    out << "block=" << block << " samples, " << numBuffers << " scratch + " << numConsts
+        << " constant columns (" << workingSetBytes() / 1024 << " KiB)\n";
+}
@@ -0,0 +1,100 @@
+#ifndef BATCHINTERPRETER_H
+#define BATCHINTERPRETER_H
+
+#include "interpreter.h"
+#include "simdKernels.h"
+#include <vector>
+#include <string>
+#include <iostream>
+
+/*
+ * BatchInterpreter
+ *  - Columnar execution: samples are processed in blocks and every instruction runs
+ *    once over a whole column of the block, so dispatch is paid per block instead
+ *    of per sample (the vectorized query engine model).
+ *  - Inputs are read in place from the caller's columns and outputs are computed
+ *    straight into the caller's columns; every other value lives in a scratch column
+ *    of blockSize() doubles. Columns are recycled as soon as their value dies, and
+ *    the default block size keeps the scratch set within 256 KiB.
+ *  - Constants stay scalars: "x * 2.5" runs as a column-by-scalar loop, constant
+ *    subexpressions are folded while decoding and plain moves only rename columns.
+ *  - Float64 ADD/SUB/MUL/DIV run on the SimdKernels level picked for this CPU.
+ *  - Statements of the shapes x*a+b, (x-o)*g, x*a+y*b and x*x (a, b, o, g
+ *    constants, intermediates read by nothing else) are matched on the value graph
+ *    and run as one prebuilt shape kernel with the constants bound, instead of one
+ *    pass per instruction. Subtractions become additions of negated constants,
+ *    which IEEE arithmetic defines to round identically.
+ *  - Results match the reference Interpreter bit for bit, and so do guard failures:
+ *    RuntimeError names the lowest failing sample and, on that sample, the first
+ *    failing guard. Outputs are written in place, so rows before the reported
+ *    sample hold their results and later rows are unspecified.
+ *  - Programs with state carry values from one sample to the next and cannot run
+ *    column-wise: columnar() is false and blocks run sample by sample on an
+ *    Interpreter.
+ */
+class BatchInterpreter {
+public:
+    static const size_t MAX_BLOCK = 1024;
+    static const size_t CACHE_BUDGET = 256 * 1024; // bytes of scratch columns
+
+    // blockSize 0 picks the largest power of two up to MAX_BLOCK within CACHE_BUDGET.
+    explicit BatchInterpreter(const std::vector<TacInst> &tac, const SymbolTable *sym = nullptr,
+                              size_t blockSize = 0);
+
+    const std::vector<std::string> &inputNames() const { return scalar.inputNames(); }
+    const std::vector<std::string> &outputNames() const { return scalar.outputNames(); }
+
+    // Columnar: inputs[k] holds n values of input k, outputs[k] receives n values.
+    void run(const double *const *inputs, double *const *outputs, size_t n);
+    // Row-major: n rows of inputs/outputs stored one after another.
+    void runRows(const double *inputs, double *outputs, size_t n);
+
+    void reset(); // clear state (only meaningful when !columnar())
+
+    bool columnar() const { return isColumnar; }
+    size_t blockSize() const { return block; }
+    int scratchColumns() const { return numBuffers + numConsts; }
+    size_t workingSetBytes() const { return (size_t)scratchColumns() * block * sizeof(double); }
+
+    // Column instruction. Column ids: inputs, scratch buffers, constants, outputs.
+    enum Form { VV, VS, SV }; // which operand of a binary op is a scalar
+    enum Shape { NO_SHAPE, AXPB, XMOG, AXBY, SQR }; // see SimdKernelTable
+    struct ColOp {
+        TACOp op;
+        bool f32;
+        Form form;
+        int dest, a, b, c; // column ids, -1 when unused or scalar
+        double imm;        // the scalar operand (VS/SV); first constant of a shape
+        int inst;          // TAC index, for guard messages; the last one of a shape
+        Shape shape = NO_SHAPE; // a: x, b: y (AXBY)
+        double imm2 = 0;        // second constant of a shape
+    };
+    const std::vector<ColOp> &code() const { return ops; }
+
+    // Column plan: one line per column instruction.
+    void print(std::ostream &out = std::cout) const;
+
+private:
+
+    Interpreter scalar; // interface, and the executor when !columnar()
+    bool isColumnar;
+    const SimdKernelTable &simd;
+    size_t block = MAX_BLOCK;
+    std::vector<ColOp> ops;
+    int numInputs = 0, numBuffers = 0, numConsts = 0;
+    std::vector<double> constValues;     // value of each constant column
+    std::vector<std::pair<int, int>> outputCopies; // (output, column) not computed in place
+    std::vector<double> scratch;         // buffers, then constant columns
+    std::vector<double *> cols;          // column id -> data of the current block
+    std::vector<double> rowIn, rowOut;   // staging for runRows
+
+    const ColOp *failOp = nullptr;       // guard failure of the last block
+    double failValue = 0;
+
+    // inputs/outputs already point at the block. Returns the rows before the first
+    // guard failure (n when none failed); failOp/failValue describe the failure.
+    size_t runBlock(const double *const *inputs, double *const *outputs, size_t n);
+    [[noreturn]] void guardFailed(const ColOp &op, double value, size_t sample) const;
+};
+
+#endif // BATCHINTERPRETER_H
@@ -0,0 +1,246 @@
+#include "bytecode.h"
+#include "../tac/tacInfo.h"
+#include <map>
+#include <stdexcept>
+#include <cstring>
+
+using namespace std;
+
+int Bytecode::operandBytes(BcOp op) {
+    switch (op) {
+        case BcOp::LOAD_CONST: case BcOp::MOVE: case BcOp::MOVE_F32: return 4;
+        case BcOp::ADD: case BcOp::SUB: case BcOp::MUL: case BcOp::DIV:
+        case BcOp::ADD_F32: case BcOp::SUB_F32: case BcOp::MUL_F32: case BcOp::DIV_F32:
+        case BcOp::ADD_IMM: case BcOp::SUB_IMM: case BcOp::RSUB_IMM:
+        case BcOp::MUL_IMM: case BcOp::DIV_IMM: case BcOp::RDIV_IMM: return 6;
+        case BcOp::FMA: case BcOp::FMA_F32: case BcOp::SUB_MOVE: case BcOp::MUL_MOVE: return 8;
+        case BcOp::MUL_IMM_ADD: case BcOp::MUL_IMM_SUB: case BcOp::MUL_IMM_RSUB: return 10;
+        case BcOp::GUARD_NONZERO: case BcOp::GUARD_FINITE: return 2;
+        default: return 0;
+    }
+}
+
+string Bytecode::opName(BcOp op) {
+    static const char *names[] = {"LOAD_CONST", "MOVE", "ADD", "SUB", "MUL", "DIV", "FMA",
+                                  "ADD_F32", "SUB_F32", "MUL_F32", "DIV_F32", "FMA_F32", "MOVE_F32",
+                                  "GUARD_NONZERO", "GUARD_FINITE",
+                                  "ADD_IMM", "SUB_IMM", "RSUB_IMM", "MUL_IMM", "DIV_IMM", "RDIV_IMM",
+                                  "MUL_IMM_ADD", "MUL_IMM_SUB", "MUL_IMM_RSUB", "SUB_MOVE", "MUL_MOVE", "HALT"};
+    static_assert(sizeof(names) / sizeof(names[0]) == (size_t)BcOp::COUNT, "one name per opcode");
+    return op < BcOp::COUNT ? names[(int)op] : "?";
+}
+
+int Bytecode::constOperand(BcOp op) {
+    switch (op) {
+        case BcOp::LOAD_CONST: return 1;
+        case BcOp::ADD_IMM: case BcOp::SUB_IMM: case BcOp::RSUB_IMM:
+        case BcOp::MUL_IMM: case BcOp::DIV_IMM: case BcOp::RDIV_IMM:
+        case BcOp::MUL_IMM_ADD: case BcOp::MUL_IMM_SUB: case BcOp::MUL_IMM_RSUB: return 2;
+        default: return -1;
+    }
+}
+
+static void put16(vector<uint8_t> &code, int v) {
+    code.push_back((uint8_t)(v & 0xff));
+    code.push_back((uint8_t)((v >> 8) & 0xff));
+}
+
+// One instruction before encoding: opcode and its 16-bit operands.
+struct BcInst {
+    BcOp op;
+    vector<int> ops;
+};
+
+// Replace adjacent pairs where the second instruction reads the first's result by
+// the matching superinstruction.
+static vector<BcInst> fusePairs(const vector<BcInst> &in) {
+    vector<BcInst> out;
+    for (size_t i = 0; i < in.size(); ++i) {
+        if (i + 1 < in.size()) {
+            const BcInst &a = in[i], &b = in[i + 1];
+            const int t = a.ops.empty() ? -1 : a.ops[0];
+            if (a.op == BcOp::MUL_IMM && b.op == BcOp::ADD && (b.ops[1] == t || b.ops[2] == t)) {
+                out.push_back({BcOp::MUL_IMM_ADD, {t, a.ops[1], a.ops[2], b.ops[0], b.ops[1] == t ? b.ops[2] : b.ops[1]}});
+                ++i;
+                continue;
+            }
+            if (a.op == BcOp::MUL_IMM && b.op == BcOp::SUB && (b.ops[1] == t || b.ops[2] == t)) {
+                out.push_back({b.ops[1] == t ? BcOp::MUL_IMM_SUB : BcOp::MUL_IMM_RSUB,
+                               {t, a.ops[1], a.ops[2], b.ops[0], b.ops[1] == t ? b.ops[2] : b.ops[1]}});
+                ++i;
+                continue;
+            }
+            if ((a.op == BcOp::SUB || a.op == BcOp::MUL) && b.op == BcOp::MOVE && b.ops[1] == t) {
+                out.push_back({a.op == BcOp::SUB ? BcOp::SUB_MOVE : BcOp::MUL_MOVE, {t, a.ops[1], a.ops[2], b.ops[0]}});
+                ++i;
+                continue;
+            }
+        }
+        out.push_back(in[i]);
+    }
+    return out;
+}
+
+static int get16(const uint8_t *p) { return p[0] | (p[1] << 8); }
+
+// Immediate opcode for op with its constant on the right (arg2) or the left (arg1).
+static BcOp immediateOp(TACOp op, bool constOnLeft) {
+    switch (op) {
+        case TACOp::ADD: return BcOp::ADD_IMM;
+        case TACOp::SUB: return constOnLeft ? BcOp::RSUB_IMM : BcOp::SUB_IMM;
+        case TACOp::MUL: return BcOp::MUL_IMM;
+        default: return constOnLeft ? BcOp::RDIV_IMM : BcOp::DIV_IMM;
+    }
+}
+
+Bytecode Bytecode::compile(const vector<TacInst> &tac, const SymbolTable *sym, const BcOptions &options) {
+    Bytecode bc;
+    TacInterface iface = describeInterface(tac, sym);
+    bc.inputs = iface.inputs;
+    bc.outputs = iface.outputs;
+    bc.state = iface.state;
+
+    map<string, int> slots;
+    auto slot = [&](const string &name) {
+        auto it = slots.find(name);
+        if (it != slots.end()) return it->second;
+        int s = (int)slots.size();
+        if (s >= MAX_SLOTS) throw length_error("program needs more than 65536 frame slots");
+        slots[name] = s;
+        bc.slotNames.push_back(name);
+        return s;
+    };
+    for (const auto &n : iface.inputs) bc.inputSlots.push_back((uint16_t)slot(n));
+    for (const auto &n : iface.state) bc.stateSlots.push_back((uint16_t)slot(n));
+    for (const auto &n : iface.outputs) bc.outputSlots.push_back((uint16_t)slot(n));
+
+    // keyed on the bit pattern: -0.0 == 0.0, but the two must get separate entries
+    map<uint64_t, int> constIndex;
+    auto constant = [&](double v) {
+        uint64_t bits;
+        memcpy(&bits, &v, 8);
+        auto k = constIndex.find(bits);
+        if (k == constIndex.end()) {
+            if (bc.consts.size() >= (size_t)MAX_SLOTS) throw length_error("more than 65536 constants");
+            k = constIndex.emplace(bits, (int)bc.consts.size()).first;
+            bc.consts.push_back(v);
+        }
+        return k->second;
+    };
+    auto constValue = [&](const TacInst &def) {
+        double v = literalValue(def.arg1Literal);
+        return def.prec == TacPrecision::F32 ? (double)(float)v : v;
+    };
+
+    // Which operand of each F64 instruction is taken from the constant pool (1 = arg1,
+    // 2 = arg2) and which LOAD_CONSTs are still read through the frame.
+    vector<int> constDef(tac.size() * 3, -1), immArg(tac.size(), 0);
+    vector<char> needed(tac.size(), !options.immediates);
+    map<string, int> lastDef;
+    auto loadedBy = [&](const string &name) {
+        auto it = lastDef.find(name);
+        return it != lastDef.end() && tac[it->second].op == TACOp::LOAD_CONST ? it->second : -1;
+    };
+    for (size_t i = 0; i < tac.size(); ++i) {
+        const TacInst &inst = tac[i];
+        vector<string> uses = usesOf(inst);
+        for (size_t u = 0; u < uses.size(); ++u) constDef[i * 3 + u] = loadedBy(uses[u]);
+        if (options.immediates && inst.prec == TacPrecision::F64) {
+            if (inst.op == TACOp::ASSIGN && constDef[i * 3] >= 0) immArg[i] = 1;
+            if (inst.op == TACOp::ADD || inst.op == TACOp::SUB || inst.op == TACOp::MUL || inst.op == TACOp::DIV)
+                immArg[i] = constDef[i * 3 + 1] >= 0 ? 2 : constDef[i * 3] >= 0 ? 1 : 0;
+        }
+        for (size_t u = 0; u < uses.size(); ++u)
+            if (constDef[i * 3 + u] >= 0 && (int)u + 1 != immArg[i]) needed[constDef[i * 3 + u]] = 1;
+        if (!inst.dest.empty()) lastDef[inst.dest] = (int)i;
+    }
+    for (const auto &names : {iface.outputs, iface.state})
+        for (const auto &n : names)
+            if (loadedBy(n) >= 0) needed[loadedBy(n)] = 1;
+
+    vector<BcInst> insts;
+    for (size_t i = 0; i < tac.size(); ++i) {
+        const TacInst &inst = tac[i];
+        const bool f32 = inst.prec == TacPrecision::F32;
+        BcOp op;
+        switch (inst.op) {
+            case TACOp::LOAD_CONST:
+                if (needed[i]) insts.push_back({BcOp::LOAD_CONST, {slot(inst.dest), constant(constValue(inst))}});
+                continue;
+            case TACOp::ASSIGN:
+                if (immArg[i]) { // a copy of a constant is a constant
+                    insts.push_back({BcOp::LOAD_CONST, {slot(inst.dest), constant(constValue(tac[constDef[i * 3]]))}});
+                    continue;
+                }
+                op = f32 ? BcOp::MOVE_F32 : BcOp::MOVE;
+                break;
+            case TACOp::ADD:
+            case TACOp::SUB:
+            case TACOp::MUL:
+            case TACOp::DIV:
+                if (immArg[i]) {
+                    const int k = immArg[i] - 1;
+                    insts.push_back({immediateOp(inst.op, k == 0), {slot(inst.dest), slot(k == 0 ? inst.arg2 : inst.arg1),
+                                                                    constant(constValue(tac[constDef[i * 3 + k]]))}});
+                    continue;
+                }
+                op = inst.op == TACOp::ADD ? (f32 ? BcOp::ADD_F32 : BcOp::ADD)
+                   : inst.op == TACOp::SUB ? (f32 ? BcOp::SUB_F32 : BcOp::SUB)
+                   : inst.op == TACOp::MUL ? (f32 ? BcOp::MUL_F32 : BcOp::MUL)
+                   : (f32 ? BcOp::DIV_F32 : BcOp::DIV);
+                break;
+            case TACOp::FMA: op = f32 ? BcOp::FMA_F32 : BcOp::FMA; break;
+            case TACOp::GUARD_NONZERO: op = BcOp::GUARD_NONZERO; break;
+            case TACOp::GUARD_FINITE: op = BcOp::GUARD_FINITE; break;
+            default: continue;
+        }
+        BcInst bi{op, {}};
+        if (!inst.dest.empty()) bi.ops.push_back(slot(inst.dest));
+        for (const auto &u : usesOf(inst)) bi.ops.push_back(slot(u));
+        insts.push_back(bi);
+    }
+
+    if (options.superinstructions) insts = fusePairs(insts);
+    for (const auto &bi : insts) {
+        bc.code.push_back((uint8_t)bi.op);
+        for (int v : bi.ops) put16(bc.code, v);
+    }
+    bc.code.push_back((uint8_t)BcOp::HALT);
+    bc.numSlots = (int)slots.size();
+    return bc;
+}
+
+void Bytecode::countPairs(map<pair<BcOp, BcOp>, size_t> &counts) const {
+    // slot written by the previous instruction, or -1
+    int written = -1;
+    BcOp prev = BcOp::HALT;
+    for (size_t pc = 0; pc < code.size();) {
+        BcOp op = (BcOp)code[pc];
+        const int n = operandBytes(op) / 2;
+        const bool guard = op == BcOp::GUARD_NONZERO || op == BcOp::GUARD_FINITE;
+        bool reads = false;
+        for (int k = guard ? 0 : 1; k < n; ++k)
+            if (k != constOperand(op) && get16(&code[pc + 1 + 2 * k]) == written) reads = true;
+        if (reads) ++counts[{prev, op}];
+        written = n > 0 && !guard ? get16(&code[pc + 1]) : -1;
+        prev = op;
+        pc += 1 + 2 * n;
+    }
+}
+
+void Bytecode::disassemble(ostream &out) const {
+    size_t pc = 0;
+    while (pc < code.size()) {
+        BcOp op = (BcOp)code[pc];
+        out << pc << ":\t" << opName(op);
+        int n = operandBytes(op);
+        for (int k = 0; k < n; k += 2) {
+            int v = get16(&code[pc + 1 + k]);
+            if (k == 2 * constOperand(op)) out << " #" << formatLiteral(consts[v]);
+            else out << " s" << v << "(" << slotNames[v] << ")";
+        }
+        out << "\n";
+        pc += 1 + n;
+    }
+    out << code.size() << " bytes, " << consts.size() << " constants, " << numSlots << " slots\n";
+}
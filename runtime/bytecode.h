@@ -0,0 +1,80 @@
+#ifndef BYTECODE_H
+#define BYTECODE_H
+
+#include "../tac/tac.h"
+#include "../symbolTable/symbolTable.h"
+#include <vector>
+#include <map>
+#include <string>
+#include <cstdint>
+#include <iostream>
+
+/*
+ * Bytecode
+ *  - Compact executable form of a TAC program for the VM: 1-byte opcodes followed
+ *    by 16-bit little-endian frame-slot operands (LOAD_CONST takes a 16-bit index
+ *    into the constant pool).
+ *  - F32 instructions get their own opcodes so the VM never tests precision.
+ *  - Frame layout matches the reference Interpreter: inputs, then state, then
+ *    outputs, then every other name in order of appearance.
+ *
+ *      LOAD_CONST d k | MOVE d a | ADD/SUB/MUL/DIV[_F32] d a b | FMA[_F32] d a b c
+ *      ADD/SUB/MUL/DIV_IMM d a k   (d = a op k)   RSUB/RDIV_IMM d a k   (d = k op a)
+ *      GUARD_NONZERO a | GUARD_FINITE a | HALT
+ *      superinstructions (t is written too, so no liveness is needed):
+ *      MUL_IMM_ADD t a k d c    (t = a * k; d = t + c)
+ *      MUL_IMM_SUB t a k d c    (t = a * k; d = t - c)   MUL_IMM_RSUB: d = c - t
+ *      SUB_MOVE/MUL_MOVE t a b d   (t = a op b; d = t)
+ *
+ *  - Immediate forms: an F64 operand whose value comes from a LOAD_CONST is read
+ *    straight from the constant pool, and the LOAD_CONST (and its frame slot) is
+ *    dropped once no other instruction needs it.
+ *  - The superinstructions are the most frequent dependent pairs that
+ *    `SignalBench --pairs` finds in the example and generated programs; pairs are
+ *    fused only when adjacent, so each one saves a dispatch and an operand decode.
+ */
+enum class BcOp : uint8_t {
+    LOAD_CONST, MOVE,
+    ADD, SUB, MUL, DIV, FMA,
+    ADD_F32, SUB_F32, MUL_F32, DIV_F32, FMA_F32, MOVE_F32,
+    GUARD_NONZERO, GUARD_FINITE,
+    ADD_IMM, SUB_IMM, RSUB_IMM, MUL_IMM, DIV_IMM, RDIV_IMM,
+    MUL_IMM_ADD, MUL_IMM_SUB, MUL_IMM_RSUB, SUB_MOVE, MUL_MOVE,
+    HALT,
+    COUNT
+};
+
+struct BcOptions {
+    bool immediates = true;        // ADD/SUB/MUL/DIV_IMM and friends
+    bool superinstructions = true; // fuse adjacent dependent pairs
+};
+
+struct Bytecode {
+    std::vector<uint8_t> code;
+    std::vector<double> consts;
+    int numSlots = 0;
+    std::vector<uint16_t> inputSlots, stateSlots, outputSlots;
+    std::vector<std::string> inputs, outputs, state;
+    std::vector<std::string> slotNames; // slot -> TAC name (for messages)
+
+    static const int MAX_SLOTS = 65536;
+
+    // Operand bytes following each opcode.
+    static int operandBytes(BcOp op);
+    static std::string opName(BcOp op);
+    // Index of the operand holding a constant-pool index, or -1.
+    static int constOperand(BcOp op);
+
+    // Lower TAC; throws std::length_error when the frame needs more than 16-bit slots.
+    static Bytecode compile(const std::vector<TacInst> &tac, const SymbolTable *sym = nullptr,
+                            const BcOptions &options = BcOptions());
+
+    // Adjacent instruction pairs where the second reads what the first wrote, counted
+    // by opcode: the raw data for choosing superinstructions (so count bytecode
+    // compiled without them).
+    void countPairs(std::map<std::pair<BcOp, BcOp>, size_t> &counts) const;
+
+    void disassemble(std::ostream &out = std::cout) const;
+};
+
+#endif // BYTECODE_H
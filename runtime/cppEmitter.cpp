@@ -0,0 +1,158 @@
+#include "cppEmitter.h"
+#include "../tac/tacInfo.h"
+#include <map>
+#include <sstream>
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include <algorithm>
+
+using namespace std;
+
+// Exact C++ spelling of a double.
+static string cppLiteral(double v) {
+    if (std::isnan(v)) return "__builtin_nan(\"\")";
+    if (std::isinf(v)) return v > 0 ? "__builtin_inf()" : "(-__builtin_inf())";
+    char buf[64];
+    snprintf(buf, sizeof buf, "%a", v);
+    return string("(") + buf + ")";
+}
+
+// One sample of the program; in(k)/out(k) spell the k-th input/output of sample s.
+static void emitBody(const vector<TacInst> &tac, const TacInterface &iface, ostringstream &src,
+                     const function<string(int)> &in, const function<string(int)> &out) {
+    map<string, string> cur; // TAC name -> C++ expression holding its current value
+    for (size_t k = 0; k < iface.inputs.size(); ++k) {
+        src << "        const double i" << k << " = " << in((int)k) << "; // " << iface.inputs[k] << "\n";
+        cur[iface.inputs[k]] = "i" + to_string(k);
+    }
+    for (size_t k = 0; k < iface.state.size(); ++k) cur[iface.state[k]] = "st" + to_string(k);
+
+    auto saveState = [&](const string &indent) {
+        for (size_t k = 0; k < iface.state.size(); ++k) src << indent << "state[" << k << "] = st" << k << ";\n";
+    };
+
+    int next = 0;
+    for (size_t i = 0; i < tac.size(); ++i) {
+        const TacInst &inst = tac[i];
+        const bool f32 = inst.prec == TacPrecision::F32;
+        auto arg = [&](const string &name) {
+            auto it = cur.find(name);
+            return it != cur.end() ? it->second : string("0.0");
+        };
+        auto f = [&](const string &name) { return "(float)" + arg(name); };
+        string expr;
+        switch (inst.op) {
+            case TACOp::LOAD_CONST: {
+                double v = literalValue(inst.arg1Literal);
+                cur[inst.dest] = cppLiteral(f32 ? (double)(float)v : v);
+                continue;
+            }
+            case TACOp::ASSIGN:
+                if (!f32) { cur[inst.dest] = arg(inst.arg1); continue; }
+                expr = "(double)" + f(inst.arg1);
+                break;
+            case TACOp::ADD:
+            case TACOp::SUB:
+            case TACOp::MUL:
+            case TACOp::DIV: {
+                const char *op = inst.op == TACOp::ADD ? " + " : inst.op == TACOp::SUB ? " - "
+                               : inst.op == TACOp::MUL ? " * " : " / ";
+                expr = f32 ? "(double)(" + f(inst.arg1) + op + f(inst.arg2) + ")" : arg(inst.arg1) + op + arg(inst.arg2);
+                break;
+            }
+            case TACOp::FMA:
+                expr = f32 ? "(double)std::fmaf(" + f(inst.arg1) + ", " + f(inst.arg2) + ", " + f(inst.arg3) + ")"
+                           : "std::fma(" + arg(inst.arg1) + ", " + arg(inst.arg2) + ", " + arg(inst.arg3) + ")";
+                break;
+            case TACOp::GUARD_NONZERO:
+            case TACOp::GUARD_FINITE: {
+                const string a = arg(inst.arg1);
+                src << "        if (" << (inst.op == TACOp::GUARD_NONZERO ? a + " == 0.0 || " + a + " != " + a
+                                                                        : "!(" + a + " - " + a + " == 0.0)")
+                    << ") {\n            st->guard = " << i << ";\n            st->value = " << a << ";\n";
+                saveState("            ");
+                src << "            return s;\n        }\n";
+                continue;
+            }
+            default:
+                continue;
+        }
+        const string v = "v" + to_string(next++);
+        src << "        const double " << v << " = " << expr << "; // " << inst.dest << "\n";
+        cur[inst.dest] = v;
+    }
+
+    for (size_t k = 0; k < iface.outputs.size(); ++k) src << "        " << out((int)k) << " = " << cur[iface.outputs[k]] << ";\n";
+    // next state into fresh locals first: a state update may read another state's old value
+    // (z2 = z1; z1 = x), so no stK is overwritten before every new value is known
+    vector<size_t> changed;
+    for (size_t k = 0; k < iface.state.size(); ++k) {
+        if (cur[iface.state[k]] == "st" + to_string(k)) continue;
+        src << "        const double ns" << k << " = " << cur[iface.state[k]] << ";\n";
+        changed.push_back(k);
+    }
+    for (size_t k : changed) src << "        st" << k << " = ns" << k << ";\n";
+}
+
+string CppEmitter::emit(const vector<TacInst> &tac, const SymbolTable *sym) {
+    TacInterface iface = describeInterface(tac, sym);
+    const size_t ni = iface.inputs.size(), no = iface.outputs.size();
+    ostringstream src;
+    src << "// Generated by SignalLang from " << tac.size() << " TAC instructions.\n"
+        << "// inputs:";
+    for (const auto &n : iface.inputs) src << " " << n;
+    src << "\n// outputs:";
+    for (const auto &n : iface.outputs) src << " " << n;
+    src << "\n// state:";
+    for (const auto &n : iface.state) src << " " << n;
+    src << "\n#include <cmath>\n#include <cstddef>\n\n"
+        << "struct signal_status {\n    int guard;\n    int pad;\n    double value;\n};\n";
+
+    auto loop = [&](const string &signature, const string &prologue, const function<string(int)> &in,
+                    const function<string(int)> &out) {
+        src << "\nextern \"C\" size_t " << signature << " {\n" << prologue;
+        for (size_t k = 0; k < iface.state.size(); ++k) src << "    double st" << k << " = state[" << k << "];\n";
+        src << "    (void)state;\n    (void)st;\n    for (size_t s = 0; s < n; ++s) {\n";
+        emitBody(tac, iface, src, in, out);
+        src << "    }\n";
+        for (size_t k = 0; k < iface.state.size(); ++k) src << "    state[" << k << "] = st" << k << ";\n";
+        src << "    return n;\n}\n";
+    };
+
+    ostringstream cols;
+    for (size_t k = 0; k < ni; ++k) cols << "    const double *__restrict in" << k << " = in[" << k << "];\n";
+    for (size_t k = 0; k < no; ++k) cols << "    double *__restrict out" << k << " = out[" << k << "];\n";
+    loop("signal_columns(const double *const *in, double *const *out, size_t n, double *state, signal_status *st)",
+         cols.str() + "    (void)in;\n    (void)out;\n", [](int k) { return "in" + to_string(k) + "[s]"; },
+         [](int k) { return "out" + to_string(k) + "[s]"; });
+
+    // Small programs get their own row loop. Large ones go through the column loop in
+    // blocks (at most 64 KiB of stack) so the body is compiled only once: host compile
+    // time grows faster than the program.
+    if (tac.size() <= DIRECT_ROWS_LIMIT) {
+        loop("signal_rows(const double *__restrict in, double *__restrict out, size_t n, double *state, "
+             "signal_status *st)",
+             "", [&](int k) { return "in[s * " + to_string(ni) + " + " + to_string(k) + "]"; },
+             [&](int k) { return "out[s * " + to_string(no) + " + " + to_string(k) + "]"; });
+        return src.str();
+    }
+    const size_t block = max<size_t>(1, min<size_t>(256, 65536 / (8 * (ni + no + 1))));
+    src << "\nextern \"C\" size_t signal_rows(const double *in, double *out, size_t n, double *state, "
+           "signal_status *st) {\n"
+        << "    const size_t B = " << block << ", NI = " << ni << ", NO = " << no << ";\n"
+        << "    double ib[NI + 1][B], ob[NO + 1][B];\n"
+        << "    const double *ip[NI + 1];\n    double *op[NO + 1];\n"
+        << "    for (size_t k = 0; k < NI; ++k) ip[k] = ib[k];\n"
+        << "    for (size_t k = 0; k < NO; ++k) op[k] = ob[k];\n"
+        << "    for (size_t first = 0; first < n; first += B) {\n"
+        << "        const size_t m = n - first < B ? n - first : B;\n"
+        << "        for (size_t s = 0; s < m; ++s)\n"
+        << "            for (size_t k = 0; k < NI; ++k) ib[k][s] = in[(first + s) * NI + k];\n"
+        << "        const size_t done = signal_columns(ip, op, m, state, st);\n"
+        << "        for (size_t s = 0; s < done; ++s)\n"
+        << "            for (size_t k = 0; k < NO; ++k) out[(first + s) * NO + k] = ob[k][s];\n"
+        << "        if (done < m) return first + done;\n"
+        << "    }\n    return n;\n}\n";
+    return src.str();
+}
@@ -0,0 +1,38 @@
+#ifndef CPPEMITTER_H
+#define CPPEMITTER_H
+
+#include "../tac/tac.h"
+#include "../symbolTable/symbolTable.h"
+#include <string>
+#include <vector>
+
+/*
+ * CppEmitter
+ *  - Turns a TAC program into a self-contained C++ translation unit (only <cmath>
+ *    and <cstddef>) exporting two batch loops:
+ *
+ *      extern "C" size_t signal_rows(const double *in, double *out, size_t n,
+ *                                    double *state, signal_status *st);
+ *      extern "C" size_t signal_columns(const double *const *in, double *const *out,
+ *                                       size_t n, double *state, signal_status *st);
+ *
+ *    Both return the number of samples completed; a failing guard stops the loop
+ *    and fills st (TAC index of the guard, value it checked) like JitKernel does.
+ *  - Every TAC definition becomes a fresh const local and plain moves vanish, so the
+ *    body is straight-line scalar code; the column loop reads and writes through
+ *    __restrict pointers, which lets the host compiler vectorize it when the
+ *    program has neither guards nor state. Above DIRECT_ROWS_LIMIT instructions the
+ *    row loop transposes through small column blocks instead of repeating the body,
+ *    which halves the host compile time.
+ *  - Constants are printed as hex floats, F32 instructions round through float and
+ *    FMA calls std::fma, so the code is bitwise equal to the Interpreter as long as
+ *    it is built without floating-point contraction (-ffp-contract=off).
+ */
+class CppEmitter {
+public:
+    static constexpr size_t DIRECT_ROWS_LIMIT = 512;
+
+    static std::string emit(const std::vector<TacInst> &tac, const SymbolTable *sym = nullptr);
+};
+
+#endif // CPPEMITTER_H
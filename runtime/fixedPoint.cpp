@@ -0,0 +1,577 @@
+#include "fixedPoint.h"
+#include <cmath>
+#include <limits>
+#include <sstream>
+#include <algorithm>
+#include <type_traits>
+#include <stdexcept>
+
+using namespace std;
+
+static const size_t BLOCK = 256; // samples per column block
+
+static int64_t storageLo(int bits) { return -(int64_t(1) << (bits - 1)); }
+static int64_t storageHi(int bits) { return (int64_t(1) << (bits - 1)) - 1; }
+static int64_t wideLo(int bits) { return bits == 16 ? numeric_limits<int32_t>::min() : numeric_limits<int64_t>::min(); }
+static int64_t wideHi(int bits) { return bits == 16 ? numeric_limits<int32_t>::max() : numeric_limits<int64_t>::max(); }
+
+// Most fraction bits that keep maxAbs inside the storage width.
+static int chooseFrac(double maxAbs, int bits) {
+    if (maxAbs == 0) return bits - 1;
+    int e;
+    frexp(maxAbs, &e); // maxAbs < 2^e
+    int f = bits - 1 - e;
+    while (ldexp(maxAbs, f) > (double)storageHi(bits)) --f;
+    return f;
+}
+
+// Requantize by s fraction bits (s < 0 drops bits, rounding to nearest), saturating
+// to the storage width.
+static FxShift requant(int s, int bits) {
+    FxShift x{wideLo(bits), wideHi(bits), 0, 0, 0, storageLo(bits), storageHi(bits)};
+    if (s >= 0) {
+        x.left = min(s, bits); // any nonzero value saturates from here on
+        x.lo = storageLo(bits) >> x.left;
+        x.hi = storageHi(bits) >> x.left;
+    } else if (-s <= 2 * bits - 2) {
+        x.right = -s;
+        x.bias = int64_t(1) << (x.right - 1);
+    } else {
+        x.lo = x.hi = 0; // intermediates are below 2^(2*bits-2): they round to zero
+    }
+    return x;
+}
+
+// Align an ADD/SUB operand; the sum has headroom, so nothing saturates.
+static FxShift align(int s, int bits) {
+    FxShift x = requant(s, bits);
+    if (s >= 0) {
+        x.lo = wideLo(bits);
+        x.hi = wideHi(bits);
+    }
+    x.outLo = wideLo(bits);
+    x.outHi = wideHi(bits);
+    return x;
+}
+
+// Half a unit of the result when bits are dropped.
+static double dropped(int s, int fracAfter) { return s < 0 ? ldexp(1.0, -fracAfter - 1) : 0.0; }
+
+template <class Wide> static inline Wide applyShift(const FxShift &s, Wide v) {
+    typedef typename make_unsigned<Wide>::type U;
+    v = v < (Wide)s.lo ? (Wide)s.lo : v > (Wide)s.hi ? (Wide)s.hi : v;
+    v = (Wide)((U)v << s.left);
+    v = (v + (Wide)s.bias) >> s.right;
+    return v < (Wide)s.outLo ? (Wide)s.outLo : v > (Wide)s.outHi ? (Wide)s.outHi : v;
+}
+
+// Quotient rounded to nearest, ties away from zero.
+template <class Wide> static inline Wide roundDiv(Wide n, Wide d) {
+    typedef typename make_unsigned<Wide>::type U;
+    const bool neg = (n < 0) != (d < 0);
+    const U un = n < 0 ? (U)0 - (U)n : (U)n, ud = d < 0 ? (U)0 - (U)d : (U)d;
+    const U q = (un + ud / 2) / ud;
+    return neg ? (Wide)((U)0 - q) : (Wide)q;
+}
+
+template <class Wide> static inline Wide divide(const FxInst &in, Wide a, Wide b, int bits) {
+    typedef typename make_unsigned<Wide>::type U;
+    if (b == 0) return a > 0 ? (Wide)storageHi(bits) : a < 0 ? (Wide)storageLo(bits) : 0;
+    return applyShift<Wide>(in.r, roundDiv<Wide>((Wide)((U)a << in.pre), b));
+}
+
+string FixedPointKernel::formatName(int f, int bits) {
+    return "Q" + to_string(bits - 1 - f) + "." + to_string(f);
+}
+
+FixedPointKernel::FixedPointKernel(const vector<TacInst> &tac, const SymbolTable *sym,
+                                   const map<string, Interval> &inputRanges, const FixedPointOptions &options)
+    : fallback(tac, sym), width(options.bits == 32 ? 32 : 16) {
+    if (!build(tac, inputRanges)) {
+        insts.clear();
+        outErr.assign(outputNames().size(), numeric_limits<double>::infinity());
+    }
+    frame.assign(frac.size(), 0);
+}
+
+bool FixedPointKernel::build(const vector<TacInst> &tac, const map<string, Interval> &ranges) {
+    vector<Interval> slotRange;
+    map<string, int> cur; // TAC name -> slot holding its current value
+    auto slot = [&](const string &name, const Interval &r) {
+        frac.push_back(chooseFrac(r.maxAbs(), width));
+        names.push_back(name);
+        slotRange.push_back(r);
+        return (int)frac.size() - 1;
+    };
+    auto declared = [&](const string &name, const char *what, vector<int> &slots) {
+        auto it = ranges.find(name);
+        if (it == ranges.end() || !it->second.isFinite()) {
+            reason = string("no declared range for ") + what + " '" + name + "'";
+            return false;
+        }
+        slots.push_back(cur[name] = slot(name, it->second));
+        return true;
+    };
+    for (const auto &name : inputNames()) {
+        if (!declared(name, "input", inSlots)) return false;
+        inRange.push_back(ranges.at(name));
+    }
+    for (const auto &name : stateNames())
+        if (!declared(name, "state", stateSlots)) return false;
+
+    RangeInfo info = RangeAnalysis::analyze(tac, ranges);
+    auto arith = [&](FxOp op, int dest, int a, int b) {
+        FxInst in;
+        in.op = op;
+        in.dest = dest;
+        in.a = a;
+        in.b = b;
+        const int fa = frac[a], fb = frac[b], g = frac[dest];
+        if (op == FxOp::ADD || op == FxOp::SUB) {
+            const int c = min(max(fa, fb), min(fa, fb) + width - 3); // keeps the sum below 2^(2*width-3)
+            in.sa = align(c - fa, width);
+            in.sb = align(c - fb, width);
+            in.r = requant(g - c, width);
+            in.round = dropped(c - fa, c) + dropped(c - fb, c) + dropped(g - c, g);
+        } else if (op == FxOp::MUL) {
+            in.r = requant(g - fa - fb, width);
+            in.round = dropped(g - fa - fb, g);
+        } else { // DIV
+            in.pre = max(0, min(g - fa + fb, width - 2));
+            const int q = fa + in.pre - fb;
+            in.r = requant(g - q, width);
+            in.round = ldexp(1.0, -q - 1) + dropped(g - q, g);
+        }
+        return in;
+    };
+
+    for (size_t i = 0; i < tac.size(); ++i) {
+        const TacInst &t = tac[i];
+        const Interval &r = info.result[i];
+        auto operand = [&](const string &name) { return cur.at(name); };
+        switch (t.op) {
+            case TACOp::LOAD_CONST: {
+                const double c = literalValue(t.arg1Literal);
+                if (!std::isfinite(c)) {
+                    reason = "constant " + t.arg1Literal + " has no fixed-point value";
+                    return false;
+                }
+                FxInst in;
+                in.op = FxOp::CONST;
+                in.dest = cur[t.dest] = slot(t.dest, Interval::point(c));
+                in.imm = llround(ldexp(c, frac[in.dest]));
+                in.round = fabs(c - ldexp((double)in.imm, -frac[in.dest]));
+                in.tac = (int)i;
+                insts.push_back(in);
+                break;
+            }
+            case TACOp::ASSIGN:
+                cur[t.dest] = operand(t.arg1); // same range, same format
+                break;
+            case TACOp::ADD:
+            case TACOp::SUB:
+            case TACOp::MUL:
+            case TACOp::DIV:
+            case TACOp::FMA: {
+                if (!r.isFinite()) {
+                    reason = "value of '" + t.dest + "' is unbounded " + r.toString();
+                    return false;
+                }
+                int a = operand(t.arg1), b = operand(t.arg2);
+                FxOp op = t.op == TACOp::ADD ? FxOp::ADD : t.op == TACOp::SUB ? FxOp::SUB
+                        : t.op == TACOp::DIV ? FxOp::DIV : FxOp::MUL;
+                if (t.op == TACOp::FMA) { // product in its own format, then the add
+                    FxInst p = arith(FxOp::MUL, slot(t.dest + "*", intervalMul(info.arg1[i], info.arg2[i])), a, b);
+                    p.tac = (int)i;
+                    insts.push_back(p);
+                    a = p.dest;
+                    b = operand(t.arg3);
+                    op = FxOp::ADD;
+                }
+                FxInst in = arith(op, slot(t.dest, r), a, b);
+                in.tac = (int)i;
+                insts.push_back(in);
+                cur[t.dest] = in.dest;
+                break;
+            }
+            case TACOp::GUARD_NONZERO: {
+                FxInst in;
+                in.op = FxOp::GUARD_NONZERO;
+                in.a = operand(t.arg1);
+                in.tac = (int)i;
+                insts.push_back(in);
+                break;
+            }
+            default: // GUARD_FINITE: fixed-point values are always finite
+                break;
+        }
+    }
+
+    for (const auto &name : outputNames()) outSlots.push_back(cur.at(name));
+    // state is written back through fresh slots, so a state read by another state's
+    // update still sees this sample's value
+    for (size_t k = 0; k < stateSlots.size(); ++k) {
+        const int fin = cur.at(stateNames()[k]), st = stateSlots[k];
+        if (fin == st) continue;
+        FxInst in;
+        in.op = FxOp::MOVE;
+        in.a = fin;
+        frac.push_back(frac[st]);
+        names.push_back(stateNames()[k] + "'");
+        slotRange.push_back(slotRange[st]);
+        in.dest = (int)frac.size() - 1;
+        in.r = requant(frac[st] - frac[fin], width);
+        in.round = dropped(frac[st] - frac[fin], frac[st]);
+        insts.push_back(in);
+        stateCopies.push_back({st, in.dest});
+    }
+    bound(slotRange);
+    return true;
+}
+
+void FixedPointKernel::bound(const vector<Interval> &slotRange) {
+    const size_t ns = frac.size();
+    vector<double> e(ns, 0.0), stateIn(stateSlots.size(), 0.0);
+    // a saturated value and the exact one both lie in the representable range
+    auto cap = [&](int s, double v) { return min(v, ldexp(1.0, width - frac[s])); };
+    auto pass = [&]() {
+        for (int s : inSlots) e[s] = ldexp(1.0, -frac[s] - 1);
+        for (size_t k = 0; k < stateSlots.size(); ++k) e[stateSlots[k]] = stateIn[k];
+        for (const FxInst &in : insts) {
+            if (in.op == FxOp::GUARD_NONZERO) continue;
+            double v = in.round;
+            if (in.op == FxOp::MOVE) {
+                v += e[in.a];
+            } else if (in.op == FxOp::ADD || in.op == FxOp::SUB) {
+                v += e[in.a] + e[in.b];
+            } else if (in.op == FxOp::MUL) {
+                const double ea = e[in.a], eb = e[in.b];
+                v += slotRange[in.a].maxAbs() * eb + slotRange[in.b].maxAbs() * ea + ea * eb;
+            } else if (in.op == FxOp::DIV) {
+                const double ea = e[in.a], eb = e[in.b], m = slotRange[in.b].minAbs();
+                v = m > eb ? v + (ea + slotRange[in.dest].maxAbs() * eb) / (m - eb) : numeric_limits<double>::infinity();
+            }
+            e[in.dest] = cap(in.dest, v);
+        }
+    };
+
+    pass();
+    // state errors only grow from one sample to the next; iterate to their limit
+    bool converged = stateCopies.empty();
+    for (int round = 0; round < 4096 && !converged; ++round) {
+        converged = true;
+        for (size_t k = 0, c = 0; k < stateSlots.size(); ++k) {
+            if (c < stateCopies.size() && stateCopies[c].first == stateSlots[k]) {
+                const double next = e[stateCopies[c++].second];
+                converged = converged && next <= stateIn[k] * (1 + 1e-12);
+                stateIn[k] = next;
+            }
+        }
+        pass();
+    }
+    if (!converged) { // still creeping: fall back to the saturation range
+        for (size_t k = 0; k < stateSlots.size(); ++k) stateIn[k] = cap(stateSlots[k], numeric_limits<double>::infinity());
+        pass();
+    }
+    outErr.clear();
+    for (int s : outSlots) outErr.push_back(e[s]);
+}
+
+int64_t FixedPointKernel::quantize(size_t input, double v) const {
+    if (std::isnan(v)) return 0;
+    v = min(max(v, inRange[input].lo), inRange[input].hi);
+    return llround(ldexp(v, frac[inSlots[input]]));
+}
+
+double FixedPointKernel::dequantize(size_t output, int64_t v) const { return ldexp((double)v, -frac[outSlots[output]]); }
+
+template <class Wide> void FixedPointKernel::step(int64_t *f, size_t sample, bool batch) const {
+    for (const FxInst &in : insts) {
+        switch (in.op) {
+            case FxOp::CONST:
+                f[in.dest] = in.imm;
+                break;
+            case FxOp::MOVE:
+                f[in.dest] = applyShift<Wide>(in.r, (Wide)f[in.a]);
+                break;
+            case FxOp::ADD:
+                f[in.dest] = applyShift<Wide>(in.r, applyShift<Wide>(in.sa, (Wide)f[in.a]) +
+                                                        applyShift<Wide>(in.sb, (Wide)f[in.b]));
+                break;
+            case FxOp::SUB:
+                f[in.dest] = applyShift<Wide>(in.r, applyShift<Wide>(in.sa, (Wide)f[in.a]) -
+                                                        applyShift<Wide>(in.sb, (Wide)f[in.b]));
+                break;
+            case FxOp::MUL:
+                f[in.dest] = applyShift<Wide>(in.r, (Wide)f[in.a] * (Wide)f[in.b]);
+                break;
+            case FxOp::DIV:
+                f[in.dest] = divide<Wide>(in, (Wide)f[in.a], (Wide)f[in.b], width);
+                break;
+            case FxOp::GUARD_NONZERO:
+                if (f[in.a] == 0)
+                    throw RuntimeError("division by zero: " + names[in.a] + " is 0.0" +
+                                           (batch ? " (sample " + to_string(sample) + ")" : ""),
+                                       in.tac);
+                break;
+        }
+    }
+    for (const auto &c : stateCopies) f[c.first] = f[c.second];
+}
+
+void FixedPointKernel::sample(const double *inputs, double *outputs, size_t s, bool batch) {
+    for (size_t k = 0; k < inSlots.size(); ++k) frame[inSlots[k]] = quantize(k, inputs[k]);
+    if (width == 16) step<int32_t>(frame.data(), s, batch);
+    else step<int64_t>(frame.data(), s, batch);
+    for (size_t k = 0; k < outSlots.size(); ++k) outputs[k] = dequantize(k, frame[outSlots[k]]);
+}
+
+void FixedPointKernel::run(const double *inputs, double *outputs) {
+    if (!compiled()) { fallback.run(inputs, outputs); return; }
+    sample(inputs, outputs, 0, false);
+}
+
+void FixedPointKernel::runBatch(const double *inputs, double *outputs, size_t n) {
+    const size_t ni = inputNames().size(), no = outputNames().size();
+    for (size_t s = 0; s < n; ++s) {
+        if (compiled()) {
+            sample(inputs + s * ni, outputs + s * no, s, true);
+            continue;
+        }
+        try {
+            fallback.run(inputs + s * ni, outputs + s * no);
+        } catch (const RuntimeError &e) {
+            throw RuntimeError(string(e.what()) + " (sample " + to_string(s) + ")", e.inst);
+        }
+    }
+}
+
+// One block of m samples over per-slot columns of BLOCK values.
+template <class Store, class Wide>
+void FixedPointKernel::block(vector<Store> &cols, size_t m, size_t first) const {
+    auto col = [&](int s) { return &cols[(size_t)s * BLOCK]; };
+    const SimdKernelTable &simd = SimdKernels::best();
+    for (const FxInst &in : insts) {
+        Store *d = in.dest >= 0 ? col(in.dest) : nullptr;
+        const Store *a = in.a >= 0 ? col(in.a) : nullptr, *b = in.b >= 0 ? col(in.b) : nullptr;
+        constexpr bool q15 = is_same<Store, int16_t>::value;
+        switch (in.op) {
+            case FxOp::CONST:
+                fill(d, d + m, (Store)in.imm);
+                break;
+            case FxOp::MOVE:
+                if constexpr (q15) simd.q15move(d, a, in.r, m);
+                else for (size_t i = 0; i < m; ++i) d[i] = (Store)applyShift<Wide>(in.r, a[i]);
+                break;
+            case FxOp::ADD:
+                if constexpr (q15) simd.q15add(d, a, in.sa, b, in.sb, in.r, m);
+                else for (size_t i = 0; i < m; ++i)
+                    d[i] = (Store)applyShift<Wide>(in.r, applyShift<Wide>(in.sa, a[i]) + applyShift<Wide>(in.sb, b[i]));
+                break;
+            case FxOp::SUB:
+                if constexpr (q15) simd.q15sub(d, a, in.sa, b, in.sb, in.r, m);
+                else for (size_t i = 0; i < m; ++i)
+                    d[i] = (Store)applyShift<Wide>(in.r, applyShift<Wide>(in.sa, a[i]) - applyShift<Wide>(in.sb, b[i]));
+                break;
+            case FxOp::MUL:
+                if constexpr (q15) simd.q15mul(d, a, b, in.r, m);
+                else for (size_t i = 0; i < m; ++i) d[i] = (Store)applyShift<Wide>(in.r, (Wide)a[i] * b[i]);
+                break;
+            case FxOp::DIV:
+                if constexpr (q15) simd.q15div(d, a, b, in.pre, in.r, m);
+                else for (size_t i = 0; i < m; ++i) d[i] = (Store)divide<Wide>(in, a[i], b[i], width);
+                break;
+            case FxOp::GUARD_NONZERO:
+                for (size_t i = 0; i < m; ++i)
+                    if (a[i] == 0)
+                        throw RuntimeError("division by zero: " + names[in.a] + " is 0.0 (sample " +
+                                               to_string(first + i) + ")",
+                                           in.tac);
+                break;
+        }
+    }
+}
+
+template <class Store, class Wide>
+void FixedPointKernel::columns(const Store *const *in, Store *const *out, size_t n, size_t base) {
+    if (!stateSlots.empty()) { // state carries from one sample to the next
+        for (size_t s = 0; s < n; ++s) {
+            for (size_t k = 0; k < inSlots.size(); ++k) frame[inSlots[k]] = in[k][s];
+            step<Wide>(frame.data(), base + s, true);
+            for (size_t k = 0; k < outSlots.size(); ++k) out[k][s] = (Store)frame[outSlots[k]];
+        }
+        return;
+    }
+    vector<Store> cols(frac.size() * BLOCK);
+    for (size_t first = 0; first < n; first += BLOCK) {
+        const size_t m = min(BLOCK, n - first);
+        for (size_t k = 0; k < inSlots.size(); ++k) copy_n(in[k] + first, m, &cols[inSlots[k] * BLOCK]);
+        block<Store, Wide>(cols, m, base + first);
+        for (size_t k = 0; k < outSlots.size(); ++k) copy_n(&cols[outSlots[k] * BLOCK], m, out[k] + first);
+    }
+}
+
+void FixedPointKernel::runInteger(const int16_t *const *inputs, int16_t *const *outputs, size_t n) {
+    if (!compiled() || width != 16) throw invalid_argument("runInteger: kernel is not Q15");
+    columns<int16_t, int32_t>(inputs, outputs, n);
+}
+
+void FixedPointKernel::runInteger(const int32_t *const *inputs, int32_t *const *outputs, size_t n) {
+    if (!compiled() || width != 32) throw invalid_argument("runInteger: kernel is not Q31");
+    columns<int32_t, int64_t>(inputs, outputs, n);
+}
+
+void FixedPointKernel::runColumns(const double *const *inputs, double *const *outputs, size_t n) {
+    const size_t ni = inputNames().size(), no = outputNames().size();
+    if (!compiled()) {
+        vector<double> in(ni), out(no);
+        for (size_t s = 0; s < n; ++s) {
+            for (size_t k = 0; k < ni; ++k) in[k] = inputs[k][s];
+            try {
+                fallback.run(in.data(), out.data());
+            } catch (const RuntimeError &e) {
+                throw RuntimeError(string(e.what()) + " (sample " + to_string(s) + ")", e.inst);
+            }
+            for (size_t k = 0; k < no; ++k) outputs[k][s] = out[k];
+        }
+        return;
+    }
+    // quantize a block, run it on integer columns, convert back
+    auto run = [&](auto tag, auto wideTag) {
+        typedef decltype(tag) Store;
+        typedef decltype(wideTag) Wide;
+        vector<Store> qin(ni * BLOCK), qout(no * BLOCK);
+        vector<const Store *> ip(ni);
+        vector<Store *> op(no);
+        for (size_t k = 0; k < ni; ++k) ip[k] = &qin[k * BLOCK];
+        for (size_t k = 0; k < no; ++k) op[k] = &qout[k * BLOCK];
+        for (size_t first = 0; first < n; first += BLOCK) {
+            const size_t m = min(BLOCK, n - first);
+            for (size_t k = 0; k < ni; ++k)
+                for (size_t s = 0; s < m; ++s) qin[k * BLOCK + s] = (Store)quantize(k, inputs[k][first + s]);
+            columns<Store, Wide>(ip.data(), op.data(), m, first);
+            for (size_t k = 0; k < no; ++k)
+                for (size_t s = 0; s < m; ++s) outputs[k][first + s] = dequantize(k, qout[k * BLOCK + s]);
+        }
+    };
+    if (width == 16) run(int16_t(), int32_t());
+    else run(int32_t(), int64_t());
+}
+
+void FixedPointKernel::reset() {
+    fill(frame.begin(), frame.end(), 0);
+    fallback.reset();
+}
+
+// C spelling of an intermediate constant.
+static string cInt(int64_t v, int bits) {
+    if (v == wideLo(bits)) return bits == 16 ? "(-2147483647 - 1)" : "(-9223372036854775807LL - 1)";
+    return to_string(v) + (bits == 32 && (v > numeric_limits<int32_t>::max() || v < numeric_limits<int32_t>::min()) ? "LL" : "");
+}
+
+string FixedPointKernel::emitC() const {
+    if (!compiled()) return "";
+    const bool q31 = width == 32;
+    const string S = q31 ? "int32_t" : "int16_t", W = q31 ? "int64_t" : "int32_t", U = q31 ? "uint64_t" : "uint32_t";
+    auto v = [](int s) { return "v" + to_string(s); };
+    auto shift = [&](const FxShift &s, const string &x) {
+        return "sl_shift(" + x + ", " + cInt(s.lo, width) + ", " + cInt(s.hi, width) + ", " + to_string(s.left) + ", " +
+               cInt(s.bias, width) + ", " + to_string(s.right) + ", " + cInt(s.outLo, width) + ", " +
+               cInt(s.outHi, width) + ")";
+    };
+    ostringstream src;
+    src << "/* Generated by SignalLang: Q" << width - 1 << " fixed point, " << insts.size()
+        << " integer instructions.\n * value = integer * 2^-frac; inputs are expected inside their declared ranges.\n"
+        << " * signal_fixed returns -1, or the TAC index of a failing guard.\n";
+    for (size_t k = 0; k < inSlots.size(); ++k)
+        src << " *   in[" << k << "]    " << inputNames()[k] << " " << formatName(frac[inSlots[k]], width) << "\n";
+    for (size_t k = 0; k < outSlots.size(); ++k)
+        src << " *   out[" << k << "]   " << outputNames()[k] << " " << formatName(frac[outSlots[k]], width)
+            << ", worst-case |error| " << outErr[k] << "\n";
+    for (size_t k = 0; k < stateSlots.size(); ++k)
+        src << " *   state[" << k << "] " << stateNames()[k] << " " << formatName(frac[stateSlots[k]], width) << "\n";
+    src << " */\n#include <stdint.h>\n\n"
+        << "static inline " << W << " sl_shift(" << W << " v, " << W << " lo, " << W << " hi, int left, " << W
+        << " bias, int right, " << W << " outLo, " << W << " outHi) {\n"
+        << "    v = v < lo ? lo : v > hi ? hi : v;\n"
+        << "    v = (" << W << ")((" << U << ")v << left);\n"
+        << "    v = (v + bias) >> right;\n"
+        << "    return v < outLo ? outLo : v > outHi ? outHi : v;\n}\n\n"
+        << "static inline " << W << " sl_div(" << W << " n, " << W << " d) {\n"
+        << "    const int neg = (n < 0) != (d < 0);\n"
+        << "    const " << U << " un = n < 0 ? (" << U << ")0 - (" << U << ")n : (" << U << ")n;\n"
+        << "    const " << U << " ud = d < 0 ? (" << U << ")0 - (" << U << ")d : (" << U << ")d;\n"
+        << "    const " << U << " q = (un + ud / 2) / ud;\n"
+        << "    return neg ? (" << W << ")((" << U << ")0 - q) : (" << W << ")q;\n}\n\n"
+        << "#ifdef __cplusplus\nextern \"C\"\n#endif\n"
+        << "int signal_fixed(const " << S << " *in, " << S << " *out, " << S << " *state) {\n";
+    for (size_t k = 0; k < inSlots.size(); ++k)
+        src << "    const " << W << " " << v(inSlots[k]) << " = in[" << k << "]; /* " << names[inSlots[k]] << " */\n";
+    for (size_t k = 0; k < stateSlots.size(); ++k)
+        src << "    const " << W << " " << v(stateSlots[k]) << " = state[" << k << "]; /* " << names[stateSlots[k]]
+            << " */\n";
+    for (const FxInst &in : insts) {
+        string expr;
+        switch (in.op) {
+            case FxOp::CONST: expr = cInt(in.imm, width); break;
+            case FxOp::MOVE: expr = shift(in.r, v(in.a)); break;
+            case FxOp::ADD:
+            case FxOp::SUB:
+                expr = shift(in.r, shift(in.sa, v(in.a)) + (in.op == FxOp::ADD ? " + " : " - ") + shift(in.sb, v(in.b)));
+                break;
+            case FxOp::MUL: expr = shift(in.r, "(" + W + ")" + v(in.a) + " * " + v(in.b)); break;
+            case FxOp::DIV:
+                expr = v(in.b) + " == 0 ? (" + v(in.a) + " > 0 ? " + cInt(storageHi(width), width) + " : " + v(in.a) +
+                       " < 0 ? " + cInt(storageLo(width), width) + " : 0)\n        : " +
+                       shift(in.r, "sl_div((" + W + ")((" + U + ")" + v(in.a) + " << " + to_string(in.pre) + "), " +
+                                       v(in.b) + ")");
+                break;
+            case FxOp::GUARD_NONZERO:
+                src << "    if (" << v(in.a) << " == 0) return " << in.tac << ";\n";
+                continue;
+        }
+        src << "    const " << W << " " << v(in.dest) << " = " << expr << "; /* " << names[in.dest] << " "
+            << formatName(frac[in.dest], width) << " */\n";
+    }
+    for (size_t k = 0; k < outSlots.size(); ++k) src << "    out[" << k << "] = (" << S << ")" << v(outSlots[k]) << ";\n";
+    for (size_t k = 0; k < stateSlots.size(); ++k)
+        for (const auto &c : stateCopies)
+            if (c.first == stateSlots[k]) src << "    state[" << k << "] = (" << S << ")" << v(c.second) << ";\n";
+    src << "    return -1;\n}\n";
+    return src.str();
+}
+
+void FixedPointKernel::print(ostream &out) const {
+    if (!compiled()) {
+        out << "interpreter fallback: " << reason << "\n";
+        return;
+    }
+    out << "Q" << width - 1 << ": " << insts.size() << " integer instructions, " << frac.size() << " values";
+    if (width == 16) out << ", columns on " << SimdKernels::levelName(SimdKernels::best().level) << " int16 kernels";
+    out << "\n";
+    for (size_t k = 0; k < inSlots.size(); ++k)
+        out << "  in    " << inputNames()[k] << " " << formatName(frac[inSlots[k]], width) << "\n";
+    for (size_t k = 0; k < stateSlots.size(); ++k)
+        out << "  state " << stateNames()[k] << " " << formatName(frac[stateSlots[k]], width) << "\n";
+    auto shiftText = [](const FxShift &s) {
+        string t;
+        if (s.left) t += " << " + to_string(s.left);
+        if (s.right) t += " >> " + to_string(s.right);
+        return t;
+    };
+    for (const FxInst &in : insts) {
+        static const char *ops[] = {"const", "move", "add", "sub", "mul", "div", "guard_nonzero"};
+        out << "  " << ops[(int)in.op];
+        if (in.op == FxOp::GUARD_NONZERO) { out << " " << names[in.a] << "\n"; continue; }
+        out << " " << names[in.dest] << " " << formatName(frac[in.dest], width) << " =";
+        if (in.op == FxOp::CONST) out << " " << in.imm;
+        if (in.a >= 0) out << " " << names[in.a] << (in.op == FxOp::ADD || in.op == FxOp::SUB ? shiftText(in.sa) : "");
+        if (in.b >= 0) out << ", " << names[in.b] << (in.op == FxOp::ADD || in.op == FxOp::SUB ? shiftText(in.sb) : "");
+        if (in.op == FxOp::DIV && in.pre) out << " (numerator << " << in.pre << ")";
+        const string r = shiftText(in.r);
+        out << (r.empty() ? "" : ", result" + r) << "\n";
+    }
+    for (size_t k = 0; k < outSlots.size(); ++k)
+        out << "  out   " << outputNames()[k] << " " << formatName(frac[outSlots[k]], width)
+            << ", worst-case |error| " << outErr[k] << "\n";
+}
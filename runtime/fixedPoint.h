@@ -0,0 +1,120 @@
+#ifndef FIXEDPOINT_H
+#define FIXEDPOINT_H
+
+#include "interpreter.h"
+#include "simdKernels.h"
+#include "../tac/rangeAnalysis.h"
+#include <vector>
+#include <map>
+#include <string>
+#include <cstdint>
+#include <iostream>
+
+struct FixedPointOptions {
+    int bits = 16; // 16: Q15 (int16 values, int32 intermediates); 32: Q31 (int32, int64)
+};
+
+// Integer TAC: every value lives in a slot holding round(value * 2^frac[slot]).
+enum class FxOp {
+    CONST,         // dest = imm
+    MOVE,          // dest = r(a)
+    ADD, SUB,      // dest = r(sa(a) +- sb(b))
+    MUL,           // dest = r(a * b)
+    DIV,           // dest = r(round((a << pre) / b)), saturated when b == 0
+    GUARD_NONZERO  // a != 0
+};
+
+struct FxInst {
+    FxOp op;
+    int dest = -1, a = -1, b = -1; // slots
+    int64_t imm = 0;
+    int pre = 0;                   // DIV: numerator shift
+    FxShift sa{}, sb{}, r{};
+    int tac = -1;                  // TAC instruction it came from
+    double round = 0;              // worst-case rounding this instruction adds
+};
+
+/*
+ * FixedPointKernel
+ *  - Converts float TAC into integer TAC for cores without an FPU, and for the 16-bit
+ *    SIMD lanes on x86. Each value gets its own Q-format, chosen from RangeAnalysis
+ *    seeded with the declared input (and state) ranges: the most fraction bits whose
+ *    range still fits the storage width, so no value overflows when the inputs are in
+ *    range. Integer values outside their format saturate instead of wrapping.
+ *  - Products are formed in the double-width type; every result is requantized
+ *    through a saturating shift (FxShift) that rounds to nearest. FMA becomes a
+ *    product in its own format plus an add.
+ *  - The worst-case absolute error of every output against exact arithmetic is
+ *    propagated with the same first-order bounds as PrecisionAnalyzer: input
+ *    quantization, constants, and half a unit per requantization. State errors are
+ *    iterated across samples to a fixed point (capped by the state's saturation range).
+ *    Bounds assume inputs inside their declared ranges.
+ *  - Programs with an undeclared input or an unbounded value run on the reference
+ *    Interpreter, and fallbackReason() says why.
+ *  - Runs per sample, in rows, in double columns, or on integer columns directly. Q15
+ *    columns go through the SIMD table's int16 kernels; emitC() writes the same
+ *    arithmetic as C99 for the target (bitwise equal to this kernel).
+ */
+class FixedPointKernel {
+public:
+    FixedPointKernel(const std::vector<TacInst> &tac, const SymbolTable *sym,
+                     const std::map<std::string, Interval> &inputRanges,
+                     const FixedPointOptions &options = FixedPointOptions());
+
+    bool compiled() const { return reason.empty(); }
+    const std::string &fallbackReason() const { return reason; }
+    int bits() const { return width; }
+
+    const std::vector<std::string> &inputNames() const { return fallback.inputNames(); }
+    const std::vector<std::string> &outputNames() const { return fallback.outputNames(); }
+    const std::vector<std::string> &stateNames() const { return fallback.stateNames(); }
+
+    // Fraction bits of the k-th input/output (value = integer * 2^-frac).
+    int inputFrac(size_t k) const { return frac[inSlots[k]]; }
+    int outputFrac(size_t k) const { return frac[outSlots[k]]; }
+    // Worst-case |fixed - exact| of every output, in outputNames() order.
+    const std::vector<double> &outputError() const { return outErr; }
+    const std::vector<FxInst> &code() const { return insts; }
+
+    // inputs in inputNames() order; outputs written in outputNames() order.
+    void run(const double *inputs, double *outputs);
+    void runBatch(const double *inputs, double *outputs, size_t n);
+    void runColumns(const double *const *inputs, double *const *outputs, size_t n);
+    // Already quantized columns (int16 for Q15, int32 for Q31).
+    void runInteger(const int16_t *const *inputs, int16_t *const *outputs, size_t n);
+    void runInteger(const int32_t *const *inputs, int32_t *const *outputs, size_t n);
+
+    // Inputs are clamped to their declared range first, so the error bounds hold.
+    int64_t quantize(size_t input, double v) const;
+    double dequantize(size_t output, int64_t v) const;
+
+    void reset(); // zero state
+    std::string emitC() const;
+    void print(std::ostream &out = std::cout) const;
+
+    static std::string formatName(int frac, int bits); // Q<int bits>.<frac bits>
+
+private:
+    Interpreter fallback;
+    int width;
+    std::string reason;
+    std::vector<FxInst> insts;
+    std::vector<int> frac;          // per slot
+    std::vector<std::string> names; // per slot, for print and emitC
+    std::vector<int> inSlots, outSlots, stateSlots;
+    std::vector<Interval> inRange;
+    std::vector<std::pair<int, int>> stateCopies; // end of sample: state slot = requantized final value
+    std::vector<double> outErr;
+    std::vector<int64_t> frame;     // per-sample values, state slots persist
+
+    bool build(const std::vector<TacInst> &tac, const std::map<std::string, Interval> &ranges);
+    void bound(const std::vector<Interval> &slotRange);
+    template <class Wide> void step(int64_t *f, size_t sample, bool batch) const;
+    template <class Store, class Wide> void block(std::vector<Store> &cols, size_t m, size_t first) const;
+    // base is the batch index of in[k][0], for the sample named by a failing guard
+    template <class Store, class Wide>
+    void columns(const Store *const *in, Store *const *out, size_t n, size_t base = 0);
+    void sample(const double *inputs, double *outputs, size_t s, bool batch);
+};
+
+#endif // FIXEDPOINT_H
@@ -0,0 +1,53 @@
+#include "floatEnv.h"
+
+#if defined(__x86_64__) || defined(_M_X64)
+#include <xmmintrin.h>
+#define SIGNALLANG_MXCSR 1
+#elif defined(__aarch64__)
+#define SIGNALLANG_FPCR 1
+#endif
+
+using namespace std;
+
+#if defined(SIGNALLANG_MXCSR)
+static const unsigned long long FLUSH_BITS = 0x8040; // FTZ (bit 15) | DAZ (bit 6)
+static unsigned long long readControl() { return _mm_getcsr(); }
+static void writeControl(unsigned long long v) { _mm_setcsr((unsigned)v); }
+#elif defined(SIGNALLANG_FPCR)
+static const unsigned long long FLUSH_BITS = 1ull << 24; // FZ
+static unsigned long long readControl() {
+    unsigned long long v;
+    __asm__ __volatile__("mrs %0, fpcr" : "=r"(v));
+    return v;
+}
+static void writeControl(unsigned long long v) { __asm__ __volatile__("msr fpcr, %0" : : "r"(v)); }
+#else
+static const unsigned long long FLUSH_BITS = 0;
+static unsigned long long readControl() { return 0; }
+static void writeControl(unsigned long long) {}
+#endif
+
+DenormalScope::DenormalScope(DenormalMode mode) {
+    if (mode != DenormalMode::FLUSH || !supported()) return;
+    saved = readControl();
+    if ((saved & FLUSH_BITS) == FLUSH_BITS) return; // an outer scope already flushes
+    writeControl(saved | FLUSH_BITS);
+    changed = true;
+}
+
+DenormalScope::~DenormalScope() {
+    if (changed) writeControl(saved);
+}
+
+bool DenormalScope::supported() { return FLUSH_BITS != 0; }
+
+bool DenormalScope::flushing() { return supported() && (readControl() & FLUSH_BITS) == FLUSH_BITS; }
+
+bool DenormalScope::parseMode(const string &name, DenormalMode &mode) {
+    if (name == "flush") mode = DenormalMode::FLUSH;
+    else if (name == "preserve") mode = DenormalMode::PRESERVE;
+    else return false;
+    return true;
+}
+
+string DenormalScope::modeName(DenormalMode mode) { return mode == DenormalMode::FLUSH ? "flush" : "preserve"; }
@@ -0,0 +1,42 @@
+#ifndef FLOATENV_H
+#define FLOATENV_H
+
+#include <string>
+
+enum class DenormalMode {
+    PRESERVE, // IEEE gradual underflow (default)
+    FLUSH     // subnormal results become 0 (FTZ), subnormal operands read as 0 (DAZ)
+};
+
+/*
+ * DenormalScope
+ *  - Switches the calling thread's float control register to the given mode for the
+ *    lifetime of the scope and restores the previous setting when it ends: MXCSR
+ *    FTZ+DAZ on x86-64, FPCR.FZ on AArch64 (which flushes operands and results).
+ *  - The register is per thread, so every thread that runs kernels enters its own
+ *    scope; a scope never leaks into code that runs after it.
+ *  - Arithmetic on subnormals takes a microcode assist on most x86 cores, 100 cycles
+ *    or more per operation. FLUSH trades the last 52 binades above 0 for that: any
+ *    value below 2^-1022 in magnitude becomes a signed zero.
+ *  - PRESERVE leaves the register alone. Where neither register exists, supported()
+ *    is false and every scope is a no-op.
+ */
+class DenormalScope {
+public:
+    explicit DenormalScope(DenormalMode mode);
+    ~DenormalScope();
+    DenormalScope(const DenormalScope &) = delete;
+    DenormalScope &operator=(const DenormalScope &) = delete;
+
+    static bool supported();
+    static bool flushing(); // does the calling thread flush right now?
+
+    static bool parseMode(const std::string &name, DenormalMode &mode); // "flush" / "preserve"
+    static std::string modeName(DenormalMode mode);
+
+private:
+    unsigned long long saved = 0;
+    bool changed = false;
+};
+
+#endif // FLOATENV_H
@@ -0,0 +1,142 @@
+#include "interpreter.h"
+#include <cmath>
+#include <algorithm>
+
+using namespace std;
+
+Interpreter::Interpreter(const vector<TacInst> &program, const SymbolTable *sym)
+    : tac(program), iface(describeInterface(program, sym)) {
+    auto slot = [&](const string &name) {
+        if (name.empty()) return -1;
+        auto it = slots.find(name);
+        if (it != slots.end()) return it->second;
+        int s = (int)slots.size();
+        slots[name] = s;
+        return s;
+    };
+    // interface first so inputs and outputs sit in predictable slots
+    for (const auto &n : iface.inputs) inputSlots.push_back(slot(n));
+    for (const auto &n : iface.state) slot(n);
+    for (const auto &n : iface.outputs) outputSlots.push_back(slot(n));
+
+    for (const auto &inst : tac) {
+        Op op;
+        op.op = inst.op;
+        op.f32 = inst.prec == TacPrecision::F32;
+        op.dest = slot(inst.dest);
+        op.a = op.b = op.c = -1;
+        op.imm = 0;
+        if (inst.op == TACOp::LOAD_CONST) {
+            op.imm = literalValue(inst.arg1Literal);
+            if (op.f32) op.imm = (float)op.imm;
+        } else {
+            vector<string> uses = usesOf(inst);
+            if (uses.size() > 0) op.a = slot(uses[0]);
+            if (uses.size() > 1) op.b = slot(uses[1]);
+            if (uses.size() > 2) op.c = slot(uses[2]);
+        }
+        ops.push_back(op);
+    }
+    frame.assign(slots.size(), 0.0);
+}
+
+int Interpreter::slotOf(const string &name) const {
+    auto it = slots.find(name);
+    return it == slots.end() ? -1 : it->second;
+}
+
+int Interpreter::inputIndex(const string &name) const {
+    auto it = find(iface.inputs.begin(), iface.inputs.end(), name);
+    return it == iface.inputs.end() ? -1 : (int)(it - iface.inputs.begin());
+}
+
+int Interpreter::outputIndex(const string &name) const {
+    auto it = find(iface.outputs.begin(), iface.outputs.end(), name);
+    return it == iface.outputs.end() ? -1 : (int)(it - iface.outputs.begin());
+}
+
+void Interpreter::reset() { fill(frame.begin(), frame.end(), 0.0); }
+
+vector<double> Interpreter::saveState() const {
+    vector<double> values;
+    for (const auto &name : iface.state) values.push_back(frame[slots.at(name)]);
+    return values;
+}
+
+void Interpreter::restoreState(const vector<double> &values) {
+    for (size_t k = 0; k < iface.state.size() && k < values.size(); ++k) frame[slots.at(iface.state[k])] = values[k];
+}
+
+void Interpreter::setProfiler(ValueProfiler *p) {
+    profiler = p;
+    probes.clear();
+    if (!p) return;
+    for (const auto &o : p->operands()) {
+        int s = slotOf(o.name);
+        if (s >= 0) probes.push_back({o.inst, o.operand, s});
+    }
+}
+
+void Interpreter::run(const double *inputs, double *outputs) {
+    double *f = frame.data();
+    for (size_t k = 0; k < inputSlots.size(); ++k) f[inputSlots[k]] = inputs[k];
+    if (profiler) {
+        for (const auto &p : probes) profiler->observe(p.inst, p.operand, f[p.slot]);
+        profiler->nextSample();
+    }
+
+    for (size_t i = 0; i < ops.size(); ++i) {
+        const Op &op = ops[i];
+        switch (op.op) {
+            case TACOp::LOAD_CONST: f[op.dest] = op.imm; break;
+            case TACOp::ASSIGN: f[op.dest] = op.f32 ? (double)(float)f[op.a] : f[op.a]; break;
+            case TACOp::ADD:
+                f[op.dest] = op.f32 ? (double)((float)f[op.a] + (float)f[op.b]) : f[op.a] + f[op.b];
+                break;
+            case TACOp::SUB:
+                f[op.dest] = op.f32 ? (double)((float)f[op.a] - (float)f[op.b]) : f[op.a] - f[op.b];
+                break;
+            case TACOp::MUL:
+                f[op.dest] = op.f32 ? (double)((float)f[op.a] * (float)f[op.b]) : f[op.a] * f[op.b];
+                break;
+            case TACOp::DIV:
+                f[op.dest] = op.f32 ? (double)((float)f[op.a] / (float)f[op.b]) : f[op.a] / f[op.b];
+                break;
+            case TACOp::FMA:
+                f[op.dest] = op.f32 ? (double)std::fmaf((float)f[op.a], (float)f[op.b], (float)f[op.c])
+                                    : std::fma(f[op.a], f[op.b], f[op.c]);
+                break;
+            case TACOp::GUARD_NONZERO:
+                if (f[op.a] == 0.0 || std::isnan(f[op.a]))
+                    throw RuntimeError("division by zero: " + tac[i].arg1 + " is " + formatLiteral(f[op.a]), (int)i);
+                break;
+            case TACOp::GUARD_FINITE:
+                if (!std::isfinite(f[op.a]))
+                    throw RuntimeError("non-finite output: " + tac[i].arg1 + " is " + formatLiteral(f[op.a]), (int)i);
+                break;
+            default:
+                break;
+        }
+    }
+
+    for (size_t k = 0; k < outputSlots.size(); ++k) outputs[k] = f[outputSlots[k]];
+}
+
+void Interpreter::run(const vector<double> &inputs, vector<double> &outputs) {
+    vector<double> in(inputs);
+    in.resize(inputSlots.size(), 0.0);
+    outputs.resize(outputSlots.size());
+    run(in.data(), outputs.data());
+}
+
+map<string, double> Interpreter::run(const map<string, double> &inputs) {
+    vector<double> in(iface.inputs.size(), 0.0), out;
+    for (size_t k = 0; k < iface.inputs.size(); ++k) {
+        auto it = inputs.find(iface.inputs[k]);
+        if (it != inputs.end()) in[k] = it->second;
+    }
+    run(in, out);
+    map<string, double> res;
+    for (size_t k = 0; k < iface.outputs.size(); ++k) res[iface.outputs[k]] = out[k];
+    return res;
+}
@@ -0,0 +1,84 @@
+#ifndef INTERPRETER_H
+#define INTERPRETER_H
+
+#include "../tac/tac.h"
+#include "../tac/tacInfo.h"
+#include "../tac/valueProfile.h"
+#include "../symbolTable/symbolTable.h"
+#include <vector>
+#include <map>
+#include <string>
+#include <stdexcept>
+
+/*
+ * RuntimeError
+ *  - Thrown when a guard fails while a sample is executed.
+ */
+class RuntimeError : public std::runtime_error {
+public:
+    RuntimeError(const std::string &message, int inst) : std::runtime_error(message), inst(inst) {}
+    int inst; // index of the failing guard
+};
+
+/*
+ * Interpreter
+ *  - Reference evaluator for straight-line TAC; every faster backend is diff-tested
+ *    against it.
+ *  - At construction every TAC name is given a dense frame slot and LOAD_CONST
+ *    literals are decoded once, so a sample only indexes the frame.
+ *  - Per sample: inputs are copied into their slots, the code runs, outputs are read
+ *    back. State slots (is_state) are not reloaded and keep their value between
+ *    samples until reset().
+ *  - F32 instructions compute in float, FMA rounds once, failing guards throw
+ *    RuntimeError.
+ *  - An attached ValueProfiler sees the inputs of every sample.
+ */
+class Interpreter {
+public:
+    explicit Interpreter(const std::vector<TacInst> &tac, const SymbolTable *sym = nullptr);
+
+    const std::vector<std::string> &inputNames() const { return iface.inputs; }
+    const std::vector<std::string> &outputNames() const { return iface.outputs; }
+    const std::vector<std::string> &stateNames() const { return iface.state; }
+    int inputIndex(const std::string &name) const;  // -1 if not an input
+    int outputIndex(const std::string &name) const; // -1 if not an output
+
+    // inputs in inputNames() order; outputs written in outputNames() order.
+    void run(const double *inputs, double *outputs);
+    void run(const std::vector<double> &inputs, std::vector<double> &outputs);
+    // By name; missing inputs read as 0.
+    std::map<std::string, double> run(const std::map<std::string, double> &inputs);
+
+    void reset(); // zero the frame, including state
+    // State values in stateNames() order, e.g. to carry a stream over to another backend.
+    std::vector<double> saveState() const;
+    void restoreState(const std::vector<double> &values);
+    void setProfiler(ValueProfiler *profiler);
+
+    int frameSlots() const { return (int)frame.size(); }
+    const std::vector<TacInst> &program() const { return tac; }
+
+    // Pre-decoded instruction.
+    struct Op {
+        TACOp op;
+        bool f32;
+        int dest, a, b, c; // frame slots, -1 when unused
+        double imm;        // LOAD_CONST value
+    };
+    const std::vector<Op> &code() const { return ops; }
+    int slotOf(const std::string &name) const; // -1 if the name does not occur
+
+private:
+    std::vector<TacInst> tac;
+    TacInterface iface;
+    std::map<std::string, int> slots;
+    std::vector<Op> ops;
+    std::vector<double> frame;
+    std::vector<int> inputSlots, outputSlots;
+
+    ValueProfiler *profiler = nullptr;
+    struct Probe { int inst, operand, slot; };
+    std::vector<Probe> probes;
+};
+
+#endif // INTERPRETER_H
@@ -0,0 +1,395 @@
+#include "jit.h"
+#include <cstring>
+#include <map>
+#include <algorithm>
+
+#ifdef SIGNALLANG_JIT
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+// ---- CodeBuffer ----
+
+CodeBuffer::CodeBuffer(CodeBuffer &&other) noexcept : mem(other.mem), bytes(other.bytes), mapped(other.mapped) {
+    other.mem = nullptr;
+    other.bytes = other.mapped = 0;
+}
+
+CodeBuffer &CodeBuffer::operator=(CodeBuffer &&other) noexcept {
+    if (this != &other) {
+        release();
+        swap(mem, other.mem);
+        swap(bytes, other.bytes);
+        swap(mapped, other.mapped);
+    }
+    return *this;
+}
+
+CodeBuffer::~CodeBuffer() { release(); }
+
+void CodeBuffer::release() {
+#ifdef SIGNALLANG_JIT
+    if (mem) munmap(mem, mapped);
+#endif
+    mem = nullptr;
+    bytes = mapped = 0;
+}
+
+bool CodeBuffer::install(const vector<uint8_t> &code) {
+    release();
+#ifdef SIGNALLANG_JIT
+    const size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    const size_t len = max<size_t>(1, (code.size() + page - 1) / page) * page;
+    void *p = mmap(nullptr, len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (p == MAP_FAILED) return false;
+    memcpy(p, code.data(), code.size());
+    // write XOR execute: the pages are never writable and executable at once
+    if (mprotect(p, len, PROT_READ | PROT_EXEC) != 0) {
+        munmap(p, len);
+        return false;
+    }
+    __builtin___clear_cache((char *)p, (char *)p + code.size());
+    mem = p;
+    bytes = code.size();
+    mapped = len;
+    return true;
+#else
+    (void)code;
+    return false;
+#endif
+}
+
+// ---- x86-64 encoding ----
+
+namespace {
+enum Gpr { RAX = 0, RCX = 1, RDX = 2, RSP = 4, RBP = 5, RSI = 6, RDI = 7, R8 = 8 };
+const int X14 = 14, X15 = 15;
+
+// An SSE operand: an xmm register, [base + disp], or a constant-pool entry.
+struct Operand {
+    enum Kind { XMM, MEM, CONST } kind;
+    int reg;      // XMM: register, MEM: base register, CONST: pool index
+    int32_t disp; // MEM
+    static Operand xmm(int r) { return {XMM, r, 0}; }
+    static Operand mem(int base, int32_t disp) { return {MEM, base, disp}; }
+    static Operand constant(int k) { return {CONST, k, 0}; }
+    bool isXmm(int r) const { return kind == XMM && reg == r; }
+};
+
+class Emitter {
+public:
+    vector<uint8_t> code;
+
+    void bytes(initializer_list<uint8_t> bs) { code.insert(code.end(), bs); }
+    void u32(uint32_t v) { for (int k = 0; k < 4; ++k) code.push_back((uint8_t)(v >> (8 * k))); }
+
+    // prefix (0: none) 0F op /r with an xmm in the reg field
+    void sse(uint8_t prefix, uint8_t op, int reg, const Operand &rm) {
+        if (prefix) code.push_back(prefix);
+        rex(false, reg, rm);
+        bytes({0x0F, op});
+        modrm(reg, rm);
+    }
+
+    // VEX.LIG.66.0F38 op /r: reg = fma(vvvv, reg, rm) for the 213 forms
+    void vex38(bool w, uint8_t op, int reg, int vvvv, const Operand &rm) {
+        const bool b = rm.kind != Operand::CONST && rm.reg >= 8;
+        code.push_back(0xC4);
+        code.push_back((uint8_t)((reg >= 8 ? 0 : 0x80) | 0x40 | (b ? 0 : 0x20) | 0x02));
+        code.push_back((uint8_t)((w ? 0x80 : 0) | ((~vvvv & 15) << 3) | 0x01));
+        code.push_back(op);
+        modrm(reg, rm);
+    }
+
+    int newLabel() { labels.push_back(-1); return (int)labels.size() - 1; }
+    void bind(int label) { labels[label] = (int)code.size(); }
+    void jcc(uint8_t cc, int label) { bytes({0x0F, (uint8_t)(0x80 | cc)}); jumpTo(label); }
+    void jmp(int label) { code.push_back(0xE9); jumpTo(label); }
+
+    // Resolve jumps, append the constant pool and point RIP-relative operands at it.
+    void finish(const vector<double> &pool) {
+        for (const auto &j : jumps) patch(j.first, labels[j.second] - (j.first + 4));
+        while (code.size() % 8) code.push_back(0xCC);
+        const int base = (int)code.size();
+        for (double v : pool) {
+            uint64_t bits;
+            memcpy(&bits, &v, 8);
+            for (int k = 0; k < 8; ++k) code.push_back((uint8_t)(bits >> (8 * k)));
+        }
+        for (const auto &c : constRefs) patch(c.first, base + 8 * c.second - (c.first + 4));
+    }
+
+private:
+    vector<int> labels;
+    vector<pair<int, int>> jumps;     // (rel32 position, label)
+    vector<pair<int, int>> constRefs; // (disp32 position, pool index)
+
+    void rex(bool w, int reg, const Operand &rm) {
+        const bool b = rm.kind != Operand::CONST && rm.reg >= 8;
+        if (w || reg >= 8 || b) code.push_back((uint8_t)(0x40 | (w ? 8 : 0) | (reg >= 8 ? 4 : 0) | (b ? 1 : 0)));
+    }
+    void modrm(int reg, const Operand &rm) {
+        const int r = (reg & 7) << 3;
+        if (rm.kind == Operand::XMM) { code.push_back((uint8_t)(0xC0 | r | (rm.reg & 7))); return; }
+        if (rm.kind == Operand::CONST) {
+            code.push_back((uint8_t)(0x05 | r)); // [rip + disp32]
+            constRefs.push_back({(int)code.size(), rm.reg});
+            u32(0);
+            return;
+        }
+        const bool small = rm.disp >= -128 && rm.disp <= 127;
+        code.push_back((uint8_t)((small ? 0x40 : 0x80) | r | (rm.reg & 7)));
+        if ((rm.reg & 7) == RSP) code.push_back(0x24); // SIB: base only
+        if (small) code.push_back((uint8_t)(int8_t)rm.disp);
+        else u32((uint32_t)rm.disp);
+    }
+    void jumpTo(int label) { jumps.push_back({(int)code.size(), label}); u32(0); }
+    void patch(int pos, int32_t v) { for (int k = 0; k < 4; ++k) code[pos + k] = (uint8_t)((uint32_t)v >> (8 * k)); }
+};
+
+// SSE opcodes (after 0F)
+const uint8_t MOVSD_LOAD = 0x10, MOVSD_STORE = 0x11, MOVAPD = 0x28, UCOMISD = 0x2E, XORPD = 0x57,
+              ADD = 0x58, MUL = 0x59, CVT = 0x5A, SUB = 0x5C, DIV = 0x5E;
+const uint8_t F2 = 0xF2, F3 = 0xF3, P66 = 0x66;
+const uint8_t CC_B = 0x2, CC_E = 0x4, CC_P = 0xA;
+} // namespace
+
+// ---- JitKernel ----
+
+JitKernel::JitKernel(const vector<TacInst> &tac, const SymbolTable *sym, int regs)
+    : fallback(tac, sym), alloc(RegisterAllocator::allocate(tac, min(max(regs, 1), XMM_REGS))) {
+    state.assign(fallback.stateNames().size(), 0.0);
+#ifdef SIGNALLANG_JIT
+    vector<uint8_t> bytes;
+    if (!generate(tac, bytes)) return;
+    if (!code.install(bytes)) {
+        reason = "executable memory unavailable";
+        return;
+    }
+    fn = reinterpret_cast<Fn>(const_cast<void *>(code.entry()));
+#else
+    reason = "no JIT for this platform";
+#endif
+}
+
+bool JitKernel::available() {
+#ifdef SIGNALLANG_JIT
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool JitKernel::generate(const vector<TacInst> &tac, vector<uint8_t> &bytes) {
+    for (const auto &inst : tac) {
+        if (inst.op != TACOp::FMA) continue;
+        if (inst.prec == TacPrecision::F32) { reason = "F32 FMA is not supported"; return false; }
+#ifdef SIGNALLANG_JIT
+        if (!__builtin_cpu_supports("fma")) { reason = "CPU lacks FMA3"; return false; }
+#endif
+    }
+
+    Emitter e;
+    vector<double> pool;
+    auto operand = [](const Location &l) {
+        return l.kind == Location::REG ? Operand::xmm(l.index) : Operand::mem(RSP, 8 * l.index);
+    };
+    // xmm r = src
+    auto load = [&](int r, const Operand &src) {
+        if (src.isXmm(r)) return;
+        if (src.kind == Operand::XMM) e.sse(P66, MOVAPD, r, src);
+        else e.sse(F2, MOVSD_LOAD, r, src);
+    };
+    // dest location = src
+    auto store = [&](const Operand &dest, const Operand &src) {
+        if (dest.kind == Operand::XMM) { load(dest.reg, src); return; }
+        if (src.kind != Operand::XMM) { load(X15, src); e.sse(F2, MOVSD_STORE, X15, dest); return; }
+        e.sse(F2, MOVSD_STORE, src.reg, dest);
+    };
+    // round xmm r to float and back
+    auto roundF32 = [&](int r, const Operand &src) {
+        e.sse(F2, CVT, r, src);
+        e.sse(F3, CVT, r, Operand::xmm(r));
+    };
+
+    const int frame = (8 * alloc.spillSlots + 15) & ~15;
+    e.bytes({0x55, 0x48, 0x89, 0xE5}); // push rbp; mov rbp, rsp
+    if (frame) { e.bytes({0x48, 0x81, 0xEC}); e.u32(frame); } // sub rsp, frame
+    e.bytes({0x31, 0xC0});             // xor eax, eax (samples done)
+    e.bytes({0x48, 0x85, 0xD2});       // test rdx, rdx
+    const int done = e.newLabel(), loop = e.newLabel();
+    e.jcc(CC_E, done);
+    e.bind(loop);
+
+    // live-in values: inputs from the row, state from memory
+    const auto &inputs = fallback.inputNames(), &outputs = fallback.outputNames(), &stateNames = fallback.stateNames();
+    for (size_t k = 0; k < inputs.size(); ++k) {
+        auto it = alloc.inputs.find(inputs[k]);
+        if (it != alloc.inputs.end()) store(operand(it->second), Operand::mem(RDI, 8 * (int)k));
+    }
+    for (size_t k = 0; k < stateNames.size(); ++k) {
+        auto it = alloc.inputs.find(stateNames[k]);
+        if (it != alloc.inputs.end()) store(operand(it->second), Operand::mem(RCX, 8 * (int)k));
+    }
+
+    struct Stub { int label, inst; Operand value; };
+    vector<Stub> stubs;
+    map<uint64_t, int> constIndex;
+    for (size_t i = 0; i < tac.size(); ++i) {
+        const TacInst &inst = tac[i];
+        const InstAlloc &ia = alloc.insts[i];
+        const bool f32 = inst.prec == TacPrecision::F32;
+        Operand d = operand(ia.dest), a = operand(ia.arg1), b = operand(ia.arg2);
+        switch (inst.op) {
+            case TACOp::LOAD_CONST: {
+                double v = literalValue(inst.arg1Literal);
+                if (f32) v = (float)v;
+                uint64_t bits;
+                memcpy(&bits, &v, 8);
+                auto k = constIndex.find(bits);
+                if (k == constIndex.end()) {
+                    k = constIndex.emplace(bits, (int)pool.size()).first;
+                    pool.push_back(v);
+                }
+                store(d, Operand::constant(k->second));
+                break;
+            }
+            case TACOp::ASSIGN:
+                if (f32) { roundF32(X15, a); store(d, Operand::xmm(X15)); }
+                else if (!ia.coalesced) store(d, a);
+                break;
+            case TACOp::ADD:
+            case TACOp::SUB:
+            case TACOp::MUL:
+            case TACOp::DIV: {
+                const uint8_t op = inst.op == TACOp::ADD ? ADD : inst.op == TACOp::SUB ? SUB
+                                 : inst.op == TACOp::MUL ? MUL : DIV;
+                if (f32) {
+                    e.sse(F2, CVT, X15, a);
+                    e.sse(F2, CVT, X14, b);
+                    e.sse(F3, op, X15, Operand::xmm(X14));
+                    e.sse(F3, CVT, X15, Operand::xmm(X15));
+                    store(d, Operand::xmm(X15));
+                    break;
+                }
+                const bool commutative = inst.op == TACOp::ADD || inst.op == TACOp::MUL;
+                if (commutative && d.kind == Operand::XMM && b.isXmm(d.reg)) swap(a, b);
+                // compute in the destination register unless that would clobber b
+                const int t = d.kind == Operand::XMM && !b.isXmm(d.reg) ? d.reg : X15;
+                load(t, a);
+                e.sse(F2, op, t, b);
+                store(d, Operand::xmm(t));
+                break;
+            }
+            case TACOp::FMA: {
+                Operand c = operand(ia.arg3);
+                load(X15, a);
+                if (b.kind != Operand::XMM) { load(X14, b); b = Operand::xmm(X14); }
+                e.vex38(true, 0xA9, X15, b.reg, c); // vfmadd213sd: x15 = b * x15 + c
+                store(d, Operand::xmm(X15));
+                break;
+            }
+            case TACOp::GUARD_NONZERO: {
+                Operand v = a;
+                if (v.kind != Operand::XMM) { load(X15, v); v = Operand::xmm(X15); }
+                e.sse(P66, XORPD, X14, Operand::xmm(X14));
+                e.sse(P66, UCOMISD, v.reg, Operand::xmm(X14)); // ZF also set when unordered
+                stubs.push_back({e.newLabel(), (int)i, a});
+                e.jcc(CC_E, stubs.back().label);
+                break;
+            }
+            case TACOp::GUARD_FINITE:
+                load(X15, a);
+                e.sse(F2, SUB, X15, Operand::xmm(X15)); // x - x is NaN unless x is finite
+                e.sse(P66, UCOMISD, X15, Operand::xmm(X15));
+                stubs.push_back({e.newLabel(), (int)i, a});
+                e.jcc(CC_P, stubs.back().label);
+                break;
+            default:
+                break;
+        }
+    }
+
+    // live-out values
+    for (size_t k = 0; k < outputs.size(); ++k) {
+        auto it = alloc.outputs.find(outputs[k]);
+        if (it != alloc.outputs.end()) store(Operand::mem(RSI, 8 * (int)k), operand(it->second));
+    }
+    for (size_t k = 0; k < stateNames.size(); ++k) {
+        auto it = alloc.outputs.find(stateNames[k]);
+        if (it != alloc.outputs.end()) store(Operand::mem(RCX, 8 * (int)k), operand(it->second));
+    }
+
+    e.bytes({0x48, 0x81, 0xC7}); e.u32(8 * (uint32_t)inputs.size());  // add rdi, row
+    e.bytes({0x48, 0x81, 0xC6}); e.u32(8 * (uint32_t)outputs.size()); // add rsi, row
+    e.bytes({0x48, 0xFF, 0xC0});                                       // inc rax
+    e.bytes({0x48, 0x39, 0xD0});                                       // cmp rax, rdx
+    e.jcc(CC_B, loop);
+    e.bind(done);
+    e.bytes({0x48, 0x89, 0xEC, 0x5D, 0xC3}); // mov rsp, rbp; pop rbp; ret
+
+    // failing guards: record which and what, leave with rax = failing sample
+    for (const auto &s : stubs) {
+        e.bind(s.label);
+        e.bytes({0x41, 0xC7, 0x00}); e.u32((uint32_t)s.inst); // mov dword [r8], inst
+        load(X15, s.value);
+        e.sse(F2, MOVSD_STORE, X15, Operand::mem(R8, 8));
+        e.jmp(done);
+    }
+
+    e.finish(pool);
+    bytes.swap(e.code);
+    return true;
+}
+
+static RuntimeError guardError(const TacInst &guard, const JitKernel::Status &st, const string &suffix) {
+    string what = guard.op == TACOp::GUARD_NONZERO ? "division by zero: " : "non-finite output: ";
+    return RuntimeError(what + guard.arg1 + " is " + formatLiteral(st.value) + suffix, st.guard);
+}
+
+void JitKernel::run(const double *inputs, double *outputs) {
+    if (!fn) { fallback.run(inputs, outputs); return; }
+    Status st;
+    if (fn(inputs, outputs, 1, state.data(), &st) == 0) throw guardError(fallback.program()[st.guard], st, "");
+}
+
+void JitKernel::runBatch(const double *inputs, double *outputs, size_t n) {
+    const size_t ni = inputNames().size(), no = outputNames().size();
+    if (!fn) {
+        for (size_t s = 0; s < n; ++s) {
+            try {
+                fallback.run(inputs + s * ni, outputs + s * no);
+            } catch (const RuntimeError &e) {
+                throw RuntimeError(string(e.what()) + " (sample " + to_string(s) + ")", e.inst);
+            }
+        }
+        return;
+    }
+    Status st;
+    size_t done = fn(inputs, outputs, n, state.data(), &st);
+    if (done < n) throw guardError(fallback.program()[st.guard], st, " (sample " + to_string(done) + ")");
+}
+
+void JitKernel::reset() {
+    fill(state.begin(), state.end(), 0.0);
+    fallback.reset();
+}
+
+vector<double> JitKernel::saveState() const { return fn ? state : fallback.saveState(); }
+
+void JitKernel::restoreState(const vector<double> &values) {
+    if (!fn) { fallback.restoreState(values); return; }
+    for (size_t k = 0; k < state.size() && k < values.size(); ++k) state[k] = values[k];
+}
+
+void JitKernel::print(ostream &out) const {
+    if (!fn) {
+        out << "interpreter fallback: " << reason << "\n";
+        return;
+    }
+    out << "native x86-64: " << code.size() << " bytes at " << code.entry() << " (read-execute)\n"
+        << "xmm registers=" << alloc.numRegs << " spilled values=" << alloc.spillCount
+        << " frame slots=" << alloc.spillSlots << " coalesced moves=" << alloc.coalescedMoves << "\n";
+}
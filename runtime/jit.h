@@ -0,0 +1,105 @@
+#ifndef JIT_H
+#define JIT_H
+
+#include "interpreter.h"
+#include "../tac/regAlloc.h"
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <iostream>
+
+#if defined(__x86_64__) && (defined(__unix__) || defined(__APPLE__))
+#define SIGNALLANG_JIT 1
+#endif
+
+/*
+ * CodeBuffer
+ *  - Executable memory under W^X: pages are mapped read-write, the code is copied in,
+ *    then the pages are flipped to read-execute and never become writable again.
+ *  - Unmapped on destruction; move-only.
+ */
+class CodeBuffer {
+public:
+    CodeBuffer() = default;
+    CodeBuffer(const CodeBuffer &) = delete;
+    CodeBuffer &operator=(const CodeBuffer &) = delete;
+    CodeBuffer(CodeBuffer &&other) noexcept;
+    CodeBuffer &operator=(CodeBuffer &&other) noexcept;
+    ~CodeBuffer();
+
+    // Map, copy and seal; false (with nothing mapped) if the OS refuses.
+    bool install(const std::vector<uint8_t> &code);
+    const void *entry() const { return mem; }
+    size_t size() const { return bytes; }
+
+private:
+    void *mem = nullptr;
+    size_t bytes = 0;  // code size
+    size_t mapped = 0; // whole pages
+    void release();
+};
+
+/*
+ * JitKernel
+ *  - Native x86-64 code for a TAC program (System V ABI, no external dependencies).
+ *  - Values are placed by the linear-scan RegisterAllocator onto xmm0..xmm13;
+ *    xmm14/xmm15 are scratch and spilled values live in the stack frame. Constants
+ *    sit in a pool after the code and are read RIP-relative.
+ *  - The generated function loops over a batch of row-major samples itself:
+ *        size_t fn(const double *in, double *out, size_t n, double *state, Status *st)
+ *    returns the number of samples completed; a failing guard stops the loop and
+ *    records its TAC index and the value it saw.
+ *  - Arithmetic is scalar SSE2 (F32 instructions round through cvtsd2ss/cvtss2sd);
+ *    FMA needs a CPU with FMA3. State lives in memory between samples.
+ *  - When native code is not possible (other architectures, an F32 FMA, no FMA3,
+ *    mmap refused) the kernel runs on the reference Interpreter instead and
+ *    fallbackReason() says why. Results are bitwise equal either way.
+ */
+class JitKernel {
+public:
+    static const int XMM_REGS = 14; // allocatable; xmm14 and xmm15 are scratch
+
+    explicit JitKernel(const std::vector<TacInst> &tac, const SymbolTable *sym = nullptr, int regs = XMM_REGS);
+
+    static bool available(); // this build and CPU can run generated code
+    bool compiled() const { return fn != nullptr; }
+    const std::string &fallbackReason() const { return reason; }
+
+    const std::vector<std::string> &inputNames() const { return fallback.inputNames(); }
+    const std::vector<std::string> &outputNames() const { return fallback.outputNames(); }
+
+    // inputs in inputNames() order; outputs written in outputNames() order.
+    void run(const double *inputs, double *outputs);
+    // n samples, rows of inputs/outputs stored one after another. On a failing guard
+    // the rows before it have been written.
+    void runBatch(const double *inputs, double *outputs, size_t n);
+
+    void reset(); // zero state
+    // State values in the Interpreter's stateNames() order.
+    std::vector<double> saveState() const;
+    void restoreState(const std::vector<double> &values);
+
+    size_t codeBytes() const { return code.size(); }
+    const RegAllocResult &allocation() const { return alloc; }
+    void print(std::ostream &out = std::cout) const;
+
+    struct Status {
+        int32_t guard; // TAC index of the failing guard
+        int32_t pad;
+        double value;  // the value it checked
+    };
+
+private:
+    typedef size_t (*Fn)(const double *in, double *out, size_t n, double *state, Status *st);
+
+    Interpreter fallback;
+    RegAllocResult alloc;
+    CodeBuffer code;
+    Fn fn = nullptr;
+    std::string reason;
+    std::vector<double> state;
+
+    bool generate(const std::vector<TacInst> &tac, std::vector<uint8_t> &bytes);
+};
+
+#endif // JIT_H
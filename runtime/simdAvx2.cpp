@@ -0,0 +1,38 @@
+#include "simdKernelsImpl.h"
+#include <immintrin.h>
+
+// AVX2 kernels; this unit is built with -mavx2 and only called when the CPU has AVX2.
+
+namespace {
+struct F64 {
+    typedef double S;
+    typedef __m256d V;
+    static const int W = 4, ALIGN = 32;
+    static const bool MASKED = false;
+    static V load(const S *p) { return _mm256_loadu_pd(p); }
+    static void store(S *p, V v) { _mm256_store_pd(p, v); }
+    static V set1(S s) { return _mm256_set1_pd(s); }
+    static V add(V a, V b) { return _mm256_add_pd(a, b); }
+    static V sub(V a, V b) { return _mm256_sub_pd(a, b); }
+    static V mul(V a, V b) { return _mm256_mul_pd(a, b); }
+    static V div(V a, V b) { return _mm256_div_pd(a, b); }
+};
+struct F32 {
+    typedef float S;
+    typedef __m256 V;
+    static const int W = 8, ALIGN = 32;
+    static const bool MASKED = false;
+    static V load(const S *p) { return _mm256_loadu_ps(p); }
+    static void store(S *p, V v) { _mm256_store_ps(p, v); }
+    static V set1(S s) { return _mm256_set1_ps(s); }
+    static V add(V a, V b) { return _mm256_add_ps(a, b); }
+    static V sub(V a, V b) { return _mm256_sub_ps(a, b); }
+    static V mul(V a, V b) { return _mm256_mul_ps(a, b); }
+    static V div(V a, V b) { return _mm256_div_ps(a, b); }
+};
+} // namespace
+
+const SimdKernelTable &simdKernelsAvx2() {
+    static const SimdKernelTable t = buildTable<F64, F32>(SimdLevel::AVX2);
+    return t;
+}
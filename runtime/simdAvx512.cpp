@@ -0,0 +1,43 @@
+#include "simdKernelsImpl.h"
+#include <immintrin.h>
+
+// AVX-512F kernels; this unit is built with -mavx512f and only called when the CPU
+// has AVX-512F. Tails use masked loads and stores instead of a scalar loop.
+
+namespace {
+struct F64 {
+    typedef double S;
+    typedef __m512d V;
+    static const int W = 8, ALIGN = 64;
+    static const bool MASKED = true;
+    static V load(const S *p) { return _mm512_loadu_pd(p); }
+    static void store(S *p, V v) { _mm512_store_pd(p, v); }
+    static V loadTail(const S *p, size_t lanes) { return _mm512_maskz_loadu_pd((__mmask8)((1u << lanes) - 1), p); }
+    static void storeTail(S *p, V v, size_t lanes) { _mm512_mask_storeu_pd(p, (__mmask8)((1u << lanes) - 1), v); }
+    static V set1(S s) { return _mm512_set1_pd(s); }
+    static V add(V a, V b) { return _mm512_add_pd(a, b); }
+    static V sub(V a, V b) { return _mm512_sub_pd(a, b); }
+    static V mul(V a, V b) { return _mm512_mul_pd(a, b); }
+    static V div(V a, V b) { return _mm512_div_pd(a, b); }
+};
+struct F32 {
+    typedef float S;
+    typedef __m512 V;
+    static const int W = 16, ALIGN = 64;
+    static const bool MASKED = true;
+    static V load(const S *p) { return _mm512_loadu_ps(p); }
+    static void store(S *p, V v) { _mm512_store_ps(p, v); }
+    static V loadTail(const S *p, size_t lanes) { return _mm512_maskz_loadu_ps((__mmask16)((1u << lanes) - 1), p); }
+    static void storeTail(S *p, V v, size_t lanes) { _mm512_mask_storeu_ps(p, (__mmask16)((1u << lanes) - 1), v); }
+    static V set1(S s) { return _mm512_set1_ps(s); }
+    static V add(V a, V b) { return _mm512_add_ps(a, b); }
+    static V sub(V a, V b) { return _mm512_sub_ps(a, b); }
+    static V mul(V a, V b) { return _mm512_mul_ps(a, b); }
+    static V div(V a, V b) { return _mm512_div_ps(a, b); }
+};
+} // namespace
+
+const SimdKernelTable &simdKernelsAvx512() {
+    static const SimdKernelTable t = buildTable<F64, F32>(SimdLevel::AVX512);
+    return t;
+}
@@ -0,0 +1,84 @@
+#include "simdKernelsImpl.h"
+#include <cstdlib>
+
+using namespace std;
+
+#ifdef SIGNALLANG_X86_SIMD
+const SimdKernelTable &simdKernelsSse2();
+const SimdKernelTable &simdKernelsAvx2();
+const SimdKernelTable &simdKernelsAvx512();
+#endif
+
+namespace {
+// Portable level: one lane, so the shared template is a plain loop.
+template <class T> struct Scalar {
+    typedef T S;
+    typedef T V;
+    static const int W = 1, ALIGN = sizeof(T);
+    static const bool MASKED = false;
+    static V load(const S *p) { return *p; }
+    static void store(S *p, V v) { *p = v; }
+    static V set1(S s) { return s; }
+    static V add(V a, V b) { return a + b; }
+    static V sub(V a, V b) { return a - b; }
+    static V mul(V a, V b) { return a * b; }
+    static V div(V a, V b) { return a / b; }
+};
+} // namespace
+
+bool SimdKernels::supported(SimdLevel level) {
+    switch (level) {
+        case SimdLevel::SCALAR: return true;
+#ifdef SIGNALLANG_X86_SIMD
+        case SimdLevel::SSE2: return __builtin_cpu_supports("sse2");
+        case SimdLevel::AVX2: return __builtin_cpu_supports("avx2");
+        case SimdLevel::AVX512: return __builtin_cpu_supports("avx512f");
+#endif
+        default: return false;
+    }
+}
+
+SimdLevel SimdKernels::detect() {
+    static const SimdLevel level = [] {
+        int cap = (int)SimdLevel::COUNT - 1;
+        if (const char *env = getenv("SIGNALLANG_SIMD"))
+            for (int l = 0; l < (int)SimdLevel::COUNT; ++l)
+                if (levelName((SimdLevel)l) == env) cap = l;
+        for (int l = cap; l > 0; --l)
+            if (supported((SimdLevel)l)) return (SimdLevel)l;
+        return SimdLevel::SCALAR;
+    }();
+    return level;
+}
+
+const SimdKernelTable &SimdKernels::table(SimdLevel level) {
+    static const SimdKernelTable scalar = buildTable<Scalar<double>, Scalar<float>>(SimdLevel::SCALAR);
+    switch (level) {
+#ifdef SIGNALLANG_X86_SIMD
+        case SimdLevel::SSE2: return simdKernelsSse2();
+        case SimdLevel::AVX2: return simdKernelsAvx2();
+        case SimdLevel::AVX512: return simdKernelsAvx512();
+#endif
+        default: return scalar;
+    }
+}
+
+const SimdKernelTable &SimdKernels::best() {
+    static const SimdKernelTable &t = table(detect());
+    return t;
+}
+
+int SimdKernels::opIndex(TACOp op) {
+    switch (op) {
+        case TACOp::ADD: return 0;
+        case TACOp::SUB: return 1;
+        case TACOp::MUL: return 2;
+        case TACOp::DIV: return 3;
+        default: return -1;
+    }
+}
+
+string SimdKernels::levelName(SimdLevel level) {
+    static const char *names[] = {"scalar", "sse2", "avx2", "avx512"};
+    return level < SimdLevel::COUNT ? names[(int)level] : "?";
+}
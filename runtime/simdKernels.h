@@ -0,0 +1,84 @@
+#ifndef SIMDKERNELS_H
+#define SIMDKERNELS_H
+
+#include "../tac/tac.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/*
+ * SimdKernels
+ *  - Elementwise ADD/SUB/MUL/DIV over arrays, in vector-vector, vector-scalar and
+ *    scalar-vector forms, for float64 and float32.
+ *  - Prebuilt kernels for the statement shapes that dominate sensor programs
+ *    (a*x+b, (x-o)*g, a*x+b*y, x*x), so BatchInterpreter runs a whole statement in
+ *    one pass without a JIT.
+ *  - Q15 fixed-point kernels for FixedPointKernel: int16 lanes, int32 intermediates,
+ *    every result requantized through an FxShift.
+ *  - One table of kernels per ISA level: portable loops, SSE2, AVX2 and AVX-512F.
+ *    Each x86 level is its own translation unit built for that level, and is only
+ *    called after the CPU reported it (cpuid via __builtin_cpu_supports).
+ *  - Kernels peel scalar iterations until the destination is vector aligned and
+ *    finish with a scalar tail (a masked one on AVX-512). The destination may be
+ *    one of the sources, but must not partially overlap it.
+ *  - Every level computes the same IEEE results bit for bit.
+ *  - best() is picked once, on first use; SIGNALLANG_SIMD=scalar|sse2|avx2|avx512 in
+ *    the environment caps the level (for comparisons and for testing fallbacks).
+ */
+enum class SimdLevel { SCALAR, SSE2, AVX2, AVX512, COUNT };
+
+// Saturating requantization of a fixed-point intermediate v:
+//   v = clamp(v, lo, hi); v <<= left; v = (v + bias) >> right; v = clamp(v, outLo, outHi)
+// The first clamp saturates before a left shift could overflow, bias rounds a right
+// shift to nearest. Bounds are in the intermediate's type (int32 for Q15, int64 for Q31).
+struct FxShift {
+    int64_t lo, hi;
+    int left;
+    int64_t bias;
+    int right;
+    int64_t outLo, outHi;
+};
+
+struct SimdKernelTable {
+    SimdLevel level;
+    // indexed by SimdKernels::opIndex(): ADD, SUB, MUL, DIV
+    void (*f64vv[4])(double *d, const double *a, const double *b, size_t n);
+    void (*f64vs[4])(double *d, const double *a, double b, size_t n);
+    void (*f64sv[4])(double *d, double a, const double *b, size_t n);
+    void (*f32vv[4])(float *d, const float *a, const float *b, size_t n);
+    void (*f32vs[4])(float *d, const float *a, float b, size_t n);
+    void (*f32sv[4])(float *d, float a, const float *b, size_t n);
+    // statement shapes (scalars are bound per statement):
+    //   axpb d = x * a + b   xmog d = (x - o) * g   axby d = x * a + y * b   sqr d = x * x
+    void (*f64axpb)(double *d, const double *x, double a, double b, size_t n);
+    void (*f64xmog)(double *d, const double *x, double o, double g, size_t n);
+    void (*f64axby)(double *d, const double *x, double a, const double *y, double b, size_t n);
+    void (*f64sqr)(double *d, const double *x, size_t n);
+    void (*f32axpb)(float *d, const float *x, float a, float b, size_t n);
+    void (*f32xmog)(float *d, const float *x, float o, float g, size_t n);
+    void (*f32axby)(float *d, const float *x, float a, const float *y, float b, size_t n);
+    void (*f32sqr)(float *d, const float *x, size_t n);
+    // Q15, operands widened to int32 (sa/sb align ADD/SUB operands, r requantizes):
+    //   q15add d = r(sa(a) + sb(b))   q15sub d = r(sa(a) - sb(b))   q15mul d = r(a * b)   q15move d = r(a)
+    //   q15div d = r((a << pre) / b), rounded to nearest, saturated by a's sign when b == 0
+    void (*q15add)(int16_t *d, const int16_t *a, const FxShift &sa, const int16_t *b, const FxShift &sb,
+                   const FxShift &r, size_t n);
+    void (*q15sub)(int16_t *d, const int16_t *a, const FxShift &sa, const int16_t *b, const FxShift &sb,
+                   const FxShift &r, size_t n);
+    void (*q15mul)(int16_t *d, const int16_t *a, const int16_t *b, const FxShift &r, size_t n);
+    void (*q15move)(int16_t *d, const int16_t *a, const FxShift &r, size_t n);
+    void (*q15div)(int16_t *d, const int16_t *a, const int16_t *b, int pre, const FxShift &r, size_t n);
+};
+
+class SimdKernels {
+public:
+    static bool supported(SimdLevel level); // built in and reported by the CPU
+    static SimdLevel detect();              // highest supported level, after SIGNALLANG_SIMD
+    static const SimdKernelTable &table(SimdLevel level); // level must be supported
+    static const SimdKernelTable &best();
+
+    static int opIndex(TACOp op); // -1 unless ADD/SUB/MUL/DIV
+    static std::string levelName(SimdLevel level);
+};
+
+#endif // SIMDKERNELS_H
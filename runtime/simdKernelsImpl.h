@@ -0,0 +1,223 @@
+#ifndef SIMDKERNELSIMPL_H
+#define SIMDKERNELSIMPL_H
+
+#include "simdKernels.h"
+#include <cstdint>
+
+/*
+ * Kernel templates shared by the ISA translation units (simd*.cpp).
+ *  - A unit defines traits F64 and F32 for its vector width and includes this file;
+ *    buildTable() then instantiates every kernel with that unit's compile flags.
+ *  - Everything here has internal linkage, so instantiations built for AVX can never
+ *    be merged into code that runs on an older CPU.
+ *
+ *  - Besides the four binary ops, the table holds the fused statement shapes
+ *    (axpb, xmog, axby, sqr). Units are built without FMA and with
+ *    -ffp-contract=off, so a multiply followed by an add rounds twice, as in TAC.
+ *
+ *  - The Q15 kernels are plain loops over int16 arrays: the compiler vectorizes them
+ *    for each unit's ISA, so they need no traits.
+ *
+ *  Traits: S (element), V (vector), W (lanes), ALIGN (bytes), MASKED (tail by mask),
+ *          load (unaligned), store (aligned), set1, add/sub/mul/div,
+ *          and for MASKED: loadTail/storeTail(p, [v,] lanes).
+ */
+namespace {
+
+struct Add {
+    template <class T> static typename T::V vec(typename T::V a, typename T::V b) { return T::add(a, b); }
+    template <class S> static S one(S a, S b) { return a + b; }
+};
+struct Sub {
+    template <class T> static typename T::V vec(typename T::V a, typename T::V b) { return T::sub(a, b); }
+    template <class S> static S one(S a, S b) { return a - b; }
+};
+struct Mul {
+    template <class T> static typename T::V vec(typename T::V a, typename T::V b) { return T::mul(a, b); }
+    template <class S> static S one(S a, S b) { return a * b; }
+};
+struct Div {
+    template <class T> static typename T::V vec(typename T::V a, typename T::V b) { return T::div(a, b); }
+    template <class S> static S one(S a, S b) { return a / b; }
+};
+
+// Operand sources: an array, or a scalar broadcast once.
+template <class T> struct Array {
+    const typename T::S *p;
+    typename T::V at(size_t i) const { return T::load(p + i); }
+    typename T::V tail(size_t i, size_t lanes) const { return T::loadTail(p + i, lanes); }
+    typename T::S one(size_t i) const { return p[i]; }
+};
+template <class T> struct Broadcast {
+    typename T::S s;
+    typename T::V v;
+    explicit Broadcast(typename T::S x) : s(x), v(T::set1(x)) {}
+    typename T::V at(size_t) const { return v; }
+    typename T::V tail(size_t, size_t) const { return v; }
+    typename T::S one(size_t) const { return s; }
+};
+
+// d[i] = f(src[i]...) for any number of sources; f has vec<T>(V...) and one(S...).
+template <class T, class F, class... Src>
+inline void mapN(typename T::S *d, const F &f, size_t n, const Src &...src) {
+    size_t i = 0;
+    while (i < n && (reinterpret_cast<uintptr_t>(d + i) % T::ALIGN) != 0) { d[i] = f.one(src.one(i)...); ++i; }
+    for (; i + 2 * T::W <= n; i += 2 * T::W) {
+        typename T::V x0 = f.vec(src.at(i)...);
+        typename T::V x1 = f.vec(src.at(i + T::W)...);
+        T::store(d + i, x0);
+        T::store(d + i + T::W, x1);
+    }
+    if (i + T::W <= n) {
+        T::store(d + i, f.vec(src.at(i)...));
+        i += T::W;
+    }
+    if constexpr (T::MASKED) {
+        if (i < n) T::storeTail(d + i, f.vec(src.tail(i, n - i)...), n - i);
+    } else {
+        for (; i < n; ++i) d[i] = f.one(src.one(i)...);
+    }
+}
+
+template <class T, class Op> struct Binary {
+    typename T::V vec(typename T::V a, typename T::V b) const { return Op::template vec<T>(a, b); }
+    typename T::S one(typename T::S a, typename T::S b) const { return Op::one(a, b); }
+};
+
+template <class T, class Op, class A, class B>
+inline void apply(typename T::S *d, const A &a, const B &b, size_t n) {
+    mapN<T>(d, Binary<T, Op>(), n, a, b);
+}
+
+template <class T, class Op>
+void vv(typename T::S *d, const typename T::S *a, const typename T::S *b, size_t n) {
+    apply<T, Op>(d, Array<T>{a}, Array<T>{b}, n);
+}
+template <class T, class Op>
+void vs(typename T::S *d, const typename T::S *a, typename T::S b, size_t n) {
+    apply<T, Op>(d, Array<T>{a}, Broadcast<T>(b), n);
+}
+template <class T, class Op>
+void sv(typename T::S *d, typename T::S a, const typename T::S *b, size_t n) {
+    apply<T, Op>(d, Broadcast<T>(a), Array<T>{b}, n);
+}
+
+template <class T, class VV, class VS, class SV>
+void fill(VV *vvs, VS *vss, SV *svs) {
+    vvs[0] = vv<T, Add>; vvs[1] = vv<T, Sub>; vvs[2] = vv<T, Mul>; vvs[3] = vv<T, Div>;
+    vss[0] = vs<T, Add>; vss[1] = vs<T, Sub>; vss[2] = vs<T, Mul>; vss[3] = vs<T, Div>;
+    svs[0] = sv<T, Add>; svs[1] = sv<T, Sub>; svs[2] = sv<T, Mul>; svs[3] = sv<T, Div>;
+}
+
+// ---- statement shapes: each rounds after every operation, like the TAC it replaces ----
+
+template <class T> struct AxpbFn { // x * a + b
+    typename T::S a, b;
+    typename T::V va = T::set1(a), vb = T::set1(b);
+    typename T::V vec(typename T::V x) const { return T::add(T::mul(x, va), vb); }
+    typename T::S one(typename T::S x) const { typename T::S t = x * a; return t + b; }
+};
+template <class T> struct XmogFn { // (x - o) * g
+    typename T::S o, g;
+    typename T::V vo = T::set1(o), vg = T::set1(g);
+    typename T::V vec(typename T::V x) const { return T::mul(T::sub(x, vo), vg); }
+    typename T::S one(typename T::S x) const { typename T::S t = x - o; return t * g; }
+};
+template <class T> struct AxbyFn { // x * a + y * b
+    typename T::S a, b;
+    typename T::V va = T::set1(a), vb = T::set1(b);
+    typename T::V vec(typename T::V x, typename T::V y) const { return T::add(T::mul(x, va), T::mul(y, vb)); }
+    typename T::S one(typename T::S x, typename T::S y) const {
+        typename T::S t = x * a, u = y * b;
+        return t + u;
+    }
+};
+template <class T> struct SqrFn { // x * x
+    typename T::V vec(typename T::V x) const { return T::mul(x, x); }
+    typename T::S one(typename T::S x) const { return x * x; }
+};
+
+template <class T> void axpb(typename T::S *d, const typename T::S *x, typename T::S a, typename T::S b, size_t n) {
+    mapN<T>(d, AxpbFn<T>{a, b}, n, Array<T>{x});
+}
+template <class T> void xmog(typename T::S *d, const typename T::S *x, typename T::S o, typename T::S g, size_t n) {
+    mapN<T>(d, XmogFn<T>{o, g}, n, Array<T>{x});
+}
+template <class T>
+void axby(typename T::S *d, const typename T::S *x, typename T::S a, const typename T::S *y, typename T::S b, size_t n) {
+    mapN<T>(d, AxbyFn<T>{a, b}, n, Array<T>{x}, Array<T>{y});
+}
+template <class T> void sqr(typename T::S *d, const typename T::S *x, size_t n) {
+    mapN<T>(d, SqrFn<T>(), n, Array<T>{x});
+}
+
+// ---- Q15 fixed point ----
+
+// FxShift narrowed to int32; by construction every bound fits.
+struct Q15Shift {
+    int32_t lo, hi, bias, outLo, outHi;
+    int left, right;
+    explicit Q15Shift(const FxShift &s)
+        : lo((int32_t)s.lo), hi((int32_t)s.hi), bias((int32_t)s.bias), outLo((int32_t)s.outLo),
+          outHi((int32_t)s.outHi), left(s.left), right(s.right) {}
+    int32_t operator()(int32_t v) const {
+        v = v < lo ? lo : v > hi ? hi : v;
+        v = (int32_t)((uint32_t)v << left);
+        v = (v + bias) >> right;
+        return v < outLo ? outLo : v > outHi ? outHi : v;
+    }
+};
+
+template <class Op>
+void q15addSub(int16_t *d, const int16_t *a, const FxShift &sa, const int16_t *b, const FxShift &sb, const FxShift &r,
+               size_t n) {
+    const Q15Shift fa(sa), fb(sb), fr(r);
+    for (size_t i = 0; i < n; ++i) d[i] = (int16_t)fr(Op::one(fa(a[i]), fb(b[i])));
+}
+inline void q15mul(int16_t *d, const int16_t *a, const int16_t *b, const FxShift &r, size_t n) {
+    const Q15Shift fr(r);
+    for (size_t i = 0; i < n; ++i) d[i] = (int16_t)fr((int32_t)a[i] * b[i]);
+}
+inline void q15move(int16_t *d, const int16_t *a, const FxShift &r, size_t n) {
+    const Q15Shift fr(r);
+    for (size_t i = 0; i < n; ++i) d[i] = (int16_t)fr(a[i]);
+}
+
+// The numerator stays below 2^30, so the float64 quotient truncates to the same
+// integer as an integer division would, and vectorizes where that does not. Each
+// loop keeps to few element types, or the vectorizer gives up.
+inline void q15div(int16_t *d, const int16_t *a, const int16_t *b, int pre, const FxShift &r, size_t n) {
+    const Q15Shift fr(r);
+    int32_t q[64];
+    for (size_t i0 = 0; i0 < n; i0 += 64) {
+        const size_t m = n - i0 < 64 ? n - i0 : 64;
+        for (size_t i = 0; i < m; ++i) {
+            const int32_t num = (int32_t)((uint32_t)a[i0 + i] << pre), den = b[i0 + i];
+            const int32_t un = num < 0 ? -num : num, ud = den < 0 ? -den : den;
+            const int32_t sign = (num ^ den) >> 31; // 0 or -1
+            const int32_t uq = (int32_t)(((double)un + (double)(ud >> 1)) / (double)(ud | (ud == 0)));
+            q[i] = (uq ^ sign) - sign;
+        }
+        for (size_t i = 0; i < m; ++i) q[i] = fr(q[i]);
+        for (size_t i = 0; i < m; ++i) d[i0 + i] = (int16_t)q[i];
+        for (size_t i = 0; i < m; ++i) // b == 0 saturates by a's sign
+            if (b[i0 + i] == 0) d[i0 + i] = a[i0 + i] > 0 ? 32767 : a[i0 + i] < 0 ? -32768 : 0;
+    }
+}
+
+template <class F64, class F32>
+SimdKernelTable buildTable(SimdLevel level) {
+    SimdKernelTable t;
+    t.level = level;
+    fill<F64>(t.f64vv, t.f64vs, t.f64sv);
+    fill<F32>(t.f32vv, t.f32vs, t.f32sv);
+    t.f64axpb = axpb<F64>; t.f64xmog = xmog<F64>; t.f64axby = axby<F64>; t.f64sqr = sqr<F64>;
+    t.f32axpb = axpb<F32>; t.f32xmog = xmog<F32>; t.f32axby = axby<F32>; t.f32sqr = sqr<F32>;
+    t.q15add = q15addSub<Add>; t.q15sub = q15addSub<Sub>; t.q15mul = q15mul; t.q15move = q15move;
+    t.q15div = q15div;
+    return t;
+}
+
+} // namespace
+
+#endif // SIMDKERNELSIMPL_H
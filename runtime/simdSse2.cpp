@@ -0,0 +1,38 @@
+#include "simdKernelsImpl.h"
+#include <emmintrin.h>
+
+// SSE2 kernels (part of the x86-64 baseline).
+
+namespace {
+struct F64 {
+    typedef double S;
+    typedef __m128d V;
+    static const int W = 2, ALIGN = 16;
+    static const bool MASKED = false;
+    static V load(const S *p) { return _mm_loadu_pd(p); }
+    static void store(S *p, V v) { _mm_store_pd(p, v); }
+    static V set1(S s) { return _mm_set1_pd(s); }
+    static V add(V a, V b) { return _mm_add_pd(a, b); }
+    static V sub(V a, V b) { return _mm_sub_pd(a, b); }
+    static V mul(V a, V b) { return _mm_mul_pd(a, b); }
+    static V div(V a, V b) { return _mm_div_pd(a, b); }
+};
+struct F32 {
+    typedef float S;
+    typedef __m128 V;
+    static const int W = 4, ALIGN = 16;
+    static const bool MASKED = false;
+    static V load(const S *p) { return _mm_loadu_ps(p); }
+    static void store(S *p, V v) { _mm_store_ps(p, v); }
+    static V set1(S s) { return _mm_set1_ps(s); }
+    static V add(V a, V b) { return _mm_add_ps(a, b); }
+    static V sub(V a, V b) { return _mm_sub_ps(a, b); }
+    static V mul(V a, V b) { return _mm_mul_ps(a, b); }
+    static V div(V a, V b) { return _mm_div_ps(a, b); }
+};
+} // namespace
+
+const SimdKernelTable &simdKernelsSse2() {
+    static const SimdKernelTable t = buildTable<F64, F32>(SimdLevel::SSE2);
+    return t;
+}
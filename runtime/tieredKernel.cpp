@@ -0,0 +1,155 @@
+#include "tieredKernel.h"
+#include "../errorHandler/errorHandler.h"
+
+using namespace std;
+
+TierCompiler::TierCompiler() : worker(&TierCompiler::loop, this) {}
+
+TierCompiler::~TierCompiler() {
+    {
+        lock_guard<mutex> g(lock);
+        stopping = true;
+        queue.clear();
+    }
+    wake.notify_all();
+    worker.join();
+}
+
+void TierCompiler::submit(function<void()> job) {
+    {
+        lock_guard<mutex> g(lock);
+        if (stopping) return;
+        queue.push_back(move(job));
+    }
+    wake.notify_one();
+}
+
+void TierCompiler::drain() {
+    unique_lock<mutex> g(lock);
+    idle.wait(g, [this]() { return queue.empty() && !busy; });
+}
+
+void TierCompiler::loop() {
+    unique_lock<mutex> g(lock);
+    for (;;) {
+        wake.wait(g, [this]() { return stopping || !queue.empty(); });
+        if (queue.empty()) break; // stopping
+        function<void()> job = move(queue.front());
+        queue.pop_front();
+        busy = true;
+        g.unlock();
+        job();
+        ++done;
+        g.lock();
+        busy = false;
+        if (queue.empty()) idle.notify_all();
+    }
+    busy = false;
+    idle.notify_all();
+}
+
+struct TieredKernel::Job {
+    vector<TacInst> tac;
+    ErrorHandler err;
+    SymbolTable sym{&err}; // only the state declarations
+    bool aot = false;
+    MathProfile math = MathProfile::STRICT;
+    atomic<bool> cancelled{false}, ready{false};
+    unique_ptr<JitKernel> jit; // written by the compiler thread before ready
+    unique_ptr<AotKernel> aotKernel;
+    string failure;
+
+    void build() {
+        if (cancelled.load(memory_order_relaxed)) return;
+        try {
+            if (aot) aotKernel.reset(new AotKernel(tac, &sym, AotOptions::defaults(math)));
+            else jit.reset(new JitKernel(tac, &sym));
+        } catch (const exception &e) {
+            failure = e.what();
+        }
+        ready.store(true, memory_order_release);
+    }
+};
+
+TieredKernel::TieredKernel(const vector<TacInst> &tac, const SymbolTable *sym, TierCompiler &tierCompiler,
+                           const TierOptions &tierOptions)
+    : vm(Bytecode::compile(tac, sym)), compiler(tierCompiler), options(tierOptions), job(make_shared<Job>()) {
+    job->tac = tac;
+    job->aot = options.aot;
+    job->math = options.math;
+    for (const auto &name : vm.bytecode().state) {
+        SymbolEntry e(name, "variable", "float");
+        e.is_state = true;
+        job->sym.insert(e);
+    }
+}
+
+TieredKernel::~TieredKernel() { job->cancelled.store(true, memory_order_relaxed); }
+
+string TieredKernel::tierName(Tier t) {
+    switch (t) {
+        case Tier::VM: return "vm";
+        case Tier::COMPILING: return "vm (compiling)";
+        default: return "native";
+    }
+}
+
+void TieredKernel::request() {
+    current = Tier::COMPILING;
+    shared_ptr<Job> j = job; // keeps the job alive if this kernel goes first
+    compiler.submit([j]() { j->build(); });
+}
+
+void TieredKernel::adopt() {
+    jit = move(job->jit);
+    aot = move(job->aotKernel);
+    const bool native = jit ? jit->compiled() : aot && aot->compiled();
+    if (!native) {
+        reason = jit ? jit->fallbackReason() : aot ? aot->fallbackReason() : job->failure;
+        jit.reset();
+        aot.reset();
+        current = Tier::VM; // the VM beats the backends' interpreter fallback
+        return;
+    }
+    if (jit) jit->restoreState(vm.saveState());
+    else aot->restoreState(vm.saveState());
+    current = Tier::NATIVE;
+}
+
+void TieredKernel::runBatch(const double *inputs, double *outputs, size_t n) {
+    DenormalScope denormals(options.denormals);
+    // tiers only change here, between batches
+    if (current == Tier::COMPILING && job->ready.load(memory_order_acquire)) adopt();
+    ++calls;
+    if (current == Tier::VM && reason.empty() && calls >= options.threshold) request();
+
+    if (current == Tier::NATIVE) {
+        if (jit) jit->runBatch(inputs, outputs, n);
+        else aot->runBatch(inputs, outputs, n);
+        return;
+    }
+    const size_t ni = vm.bytecode().inputs.size(), no = vm.bytecode().outputs.size();
+    for (size_t s = 0; s < n; ++s) {
+        try {
+            vm.run(inputs + s * ni, outputs + s * no);
+        } catch (const RuntimeError &e) {
+            if (n == 1) throw;
+            throw RuntimeError(string(e.what()) + " (sample " + to_string(s) + ")", e.inst);
+        }
+    }
+}
+
+void TieredKernel::reset() {
+    vm.reset();
+    if (jit) jit->reset();
+    if (aot) aot->reset();
+}
+
+void TieredKernel::print(ostream &out) const {
+    out << "tier: " << tierName(current) << " after " << calls << " batches (threshold " << options.threshold
+        << ", native tier " << (options.aot ? "aot" : "jit") << ")";
+    if (options.denormals == DenormalMode::FLUSH) out << ", denormals flushed";
+    if (options.math == MathProfile::FASTMATH && options.aot) out << ", fastmath";
+    if (!reason.empty()) out << ", staying on the vm: " << reason;
+    out << "\n";
+}
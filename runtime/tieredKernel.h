@@ -0,0 +1,109 @@
+#ifndef TIEREDKERNEL_H
+#define TIEREDKERNEL_H
+
+#include "vm.h"
+#include "jit.h"
+#include "aotKernel.h"
+#include "floatEnv.h"
+#include <vector>
+#include <string>
+#include <deque>
+#include <memory>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <iostream>
+
+/*
+ * TierCompiler
+ *  - One background thread that builds native tiers, in request order, for any
+ *    number of TieredKernels. Jobs submitted after shutdown starts are dropped.
+ */
+class TierCompiler {
+public:
+    TierCompiler();
+    ~TierCompiler(); // finishes the running job, drops the queued ones, joins
+    TierCompiler(const TierCompiler &) = delete;
+    TierCompiler &operator=(const TierCompiler &) = delete;
+
+    void submit(std::function<void()> job);
+    void drain(); // block until the queue is empty and no job is running
+    size_t compiled() const { return done; }
+
+private:
+    std::mutex lock;
+    std::condition_variable wake, idle;
+    std::deque<std::function<void()>> queue;
+    bool stopping = false, busy = false;
+    std::atomic<size_t> done{0};
+    std::thread worker; // last: starts once the members above exist
+
+    void loop();
+};
+
+struct TierOptions {
+    size_t threshold = 16; // batches on the VM before the native tier is requested
+    bool aot = false;      // native tier: AotKernel instead of JitKernel
+    // Per-program float modes: denormals applies to every batch on either tier (on
+    // the calling thread, restored when the batch returns); math picks the AOT flags.
+    DenormalMode denormals = DenormalMode::PRESERVE;
+    MathProfile math = MathProfile::STRICT;
+};
+
+/*
+ * TieredKernel
+ *  - Starts on the bytecode VM (cheap to build, small) and counts invocations
+ *    (runBatch calls). At the threshold it asks the shared TierCompiler for a native
+ *    kernel and keeps serving batches from the VM while that is built.
+ *  - The finished kernel is published with a release store and adopted at the
+ *    start of the next batch, so a batch never mixes tiers and the stream never
+ *    waits for the compiler. State moves over with the swap.
+ *  - The background job works on its own copy of the program and of the state
+ *    declarations, so the caller's SymbolTable may go away after construction.
+ *    If native code is not possible the kernel stays on the VM.
+ */
+class TieredKernel {
+public:
+    enum class Tier { VM, COMPILING, NATIVE };
+
+    TieredKernel(const std::vector<TacInst> &tac, const SymbolTable *sym, TierCompiler &compiler,
+                 const TierOptions &options = TierOptions());
+    ~TieredKernel(); // a queued compile is cancelled
+    TieredKernel(const TieredKernel &) = delete;
+    TieredKernel &operator=(const TieredKernel &) = delete;
+
+    Tier tier() const { return current; }
+    size_t invocations() const { return calls; }
+    const std::string &fallbackReason() const { return reason; }
+    const std::vector<std::string> &inputNames() const { return vm.bytecode().inputs; }
+    const std::vector<std::string> &outputNames() const { return vm.bytecode().outputs; }
+
+    // n samples, rows of inputs/outputs stored one after another.
+    void runBatch(const double *inputs, double *outputs, size_t n);
+    void run(const double *inputs, double *outputs) { runBatch(inputs, outputs, 1); }
+
+    void reset(); // zero state in whichever tier is running
+    void print(std::ostream &out = std::cout) const;
+
+    static std::string tierName(Tier t);
+
+private:
+    struct Job; // shared with the background thread
+
+    VM vm;
+    TierCompiler &compiler;
+    TierOptions options;
+    std::shared_ptr<Job> job;
+    std::unique_ptr<JitKernel> jit;
+    std::unique_ptr<AotKernel> aot;
+    Tier current = Tier::VM;
+    size_t calls = 0;
+    std::string reason;
+
+    void request();
+    void adopt();
+};
+
+#endif // TIEREDKERNEL_H
@@ -0,0 +1,162 @@
+#include "vm.h"
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+
+using namespace std;
+
+VM::VM(const Bytecode &code) : bc(code), frame(code.numSlots, 0.0) {}
+
+void VM::reset() { fill(frame.begin(), frame.end(), 0.0); }
+
+vector<double> VM::saveState() const {
+    vector<double> values;
+    for (uint16_t s : bc.stateSlots) values.push_back(frame[s]);
+    return values;
+}
+
+void VM::restoreState(const vector<double> &values) {
+    for (size_t k = 0; k < bc.stateSlots.size() && k < values.size(); ++k) frame[bc.stateSlots[k]] = values[k];
+}
+
+bool VM::threaded() {
+#ifdef SIGNALLANG_COMPUTED_GOTO
+    return true;
+#else
+    return false;
+#endif
+}
+
+void VM::guardFailed(BcOp op, int slot, size_t pc) const {
+    const string &name = bc.slotNames[slot];
+    string what = op == BcOp::GUARD_NONZERO ? "division by zero: " : "non-finite output: ";
+    throw RuntimeError(what + name + " is " + formatLiteral(frame[slot]), (int)pc);
+}
+
+static inline unsigned rd16(const uint8_t *p) {
+    uint16_t v;
+    memcpy(&v, p, 2);
+    return v; // the bytecode is little endian, like every target we run on
+}
+
+#define D rd16(pc + 1)
+#define A rd16(pc + 3)
+#define B rd16(pc + 5)
+#define C rd16(pc + 7)
+#define E rd16(pc + 9)
+#define F32(x) ((float)(x))
+
+void VM::runSwitch(const double *inputs, double *outputs) {
+    double *f = frame.data();
+    const double *k = bc.consts.data();
+    for (size_t i = 0; i < bc.inputSlots.size(); ++i) f[bc.inputSlots[i]] = inputs[i];
+
+    const uint8_t *pc = bc.code.data();
+    for (;;) {
+        switch ((BcOp)*pc) {
+            case BcOp::LOAD_CONST: f[D] = k[A]; pc += 5; break;
+            case BcOp::MOVE: f[D] = f[A]; pc += 5; break;
+            case BcOp::ADD: f[D] = f[A] + f[B]; pc += 7; break;
+            case BcOp::SUB: f[D] = f[A] - f[B]; pc += 7; break;
+            case BcOp::MUL: f[D] = f[A] * f[B]; pc += 7; break;
+            case BcOp::DIV: f[D] = f[A] / f[B]; pc += 7; break;
+            case BcOp::FMA: f[D] = std::fma(f[A], f[B], f[C]); pc += 9; break;
+            case BcOp::ADD_F32: f[D] = F32(f[A]) + F32(f[B]); pc += 7; break;
+            case BcOp::SUB_F32: f[D] = F32(f[A]) - F32(f[B]); pc += 7; break;
+            case BcOp::MUL_F32: f[D] = F32(f[A]) * F32(f[B]); pc += 7; break;
+            case BcOp::DIV_F32: f[D] = F32(f[A]) / F32(f[B]); pc += 7; break;
+            case BcOp::FMA_F32: f[D] = std::fmaf(F32(f[A]), F32(f[B]), F32(f[C])); pc += 9; break;
+            case BcOp::MOVE_F32: f[D] = F32(f[A]); pc += 5; break;
+            case BcOp::GUARD_NONZERO:
+                if (f[D] == 0.0 || std::isnan(f[D])) guardFailed(BcOp::GUARD_NONZERO, D, pc - bc.code.data());
+                pc += 3;
+                break;
+            case BcOp::GUARD_FINITE:
+                if (!std::isfinite(f[D])) guardFailed(BcOp::GUARD_FINITE, D, pc - bc.code.data());
+                pc += 3;
+                break;
+            case BcOp::ADD_IMM: f[D] = f[A] + k[B]; pc += 7; break;
+            case BcOp::SUB_IMM: f[D] = f[A] - k[B]; pc += 7; break;
+            case BcOp::RSUB_IMM: f[D] = k[B] - f[A]; pc += 7; break;
+            case BcOp::MUL_IMM: f[D] = f[A] * k[B]; pc += 7; break;
+            case BcOp::DIV_IMM: f[D] = f[A] / k[B]; pc += 7; break;
+            case BcOp::RDIV_IMM: f[D] = k[B] / f[A]; pc += 7; break;
+            case BcOp::MUL_IMM_ADD: { double t = f[A] * k[B]; f[D] = t; f[C] = t + f[E]; pc += 11; break; }
+            case BcOp::MUL_IMM_SUB: { double t = f[A] * k[B]; f[D] = t; f[C] = t - f[E]; pc += 11; break; }
+            case BcOp::MUL_IMM_RSUB: { double t = f[A] * k[B]; f[D] = t; f[C] = f[E] - t; pc += 11; break; }
+            case BcOp::SUB_MOVE: { double t = f[A] - f[B]; f[D] = t; f[C] = t; pc += 9; break; }
+            case BcOp::MUL_MOVE: { double t = f[A] * f[B]; f[D] = t; f[C] = t; pc += 9; break; }
+            default:
+                for (size_t i = 0; i < bc.outputSlots.size(); ++i) outputs[i] = f[bc.outputSlots[i]];
+                return;
+        }
+    }
+}
+
+void VM::run(const double *inputs, double *outputs) {
+#ifndef SIGNALLANG_COMPUTED_GOTO
+    runSwitch(inputs, outputs);
+#else
+    // order must match BcOp
+    static void *const labels[] = {&&L_LOAD_CONST, &&L_MOVE, &&L_ADD, &&L_SUB, &&L_MUL, &&L_DIV, &&L_FMA,
+                                   &&L_ADD_F32, &&L_SUB_F32, &&L_MUL_F32, &&L_DIV_F32, &&L_FMA_F32, &&L_MOVE_F32,
+                                   &&L_GUARD_NONZERO, &&L_GUARD_FINITE,
+                                   &&L_ADD_IMM, &&L_SUB_IMM, &&L_RSUB_IMM, &&L_MUL_IMM, &&L_DIV_IMM, &&L_RDIV_IMM,
+                                   &&L_MUL_IMM_ADD, &&L_MUL_IMM_SUB, &&L_MUL_IMM_RSUB, &&L_SUB_MOVE, &&L_MUL_MOVE,
+                                   &&L_HALT};
+    static_assert(sizeof(labels) / sizeof(labels[0]) == (size_t)BcOp::COUNT, "one label per opcode");
+
+    double *f = frame.data();
+    const double *k = bc.consts.data();
+    for (size_t i = 0; i < bc.inputSlots.size(); ++i) f[bc.inputSlots[i]] = inputs[i];
+
+    const uint8_t *pc = bc.code.data();
+#define NEXT(n) do { pc += (n); goto *labels[*pc]; } while (0)
+    goto *labels[*pc];
+L_LOAD_CONST: f[D] = k[A]; NEXT(5);
+L_MOVE: f[D] = f[A]; NEXT(5);
+L_ADD: f[D] = f[A] + f[B]; NEXT(7);
+L_SUB: f[D] = f[A] - f[B]; NEXT(7);
+L_MUL: f[D] = f[A] * f[B]; NEXT(7);
+L_DIV: f[D] = f[A] / f[B]; NEXT(7);
+L_FMA: f[D] = std::fma(f[A], f[B], f[C]); NEXT(9);
+L_ADD_F32: f[D] = F32(f[A]) + F32(f[B]); NEXT(7);
+L_SUB_F32: f[D] = F32(f[A]) - F32(f[B]); NEXT(7);
+L_MUL_F32: f[D] = F32(f[A]) * F32(f[B]); NEXT(7);
+L_DIV_F32: f[D] = F32(f[A]) / F32(f[B]); NEXT(7);
+L_FMA_F32: f[D] = std::fmaf(F32(f[A]), F32(f[B]), F32(f[C])); NEXT(9);
+L_MOVE_F32: f[D] = F32(f[A]); NEXT(5);
+L_GUARD_NONZERO:
+    if (f[D] == 0.0 || std::isnan(f[D])) guardFailed(BcOp::GUARD_NONZERO, D, pc - bc.code.data());
+    NEXT(3);
+L_GUARD_FINITE:
+    if (!std::isfinite(f[D])) guardFailed(BcOp::GUARD_FINITE, D, pc - bc.code.data());
+    NEXT(3);
+L_ADD_IMM: f[D] = f[A] + k[B]; NEXT(7);
+L_SUB_IMM: f[D] = f[A] - k[B]; NEXT(7);
+L_RSUB_IMM: f[D] = k[B] - f[A]; NEXT(7);
+L_MUL_IMM: f[D] = f[A] * k[B]; NEXT(7);
+L_DIV_IMM: f[D] = f[A] / k[B]; NEXT(7);
+L_RDIV_IMM: f[D] = k[B] / f[A]; NEXT(7);
+L_MUL_IMM_ADD: { double t = f[A] * k[B]; f[D] = t; f[C] = t + f[E]; } NEXT(11);
+L_MUL_IMM_SUB: { double t = f[A] * k[B]; f[D] = t; f[C] = t - f[E]; } NEXT(11);
+L_MUL_IMM_RSUB: { double t = f[A] * k[B]; f[D] = t; f[C] = f[E] - t; } NEXT(11);
+L_SUB_MOVE: { double t = f[A] - f[B]; f[D] = t; f[C] = t; } NEXT(9);
+L_MUL_MOVE: { double t = f[A] * f[B]; f[D] = t; f[C] = t; } NEXT(9);
+L_HALT:
+    for (size_t i = 0; i < bc.outputSlots.size(); ++i) outputs[i] = f[bc.outputSlots[i]];
+#undef NEXT
+#endif
+}
+
+#undef D
+#undef A
+#undef B
+#undef C
+#undef E
+#undef F32
+
+void VM::runBatch(const double *inputs, double *outputs, size_t n) {
+    const size_t ni = bc.inputSlots.size(), no = bc.outputSlots.size();
+    for (size_t s = 0; s < n; ++s) run(inputs + s * ni, outputs + s * no);
+}
@@ -0,0 +1,48 @@
+#ifndef VM_H
+#define VM_H
+
+#include "bytecode.h"
+#include "interpreter.h"
+#include <vector>
+
+/*
+ * VM
+ *  - Executes Bytecode one sample at a time over a frame of 16-bit-indexed slots.
+ *  - run() is direct threaded: with GCC/Clang each handler jumps straight to the
+ *    next one through a label table (computed goto); elsewhere, or when built with
+ *    SIGNALLANG_NO_COMPUTED_GOTO, it is the switch loop.
+ *  - runSwitch() is the portable switch loop, always available (for comparison).
+ *  - Semantics match the reference Interpreter, including state slots, F32 opcodes
+ *    and RuntimeError on a failing guard.
+ */
+#if (defined(__GNUC__) || defined(__clang__)) && !defined(SIGNALLANG_NO_COMPUTED_GOTO)
+#define SIGNALLANG_COMPUTED_GOTO 1
+#endif
+
+class VM {
+public:
+    explicit VM(const Bytecode &bc);
+
+    // inputs in bytecode().inputs order; outputs written in bytecode().outputs order.
+    void run(const double *inputs, double *outputs);
+    void runSwitch(const double *inputs, double *outputs);
+
+    // n samples, rows of inputs/outputs stored one after another.
+    void runBatch(const double *inputs, double *outputs, size_t n);
+
+    void reset(); // zero the frame, including state
+    // State values in bytecode().state order.
+    std::vector<double> saveState() const;
+    void restoreState(const std::vector<double> &values);
+    const Bytecode &bytecode() const { return bc; }
+
+    static bool threaded(); // true when run() uses computed goto
+
+private:
+    Bytecode bc;
+    std::vector<double> frame;
+
+    [[noreturn]] void guardFailed(BcOp op, int slot, size_t pc) const;
+};
+
+#endif // VM_H
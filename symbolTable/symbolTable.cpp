@@ -110,6 +110,14 @@ SymbolEntry* SymbolTable::lookup(const string &name) {
     return nullptr; // not found
 }
 
+const SymbolEntry* SymbolTable::lookup(const string &name) const {
+    for (int i = static_cast<int>(scopes.size()) - 1; i >= 0; --i) {
+        auto it = scopes[i].find(name);
+        if (it != scopes[i].end()) return &it->second;
+    }
+    return nullptr;
+}
+
 // Lookup a symbol only in the current scope
 SymbolEntry* SymbolTable::lookupLocal(const string &name) {
     if (scopes.empty()) return nullptr;
@@ -92,6 +92,7 @@ public:
     // Lookup a symbol from the innermost to outermost scope
     // Returns pointer to SymbolEntry or nullptr if not found
     SymbolEntry* lookup(const std::string &name);
+    const SymbolEntry* lookup(const std::string &name) const;
 
     // Lookup a symbol only in top (current) scope
     SymbolEntry* lookupLocal(const std::string &name);
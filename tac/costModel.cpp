@@ -0,0 +1,167 @@
+#include "costModel.h"
+#include <unordered_map>
+#include <unordered_set>
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+
+using namespace std;
+
+const OpCost &TargetModel::cost(TACOp op) const {
+    auto it = ops.find(op);
+    return it != ops.end() ? it->second : defaultCost;
+}
+
+LatencyTable TargetModel::latencies() const {
+    LatencyTable t;
+    t.defaultLatency = defaultCost.latency;
+    for (const auto &p : ops) t.latency[p.first] = p.second.latency;
+    return t;
+}
+
+static void set(TargetModel &t, TACOp op, int latency, double rthroughput) {
+    t.ops[op] = OpCost{latency, rthroughput};
+}
+
+bool TargetModel::byName(const string &name, TargetModel &t) {
+    t = TargetModel();
+    t.name = name;
+    if (name == "generic") {
+        // single issue, every instruction occupies the pipeline for one cycle
+        LatencyTable lat = LatencyTable::defaults();
+        for (const auto &p : lat.latency) set(t, p.first, p.second, p.first == TACOp::NOP ? 0 : 1);
+        t.defaultCost = OpCost{lat.defaultLatency, 1};
+        return true;
+    }
+    if (name == "x86-64") {
+        // recent out-of-order x86-64 (two FP pipes, constants loaded from memory)
+        t.issueWidth = 4;
+        t.inOrder = false;
+        t.loadLatency = 5;
+        t.memRthroughput = 0.5;
+        set(t, TACOp::LOAD_CONST, 5, 0.5);
+        set(t, TACOp::ASSIGN, 1, 0.25);
+        set(t, TACOp::ADD, 4, 0.5);
+        set(t, TACOp::SUB, 4, 0.5);
+        set(t, TACOp::MUL, 4, 0.5);
+        set(t, TACOp::DIV, 14, 4);
+        set(t, TACOp::FMA, 4, 0.5);
+        set(t, TACOp::GUARD_NONZERO, 3, 1);
+        set(t, TACOp::GUARD_FINITE, 3, 1);
+        set(t, TACOp::NOP, 0, 0);
+        return true;
+    }
+    if (name == "cortex-a53") {
+        // in-order dual issue, non-pipelined double divide
+        t.issueWidth = 2;
+        t.loadLatency = 3;
+        set(t, TACOp::LOAD_CONST, 3, 1);
+        set(t, TACOp::ASSIGN, 1, 0.5);
+        set(t, TACOp::ADD, 4, 1);
+        set(t, TACOp::SUB, 4, 1);
+        set(t, TACOp::MUL, 4, 1);
+        set(t, TACOp::DIV, 22, 19);
+        set(t, TACOp::FMA, 8, 1);
+        set(t, TACOp::GUARD_NONZERO, 2, 1);
+        set(t, TACOp::GUARD_FINITE, 3, 1);
+        set(t, TACOp::NOP, 0, 0);
+        return true;
+    }
+    return false;
+}
+
+vector<string> TargetModel::names() { return {"generic", "x86-64", "cortex-a53"}; }
+
+CostEstimate CostModel::estimate(const vector<TacInst> &tac, const TargetModel &target, const RegAllocResult *alloc) {
+    CostEstimate est;
+    est.target = target.name;
+    const int n = (int)tac.size();
+
+    unordered_map<string, int> lastDef;
+    unordered_set<string> names;
+    vector<int> finish(n, 0), avail(n, 0);
+    int prevIssue = 0, issuedThisCycle = 0;
+    double pipeFree = 0; // in-order: cycle the FP pipeline can accept the next op
+
+    for (int i = 0; i < n; ++i) {
+        const TacInst &inst = tac[i];
+        if (!inst.dest.empty()) names.insert(inst.dest);
+        for (const auto &u : usesOf(inst)) names.insert(u);
+        if (inst.op == TACOp::NOP) continue;
+
+        bool coalesced = alloc && i < (int)alloc->insts.size() && alloc->insts[i].coalesced;
+        OpCost c = coalesced ? OpCost{0, 0} : target.cost(inst.op);
+        int reloads = 0;
+        if (alloc && i < (int)alloc->insts.size()) {
+            const InstAlloc &a = alloc->insts[i];
+            reloads = (a.arg1.kind == Location::SLOT) + (a.arg2.kind == Location::SLOT) +
+                      (a.arg3.kind == Location::SLOT);
+            int stores = a.dest.kind == Location::SLOT;
+            est.resourceBound += (reloads + stores) * target.memRthroughput;
+        }
+        if (!coalesced) {
+            est.instructions++;
+            est.opCounts[inst.op]++;
+        }
+        est.resourceBound += c.rthroughput;
+
+        // operands ready (dataflow order, for the critical path)
+        int ready = reloads ? target.loadLatency : 0;
+        for (const auto &u : usesOf(inst)) {
+            auto d = lastDef.find(u);
+            if (d != lastDef.end()) ready = max(ready, finish[d->second]);
+        }
+        finish[i] = ready + c.latency;
+        est.criticalPath = max(est.criticalPath, finish[i]);
+
+        // in-order issue: not before the previous instruction, width per cycle,
+        // operands ready and the pipeline free
+        if (target.inOrder) {
+            int operandsAt = reloads ? prevIssue + target.loadLatency : 0;
+            for (const auto &u : usesOf(inst)) {
+                auto d = lastDef.find(u);
+                if (d != lastDef.end()) operandsAt = max(operandsAt, avail[d->second]);
+            }
+            if (coalesced) {
+                avail[i] = operandsAt; // same register, nothing to issue
+            } else {
+                int t = issuedThisCycle >= target.issueWidth ? prevIssue + 1 : prevIssue;
+                t = max(t, max(operandsAt, (int)ceil(pipeFree)));
+                issuedThisCycle = t == prevIssue ? issuedThisCycle + 1 : 1;
+                prevIssue = t;
+                pipeFree = max(pipeFree, (double)t) + c.rthroughput;
+                avail[i] = t + c.latency;
+                est.cyclesPerSample = max(est.cyclesPerSample, (double)avail[i]);
+            }
+        }
+        if (!inst.dest.empty()) lastDef[inst.dest] = i;
+    }
+
+    est.issueBound = (double)est.instructions / max(1, target.issueWidth);
+    if (!target.inOrder)
+        est.cyclesPerSample = max((double)est.criticalPath, max(est.resourceBound, est.issueBound));
+    est.frameSlots = (int)names.size();
+    est.frameBytes = est.frameSlots * target.valueBytes;
+    if (alloc) est.spillBytes = alloc->spillSlots * target.valueBytes;
+    return est;
+}
+
+void CostModel::print(const CostEstimate &est, ostream &out) {
+    out << "target: " << est.target << "\n";
+    out << "instructions: " << est.instructions << " (";
+    bool first = true;
+    for (const auto &p : est.opCounts) {
+        out << (first ? "" : ", ") << opToString(p.first) << " " << p.second;
+        first = false;
+    }
+    out << ")\n";
+    out << fixed << setprecision(2);
+    out << "critical path: " << est.criticalPath << " cycles\n";
+    out << "pipeline occupancy: " << est.resourceBound << " cycles, issue bound: " << est.issueBound << " cycles\n";
+    out << "estimated cycles/sample: " << est.cyclesPerSample << "\n";
+    out << "frame: " << est.frameSlots << " slots, " << est.frameBytes << " bytes";
+    if (est.spillBytes) out << " (" << est.spillBytes << " bytes of spill slots)";
+    out << "\n";
+    out.unsetf(ios::fixed);
+    out << setprecision(6);
+}
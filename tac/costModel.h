@@ -0,0 +1,75 @@
+#ifndef COSTMODEL_H
+#define COSTMODEL_H
+
+#include "tac.h"
+#include "scheduler.h"
+#include "regAlloc.h"
+#include <vector>
+#include <map>
+#include <string>
+#include <iostream>
+
+/*
+ * TargetModel
+ *  - Per-target cost of each TACOp: result latency and reciprocal throughput
+ *    (cycles the shared FP pipeline is busy per instruction), plus issue width and
+ *    whether the core executes in order.
+ *  - "generic" is the single-issue model the scheduler has always used; the other
+ *    tables are approximate figures for scalar double arithmetic on those cores.
+ */
+struct OpCost {
+    int latency = 1;
+    double rthroughput = 1.0;
+};
+
+struct TargetModel {
+    std::string name;
+    std::map<TACOp, OpCost> ops;
+    OpCost defaultCost;
+    int issueWidth = 1;
+    bool inOrder = true;
+    int valueBytes = 8;     // one double per frame slot
+    int loadLatency = 4;    // spill reload
+    double memRthroughput = 1.0;
+
+    const OpCost &cost(TACOp op) const;
+    LatencyTable latencies() const; // for InstructionScheduler
+
+    static bool byName(const std::string &name, TargetModel &out);
+    static std::vector<std::string> names();
+};
+
+/*
+ * CostModel
+ *  - Static per-sample cost of a TAC module on a target, for admission control
+ *    before a program is deployed on a shared node.
+ *  - criticalPath : latency-weighted longest dependence chain (one sample alone)
+ *  - cyclesPerSample:
+ *      in-order targets : simulated in-order issue (width, operand latency and
+ *                         pipeline occupancy)
+ *      out-of-order     : max(critical path, FP pipeline occupancy, issue bound);
+ *                         samples are assumed to run one call at a time
+ *  - frameBytes   : slot-indexed frame, one slot per distinct TAC name
+ *  - with an allocation, coalesced moves are free and spill traffic is charged.
+ */
+struct CostEstimate {
+    std::string target;
+    int instructions = 0;
+    std::map<TACOp, int> opCounts;
+    int criticalPath = 0;
+    double resourceBound = 0; // sum of reciprocal throughputs
+    double issueBound = 0;    // instructions / issue width
+    double cyclesPerSample = 0;
+    int frameSlots = 0;
+    int frameBytes = 0;
+    int spillBytes = 0;
+};
+
+class CostModel {
+public:
+    static CostEstimate estimate(const std::vector<TacInst> &tac, const TargetModel &target,
+                                 const RegAllocResult *alloc = nullptr);
+    static void print(const CostEstimate &est, std::ostream &out = std::cout);
+};
+
+#endif // COSTMODEL_H
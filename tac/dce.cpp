@@ -5,28 +5,6 @@
 
 using namespace std;
 
-static inline vector<string> usesOf(const TacInst &i) {
-    vector<string> res;
-    switch (i.op) {
-        case TACOp::LOAD_CONST:
-            // no uses
-            break;
-        case TACOp::ASSIGN:
-            if (!i.arg1.empty()) res.push_back(i.arg1);
-            break;
-        case TACOp::ADD:
-        case TACOp::SUB:
-        case TACOp::MUL:
-        case TACOp::DIV:
-            if (!i.arg1.empty()) res.push_back(i.arg1);
-            if (!i.arg2.empty()) res.push_back(i.arg2);
-            break;
-        default:
-            break;
-    }
-    return res;
-}
-
 void DeadCodeEliminator::eliminate(vector<TacInst> &tac, const SymbolTable &sym) {
     unordered_set<string> live;
     // initialize live set with variables that are externally used (sym.is_used)
@@ -39,7 +17,7 @@ void DeadCodeEliminator::eliminate(vector<TacInst> &tac, const SymbolTable &sym)
     // Build set of declared names from union of defs in TAC too.
     unordered_set<string> declared;
     for (const auto &inst : tac) {
-        if (!inst.dest.empty() && inst.dest[0] != 't') declared.insert(inst.dest);
+        if (!inst.dest.empty() && !isTempName(inst.dest)) declared.insert(inst.dest);
     }
     // Build set of unused from symbol table
     unordered_set<string> unusedSet;
@@ -57,11 +35,14 @@ void DeadCodeEliminator::eliminate(vector<TacInst> &tac, const SymbolTable &sym)
     vector<char> keep(tac.size(), 0);
     for (int i = (int)tac.size()-1; i >= 0; --i) {
         const TacInst &inst = tac[i];
-        bool hasSideEffect = false; // our instructions are pure
+        bool hasSideEffect = isGuard(inst.op); // guards report at runtime; the rest is pure
         const string &def = inst.dest;
-        if (!def.empty() && live.find(def) != live.end()) {
-            // definition is needed -> keep and add uses
+        if (hasSideEffect || (!def.empty() && live.find(def) != live.end())) {
+            // definition is needed -> keep and add uses; the def kills the name
+            // above this point (straight-line code, so an earlier def is only
+            // needed if something in between reads it)
             keep[i] = 1;
+            if (!def.empty()) live.erase(def);
             for (auto &u : usesOf(inst)) {
                 // if this use is a temp like tX, add it; or variable
                 if (!u.empty()) live.insert(u);
@@ -10,7 +10,8 @@
  *  - Performs a backward liveness pass on linear TAC (no control flow).
  *  - Preserves instructions that define symbols which are live (either
  *    used later in program, or marked used externally via symbol table).
- *  - Side-effect free assumption: LOAD_CONST, ASSIGN, ADD/SUB/MUL/DIV are pure.
+ *  - Side-effect free assumption: LOAD_CONST, ASSIGN, ADD/SUB/MUL/DIV are pure;
+ *    GUARD_* instructions are always kept (together with what they read).
  */
 class DeadCodeEliminator {
 public:
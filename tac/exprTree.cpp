@@ -0,0 +1,84 @@
+#include "exprTree.h"
+#include <unordered_map>
+#include <unordered_set>
+
+using namespace std;
+
+int ExprDag::arity(int node) const {
+    const ExprNode &n = nodes[node];
+    if (n.kind != ExprNode::OP) return 0;
+    return n.op == TACOp::FMA ? 3 : 2;
+}
+
+string ExprDag::toString(int node) const {
+    const ExprNode &n = nodes[node];
+    if (n.kind == ExprNode::INPUT) return n.name;
+    if (n.kind == ExprNode::CONST) return formatLiteral(n.value);
+    if (n.op == TACOp::FMA)
+        return "fma(" + toString(n.kids[0]) + ", " + toString(n.kids[1]) + ", " + toString(n.kids[2]) + ")";
+    const char *sym = n.op == TACOp::ADD ? " + " : n.op == TACOp::SUB ? " - " : n.op == TACOp::MUL ? " * " : " / ";
+    return "(" + toString(n.kids[0]) + sym + toString(n.kids[1]) + ")";
+}
+
+ExprDag ExprTreeBuilder::build(const vector<TacInst> &tac) {
+    ExprDag dag;
+    const int n = (int)tac.size();
+    dag.result.assign(n, -1);
+    dag.operands.assign(n, {{-1, -1, -1}});
+
+    unordered_map<string, int> current; // name -> node it holds
+    unordered_set<string> defined;
+    auto newNode = [&](ExprNode node) {
+        dag.nodes.push_back(node);
+        dag.consumers.emplace_back();
+        return (int)dag.nodes.size() - 1;
+    };
+    auto read = [&](const string &name, int inst) {
+        auto it = current.find(name);
+        int v;
+        if (it != current.end()) {
+            v = it->second;
+        } else {
+            ExprNode in;
+            in.name = name;
+            v = current[name] = newNode(in);
+        }
+        dag.nodes[v].uses++;
+        dag.consumers[v].push_back(inst);
+        return v;
+    };
+
+    for (int i = 0; i < n; ++i) {
+        const TacInst &inst = tac[i];
+        vector<string> uses = usesOf(inst);
+        for (size_t k = 0; k < uses.size() && k < 3; ++k) dag.operands[i][k] = read(uses[k], i);
+        if (inst.dest.empty()) continue;
+
+        int v;
+        if (inst.op == TACOp::ASSIGN) {
+            v = dag.operands[i][0];
+        } else {
+            ExprNode node;
+            node.inst = i;
+            node.name = inst.dest;
+            if (inst.op == TACOp::LOAD_CONST) {
+                node.kind = ExprNode::CONST;
+                node.value = literalValue(inst.arg1Literal);
+            } else {
+                node.kind = ExprNode::OP;
+                node.op = inst.op;
+                node.kids = dag.operands[i];
+            }
+            v = newNode(node);
+        }
+        dag.result[i] = current[inst.dest] = v;
+        defined.insert(inst.dest);
+    }
+
+    for (const auto &p : current) {
+        if (isTempName(p.first) || !defined.count(p.first)) continue;
+        dag.outputs[p.first] = p.second;
+        dag.nodes[p.second].uses++;
+    }
+    return dag;
+}
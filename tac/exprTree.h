@@ -0,0 +1,47 @@
+#ifndef EXPRTREE_H
+#define EXPRTREE_H
+
+#include "tac.h"
+#include <vector>
+#include <map>
+#include <string>
+#include <array>
+
+/*
+ * ExprTreeBuilder
+ *  - Rebuilds the expression DAG behind straight-line TAC so passes can reason
+ *    about whole expressions instead of single instructions (polynomial
+ *    rewriting, kernel shape matching).
+ *  - One node per value: program inputs, LOAD_CONST results and arithmetic
+ *    results. ASSIGN does not create a node; the copy names the same value.
+ *  - uses counts the instruction operands reading a node plus one for each
+ *    program output it ends up in, so uses == 1 means a private subexpression.
+ */
+struct ExprNode {
+    enum Kind { INPUT, CONST, OP };
+    Kind kind = INPUT;
+    TACOp op = TACOp::NOP;             // OP nodes
+    std::string name;                  // INPUT: variable; otherwise the name first holding it
+    double value = 0;                  // CONST
+    std::array<int, 3> kids{{-1, -1, -1}};
+    int inst = -1;                     // defining instruction (-1 for inputs)
+    int uses = 0;
+};
+
+struct ExprDag {
+    std::vector<ExprNode> nodes;
+    std::vector<int> result;                   // per instruction: node written (-1 if none)
+    std::vector<std::array<int, 3>> operands;  // per instruction: nodes read
+    std::map<std::string, int> outputs;        // program variable -> final value
+    std::vector<std::vector<int>> consumers;   // per node: instructions reading it
+
+    int arity(int node) const;
+    std::string toString(int node) const;      // infix form, for reports and tests
+};
+
+class ExprTreeBuilder {
+public:
+    static ExprDag build(const std::vector<TacInst> &tac);
+};
+
+#endif // EXPRTREE_H
@@ -0,0 +1,154 @@
+#include "fusion.h"
+#include <unordered_map>
+#include <unordered_set>
+
+using namespace std;
+
+FusedModule ProgramFuser::fuse(const vector<FusionInput> &programs) {
+    FusedModule m;
+    unordered_map<string, int> inputId;   // input channel -> canonical id
+    unordered_map<string, int> valueOf;   // value-numbering key -> value number
+    vector<string> holder;                // value number -> module name holding it
+    int nextTemp = 0;
+
+    auto newValue = [&](const string &key, const string &name) {
+        int vn = (int)holder.size();
+        holder.push_back(name);
+        valueOf[key] = vn;
+        return vn;
+    };
+
+    unordered_map<string, int> nameUses; // a program fused twice gets name_2, name_3, ...
+    for (const auto &prog : programs) {
+        m.instructionsBefore += (int)prog.tac.size();
+        const int use = ++nameUses[prog.name];
+        const string progName = use == 1 ? prog.name : prog.name + "_" + to_string(use);
+        const string prefix = progName + ".";
+
+        // last definition of each program variable, where it gets published; names
+        // read before that program defines them and then redefined carry over samples
+        unordered_map<string, size_t> lastDef;
+        unordered_set<string> readFirst, defined, own(prog.state.begin(), prog.state.end());
+        for (size_t i = 0; i < prog.tac.size(); ++i) {
+            for (const auto &u : usesOf(prog.tac[i])) if (!defined.count(u)) readFirst.insert(u);
+            if (prog.tac[i].dest.empty()) continue;
+            defined.insert(prog.tac[i].dest);
+            if (!isTempName(prog.tac[i].dest)) lastDef[prog.tac[i].dest] = i;
+        }
+        for (const auto &name : readFirst) if (lastDef.count(name)) own.insert(name);
+
+        unordered_map<string, int> current; // program name -> value number
+        auto operand = [&](const string &name) {
+            auto it = current.find(name);
+            if (it != current.end()) return it->second;
+            if (own.count(name)) {
+                // this program's state, read under its published name into a temp: the
+                // publishing ASSIGN overwrites that name while copies may still be read
+                TacInst load;
+                load.op = TACOp::ASSIGN;
+                load.dest = "t" + to_string(nextTemp++);
+                load.arg1 = prefix + name;
+                m.tac.push_back(load);
+                m.state.push_back(load.arg1);
+                int vn = newValue("S:" + load.arg1, load.dest);
+                current[name] = vn;
+                return vn;
+            }
+            auto in = inputId.find(name);
+            if (in == inputId.end()) {
+                in = inputId.emplace(name, (int)m.inputs.size()).first;
+                m.inputs.push_back(name);
+            }
+            string key = "I:" + to_string(in->second);
+            auto vn = valueOf.find(key);
+            return vn != valueOf.end() ? vn->second : newValue(key, name);
+        };
+
+        for (size_t i = 0; i < prog.tac.size(); ++i) {
+            const TacInst &inst = prog.tac[i];
+            if (isGuard(inst.op)) {
+                // one check per (guard kind, value) across all programs
+                int a = operand(inst.arg1);
+                string key = opToString(inst.op) + ":" + to_string(a);
+                if (valueOf.count(key)) { m.sharedValues++; continue; }
+                valueOf[key] = -1;
+                TacInst g = inst;
+                g.arg1 = holder[a];
+                m.tac.push_back(g);
+                continue;
+            }
+            if (inst.op == TACOp::NOP || inst.dest.empty()) continue;
+
+            int vn;
+            TacInst emit = inst;
+            const bool f32 = inst.prec == TacPrecision::F32;
+            if (inst.op == TACOp::ASSIGN && !f32) {
+                vn = operand(inst.arg1); // a copy is the same value under another name
+            } else {
+                // an F32 op rounds where its F64 twin does not: the precision is part of the key
+                string key = f32 ? "f32:" : "";
+                if (inst.op == TACOp::LOAD_CONST) {
+                    key += "C:" + formatLiteral(constValue(inst));
+                } else if (inst.op == TACOp::ASSIGN) { // F32 copy: rounds its operand
+                    const int a = operand(inst.arg1);
+                    key += "ASSIGN:" + to_string(a);
+                    emit.arg1 = holder[a];
+                } else {
+                    int a = operand(inst.arg1), b = operand(inst.arg2);
+                    if ((inst.op == TACOp::ADD || inst.op == TACOp::MUL) && b < a) swap(a, b);
+                    key += opToString(inst.op) + ":" + to_string(a) + "," + to_string(b);
+                    emit.arg1 = holder[operand(inst.arg1)];
+                    emit.arg2 = holder[operand(inst.arg2)];
+                    if (inst.op == TACOp::FMA) {
+                        int c = operand(inst.arg3);
+                        key += "," + to_string(c);
+                        emit.arg3 = holder[c];
+                    }
+                }
+                auto found = valueOf.find(key);
+                if (found != valueOf.end()) {
+                    vn = found->second;
+                    m.sharedValues++;
+                } else {
+                    emit.dest = "t" + to_string(nextTemp++);
+                    vn = newValue(key, emit.dest);
+                    m.tac.push_back(emit);
+                }
+            }
+            current[inst.dest] = vn;
+
+            auto ld = lastDef.find(inst.dest);
+            if (ld != lastDef.end() && ld->second == i) {
+                TacInst pub;
+                pub.op = TACOp::ASSIGN;
+                pub.dest = prefix + inst.dest;
+                pub.arg1 = holder[vn];
+                m.tac.push_back(pub);
+                m.outputs[progName][inst.dest] = pub.dest;
+            }
+        }
+    }
+    return m;
+}
+
+void ProgramFuser::print(const FusedModule &m, ostream &out) {
+    out << "inputs:";
+    for (size_t i = 0; i < m.inputs.size(); ++i) out << " #" << i << "=" << m.inputs[i];
+    out << "\n";
+    if (!m.state.empty()) {
+        out << "state:";
+        for (const auto &n : m.state) out << " " << n;
+        out << "\n";
+    }
+    for (size_t i = 0; i < m.tac.size(); ++i) {
+        out << i << ":\t";
+        printTacLine(m.tac[i], out);
+    }
+    for (const auto &p : m.outputs) {
+        out << "outputs of " << p.first << ":";
+        for (const auto &o : p.second) out << " " << o.first << "->" << o.second;
+        out << "\n";
+    }
+    out << "instructions: " << m.instructionsBefore << " across programs -> " << m.tac.size()
+        << " fused (" << m.sharedValues << " computations shared)\n";
+}
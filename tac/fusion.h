@@ -0,0 +1,50 @@
+#ifndef FUSION_H
+#define FUSION_H
+
+#include "tac.h"
+#include <vector>
+#include <map>
+#include <string>
+#include <iostream>
+
+/*
+ * ProgramFuser
+ *  - Compiles a set of programs that read the same input channels into one TAC module.
+ *  - Inputs (names a program reads before defining them) are shared: every program
+ *    that reads "signal1" reads the same canonical input.
+ *  - Value numbering is keyed on canonical input ids, literal values and
+ *    (op, operand value numbers), with ADD/MUL operands ordered, so a subexpression
+ *    computed by several programs is emitted once. F32 values are keyed apart from
+ *    F64 ones; an F32 copy rounds, so it is a value of its own, not a rename.
+ *  - Every value in the module is defined exactly once. Each program's variables are
+ *    published as "<program>.<variable>" at their final definition, so outputs stay
+ *    separately addressable.
+ *  - State is never shared: a state variable, or any name a program reads before
+ *    defining and then redefines, is read from "<program>.<variable>" instead of a
+ *    shared channel. That is the name it is published under, so the module carries
+ *    each program's state separately (listed in FusedModule::state).
+ */
+struct FusionInput {
+    std::string name;          // program name, used as output prefix (made unique with _2, _3, ...)
+    std::vector<TacInst> tac;  // program TAC (ideally after DCE)
+    std::vector<std::string> state; // state variables of the program (TacInterface::state)
+};
+
+struct FusedModule {
+    std::vector<TacInst> tac;
+    std::vector<std::string> inputs; // canonical input channels, index = input id
+    std::vector<std::string> state;  // per-program carried values, "<program>.<variable>"
+    std::map<std::string, std::map<std::string, std::string>> outputs; // program -> variable -> module name
+
+    int instructionsBefore = 0; // total instructions over all programs
+    int sharedValues = 0;       // computations reused instead of recomputed
+};
+
+class ProgramFuser {
+public:
+    static FusedModule fuse(const std::vector<FusionInput> &programs);
+
+    static void print(const FusedModule &m, std::ostream &out = std::cout);
+};
+
+#endif // FUSION_H
@@ -0,0 +1,79 @@
+#include "guards.h"
+#include <unordered_map>
+#include <set>
+#include <sstream>
+#include <algorithm>
+
+using namespace std;
+
+static TacInst makeGuard(TACOp op, const string &name) {
+    TacInst g;
+    g.op = op;
+    g.arg1 = name;
+    return g;
+}
+
+GuardStats GuardInserter::insert(vector<TacInst> &tac, const map<string, Interval> &inputRanges,
+                                 OptReport *report) {
+    GuardStats st;
+    RangeInfo ranges = RangeAnalysis::analyze(tac, inputRanges);
+
+    // value identity: name + defining instruction (-1 for inputs)
+    unordered_map<string, int> lastDef;
+    set<string> guarded;
+    auto valueKey = [&](const string &name) {
+        auto it = lastDef.find(name);
+        return name + "@" + to_string(it == lastDef.end() ? -1 : it->second);
+    };
+
+    int provedNonZero = 0, provedFinite = 0;
+    vector<TacInst> out;
+    out.reserve(tac.size());
+    for (size_t i = 0; i < tac.size(); ++i) {
+        const TacInst &inst = tac[i];
+        // guards already in the program (an earlier run) count as checks done
+        if (inst.op == TACOp::GUARD_NONZERO) guarded.insert("nz:" + valueKey(inst.arg1));
+        if (inst.op == TACOp::GUARD_FINITE) guarded.insert("fin:" + valueKey(inst.arg1));
+        if (inst.op == TACOp::DIV) {
+            st.candidates++;
+            string key = "nz:" + valueKey(inst.arg2);
+            if (ranges.arg2[i].containsZero() || ranges.arg2[i].mayBeNaN) {
+                if (guarded.insert(key).second) {
+                    out.push_back(makeGuard(TACOp::GUARD_NONZERO, inst.arg2));
+                    st.emitted++;
+                }
+            } else {
+                provedNonZero++;
+            }
+        }
+        out.push_back(inst);
+        if (!inst.dest.empty()) lastDef[inst.dest] = (int)i;
+    }
+
+    // outputs are checked once, after the last instruction, in order of definition
+    vector<pair<int, string>> outputs;
+    for (const auto &p : lastDef) if (!isTempName(p.first)) outputs.push_back({p.second, p.first});
+    sort(outputs.begin(), outputs.end());
+    for (const auto &o : outputs) {
+        st.candidates++;
+        if (ranges.result[o.first].isFinite()) {
+            provedFinite++;
+            continue;
+        }
+        if (guarded.insert("fin:" + valueKey(o.second)).second) {
+            out.push_back(makeGuard(TACOp::GUARD_FINITE, o.second));
+            st.emitted++;
+        }
+    }
+    tac.swap(out);
+    st.eliminated = st.candidates - st.emitted;
+
+    if (report) {
+        ostringstream msg;
+        msg << st.candidates << " runtime checks needed, " << st.emitted << " emitted, " << st.eliminated
+            << " eliminated (" << provedNonZero << " divisors proven non-zero, " << provedFinite
+            << " outputs proven finite)";
+        report->note("guards", msg.str());
+    }
+    return st;
+}
@@ -0,0 +1,35 @@
+#ifndef GUARDS_H
+#define GUARDS_H
+
+#include "tac.h"
+#include "rangeAnalysis.h"
+#include "optReport.h"
+#include <vector>
+#include <map>
+#include <string>
+
+/*
+ * GuardInserter
+ *  - Emits the runtime checks a safe SignalLang runtime needs, but only where the
+ *    value-range analysis cannot prove them redundant:
+ *      GUARD_NONZERO before a DIV, unless the divisor's range excludes zero
+ *      GUARD_FINITE on every program output, unless its range is finite and NaN-free
+ *  - A value that is already guarded (here or by guards already in the TAC) is not
+ *    checked again, so running the pass twice is harmless.
+ *  - Ranges come from RangeAnalysis seeded with the declared input ranges; the sign,
+ *    non-zero and finiteness facts are read off the intervals.
+ */
+struct GuardStats {
+    int candidates = 0; // checks a naive runtime would perform per sample
+    int emitted = 0;    // guards inserted
+    int eliminated = 0; // proven unnecessary (candidates - emitted)
+};
+
+class GuardInserter {
+public:
+    static GuardStats insert(std::vector<TacInst> &tac,
+                             const std::map<std::string, Interval> &inputRanges,
+                             OptReport *report = nullptr);
+};
+
+#endif // GUARDS_H
@@ -0,0 +1,319 @@
+#include "horner.h"
+#include "exprTree.h"
+#include <map>
+#include <set>
+#include <unordered_map>
+#include <sstream>
+#include <algorithm>
+
+using namespace std;
+
+namespace {
+
+const size_t kMaxTerms = 64; // give up on expressions that expand further than this
+const int kMaxDegree = 16;
+
+typedef vector<int> Monomial;       // sorted atom ids, repeated for powers
+typedef map<Monomial, double> Poly; // monomial -> coefficient
+
+Poly polyMul(const Poly &a, const Poly &b) {
+    Poly r;
+    for (const auto &x : a)
+        for (const auto &y : b) {
+            Monomial m = x.first;
+            m.insert(m.end(), y.first.begin(), y.first.end());
+            sort(m.begin(), m.end());
+            r[m] += x.second * y.second;
+        }
+    return r;
+}
+
+Poly polyAdd(Poly a, const Poly &b, double sign) {
+    for (const auto &y : b) a[y.first] += sign * y.second;
+    return a;
+}
+
+void dropZeros(Poly &p) {
+    for (auto it = p.begin(); it != p.end();) it = it->second == 0.0 ? p.erase(it) : next(it);
+}
+
+// One candidate expression: its polynomial over atoms and the instructions it replaces.
+struct Region {
+    Poly poly;
+    vector<int> insts;             // defining instructions of private nodes (root excluded)
+    vector<int> atoms;             // atom id -> node
+    vector<string> atomName;       // atom id -> name holding it at the root
+    int muls = 0;
+    bool ok = true;
+};
+
+class Expander {
+public:
+    Expander(const vector<TacInst> &tac, const ExprDag &dag) : tac(tac), dag(dag) {
+        for (size_t i = 0; i < tac.size(); ++i)
+            if (!tac[i].dest.empty()) defsOf[tac[i].dest].push_back((int)i);
+    }
+
+    static bool isPolyOp(TACOp op) { return op == TACOp::ADD || op == TACOp::SUB || op == TACOp::MUL; }
+    static bool isPolyOp(const ExprNode &n) { return n.kind == ExprNode::OP && isPolyOp(n.op); }
+
+    // A node that is part of the expression reading it rather than an operand of it:
+    // a temp read exactly once, by another +, - or *.
+    bool isPrivate(int node) const {
+        const ExprNode &n = dag.nodes[node];
+        if (n.uses != 1 || !isTempName(n.name) || dag.consumers[node].size() != 1) return false;
+        if (n.kind != ExprNode::CONST && !isPolyOp(n)) return false;
+        return isPolyOp(tac[dag.consumers[node][0]].op);
+    }
+
+    Region expandRoot(int rootInst) {
+        Region r;
+        root = rootInst;
+        int node = dag.result[rootInst];
+        r.poly = expandOp(node, r);
+        if (r.ok) dropZeros(r.poly);
+        return r;
+    }
+
+private:
+    const vector<TacInst> &tac;
+    const ExprDag &dag;
+    unordered_map<string, vector<int>> defsOf;
+    int root = -1;
+
+    // name still holds the value it had when instruction reader read it
+    bool unchangedUntilRoot(const string &name, int reader) const {
+        auto it = defsOf.find(name);
+        if (it == defsOf.end()) return true;
+        for (int d : it->second)
+            if (d >= reader && d < root) return false;
+        return true;
+    }
+
+    Poly expandOp(int node, Region &r) {
+        const ExprNode &n = dag.nodes[node];
+        Poly a = expandOperand(n.kids[0], n.inst, 0, r);
+        Poly b = expandOperand(n.kids[1], n.inst, 1, r);
+        if (!r.ok) return Poly();
+        Poly res;
+        if (n.op == TACOp::MUL) {
+            r.muls++;
+            res = polyMul(a, b);
+        } else {
+            res = polyAdd(a, b, n.op == TACOp::ADD ? 1.0 : -1.0);
+        }
+        if (res.size() > kMaxTerms) r.ok = false;
+        for (const auto &m : res)
+            if ((int)m.first.size() > kMaxDegree) r.ok = false;
+        return res;
+    }
+
+    Poly expandOperand(int node, int reader, int operand, Region &r) {
+        if (!r.ok) return Poly();
+        const ExprNode &n = dag.nodes[node];
+        if (isPrivate(node)) {
+            r.insts.push_back(n.inst);
+            if (n.kind == ExprNode::CONST) return Poly{{Monomial(), n.value}};
+            return expandOp(node, r);
+        }
+        if (n.kind == ExprNode::CONST) return Poly{{Monomial(), n.value}};
+
+        // opaque value: read it at the root under a name that still holds it
+        const string name = usesOf(tac[reader])[operand];
+        int id = (int)(find(r.atoms.begin(), r.atoms.end(), node) - r.atoms.begin());
+        if (id == (int)r.atoms.size()) {
+            r.atoms.push_back(node);
+            r.atomName.push_back("");
+        }
+        if (r.atomName[id].empty() && unchangedUntilRoot(name, reader)) r.atomName[id] = name;
+        return Poly{{Monomial{id}, 1.0}};
+    }
+};
+
+// Emits the rewritten expression as TAC with fresh temps.
+class Emitter {
+public:
+    Emitter(int &nextTemp, bool useFma) : nextTemp(nextTemp), useFma(useFma) {}
+
+    vector<TacInst> code;
+
+    string fresh() { return "t" + to_string(nextTemp++); }
+
+    string constant(double v) {
+        TacInst i;
+        i.op = TACOp::LOAD_CONST;
+        i.dest = fresh();
+        i.arg1Literal = formatLiteral(v);
+        code.push_back(i);
+        return i.dest;
+    }
+
+    string binary(TACOp op, const string &a, const string &b) {
+        TacInst i;
+        i.op = op;
+        i.dest = fresh();
+        i.arg1 = a;
+        i.arg2 = b;
+        code.push_back(i);
+        return i.dest;
+    }
+
+    // a*b + c; c may be absent
+    string mulAdd(const string &a, const string &b, const string &c) {
+        if (c.empty()) return binary(TACOp::MUL, a, b);
+        if (!useFma) return binary(TACOp::ADD, binary(TACOp::MUL, a, b), c);
+        TacInst i;
+        i.op = TACOp::FMA;
+        i.dest = fresh();
+        i.arg1 = a;
+        i.arg2 = b;
+        i.arg3 = c;
+        code.push_back(i);
+        return i.dest;
+    }
+
+    // Sum of monomials over atoms; "" when the coefficient is zero.
+    string coefficient(const Poly &c, const vector<string> &atomName) {
+        vector<pair<Monomial, double>> terms(c.begin(), c.end());
+        stable_sort(terms.begin(), terms.end(), [](const pair<Monomial, double> &a, const pair<Monomial, double> &b) {
+            return a.second > 0 && b.second < 0;
+        });
+        string acc;
+        for (const auto &t : terms) {
+            bool neg = !acc.empty() && t.second < 0;
+            double mag = neg ? -t.second : t.second;
+            string term;
+            for (int a : t.first) term = term.empty() ? atomName[a] : binary(TACOp::MUL, term, atomName[a]);
+            if (term.empty()) term = constant(mag);
+            else if (mag != 1.0) term = binary(TACOp::MUL, term, constant(mag));
+            acc = acc.empty() ? term : binary(neg ? TACOp::SUB : TACOp::ADD, acc, term);
+        }
+        return acc;
+    }
+
+    int multiplies() const {
+        int m = 0;
+        for (const auto &i : code) m += i.op == TACOp::MUL || i.op == TACOp::FMA;
+        return m;
+    }
+    int fmas() const {
+        int m = 0;
+        for (const auto &i : code) m += i.op == TACOp::FMA;
+        return m;
+    }
+
+private:
+    int &nextTemp;
+    bool useFma;
+};
+
+string horner(Emitter &e, const vector<string> &c, const string &x) {
+    string p = c.back();
+    for (int k = (int)c.size() - 2; k >= 0; --k) p = e.mulAdd(p, x, c[k]);
+    return p;
+}
+
+string estrin(Emitter &e, vector<string> c, const string &x) {
+    string pw = x;
+    while (c.size() > 1) {
+        vector<string> next;
+        for (size_t i = 0; i < c.size(); i += 2) {
+            const string &lo = c[i];
+            const string hi = i + 1 < c.size() ? c[i + 1] : "";
+            if (hi.empty()) next.push_back(lo);
+            else next.push_back(e.mulAdd(hi, pw, lo));
+        }
+        c.swap(next);
+        if (c.size() > 1) pw = e.binary(TACOp::MUL, pw, pw);
+    }
+    return c.front();
+}
+
+} // namespace
+
+PolyStats PolynomialRewriter::run(vector<TacInst> &tac, PolyForm form, bool useFma, OptReport *report) {
+    PolyStats st;
+    ExprDag dag = ExprTreeBuilder::build(tac);
+    Expander expander(tac, dag);
+    int nextTemp = nextTempIndex(tac);
+
+    map<int, vector<TacInst>> replacement; // root instruction -> new code
+    set<int> removed;
+    vector<string> notes;
+
+    for (size_t i = 0; i < tac.size(); ++i) {
+        int node = dag.result[i];
+        if (node < 0 || dag.nodes[node].inst != (int)i || !Expander::isPolyOp(dag.nodes[node])) continue;
+        // roots are arithmetic values not folded into a larger expression
+        if (expander.isPrivate(node)) continue;
+
+        Region r = expander.expandRoot((int)i);
+        if (!r.ok || r.poly.empty()) continue;
+        bool named = true;
+        for (const auto &n : r.atomName) named = named && !n.empty();
+        if (!named) continue;
+
+        // the polynomial variable: the atom with the highest power
+        int x = -1, degree = 0;
+        for (size_t a = 0; a < r.atoms.size(); ++a)
+            for (const auto &m : r.poly) {
+                int d = (int)count(m.first.begin(), m.first.end(), (int)a);
+                if (d > degree) { degree = d; x = (int)a; }
+            }
+        if (degree < 2) continue;
+
+        vector<Poly> coef(degree + 1);
+        for (const auto &m : r.poly) {
+            Monomial rest;
+            int d = 0;
+            for (int a : m.first) {
+                if (a == x) d++;
+                else rest.push_back(a);
+            }
+            coef[d][rest] += m.second;
+        }
+
+        int saved = nextTemp;
+        Emitter e(nextTemp, useFma);
+        vector<string> c;
+        for (const auto &p : coef) c.push_back(e.coefficient(p, r.atomName));
+        string res = form == PolyForm::HORNER ? horner(e, c, r.atomName[x]) : estrin(e, c, r.atomName[x]);
+
+        int after = e.multiplies();
+        bool better = form == PolyForm::HORNER ? after < r.muls : after <= r.muls;
+        if (!better || e.code.empty() || e.code.back().dest != res) {
+            nextTemp = saved;
+            continue;
+        }
+        e.code.back().dest = tac[i].dest;
+        replacement[(int)i] = e.code;
+        removed.insert(r.insts.begin(), r.insts.end());
+
+        st.polynomials++;
+        st.mulsBefore += r.muls;
+        st.mulsAfter += after;
+        st.fmas += e.fmas();
+        ostringstream msg;
+        msg << "degree " << degree << " in " << r.atomName[x] << " at instruction " << i << ": "
+            << r.muls << " multiplies -> " << after;
+        if (e.fmas()) msg << " (" << e.fmas() << " fma)";
+        notes.push_back(msg.str());
+    }
+    if (replacement.empty()) return st;
+
+    vector<TacInst> out;
+    out.reserve(tac.size());
+    for (size_t i = 0; i < tac.size(); ++i) {
+        auto rep = replacement.find((int)i);
+        if (rep != replacement.end()) out.insert(out.end(), rep->second.begin(), rep->second.end());
+        else if (!removed.count((int)i)) out.push_back(tac[i]);
+    }
+    tac.swap(out);
+
+    if (report) {
+        const char *name = form == PolyForm::HORNER ? "horner" : "estrin";
+        for (const auto &n : notes) report->note(name, n);
+        report->note(name, "polynomials reassociated; results may differ from source order in the last bits");
+    }
+    return st;
+}
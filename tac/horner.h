@@ -0,0 +1,36 @@
+#ifndef HORNER_H
+#define HORNER_H
+
+#include "tac.h"
+#include "optReport.h"
+#include <vector>
+
+/*
+ * PolynomialRewriter
+ *  - Finds arithmetic expressions that are polynomials in one value x, such as
+ *    c3*x*x*x + c2*x*x + c1*x + c0, and re-emits them with fewer multiplies:
+ *      HORNER : ((c3*x + c2)*x + c1)*x + c0           (n multiplies, serial chain)
+ *      ESTRIN : (c0 + c1*x) + (c2 + c3*x)*(x*x)       (independent halves for ILP)
+ *  - Coefficients may be constants or any expression not involving x. Values read
+ *    more than once, program variables and divisions are treated as opaque.
+ *  - With useFma every "p*x + c" step becomes a single FMA.
+ *  - The rewrite reassociates the expression (results can differ in the last bits),
+ *    so it is only applied on request; an expression is rewritten only when the new
+ *    form needs no more multiplies (strictly fewer for HORNER).
+ */
+enum class PolyForm { HORNER, ESTRIN };
+
+struct PolyStats {
+    int polynomials = 0; // expressions rewritten
+    int mulsBefore = 0;  // multiplies in the rewritten expressions before
+    int mulsAfter = 0;   // multiplies after, FMAs included
+    int fmas = 0;
+};
+
+class PolynomialRewriter {
+public:
+    static PolyStats run(std::vector<TacInst> &tac, PolyForm form, bool useFma = false,
+                         OptReport *report = nullptr);
+};
+
+#endif // HORNER_H
@@ -0,0 +1,130 @@
+#include "invariance.h"
+#include <unordered_map>
+
+using namespace std;
+
+static bool isStateSymbol(const SymbolTable &sym, const string &name) {
+    const SymbolEntry *e = sym.lookup(name);
+    return e && e->is_state;
+}
+
+// Variance of a name that is read before the program defines it.
+static Variance sourceVariance(const SymbolTable &sym, const set<string> &params, const string &name) {
+    if (params.count(name)) return Variance::LOAD_TIME;
+    const SymbolEntry *e = sym.lookup(name);
+    if (e && e->kind == "parameter" && !e->is_state) return Variance::LOAD_TIME;
+    return Variance::PER_SAMPLE; // in() sample or state carried from the previous sample
+}
+
+string InvarianceAnalyzer::varianceToString(Variance v) {
+    switch (v) {
+        case Variance::CONSTANT: return "constant";
+        case Variance::LOAD_TIME: return "load-time";
+        default: return "per-sample";
+    }
+}
+
+vector<Variance> InvarianceAnalyzer::classify(const vector<TacInst> &tac, const SymbolTable &sym,
+                                              const set<string> &params) {
+    vector<Variance> res(tac.size(), Variance::PER_SAMPLE);
+    unordered_map<string, Variance> current;
+
+    auto varianceOf = [&](const string &name) {
+        auto it = current.find(name);
+        return it != current.end() ? it->second : sourceVariance(sym, params, name);
+    };
+
+    for (size_t i = 0; i < tac.size(); ++i) {
+        const TacInst &inst = tac[i];
+        Variance v = Variance::CONSTANT;
+        if (inst.op == TACOp::NOP) {
+            v = Variance::PER_SAMPLE; // nothing to hoist
+        } else {
+            for (const auto &u : usesOf(inst)) v = max(v, varianceOf(u));
+        }
+        // a state variable's definition feeds the next sample, keep it in the body
+        if (!inst.dest.empty() && isStateSymbol(sym, inst.dest)) v = Variance::PER_SAMPLE;
+
+        res[i] = v;
+        if (!inst.dest.empty()) current[inst.dest] = v;
+    }
+    return res;
+}
+
+StreamSplit InvarianceAnalyzer::split(const vector<TacInst> &tac, const SymbolTable &sym,
+                                      const set<string> &params) {
+    StreamSplit res;
+    vector<Variance> cls = classify(tac, sym, params);
+
+    // a program variable can be hoisted under its own name only if this is its
+    // single definition and nothing reads it earlier in the sample
+    unordered_map<string, int> defCount;
+    set<string> readBeforeDef, defined;
+    for (const auto &inst : tac) {
+        for (const auto &u : usesOf(inst)) if (!defined.count(u)) readBeforeDef.insert(u);
+        if (!inst.dest.empty()) { defCount[inst.dest]++; defined.insert(inst.dest); }
+    }
+
+    int nextTemp = nextTempIndex(tac);
+    unordered_map<string, string> rename; // name -> hoisted copy currently holding its value
+    auto renamed = [&](const string &name) {
+        auto it = rename.find(name);
+        return it == rename.end() ? name : it->second;
+    };
+
+    for (size_t i = 0; i < tac.size(); ++i) {
+        TacInst inst = tac[i];
+        if (inst.op != TACOp::LOAD_CONST) {
+            if (!inst.arg1.empty()) inst.arg1 = renamed(inst.arg1);
+            if (!inst.arg2.empty()) inst.arg2 = renamed(inst.arg2);
+            if (!inst.arg3.empty()) inst.arg3 = renamed(inst.arg3);
+        }
+
+        if (cls[i] == Variance::PER_SAMPLE) {
+            if (!inst.dest.empty()) rename.erase(inst.dest);
+            res.body.push_back(inst);
+            continue;
+        }
+
+        res.hoisted++;
+        if (inst.dest.empty()) { // a guard on load-time values is checked once
+            res.prologue.push_back(inst);
+            continue;
+        }
+        const string name = inst.dest;
+        bool keepName = !isTempName(name) && defCount[name] == 1 && !readBeforeDef.count(name);
+        if (keepName) {
+            rename.erase(name);
+            res.prologue.push_back(inst);
+            continue;
+        }
+
+        string fresh = "t" + to_string(nextTemp++);
+        inst.dest = fresh;
+        res.prologue.push_back(inst);
+        rename[name] = fresh;
+        if (!isTempName(name)) {
+            // the variable is redefined per sample: restore it from the hoisted copy
+            TacInst restore;
+            restore.op = TACOp::ASSIGN;
+            restore.dest = name;
+            restore.arg1 = fresh;
+            res.body.push_back(restore);
+        }
+    }
+    return res;
+}
+
+void InvarianceAnalyzer::print(const StreamSplit &s, ostream &out) {
+    out << "-- prologue (run once, " << s.prologue.size() << " instructions) --\n";
+    for (size_t i = 0; i < s.prologue.size(); ++i) {
+        out << i << ":\t";
+        printTacLine(s.prologue[i], out);
+    }
+    out << "-- per-sample body (" << s.body.size() << " instructions, "
+        << s.hoisted << " hoisted) --\n";
+    for (size_t i = 0; i < s.body.size(); ++i) {
+        out << i << ":\t";
+        printTacLine(s.body[i], out);
+    }
+}
@@ -0,0 +1,48 @@
+#ifndef INVARIANCE_H
+#define INVARIANCE_H
+
+#include "tac.h"
+#include "../symbolTable/symbolTable.h"
+#include <vector>
+#include <set>
+#include <string>
+
+/*
+ * InvarianceAnalyzer
+ *  - Classifies every TAC instruction of a streaming program by how often its
+ *    value can change:
+ *      CONSTANT   : depends only on literals
+ *      LOAD_TIME  : depends on load-time parameters (and literals)
+ *      PER_SAMPLE : depends on in() samples or state variables
+ *  - Variance sources are names read before being defined in the program (they
+ *    are fed by in() every sample) and symbols flagged is_state. Names listed in
+ *    params, or whose symbol kind is "parameter", are load-time invariant.
+ *  - split() moves everything that is not PER_SAMPLE into a run-once prologue and
+ *    leaves a minimal per-sample body. Hoisted values that share a name with a
+ *    per-sample definition are renamed to fresh temps so the body cannot clobber them.
+ */
+enum class Variance { CONSTANT, LOAD_TIME, PER_SAMPLE };
+
+struct StreamSplit {
+    std::vector<TacInst> prologue; // run once when the program is loaded
+    std::vector<TacInst> body;     // run for every input sample
+    int hoisted = 0;               // instructions moved out of the per-sample body
+};
+
+class InvarianceAnalyzer {
+public:
+    // One classification per instruction of tac.
+    static std::vector<Variance> classify(const std::vector<TacInst> &tac, const SymbolTable &sym,
+                                          const std::set<std::string> &params = {});
+
+    // Split tac into prologue + per-sample body.
+    static StreamSplit split(const std::vector<TacInst> &tac, const SymbolTable &sym,
+                             const std::set<std::string> &params = {});
+
+    static std::string varianceToString(Variance v);
+
+    // Print both halves of a split.
+    static void print(const StreamSplit &s, std::ostream &out = std::cout);
+};
+
+#endif // INVARIANCE_H
@@ -0,0 +1,19 @@
+#include "optReport.h"
+
+using namespace std;
+
+void OptReport::note(const string &pass, const string &message) {
+    entries.push_back({pass, message});
+}
+
+const vector<OptNote> &OptReport::notes() const { return entries; }
+
+bool OptReport::empty() const { return entries.empty(); }
+
+void OptReport::print(ostream &out) const {
+    if (entries.empty()) {
+        out << "(no optimizations applied)\n";
+        return;
+    }
+    for (const auto &e : entries) out << "[" << e.pass << "] " << e.message << "\n";
+}
@@ -0,0 +1,31 @@
+#ifndef OPTREPORT_H
+#define OPTREPORT_H
+
+#include <string>
+#include <vector>
+#include <iostream>
+
+/*
+ * OptReport
+ *  - Collects what the optimization passes did (and any precision caveats of the
+ *    transformations they applied) so the driver can print it after the pipeline.
+ */
+struct OptNote {
+    std::string pass;    // pass that wrote the note
+    std::string message;
+};
+
+class OptReport {
+public:
+    void note(const std::string &pass, const std::string &message);
+
+    const std::vector<OptNote> &notes() const;
+    bool empty() const;
+
+    void print(std::ostream &out = std::cout) const;
+
+private:
+    std::vector<OptNote> entries;
+};
+
+#endif // OPTREPORT_H
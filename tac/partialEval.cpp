@@ -0,0 +1,133 @@
+#include "partialEval.h"
+#include "dce.h"
+#include "peephole.h"
+#include <unordered_map>
+#include <set>
+#include <cmath>
+
+using namespace std;
+
+// Evaluate as the backends do: F32 rounds the operands and computes in float.
+static bool evalBinary(TACOp op, TacPrecision prec, double a, double b, double &r) {
+    if (prec == TacPrecision::F32) {
+        const float x = (float)a, y = (float)b;
+        switch (op) {
+            case TACOp::ADD: r = x + y; break;
+            case TACOp::SUB: r = x - y; break;
+            case TACOp::MUL: r = x * y; break;
+            case TACOp::DIV: r = x / y; break;
+            default: return false;
+        }
+        return std::isfinite(r);
+    }
+    switch (op) {
+        case TACOp::ADD: r = a + b; break;
+        case TACOp::SUB: r = a - b; break;
+        case TACOp::MUL: r = a * b; break;
+        case TACOp::DIV: r = a / b; break;
+        default: return false;
+    }
+    return std::isfinite(r);
+}
+
+static void toLoadConst(TacInst &inst, double v) {
+    inst.op = TACOp::LOAD_CONST;
+    inst.arg1Literal = formatLiteral(v);
+    inst.arg1.clear();
+    inst.arg2.clear();
+    inst.arg3.clear();
+}
+
+FoldStats ConstantFolder::fold(vector<TacInst> &tac, const map<string, double> &known) {
+    FoldStats st;
+    unordered_map<string, double> value; // names currently holding a known constant
+    set<string> bound;                   // bound parameters not yet redefined
+    map<string, string> loaded;          // bound parameter -> temp holding its value
+    for (const auto &p : known) { value[p.first] = p.second; bound.insert(p.first); }
+
+    int nextTemp = nextTempIndex(tac);
+    vector<TacInst> out;
+    out.reserve(tac.size());
+
+    auto lookup = [&](const string &name, double &v) {
+        auto it = value.find(name);
+        if (it == value.end()) return false;
+        v = it->second;
+        return true;
+    };
+
+    for (TacInst inst : tac) {
+        double a = 0, b = 0, r = 0;
+        switch (inst.op) {
+            case TACOp::ASSIGN:
+                if (lookup(inst.arg1, a)) {
+                    if (bound.count(inst.arg1)) st.bound++;
+                    toLoadConst(inst, inst.prec == TacPrecision::F32 ? (double)(float)a : a);
+                    st.folded++;
+                }
+                break;
+            case TACOp::ADD:
+            case TACOp::SUB:
+            case TACOp::MUL:
+            case TACOp::DIV:
+            case TACOp::FMA: {
+                const bool fma = inst.op == TACOp::FMA;
+                double c = 0;
+                bool ka = lookup(inst.arg1, a), kb = lookup(inst.arg2, b), kc = !fma || lookup(inst.arg3, c);
+                // every path below removes the reads of bound parameters
+                st.bound += (int)bound.count(inst.arg1) + (int)bound.count(inst.arg2);
+                if (fma) st.bound += (int)bound.count(inst.arg3);
+                if (fma && inst.prec == TacPrecision::F32) r = std::fmaf((float)a, (float)b, (float)c);
+                else if (fma) r = std::fma(a, b, c);
+                bool folds = fma ? std::isfinite(r) : evalBinary(inst.op, inst.prec, a, b, r);
+                if (ka && kb && kc && folds) {
+                    toLoadConst(inst, r);
+                    st.folded++;
+                    break;
+                }
+                // a bound parameter disappears from the program: load its value
+                // instead (once; the fresh temp is never redefined)
+                for (string *arg : {&inst.arg1, &inst.arg2, &inst.arg3}) {
+                    if (arg->empty() || !bound.count(*arg)) continue;
+                    auto ld = loaded.find(*arg);
+                    if (ld == loaded.end()) {
+                        TacInst lc;
+                        lc.dest = "t" + to_string(nextTemp++);
+                        toLoadConst(lc, value[*arg]);
+                        out.push_back(lc);
+                        ld = loaded.emplace(*arg, lc.dest).first;
+                    }
+                    *arg = ld->second;
+                }
+                break;
+            }
+            default:
+                break;
+        }
+
+        if (!inst.dest.empty()) {
+            bound.erase(inst.dest);
+            loaded.erase(inst.dest);
+            if (inst.op == TACOp::LOAD_CONST) value[inst.dest] = constValue(inst);
+            else value.erase(inst.dest);
+        }
+        out.push_back(inst);
+    }
+    tac.swap(out);
+    return st;
+}
+
+vector<TacInst> PartialEvaluator::specialize(const vector<TacInst> &tac, const SymbolTable &sym,
+                                             const map<string, double> &bindings, FoldStats *stats) {
+    vector<TacInst> res = tac;
+    FoldStats st = ConstantFolder::fold(res, bindings);
+    // peephole's fold-* rules are folds too; simplified counts only the identities
+    PeepholeStats ps = PeepholeOptimizer::run(res);
+    int peepholeFolds = 0;
+    for (const auto &f : ps.fired) if (f.first.compare(0, 5, "fold-") == 0) peepholeFolds += f.second;
+    st.folded += peepholeFolds;
+    st.simplified = ps.total - peepholeFolds;
+    DeadCodeEliminator::eliminate(res, sym);
+    if (stats) *stats = st;
+    return res;
+}
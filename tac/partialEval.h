@@ -0,0 +1,45 @@
+#ifndef PARTIALEVAL_H
+#define PARTIALEVAL_H
+
+#include "tac.h"
+#include "../symbolTable/symbolTable.h"
+#include <vector>
+#include <map>
+#include <string>
+
+/*
+ * ConstantFolder
+ *  - Forward constant propagation over straight-line TAC.
+ *  - Folds operations whose operands are all known into LOAD_CONST; algebraic
+ *    identities are left to PeepholeOptimizer.
+ *  - Results that would not be finite are left unfolded so runtime behaviour is kept.
+ *  - Dead LOAD_CONSTs left behind are for DeadCodeEliminator to remove.
+ */
+struct FoldStats {
+    int folded = 0;     // operations replaced by LOAD_CONST (by either pass)
+    int simplified = 0; // peephole identity rewrites, folds excluded (specialize only)
+    int bound = 0;      // uses of bound parameters replaced by constants
+};
+
+class ConstantFolder {
+public:
+    // known: values of names that are read before the program defines them
+    // (bound parameters). Their uses are replaced by constants.
+    static FoldStats fold(std::vector<TacInst> &tac, const std::map<std::string, double> &known = {});
+};
+
+/*
+ * PartialEvaluator
+ *  - Re-specializes a compiled program when it is loaded: calibration parameters
+ *    (gain, offset, coefficients) are bound to their deployment values, folded into
+ *    the TAC, and folding, peephole simplification and DCE are rerun to give a
+ *    smaller per-deployment kernel.
+ */
+class PartialEvaluator {
+public:
+    static std::vector<TacInst> specialize(const std::vector<TacInst> &tac, const SymbolTable &sym,
+                                           const std::map<std::string, double> &bindings,
+                                           FoldStats *stats = nullptr);
+};
+
+#endif // PARTIALEVAL_H
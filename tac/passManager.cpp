@@ -0,0 +1,150 @@
+#include "passManager.h"
+#include "dce.h"
+#include "peephole.h"
+#include "scheduler.h"
+#include <chrono>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+
+using namespace std;
+
+PassManager::PassManager(OptLevel lvl)
+    : level(lvl), budgetMs(0), precision(PrecisionMode::STRICT), math(MathProfile::STRICT), numRegs(16),
+      latency(LatencyTable::defaults()), elapsed(0) {
+    switch (level) {
+        case OptLevel::O0:
+            break;
+        case OptLevel::O1:
+            pipeline = {peepholePass(), dcePass(), reciprocalPass()};
+            break;
+        case OptLevel::O2:
+            pipeline = {peepholePass(), dcePass(), reciprocalPass(), dcePass()};
+            break;
+        case OptLevel::O3:
+            pipeline = {fixpointPass(), reciprocalPass(), fixpointPass()};
+            break;
+    }
+}
+
+void PassManager::setBudgetMs(double ms) { budgetMs = ms; }
+void PassManager::setPrecision(PrecisionMode mode) { precision = mode; }
+void PassManager::setMathProfile(MathProfile profile) {
+    math = profile;
+    pipeline.erase(remove_if(pipeline.begin(), pipeline.end(), [](const Pass &p) { return p.name == "reassociate"; }),
+                   pipeline.end());
+    if (math == MathProfile::FASTMATH && level != OptLevel::O0) pipeline.insert(pipeline.begin(), reassociatePass());
+}
+void PassManager::setNumRegs(int n) { numRegs = n; }
+void PassManager::setLatencies(const LatencyTable &lat) { latency = lat; }
+
+void PassManager::add(const Pass &p) { pipeline.push_back(p); }
+
+bool PassManager::has(const string &name) const {
+    for (const auto &p : pipeline) if (p.name == name) return true;
+    return false;
+}
+
+const vector<PassDecision> &PassManager::decisions() const { return log; }
+double PassManager::elapsedMs() const { return elapsed; }
+
+bool PassManager::parseLevel(const string &flag, OptLevel &lvl) {
+    if (flag == "-O0") lvl = OptLevel::O0;
+    else if (flag == "-O1") lvl = OptLevel::O1;
+    else if (flag == "-O2") lvl = OptLevel::O2;
+    else if (flag == "-O3") lvl = OptLevel::O3;
+    else return false;
+    return true;
+}
+
+string PassManager::levelToString(OptLevel lvl) {
+    return "-O" + to_string((int)lvl);
+}
+
+void PassManager::run(vector<TacInst> &tac, const SymbolTable &sym, OptReport *report) {
+    using clock = chrono::steady_clock;
+    PassContext ctx{sym, math == MathProfile::FASTMATH ? PrecisionMode::RELAXED : precision, numRegs, report, latency};
+    log.clear();
+    elapsed = 0;
+
+    for (const auto &p : pipeline) {
+        PassDecision d;
+        d.pass = p.name;
+        if (p.expensive && budgetMs > 0 && elapsed >= budgetMs) {
+            ostringstream why;
+            why << fixed << setprecision(3) << "compile budget " << budgetMs << " ms spent ("
+                << elapsed << " ms elapsed)";
+            d.reason = why.str();
+        } else {
+            auto t0 = clock::now();
+            p.run(tac, ctx);
+            d.micros = chrono::duration<double, micro>(clock::now() - t0).count();
+            d.ran = true;
+            elapsed += d.micros / 1000.0;
+        }
+        log.push_back(d);
+    }
+
+    if (!report) return;
+    ostringstream head;
+    head << levelToString(level) << ": " << pipeline.size() << " passes, " << fixed << setprecision(3)
+         << elapsed << " ms";
+    if (budgetMs > 0) head << " (budget " << budgetMs << " ms)";
+    if (math == MathProfile::FASTMATH) head << ", fastmath";
+    report->note("passes", head.str());
+    for (const auto &d : log) {
+        ostringstream line;
+        if (d.ran) line << "ran " << d.pass << " (" << fixed << setprecision(1) << d.micros << " us)";
+        else line << "skipped " << d.pass << ": " << d.reason;
+        report->note("passes", line.str());
+    }
+}
+
+Pass PassManager::peepholePass() {
+    return {"peephole", false, [](vector<TacInst> &tac, PassContext &ctx) {
+        PeepholeStats st = PeepholeOptimizer::run(tac);
+        if (ctx.report) PeepholeOptimizer::report(st, *ctx.report);
+    }};
+}
+
+Pass PassManager::dcePass() {
+    return {"dce", false, [](vector<TacInst> &tac, PassContext &ctx) {
+        DeadCodeEliminator::eliminate(tac, ctx.sym);
+    }};
+}
+
+Pass PassManager::reciprocalPass() {
+    return {"reciprocal", false, [](vector<TacInst> &tac, PassContext &ctx) {
+        if (ReciprocalHoister::run(tac, ctx.precision, ctx.report).rewritten > 0)
+            DeadCodeEliminator::eliminate(tac, ctx.sym);
+    }};
+}
+
+Pass PassManager::reassociatePass() {
+    return {"reassociate", false, [](vector<TacInst> &tac, PassContext &ctx) {
+        if (Reassociator::run(tac, ctx.report).chains > 0) DeadCodeEliminator::eliminate(tac, ctx.sym);
+    }};
+}
+
+Pass PassManager::schedulePass(bool wholeRegisterFile) {
+    return {"sched", true, [wholeRegisterFile](vector<TacInst> &tac, PassContext &ctx) {
+        ScheduleStats st = InstructionScheduler::schedule(tac, ctx.latency,
+                                                          wholeRegisterFile ? ctx.numRegs : 0);
+        if (ctx.report)
+            ctx.report->note("sched", "estimated cycles/sample " + to_string(st.cyclesBefore) + " -> " +
+                                      to_string(st.cyclesAfter) + ", temps " + to_string(st.tempsBefore) +
+                                      " -> " + to_string(st.tempsAfter));
+    }};
+}
+
+Pass PassManager::fixpointPass() {
+    return {"peephole+dce*", true, [](vector<TacInst> &tac, PassContext &ctx) {
+        for (int round = 0; round < 8; ++round) {
+            size_t before = tac.size();
+            PeepholeStats st = PeepholeOptimizer::run(tac);
+            if (ctx.report) PeepholeOptimizer::report(st, *ctx.report);
+            DeadCodeEliminator::eliminate(tac, ctx.sym);
+            if (st.total == 0 && tac.size() == before) break;
+        }
+    }};
+}
@@ -0,0 +1,96 @@
+#ifndef PASSMANAGER_H
+#define PASSMANAGER_H
+
+#include "tac.h"
+#include "optReport.h"
+#include "reciprocal.h"
+#include "reassociate.h"
+#include "scheduler.h"
+#include "../symbolTable/symbolTable.h"
+#include <vector>
+#include <string>
+#include <functional>
+
+/*
+ * PassManager
+ *  - Maps an optimization level onto a pipeline of TAC passes:
+ *      -O0 : nothing (fastest compile, for hot reload)
+ *      -O1 : peephole rules + DCE, exact reciprocals
+ *      -O2 : -O1 with DCE after the reciprocal pass
+ *      -O3 : -O2 with peephole/DCE iterated to a fixpoint
+ *  - Scheduling is opt-in at every level (--sched): on the VM and the JIT the
+ *    scheduled order has not measured faster (SignalBench --sched), only its
+ *    cycle estimate is lower.
+ *  - Compile budget: passes are tagged cheap or expensive. Once the time spent in
+ *    the pipeline reaches the budget, remaining expensive passes are skipped
+ *    (cheap ones always run). Every choice is recorded and written to the OptReport.
+ *  - MathProfile::FASTMATH (-O1 and up) starts the pipeline with reassociation and
+ *    runs the reciprocal pass RELAXED, whatever setPrecision() asked for.
+ */
+enum class OptLevel { O0, O1, O2, O3 };
+
+struct PassContext {
+    const SymbolTable &sym;
+    PrecisionMode precision;
+    int numRegs;
+    OptReport *report;
+    const LatencyTable &latency; // target latencies for scheduling
+};
+
+struct Pass {
+    std::string name;
+    bool expensive;
+    std::function<void(std::vector<TacInst> &, PassContext &)> run;
+};
+
+struct PassDecision {
+    std::string pass;
+    bool ran = false;
+    double micros = 0;  // time spent in the pass
+    std::string reason; // why it was skipped
+};
+
+class PassManager {
+public:
+    explicit PassManager(OptLevel level);
+
+    void setBudgetMs(double ms); // <= 0 means unlimited
+    void setPrecision(PrecisionMode mode);
+    void setMathProfile(MathProfile profile);
+    void setNumRegs(int n);
+    void setLatencies(const LatencyTable &lat);
+
+    // Append a pass to the level's pipeline (e.g. --sched).
+    void add(const Pass &p);
+    bool has(const std::string &name) const;
+
+    // Run the pipeline; decisions are also noted in report when given.
+    void run(std::vector<TacInst> &tac, const SymbolTable &sym, OptReport *report = nullptr);
+
+    const std::vector<PassDecision> &decisions() const;
+    double elapsedMs() const;
+
+    static bool parseLevel(const std::string &flag, OptLevel &level); // "-O2" -> O2
+    static std::string levelToString(OptLevel level);
+
+    // Pass factories, also usable on their own
+    static Pass peepholePass();
+    static Pass dcePass();
+    static Pass reciprocalPass();
+    static Pass reassociatePass();
+    static Pass schedulePass(bool wholeRegisterFile);
+    static Pass fixpointPass();
+
+private:
+    OptLevel level;
+    double budgetMs;
+    PrecisionMode precision;
+    MathProfile math;
+    int numRegs;
+    LatencyTable latency;
+    std::vector<Pass> pipeline;
+    std::vector<PassDecision> log;
+    double elapsed;
+};
+
+#endif // PASSMANAGER_H
@@ -0,0 +1,280 @@
+#include "peephole.h"
+#include <array>
+#include <deque>
+#include <unordered_map>
+#include <cstdint>
+#include <cmath>
+
+using namespace std;
+
+namespace {
+
+// Concrete shape of an operand.
+enum Shape : uint8_t { S_NONE, S_VAR, S_ZERO, S_ONE, S_TWO, S_CONST, NUM_SHAPES };
+
+// Relation between the operands of the instruction.
+enum Relation : uint8_t { R_NONE, R_DEST_IS_ARG1, NUM_RELATIONS };
+
+// Pattern for one operand position.
+enum class Pat : uint8_t { NONE, ANY, VAR, CONST, ZERO, ONE, TWO };
+
+enum class Rewrite : uint8_t {
+    FOLD,         // evaluate: dest = constant
+    ASSIGN_ARG1,  // dest = arg1
+    ASSIGN_ARG2,  // dest = arg2
+    ADD_SELF1,    // dest = arg1 + arg1
+    ADD_SELF2,    // dest = arg2 + arg2
+    DROP          // remove the instruction
+};
+
+struct Rule {
+    const char *name;
+    TACOp op;
+    Pat a, b;
+    Relation rel;
+    Rewrite rw;
+};
+
+// Rules in priority order. Only IEEE-exact rewrites belong here (x+0 is not: -0+0 == +0).
+constexpr Rule kRules[] = {
+    {"fold-add",   TACOp::ADD,    Pat::CONST, Pat::CONST, R_NONE,         Rewrite::FOLD},
+    {"fold-sub",   TACOp::SUB,    Pat::CONST, Pat::CONST, R_NONE,         Rewrite::FOLD},
+    {"fold-mul",   TACOp::MUL,    Pat::CONST, Pat::CONST, R_NONE,         Rewrite::FOLD},
+    {"fold-div",   TACOp::DIV,    Pat::CONST, Pat::CONST, R_NONE,         Rewrite::FOLD},
+    {"fold-copy",  TACOp::ASSIGN, Pat::CONST, Pat::NONE,  R_NONE,         Rewrite::FOLD},
+    {"self-copy",  TACOp::ASSIGN, Pat::ANY,   Pat::NONE,  R_DEST_IS_ARG1, Rewrite::DROP},
+    {"mul-by-1",   TACOp::MUL,    Pat::ANY,   Pat::ONE,   R_NONE,         Rewrite::ASSIGN_ARG1},
+    {"1-mul",      TACOp::MUL,    Pat::ONE,   Pat::ANY,   R_NONE,         Rewrite::ASSIGN_ARG2},
+    {"div-by-1",   TACOp::DIV,    Pat::ANY,   Pat::ONE,   R_NONE,         Rewrite::ASSIGN_ARG1},
+    {"sub-0",      TACOp::SUB,    Pat::ANY,   Pat::ZERO,  R_NONE,         Rewrite::ASSIGN_ARG1},
+    {"mul-by-2",   TACOp::MUL,    Pat::VAR,   Pat::TWO,   R_NONE,         Rewrite::ADD_SELF1},
+    {"2-mul",      TACOp::MUL,    Pat::TWO,   Pat::VAR,   R_NONE,         Rewrite::ADD_SELF2},
+};
+constexpr int kNumRules = sizeof(kRules) / sizeof(kRules[0]);
+constexpr int kNumOps = (int)TACOp::NOP + 1;
+constexpr int kTableSize = kNumOps * NUM_SHAPES * NUM_SHAPES * NUM_RELATIONS;
+
+constexpr bool matches(Pat p, int s) {
+    switch (p) {
+        case Pat::NONE:  return s == S_NONE;
+        case Pat::ANY:   return s != S_NONE;
+        case Pat::VAR:   return s == S_VAR;
+        case Pat::CONST: return s == S_ZERO || s == S_ONE || s == S_TWO || s == S_CONST;
+        case Pat::ZERO:  return s == S_ZERO;
+        case Pat::ONE:   return s == S_ONE;
+        case Pat::TWO:   return s == S_TWO;
+    }
+    return false;
+}
+
+constexpr int tableIndex(int op, int a, int b, int rel) {
+    return ((op * NUM_SHAPES + a) * NUM_SHAPES + b) * NUM_RELATIONS + rel;
+}
+
+// The decision tree, fully evaluated by the compiler: for every combination of
+// (opcode, shape, shape, relation) the first rule that matches, or -1.
+constexpr array<int8_t, kTableSize> buildTable() {
+    array<int8_t, kTableSize> t{};
+    for (int op = 0; op < kNumOps; ++op)
+        for (int a = 0; a < NUM_SHAPES; ++a)
+            for (int b = 0; b < NUM_SHAPES; ++b)
+                for (int rel = 0; rel < NUM_RELATIONS; ++rel) {
+                    int8_t hit = -1;
+                    for (int r = 0; r < kNumRules && hit < 0; ++r) {
+                        const Rule &rule = kRules[r];
+                        bool relOk = rule.rel == R_NONE || rule.rel == rel;
+                        if ((int)rule.op == op && relOk && matches(rule.a, a) && matches(rule.b, b))
+                            hit = (int8_t)r;
+                    }
+                    t[tableIndex(op, a, b, rel)] = hit;
+                }
+    return t;
+}
+
+constexpr auto kDecision = buildTable();
+
+constexpr bool sameName(const char *a, const char *b) {
+    while (*a && *a == *b) { ++a; ++b; }
+    return *a == *b;
+}
+
+constexpr int ruleIndex(const char *name) {
+    for (int r = 0; r < kNumRules; ++r) if (sameName(kRules[r].name, name)) return r;
+    return -1;
+}
+
+static_assert(kNumRules < 127, "rule index must fit the decision table");
+static_assert(kDecision[tableIndex((int)TACOp::MUL, S_VAR, S_ONE, R_NONE)] == ruleIndex("mul-by-1"),
+              "x*1 resolves to mul-by-1 at compile time");
+static_assert(kDecision[tableIndex((int)TACOp::MUL, S_ONE, S_TWO, R_NONE)] == ruleIndex("fold-mul"),
+              "constant operands fold before any identity applies");
+static_assert(kDecision[tableIndex((int)TACOp::ADD, S_VAR, S_ZERO, R_NONE)] == -1,
+              "x+0 is not IEEE-exact and must not match");
+
+Shape shapeOfValue(double v) {
+    if (v == 0.0 && !std::signbit(v)) return S_ZERO;
+    if (v == 1.0) return S_ONE;
+    if (v == 2.0) return S_TWO;
+    return S_CONST;
+}
+
+// Evaluate as the backends do: F32 rounds the operands and computes in float.
+bool evaluate(const TacInst &inst, double a, double b, double &r) {
+    if (inst.prec == TacPrecision::F32) {
+        const float x = (float)a, y = (float)b;
+        switch (inst.op) {
+            case TACOp::ASSIGN: r = x; break;
+            case TACOp::ADD: r = x + y; break;
+            case TACOp::SUB: r = x - y; break;
+            case TACOp::MUL: r = x * y; break;
+            case TACOp::DIV: r = x / y; break;
+            default: return false;
+        }
+        return std::isfinite(r);
+    }
+    switch (inst.op) {
+        case TACOp::ASSIGN: r = a; break;
+        case TACOp::ADD: r = a + b; break;
+        case TACOp::SUB: r = a - b; break;
+        case TACOp::MUL: r = a * b; break;
+        case TACOp::DIV: r = a / b; break;
+        default: return false;
+    }
+    return std::isfinite(r);
+}
+
+} // namespace
+
+PeepholeStats PeepholeOptimizer::run(vector<TacInst> &tac) {
+    PeepholeStats st;
+    const int n = (int)tac.size();
+
+    // reaching definitions and readers of every definition
+    vector<int> prod1(n, -1), prod2(n, -1);
+    vector<vector<int>> readers(n);
+    unordered_map<string, int> defs; // definitions of each name
+    {
+        unordered_map<string, int> lastDef;
+        for (int i = 0; i < n; ++i) {
+            const TacInst &inst = tac[i];
+            vector<string> uses = usesOf(inst);
+            if (uses.size() > 0 && lastDef.count(uses[0])) prod1[i] = lastDef[uses[0]];
+            if (uses.size() > 1 && lastDef.count(uses[1])) prod2[i] = lastDef[uses[1]];
+            for (int p : {prod1[i], prod2[i]}) if (p >= 0) readers[p].push_back(i);
+            if (!inst.dest.empty()) { lastDef[inst.dest] = i; defs[inst.dest]++; }
+        }
+    }
+
+    auto shapeOf = [&](int prod, const string &name, double &v) -> Shape {
+        if (name.empty()) return S_NONE;
+        if (prod >= 0 && tac[prod].op == TACOp::LOAD_CONST) {
+            v = constValue(tac[prod]);
+            return shapeOfValue(v);
+        }
+        return S_VAR;
+    };
+
+    deque<int> work;
+    vector<char> queued(n, 1);
+    for (int i = 0; i < n; ++i) work.push_back(i);
+    auto push = [&](int i) {
+        if (!queued[i]) { queued[i] = 1; work.push_back(i); }
+    };
+
+    while (!work.empty()) {
+        int i = work.front();
+        work.pop_front();
+        queued[i] = 0;
+        st.visited++;
+
+        TacInst &inst = tac[i];
+        if (inst.op == TACOp::NOP || inst.op == TACOp::LOAD_CONST) continue;
+        double a = 0, b = 0;
+        Shape sa = shapeOf(prod1[i], inst.arg1, a);
+        Shape sb = inst.op == TACOp::ASSIGN ? S_NONE : shapeOf(prod2[i], inst.arg2, b);
+        Relation rel = (inst.op == TACOp::ASSIGN && inst.dest == inst.arg1) ? R_DEST_IS_ARG1 : R_NONE;
+
+        int r = kDecision[tableIndex((int)inst.op, sa, sb, rel)];
+        if (r < 0) continue;
+        const Rule &rule = kRules[r];
+        // an F32 copy rounds its value, even onto itself; and a variable's only
+        // definition keeps it an output of the program
+        if (rule.rw == Rewrite::DROP &&
+            (inst.prec == TacPrecision::F32 || (!isTempName(inst.dest) && defs[inst.dest] < 2)))
+            continue;
+
+        switch (rule.rw) {
+            case Rewrite::FOLD: {
+                double v;
+                if (!evaluate(inst, a, b, v)) continue;
+                inst.op = TACOp::LOAD_CONST;
+                inst.arg1Literal = formatLiteral(v);
+                inst.arg1.clear();
+                inst.arg2.clear();
+                prod1[i] = prod2[i] = -1;
+                break;
+            }
+            case Rewrite::ASSIGN_ARG1:
+                inst.op = TACOp::ASSIGN;
+                inst.arg2.clear();
+                prod2[i] = -1;
+                break;
+            case Rewrite::ASSIGN_ARG2:
+                inst.op = TACOp::ASSIGN;
+                inst.arg1 = inst.arg2;
+                inst.arg2.clear();
+                prod1[i] = prod2[i];
+                prod2[i] = -1;
+                break;
+            case Rewrite::ADD_SELF1:
+                inst.op = TACOp::ADD;
+                inst.arg2 = inst.arg1;
+                prod2[i] = prod1[i];
+                break;
+            case Rewrite::ADD_SELF2:
+                inst.op = TACOp::ADD;
+                inst.arg1 = inst.arg2;
+                prod1[i] = prod2[i];
+                break;
+            case Rewrite::DROP:
+                // readers of this copy now read the value it copied
+                for (int u : readers[i]) {
+                    if (prod1[u] == i) prod1[u] = prod1[i];
+                    if (prod2[u] == i) prod2[u] = prod1[i];
+                    if (prod1[i] >= 0) readers[prod1[i]].push_back(u);
+                }
+                defs[inst.dest]--;
+                inst = TacInst();
+                break;
+        }
+
+        st.fired[rule.name]++;
+        st.total++;
+        push(i);
+        for (int u : readers[i]) push(u);
+    }
+
+    vector<TacInst> out;
+    out.reserve(n);
+    for (auto &inst : tac) if (inst.op != TACOp::NOP) out.push_back(inst);
+    tac.swap(out);
+    return st;
+}
+
+vector<string> PeepholeOptimizer::ruleNames() {
+    vector<string> names;
+    for (const auto &r : kRules) names.push_back(r.name);
+    return names;
+}
+
+void PeepholeOptimizer::print(const PeepholeStats &st, ostream &out) {
+    for (const auto &name : ruleNames()) {
+        auto it = st.fired.find(name);
+        out << "  " << name << ": " << (it == st.fired.end() ? 0 : it->second) << "\n";
+    }
+    out << "  total firings: " << st.total << " (" << st.visited << " worklist visits)\n";
+}
+
+void PeepholeOptimizer::report(const PeepholeStats &st, OptReport &rep) {
+    for (const auto &p : st.fired) rep.note("peephole", p.first + " fired " + to_string(p.second) + "x");
+}
@@ -0,0 +1,41 @@
+#ifndef PEEPHOLE_H
+#define PEEPHOLE_H
+
+#include "tac.h"
+#include "optReport.h"
+#include <vector>
+#include <string>
+#include <map>
+
+/*
+ * PeepholeOptimizer
+ *  - Table-driven rewriting of single TAC instructions. Each rule in peephole.cpp
+ *    is a pattern over (opcode, operand shape, operand shape, operand relation)
+ *    and a replacement; the table is compiled into a decision table at C++ compile
+ *    time (constexpr), so matching an instruction is a single indexed load.
+ *  - Operand shapes come from the reaching definition: a value loaded by
+ *    LOAD_CONST is classified as 0, 1, 2 or another constant, anything else is a
+ *    variable.
+ *  - Applied with one worklist pass: when a rule fires, the instruction and the
+ *    readers of its value are revisited, so rewrites cascade to a fixpoint.
+ *  - Adding a simplification means adding a row to the rule table.
+ */
+struct PeepholeStats {
+    std::map<std::string, int> fired; // rule name -> times it fired
+    int total = 0;
+    int visited = 0;                  // worklist pops
+};
+
+class PeepholeOptimizer {
+public:
+    static PeepholeStats run(std::vector<TacInst> &tac);
+
+    // Names of every rule, in priority order.
+    static std::vector<std::string> ruleNames();
+
+    // Per-rule firing counts (rules that never fired included).
+    static void print(const PeepholeStats &st, std::ostream &out = std::cout);
+    static void report(const PeepholeStats &st, OptReport &rep);
+};
+
+#endif // PEEPHOLE_H
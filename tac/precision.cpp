@@ -0,0 +1,158 @@
+#include "precision.h"
+#include <unordered_map>
+#include <limits>
+#include <cmath>
+#include <cfloat>
+#include <sstream>
+
+using namespace std;
+
+static const double U32 = std::ldexp(1.0, -24);
+static const double U64 = std::ldexp(1.0, -53);
+static const double TINY32 = std::ldexp(1.0, -150); // float32 subnormal spacing / 2
+static const double INF = numeric_limits<double>::infinity();
+
+// worst-case absolute error of every instruction result for the given choice
+static vector<double> propagate(const vector<TacInst> &tac, const RangeInfo &ranges, const vector<char> &f32) {
+    vector<double> err(tac.size(), 0.0);
+    unordered_map<string, double> errOf;
+    unordered_map<string, bool> inF32;
+
+    for (size_t i = 0; i < tac.size(); ++i) {
+        const TacInst &inst = tac[i];
+        const bool single = f32[i] != 0;
+        const double u = single ? U32 : U64;
+        auto operandErr = [&](const string &name, const Interval &range) {
+            double e = errOf.count(name) ? errOf[name] : 0.0; // inputs arrive exact as double
+            if (single && !inF32[name]) e += U32 * range.maxAbs() + TINY32;
+            return e;
+        };
+
+        const Interval &r = ranges.result[i];
+        double e = 0;
+        switch (inst.op) {
+            case TACOp::LOAD_CONST: {
+                double c = literalValue(inst.arg1Literal);
+                e = single ? fabs(c - (double)(float)c) : 0.0;
+                break;
+            }
+            case TACOp::ASSIGN:
+                e = operandErr(inst.arg1, ranges.arg1[i]);
+                break;
+            case TACOp::ADD:
+            case TACOp::SUB:
+            case TACOp::MUL:
+            case TACOp::DIV: {
+                const Interval &ra = ranges.arg1[i], &rb = ranges.arg2[i];
+                double ea = operandErr(inst.arg1, ra), eb = operandErr(inst.arg2, rb);
+                if (inst.op == TACOp::ADD || inst.op == TACOp::SUB) {
+                    e = ea + eb;
+                } else if (inst.op == TACOp::MUL) {
+                    e = ra.maxAbs() * eb + rb.maxAbs() * ea + ea * eb;
+                } else {
+                    double m = rb.minAbs();
+                    e = m > eb ? (ea + r.maxAbs() * eb) / (m - eb) : INF;
+                }
+                e += u * r.maxAbs() + (single ? TINY32 : 0.0);
+                break;
+            }
+            case TACOp::FMA: {
+                // product error plus addend error, one rounding of the result
+                const Interval &ra = ranges.arg1[i], &rb = ranges.arg2[i], &rc = ranges.arg3[i];
+                double ea = operandErr(inst.arg1, ra), eb = operandErr(inst.arg2, rb);
+                e = ra.maxAbs() * eb + rb.maxAbs() * ea + ea * eb + operandErr(inst.arg3, rc);
+                e += u * r.maxAbs() + (single ? TINY32 : 0.0);
+                break;
+            }
+            default:
+                break;
+        }
+        if (!std::isfinite(r.lo) || !std::isfinite(r.hi) || r.mayBeNaN) e = INF;
+        err[i] = e;
+        if (!inst.dest.empty()) {
+            errOf[inst.dest] = e;
+            inF32[inst.dest] = single && inst.op != TACOp::NOP;
+        }
+    }
+    return err;
+}
+
+PrecisionResult PrecisionAnalyzer::demote(vector<TacInst> &tac, const map<string, Interval> &inputRanges,
+                                          double maxAbsError, OptReport *report) {
+    PrecisionResult res;
+    const int n = (int)tac.size();
+    RangeInfo ranges = RangeAnalysis::analyze(tac, inputRanges);
+
+    // producers of every operand, for walking back from an output
+    vector<int> prod1(n, -1), prod2(n, -1), prod3(n, -1);
+    unordered_map<string, int> lastDef;
+    for (int i = 0; i < n; ++i) {
+        vector<string> uses = usesOf(tac[i]);
+        if (uses.size() > 0 && lastDef.count(uses[0])) prod1[i] = lastDef[uses[0]];
+        if (uses.size() > 1 && lastDef.count(uses[1])) prod2[i] = lastDef[uses[1]];
+        if (uses.size() > 2 && lastDef.count(uses[2])) prod3[i] = lastDef[uses[2]];
+        if (!tac[i].dest.empty()) lastDef[tac[i].dest] = i;
+    }
+    vector<pair<string, int>> outputs; // variable -> final definition
+    for (const auto &p : lastDef) if (!isTempName(p.first)) outputs.push_back(p);
+
+    // result and every operand must be representable in float32
+    auto inFloat = [](const Interval &r) { return r.isFinite() && r.maxAbs() < FLT_MAX; };
+    vector<char> f32(n, 0);
+    for (int i = 0; i < n; ++i) {
+        bool fits = inFloat(ranges.result[i]) && tac[i].op != TACOp::NOP && !tac[i].dest.empty();
+        const size_t operands = usesOf(tac[i]).size();
+        if (operands > 0) fits = fits && inFloat(ranges.arg1[i]);
+        if (operands > 1) fits = fits && inFloat(ranges.arg2[i]);
+        if (operands > 2) fits = fits && inFloat(ranges.arg3[i]);
+        f32[i] = fits;
+    }
+
+    vector<double> err;
+    for (int round = 0; round <= n; ++round) {
+        err = propagate(tac, ranges, f32);
+
+        // largest float32 rounding term feeding an output over the bound
+        int worst = -1;
+        double worstTerm = -1;
+        for (const auto &o : outputs) {
+            if (err[o.second] <= maxAbsError) continue;
+            vector<int> stack = {o.second};
+            vector<char> seen(n, 0);
+            while (!stack.empty()) {
+                int i = stack.back();
+                stack.pop_back();
+                if (i < 0 || seen[i]) continue;
+                seen[i] = 1;
+                double term = U32 * ranges.result[i].maxAbs();
+                if (f32[i] && term > worstTerm) { worstTerm = term; worst = i; }
+                stack.push_back(prod1[i]);
+                stack.push_back(prod2[i]);
+                stack.push_back(prod3[i]);
+            }
+        }
+        if (worst < 0) break;
+        f32[worst] = 0;
+    }
+
+    for (int i = 0; i < n; ++i) {
+        tac[i].prec = f32[i] ? TacPrecision::F32 : TacPrecision::F64;
+        if (tac[i].op != TACOp::NOP) res.total++;
+        if (f32[i]) res.demoted++;
+    }
+    for (const auto &o : outputs) res.outputError[o.first] = err.empty() ? 0.0 : err[o.second];
+
+    if (report) {
+        ostringstream msg;
+        msg << res.demoted << "/" << res.total << " instructions demoted to float32 (2x SIMD lanes) for |error| <= "
+            << maxAbsError;
+        report->note("precision", msg.str());
+        for (const auto &o : res.outputError) {
+            ostringstream line;
+            line << o.first << ": worst-case |error| " << o.second
+                 << (o.second <= maxAbsError ? "" : " (exceeds bound even in double)");
+            report->note("precision", line.str());
+        }
+    }
+    return res;
+}
@@ -0,0 +1,38 @@
+#ifndef PRECISION_H
+#define PRECISION_H
+
+#include "tac.h"
+#include "rangeAnalysis.h"
+#include "optReport.h"
+#include <vector>
+#include <map>
+#include <string>
+
+/*
+ * PrecisionAnalyzer
+ *  - Proves which TAC values can be computed in float32 while every program output
+ *    stays within a user-given absolute error bound, and sets TacInst::prec = F32
+ *    on them so vector backends can run twice as many lanes per instruction.
+ *  - Uses RangeAnalysis (seeded by declared sensor input ranges) and forward
+ *    propagation of worst-case absolute error: each rounding adds u*|result|
+ *    (u = 2^-24 for float32, 2^-53 for double), converting a double operand to
+ *    float32 adds u*|operand|, and operand errors propagate through + - * / with
+ *    first-order bounds (division needs a divisor range that excludes zero).
+ *  - Starts with every value whose range is finite in float32 demoted, then promotes
+ *    the largest rounding contributor to an over-budget output back to double until
+ *    all outputs meet the bound.
+ */
+struct PrecisionResult {
+    int demoted = 0;
+    int total = 0;
+    std::map<std::string, double> outputError; // worst-case absolute error per output
+};
+
+class PrecisionAnalyzer {
+public:
+    static PrecisionResult demote(std::vector<TacInst> &tac,
+                                  const std::map<std::string, Interval> &inputRanges,
+                                  double maxAbsError, OptReport *report = nullptr);
+};
+
+#endif // PRECISION_H
@@ -0,0 +1,133 @@
+#include "rangeAnalysis.h"
+#include <unordered_map>
+#include <algorithm>
+#include <limits>
+#include <cmath>
+#include <sstream>
+
+using namespace std;
+
+static const double INF = numeric_limits<double>::infinity();
+
+Interval::Interval() : lo(-INF), hi(INF), mayBeNaN(true) {}
+Interval::Interval(double l, double h) : lo(l), hi(h), mayBeNaN(false) {}
+
+Interval Interval::point(double v) {
+    if (std::isnan(v)) return Interval();
+    return Interval(v, v);
+}
+
+bool Interval::isFinite() const { return !mayBeNaN && std::isfinite(lo) && std::isfinite(hi); }
+bool Interval::containsZero() const { return lo <= 0.0 && hi >= 0.0; }
+double Interval::maxAbs() const { return max(fabs(lo), fabs(hi)); }
+double Interval::minAbs() const { return containsZero() ? 0.0 : min(fabs(lo), fabs(hi)); }
+
+string Interval::toString() const {
+    ostringstream o;
+    o << "[" << lo << ", " << hi << "]" << (mayBeNaN ? "+NaN" : "");
+    return o.str();
+}
+
+// widen by one ulp on each side: the computed bound was itself rounded
+static Interval widened(double lo, double hi, bool nan) {
+    Interval r(std::nextafter(lo, -INF), std::nextafter(hi, INF));
+    if (std::isnan(lo) || std::isnan(hi)) return Interval();
+    r.mayBeNaN = nan;
+    return r;
+}
+
+Interval intervalAdd(const Interval &a, const Interval &b) {
+    // inf + -inf is NaN
+    bool nan = a.mayBeNaN || b.mayBeNaN ||
+               (a.hi == INF && b.lo == -INF) || (a.lo == -INF && b.hi == INF);
+    return widened(a.lo + b.lo, a.hi + b.hi, nan);
+}
+
+Interval intervalSub(const Interval &a, const Interval &b) {
+    Interval nb(-b.hi, -b.lo);
+    nb.mayBeNaN = b.mayBeNaN;
+    return intervalAdd(a, nb);
+}
+
+// product of two bounds where 0 * inf counts as 0 (the NaN case is tracked separately)
+static double mulBound(double x, double y) {
+    if (x == 0.0 || y == 0.0) return 0.0;
+    return x * y;
+}
+
+Interval intervalMul(const Interval &a, const Interval &b) {
+    bool aInf = std::isinf(a.lo) || std::isinf(a.hi);
+    bool bInf = std::isinf(b.lo) || std::isinf(b.hi);
+    bool nan = a.mayBeNaN || b.mayBeNaN || (aInf && b.containsZero()) || (bInf && a.containsZero());
+    double c[4] = {mulBound(a.lo, b.lo), mulBound(a.lo, b.hi), mulBound(a.hi, b.lo), mulBound(a.hi, b.hi)};
+    return widened(*min_element(c, c + 4), *max_element(c, c + 4), nan);
+}
+
+Interval intervalDiv(const Interval &a, const Interval &b) {
+    if (b.containsZero()) {
+        Interval r; // anything, including +-inf
+        r.mayBeNaN = a.mayBeNaN || b.mayBeNaN || a.containsZero() ||
+                     ((std::isinf(a.lo) || std::isinf(a.hi)) && (std::isinf(b.lo) || std::isinf(b.hi)));
+        return r;
+    }
+    bool aInf = std::isinf(a.lo) || std::isinf(a.hi);
+    bool bInf = std::isinf(b.lo) || std::isinf(b.hi);
+    bool nan = a.mayBeNaN || b.mayBeNaN || (aInf && bInf);
+    double c[4] = {a.lo / b.lo, a.lo / b.hi, a.hi / b.lo, a.hi / b.hi};
+    for (double &x : c) if (std::isnan(x)) x = 0.0; // inf/inf, flagged above
+    return widened(*min_element(c, c + 4), *max_element(c, c + 4), nan);
+}
+
+RangeInfo RangeAnalysis::analyze(const vector<TacInst> &tac, const map<string, Interval> &inputRanges) {
+    RangeInfo info;
+    info.result.resize(tac.size());
+    info.arg1.resize(tac.size());
+    info.arg2.resize(tac.size());
+    info.arg3.resize(tac.size());
+
+    unordered_map<string, Interval> current;
+    auto rangeOf = [&](const string &name) {
+        auto it = current.find(name);
+        if (it != current.end()) return it->second;
+        auto in = inputRanges.find(name);
+        return in != inputRanges.end() ? in->second : Interval();
+    };
+
+    for (size_t i = 0; i < tac.size(); ++i) {
+        const TacInst &inst = tac[i];
+        Interval r;
+        switch (inst.op) {
+            case TACOp::LOAD_CONST:
+                r = Interval::point(literalValue(inst.arg1Literal));
+                break;
+            case TACOp::ASSIGN:
+                r = info.arg1[i] = rangeOf(inst.arg1);
+                break;
+            case TACOp::ADD:
+            case TACOp::SUB:
+            case TACOp::MUL:
+            case TACOp::DIV: {
+                Interval a = info.arg1[i] = rangeOf(inst.arg1);
+                Interval b = info.arg2[i] = rangeOf(inst.arg2);
+                r = inst.op == TACOp::ADD ? intervalAdd(a, b)
+                  : inst.op == TACOp::SUB ? intervalSub(a, b)
+                  : inst.op == TACOp::MUL ? intervalMul(a, b)
+                  : intervalDiv(a, b);
+                break;
+            }
+            case TACOp::FMA: {
+                // bounds of the unfused a*b+c also bound the singly rounded result
+                Interval a = info.arg1[i] = rangeOf(inst.arg1);
+                Interval b = info.arg2[i] = rangeOf(inst.arg2);
+                Interval c = info.arg3[i] = rangeOf(inst.arg3);
+                r = intervalAdd(intervalMul(a, b), c);
+                break;
+            }
+            default:
+                break;
+        }
+        info.result[i] = r;
+        if (!inst.dest.empty()) current[inst.dest] = r;
+    }
+    return info;
+}
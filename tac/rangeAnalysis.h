@@ -0,0 +1,58 @@
+#ifndef RANGEANALYSIS_H
+#define RANGEANALYSIS_H
+
+#include "tac.h"
+#include <vector>
+#include <map>
+#include <string>
+
+/*
+ * Interval
+ *  - Closed range [lo, hi] of the values a TAC name can hold, plus whether it may
+ *    be NaN. Bounds are widened outward by one ulp per operation so the ranges stay
+ *    sound under double rounding.
+ */
+struct Interval {
+    double lo;
+    double hi;
+    bool mayBeNaN;
+
+    Interval();                      // unknown: (-inf, inf), may be NaN
+    Interval(double lo, double hi);  // declared range, never NaN
+
+    static Interval point(double v);
+
+    bool isFinite() const;       // bounded and never NaN
+    bool containsZero() const;
+    double maxAbs() const;       // largest magnitude in the range
+    double minAbs() const;       // smallest magnitude in the range
+
+    std::string toString() const;
+};
+
+Interval intervalAdd(const Interval &a, const Interval &b);
+Interval intervalSub(const Interval &a, const Interval &b);
+Interval intervalMul(const Interval &a, const Interval &b);
+Interval intervalDiv(const Interval &a, const Interval &b);
+
+// Ranges of every operand and result of a TAC program.
+struct RangeInfo {
+    std::vector<Interval> result; // per instruction: value written to dest
+    std::vector<Interval> arg1;   // per instruction: value read as arg1
+    std::vector<Interval> arg2;   // per instruction: value read as arg2
+    std::vector<Interval> arg3;   // per instruction: addend read by FMA
+};
+
+/*
+ * RangeAnalysis
+ *  - Forward interval analysis over straight-line TAC, seeded with declared ranges
+ *    of the program inputs (names read before they are defined). Inputs without a
+ *    declared range are unknown.
+ */
+class RangeAnalysis {
+public:
+    static RangeInfo analyze(const std::vector<TacInst> &tac,
+                             const std::map<std::string, Interval> &inputRanges);
+};
+
+#endif // RANGEANALYSIS_H
@@ -0,0 +1,129 @@
+#include "reassociate.h"
+#include "exprTree.h"
+#include <unordered_map>
+#include <map>
+#include <cmath>
+#include <functional>
+#include <algorithm>
+
+using namespace std;
+
+ReassocStats Reassociator::run(vector<TacInst> &tac, OptReport *report) {
+    ReassocStats st;
+    ExprDag dag = ExprTreeBuilder::build(tac);
+
+    // an inner link of a chain: a temp whose one reader is the same operation
+    auto inner = [&](int node, TACOp op, TacPrecision prec) {
+        const ExprNode &n = dag.nodes[node];
+        if (n.kind != ExprNode::OP || n.op != op || n.uses != 1 || dag.consumers[node].size() != 1) return false;
+        const TacInst &def = tac[n.inst], &reader = tac[dag.consumers[node][0]];
+        return isTempName(def.dest) && def.prec == prec && reader.op == op && reader.prec == prec;
+    };
+
+    int nextTemp = nextTempIndex(tac);
+    map<int, vector<TacInst>> replace;      // root index -> its new instructions
+    map<int, vector<TacInst>> copies;       // inserted before an index
+    unordered_map<string, int> current;     // name -> node it holds before instruction i
+    for (size_t i = 0; i < tac.size(); ++i) {
+        const TacInst &root = tac[i];
+        const int r = dag.result[i];
+        const bool chainOp = root.op == TACOp::ADD || root.op == TACOp::MUL;
+        if (chainOp && r >= 0 && !inner(r, root.op, root.prec)) {
+            // flatten the chain, operands in source order
+            vector<int> leaves;
+            function<int(int)> flatten = [&](int node) {
+                if (node != r && !inner(node, root.op, root.prec)) {
+                    leaves.push_back(node);
+                    return 0;
+                }
+                const ExprNode &n = dag.nodes[node];
+                return 1 + max(flatten(n.kids[0]), flatten(n.kids[1]));
+            };
+            const int depth = flatten(r);
+
+            vector<int> vars;
+            vector<double> consts;
+            for (int leaf : leaves) {
+                if (dag.nodes[leaf].kind == ExprNode::CONST) consts.push_back(dag.nodes[leaf].value);
+                else vars.push_back(leaf);
+            }
+            double c = root.op == TACOp::ADD ? 0.0 : 1.0;
+            for (double v : consts) c = root.op == TACOp::ADD ? c + v : c * v;
+            const size_t operands = vars.size() + (consts.empty() ? 0 : 1);
+            int balanced = 0;
+            while ((size_t)1 << balanced < operands) ++balanced;
+
+            if (std::isfinite(c) && operands >= 2 && (consts.size() >= 2 || balanced < depth)) {
+                vector<TacInst> &out = replace[(int)i];
+                vector<string> level;
+                for (int leaf : vars) {
+                    const ExprNode &n = dag.nodes[leaf];
+                    auto held = current.find(n.name);
+                    if (held == current.end() ? n.kind == ExprNode::INPUT : held->second == leaf) {
+                        level.push_back(n.name);
+                        continue;
+                    }
+                    // the name has been reused since: copy the value right after it is made
+                    TacInst copy;
+                    copy.op = TACOp::ASSIGN;
+                    copy.dest = "t" + to_string(nextTemp++);
+                    copy.arg1 = n.name;
+                    copy.prec = root.prec;
+                    copies[n.kind == ExprNode::INPUT ? 0 : n.inst + 1].push_back(copy);
+                    level.push_back(copy.dest);
+                }
+                if (!consts.empty()) {
+                    TacInst lc;
+                    lc.op = TACOp::LOAD_CONST;
+                    lc.dest = "t" + to_string(nextTemp++);
+                    lc.arg1Literal = formatLiteral(c);
+                    lc.prec = root.prec;
+                    out.push_back(lc);
+                    level.push_back(lc.dest);
+                }
+                // pair neighbours until one value is left; the last op writes the root's dest
+                while (level.size() > 1) {
+                    vector<string> next;
+                    for (size_t k = 0; k + 1 < level.size(); k += 2) {
+                        TacInst op;
+                        op.op = root.op;
+                        op.prec = root.prec;
+                        op.arg1 = level[k];
+                        op.arg2 = level[k + 1];
+                        op.dest = level.size() == 2 ? root.dest : "t" + to_string(nextTemp++);
+                        out.push_back(op);
+                        next.push_back(op.dest);
+                    }
+                    if (level.size() % 2) next.push_back(level.back());
+                    level.swap(next);
+                }
+                st.chains++;
+                st.folded += consts.size() >= 2 ? (int)consts.size() - 1 : 0;
+                st.depthBefore += depth;
+                st.depthAfter += balanced;
+                if (report)
+                    report->note("reassociate", root.dest + ": " + (root.op == TACOp::ADD ? "+" : "*") + " chain of " +
+                                                    to_string(leaves.size()) + " operands, depth " + to_string(depth) +
+                                                    " -> " + to_string(balanced) +
+                                                    (consts.size() >= 2 ? ", constants folded" : ""));
+            }
+        }
+        if (!root.dest.empty()) current[root.dest] = r;
+    }
+    if (replace.empty()) return st;
+
+    vector<TacInst> out;
+    out.reserve(tac.size() + replace.size() * 2 + copies.size());
+    for (size_t i = 0; i < tac.size(); ++i) {
+        auto c = copies.find((int)i);
+        if (c != copies.end()) out.insert(out.end(), c->second.begin(), c->second.end());
+        auto p = replace.find((int)i);
+        if (p == replace.end()) out.push_back(tac[i]);
+        else out.insert(out.end(), p->second.begin(), p->second.end());
+    }
+    tac.swap(out);
+    if (report)
+        report->note("reassociate", to_string(st.chains) + " chain(s) rewritten, depth " + to_string(st.depthBefore) +
+                                        " -> " + to_string(st.depthAfter) + " (fastmath: results may differ in the last bits)");
+    return st;
+}
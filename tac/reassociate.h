@@ -0,0 +1,40 @@
+#ifndef REASSOCIATE_H
+#define REASSOCIATE_H
+
+#include "tac.h"
+#include "optReport.h"
+#include <vector>
+
+/*
+ * Float semantics a program is compiled for.
+ *  - STRICT   : IEEE double in source order; every backend agrees bit for bit.
+ *  - FASTMATH : + and * may be reassociated and divisions replaced by reciprocal
+ *               multiplies (RELAXED reciprocals), and the AOT backend is built with
+ *               the matching compiler flags. Results may differ in the last bits.
+ */
+enum class MathProfile { STRICT, FASTMATH };
+
+/*
+ * Reassociator
+ *  - Treats a chain of ADDs (or of MULs) joined through single-use temporaries as
+ *    one n-ary operation, e.g. ((a + 1) + b) + 2.
+ *  - Constants in a chain are folded into one: a + b + 3.
+ *  - Long chains are rebuilt as a balanced tree, (a + b) + (c + d), so the
+ *    dependency height drops from n-1 to ceil(log2 n) and the halves can issue in
+ *    parallel.
+ *  - Only for MathProfile::FASTMATH: the rewrite changes rounding. The old chain
+ *    instructions are left for DCE.
+ */
+struct ReassocStats {
+    int chains = 0;      // chains rewritten
+    int folded = 0;      // constants folded away
+    int depthBefore = 0; // summed over the rewritten chains
+    int depthAfter = 0;
+};
+
+class Reassociator {
+public:
+    static ReassocStats run(std::vector<TacInst> &tac, OptReport *report = nullptr);
+};
+
+#endif // REASSOCIATE_H
@@ -0,0 +1,113 @@
+#include "reciprocal.h"
+#include <unordered_map>
+#include <map>
+#include <cmath>
+
+using namespace std;
+
+static bool isPowerOfTwo(double c) {
+    int e = 0;
+    double m = std::frexp(c, &e);
+    double r = 1.0 / c;
+    return std::isfinite(r) && r != 0.0 && std::fabs(m) == 0.5;
+}
+
+ReciprocalStats ReciprocalHoister::run(vector<TacInst> &tac, PrecisionMode mode,
+                                       OptReport *report, int minDivisions) {
+    ReciprocalStats st;
+
+    // group divisions by the value of their divisor
+    struct Group {
+        vector<int> divs;
+        bool isConst = false;
+        double value = 0;
+    };
+    unordered_map<string, int> lastDef;
+    map<string, Group> groups;
+    vector<string> keyOrder;
+    for (size_t i = 0; i < tac.size(); ++i) {
+        const TacInst &inst = tac[i];
+        if (inst.op == TACOp::DIV) {
+            auto d = lastDef.find(inst.arg2);
+            int def = d == lastDef.end() ? -1 : d->second;
+            string key;
+            Group g;
+            if (def >= 0 && tac[def].op == TACOp::LOAD_CONST) {
+                g.isConst = true;
+                g.value = literalValue(tac[def].arg1Literal);
+                key = "C:" + formatLiteral(g.value);
+            } else {
+                key = inst.arg2 + "@" + to_string(def);
+            }
+            auto it = groups.find(key);
+            if (it == groups.end()) {
+                it = groups.emplace(key, g).first;
+                keyOrder.push_back(key);
+            }
+            it->second.divs.push_back((int)i);
+        }
+        if (!inst.dest.empty()) lastDef[inst.dest] = (int)i;
+    }
+
+    int nextTemp = nextTempIndex(tac);
+    map<int, vector<TacInst>> prefix; // instructions inserted before an index
+    map<int, string> recipOf;         // DIV index -> reciprocal name
+
+    for (const auto &key : keyOrder) {
+        const Group &g = groups[key];
+        const TacInst &first = tac[g.divs.front()];
+        bool exact = g.isConst && isPowerOfTwo(g.value);
+        bool take;
+        if (g.isConst) take = exact || (mode == PrecisionMode::RELAXED && std::isfinite(1.0 / g.value) && g.value != 0.0);
+        else take = mode == PrecisionMode::RELAXED && (int)g.divs.size() >= minDivisions;
+        if (!take) continue;
+
+        string recip = "t" + to_string(nextTemp++);
+        vector<TacInst> &pre = prefix[g.divs.front()];
+        TacInst lc;
+        lc.op = TACOp::LOAD_CONST;
+        if (g.isConst) {
+            lc.dest = recip;
+            lc.arg1Literal = formatLiteral(1.0 / g.value);
+            pre.push_back(lc);
+        } else {
+            lc.dest = "t" + to_string(nextTemp++);
+            lc.arg1Literal = "1.0";
+            pre.push_back(lc);
+            TacInst div;
+            div.op = TACOp::DIV;
+            div.dest = recip;
+            div.arg1 = lc.dest;
+            div.arg2 = first.arg2;
+            pre.push_back(div);
+        }
+        for (int idx : g.divs) recipOf[idx] = recip;
+
+        st.divisors++;
+        st.rewritten += (int)g.divs.size();
+        if (report) {
+            string what = g.isConst ? formatLiteral(g.value) : first.arg2;
+            string msg = to_string(g.divs.size()) + " division(s) by " + what + " -> multiply by reciprocal";
+            if (exact) msg += " (exact: power-of-two divisor)";
+            else msg += " (tolerance: up to 1.5 ulp vs IEEE division, two roundings)";
+            report->note("reciprocal", msg);
+        }
+    }
+    if (recipOf.empty()) return st;
+
+    vector<TacInst> out;
+    out.reserve(tac.size() + prefix.size() * 2);
+    for (size_t i = 0; i < tac.size(); ++i) {
+        auto p = prefix.find((int)i);
+        if (p != prefix.end()) out.insert(out.end(), p->second.begin(), p->second.end());
+        TacInst inst = tac[i];
+        auto r = recipOf.find((int)i);
+        if (r != recipOf.end()) {
+            inst.op = TACOp::MUL;
+            inst.arg2 = r->second;
+        }
+        out.push_back(inst);
+    }
+    tac.swap(out);
+    return st;
+}
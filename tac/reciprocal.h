@@ -0,0 +1,33 @@
+#ifndef RECIPROCAL_H
+#define RECIPROCAL_H
+
+#include "tac.h"
+#include "optReport.h"
+#include <vector>
+
+/*
+ * ReciprocalHoister
+ *  - Replaces divisions by multiplications with a reciprocal.
+ *  - STRICT  : only constant power-of-two divisors (x/2.0 == x*0.5 exactly).
+ *  - RELAXED : additionally, when a region divides by the same value several times
+ *              (x/range, y/range, z/range), 1/range is computed once and every
+ *              division becomes a multiply; constant divisors use a folded reciprocal.
+ *              x*(1/d) is rounded twice and may differ from x/d by up to 1.5 ulp; for
+ *              |d| below 1/DBL_MAX the reciprocal itself overflows to infinity.
+ *  - A region is the stretch of straight-line TAC over which the divisor keeps the
+ *    same definition.
+ */
+enum class PrecisionMode { STRICT, RELAXED };
+
+struct ReciprocalStats {
+    int divisors = 0;  // distinct divisors given a reciprocal
+    int rewritten = 0; // DIVs turned into MULs
+};
+
+class ReciprocalHoister {
+public:
+    static ReciprocalStats run(std::vector<TacInst> &tac, PrecisionMode mode,
+                               OptReport *report = nullptr, int minDivisions = 2);
+};
+
+#endif // RECIPROCAL_H
@@ -0,0 +1,220 @@
+#include "regAlloc.h"
+#include <unordered_map>
+#include <algorithm>
+#include <sstream>
+
+using namespace std;
+
+/*
+ * Positions: operands of instruction i are read at 2*i and its destination is
+ * written at 2*i+1, so a value whose last use is instruction i has already expired
+ * when the destination of i is allocated and its register can be reused (this is
+ * what makes ASSIGN coalescing possible).
+ */
+static inline int usePos(int i) { return 2 * i; }
+static inline int defPos(int i) { return 2 * i + 1; }
+
+static string locToString(const Location &l) {
+    if (l.kind == Location::REG) return "r" + to_string(l.index);
+    if (l.kind == Location::SLOT) return "[s" + to_string(l.index) + "]";
+    return "-";
+}
+
+RegAllocResult RegisterAllocator::allocate(const vector<TacInst> &tac, int numRegs) {
+    RegAllocResult res;
+    res.numRegs = numRegs < 1 ? 1 : numRegs;
+    const int n = (int)tac.size();
+
+    // ---- build one interval per value ----
+    unordered_map<string, int> current; // name -> value currently held
+    vector<int> val1(n, -1), val2(n, -1), val3(n, -1), valDest(n, -1);
+
+    auto useValue = [&](const string &name, int i) {
+        auto it = current.find(name);
+        int v;
+        if (it == current.end()) {
+            LiveInterval li;
+            li.name = name;
+            li.value = v = (int)res.intervals.size();
+            li.start = -1;
+            li.end = usePos(i);
+            res.intervals.push_back(li);
+            current[name] = v;
+            res.inputs[name] = Location(); // filled in after allocation
+        } else {
+            v = it->second;
+        }
+        res.intervals[v].end = max(res.intervals[v].end, usePos(i));
+        return v;
+    };
+
+    for (int i = 0; i < n; ++i) {
+        const TacInst &inst = tac[i];
+        if (inst.op == TACOp::NOP) continue;
+        if (!inst.arg1.empty() && inst.op != TACOp::LOAD_CONST) val1[i] = useValue(inst.arg1, i);
+        if (!inst.arg2.empty() && inst.op != TACOp::LOAD_CONST && inst.op != TACOp::ASSIGN)
+            val2[i] = useValue(inst.arg2, i);
+        if (inst.op == TACOp::FMA && !inst.arg3.empty()) val3[i] = useValue(inst.arg3, i);
+        if (inst.dest.empty()) continue;
+
+        LiveInterval li;
+        li.name = inst.dest;
+        li.value = (int)res.intervals.size();
+        li.start = li.end = defPos(i);
+        li.defInst = i;
+        res.intervals.push_back(li);
+        current[inst.dest] = valDest[i] = li.value;
+    }
+
+    // program variables are observable after the last instruction
+    for (const auto &p : current) {
+        LiveInterval &li = res.intervals[p.second];
+        if (!isTempName(p.first) && li.defInst >= 0) li.end = usePos(n);
+    }
+
+    // ---- linear scan ----
+    vector<int> order(res.intervals.size());
+    for (size_t v = 0; v < order.size(); ++v) order[v] = (int)v;
+    stable_sort(order.begin(), order.end(), [&](int a, int b) {
+        return res.intervals[a].start < res.intervals[b].start;
+    });
+
+    vector<char> regFree(res.numRegs, 1);
+    vector<int> active; // value numbers currently in registers
+
+    auto takeReg = [&](int r, int v) {
+        regFree[r] = 0;
+        res.intervals[v].loc.kind = Location::REG;
+        res.intervals[v].loc.index = r;
+        active.push_back(v);
+    };
+    auto spill = [&](int v) {
+        res.intervals[v].loc.kind = Location::SLOT;
+        res.intervals[v].loc.index = res.spillSlots++;
+        res.spillCount++;
+    };
+
+    for (int v : order) {
+        LiveInterval &cur = res.intervals[v];
+
+        // expire intervals that ended before this one starts
+        for (size_t k = 0; k < active.size();) {
+            const LiveInterval &a = res.intervals[active[k]];
+            if (a.end < cur.start) {
+                regFree[a.loc.index] = 1;
+                active.erase(active.begin() + k);
+            } else {
+                ++k;
+            }
+        }
+
+        // coalesce "dest = src" when src dies at this move
+        if (cur.defInst >= 0 && tac[cur.defInst].op == TACOp::ASSIGN && val1[cur.defInst] >= 0) {
+            const LiveInterval &src = res.intervals[val1[cur.defInst]];
+            if (src.loc.kind == Location::REG && src.end == usePos(cur.defInst) && regFree[src.loc.index]) {
+                takeReg(src.loc.index, v);
+                continue;
+            }
+        }
+
+        int freeReg = -1;
+        for (int r = 0; r < res.numRegs; ++r) if (regFree[r]) { freeReg = r; break; }
+        if (freeReg >= 0) {
+            takeReg(freeReg, v);
+            continue;
+        }
+
+        // register file is full: spill whichever interval ends last
+        int victimPos = 0;
+        for (size_t k = 1; k < active.size(); ++k)
+            if (res.intervals[active[k]].end > res.intervals[active[victimPos]].end) victimPos = (int)k;
+        int victim = active[victimPos];
+        if (res.intervals[victim].end > cur.end) {
+            int r = res.intervals[victim].loc.index;
+            active.erase(active.begin() + victimPos);
+            spill(victim);
+            takeReg(r, v);
+        } else {
+            spill(v);
+        }
+    }
+
+    // ---- per-instruction view for backends ----
+    res.insts.resize(n);
+    for (int i = 0; i < n; ++i) {
+        InstAlloc &ia = res.insts[i];
+        if (val1[i] >= 0) ia.arg1 = res.intervals[val1[i]].loc;
+        if (val2[i] >= 0) ia.arg2 = res.intervals[val2[i]].loc;
+        if (val3[i] >= 0) ia.arg3 = res.intervals[val3[i]].loc;
+        if (valDest[i] >= 0) ia.dest = res.intervals[valDest[i]].loc;
+
+        if (ia.arg1.kind == Location::SLOT) res.spillReloads++;
+        if (ia.arg2.kind == Location::SLOT) res.spillReloads++;
+        if (ia.arg3.kind == Location::SLOT) res.spillReloads++;
+        if (ia.dest.kind == Location::SLOT) res.spillStores++;
+
+        if (tac[i].op == TACOp::ASSIGN && ia.dest.kind == Location::REG && ia.dest == ia.arg1) {
+            ia.coalesced = true;
+            res.coalescedMoves++;
+        }
+    }
+    for (auto &p : res.inputs) {
+        for (const auto &li : res.intervals)
+            if (li.start < 0 && li.name == p.first) { p.second = li.loc; break; }
+    }
+    for (const auto &p : current) {
+        const LiveInterval &li = res.intervals[p.second];
+        if (!isTempName(p.first) && li.defInst >= 0) res.outputs[p.first] = li.loc;
+    }
+    return res;
+}
+
+void RegisterAllocator::print(const vector<TacInst> &tac, const RegAllocResult &res, ostream &out) {
+    for (size_t i = 0; i < tac.size() && i < res.insts.size(); ++i) {
+        const TacInst &t = tac[i];
+        const InstAlloc &a = res.insts[i];
+        ostringstream line;
+        switch (t.op) {
+            case TACOp::LOAD_CONST:
+                line << locToString(a.dest) << " = " << t.arg1Literal;
+                break;
+            case TACOp::ASSIGN:
+                line << locToString(a.dest) << " = " << locToString(a.arg1);
+                break;
+            case TACOp::ADD:
+            case TACOp::SUB:
+            case TACOp::MUL:
+            case TACOp::DIV:
+                line << locToString(a.dest) << " = " << locToString(a.arg1) << " "
+                     << (t.op == TACOp::ADD ? "+" : t.op == TACOp::SUB ? "-" : t.op == TACOp::MUL ? "*" : "/")
+                     << " " << locToString(a.arg2);
+                break;
+            case TACOp::FMA:
+                line << locToString(a.dest) << " = fma(" << locToString(a.arg1) << ", " << locToString(a.arg2)
+                     << ", " << locToString(a.arg3) << ")";
+                break;
+            case TACOp::GUARD_NONZERO:
+                line << "check " << locToString(a.arg1) << " != 0";
+                break;
+            case TACOp::GUARD_FINITE:
+                line << "check isfinite(" << locToString(a.arg1) << ")";
+                break;
+            default:
+                line << "NOP";
+        }
+        out << i << ":\t" << line.str();
+        if (a.coalesced) out << "\t(coalesced)";
+        out << "\t// ";
+        printTacLine(t, out);
+    }
+
+    out << "inputs: ";
+    for (const auto &p : res.inputs) out << p.first << "->" << locToString(p.second) << " ";
+    out << "\noutputs: ";
+    for (const auto &p : res.outputs) out << p.first << "->" << locToString(p.second) << " ";
+    out << "\nregisters=" << res.numRegs
+        << " spilled values=" << res.spillCount
+        << " (stores=" << res.spillStores << ", reloads=" << res.spillReloads << ")"
+        << " frame slots=" << res.spillSlots
+        << " coalesced moves=" << res.coalescedMoves << "\n";
+}
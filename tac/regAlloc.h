@@ -0,0 +1,73 @@
+#ifndef REGALLOC_H
+#define REGALLOC_H
+
+#include "tac.h"
+#include "tacInfo.h"
+#include <vector>
+#include <string>
+#include <map>
+#include <iostream>
+
+/*
+ * RegisterAllocator
+ *  - Linear-scan allocation of TAC values onto a fixed register file.
+ *  - TAC names are redefined freely (temps are recycled by TACGenerator), so every
+ *    definition starts a new value with its own live interval; a name read before
+ *    any definition is a live-in value.
+ *  - Values are spilled to frame slots only when more than numRegs are live at once
+ *    (the active interval ending furthest away is the one spilled).
+ *  - ASSIGN moves whose source dies at the move are coalesced: the destination gets
+ *    the source's register and the move becomes a no-op for the backend.
+ */
+
+struct Location {
+    enum Kind { NONE, REG, SLOT };
+    Kind kind = NONE;
+    int index = -1; // register number or frame slot
+
+    bool operator==(const Location &o) const { return kind == o.kind && index == o.index; }
+    bool operator!=(const Location &o) const { return !(*this == o); }
+};
+
+struct LiveInterval {
+    std::string name; // TAC name holding the value
+    int value = -1;   // value number (index into RegAllocResult::intervals)
+    int start = 0;    // position of definition (-1 for live-in values)
+    int end = 0;      // position of last use (past the last instruction if live-out)
+    int defInst = -1; // defining instruction, -1 for live-in
+    Location loc;
+};
+
+// Locations of the operands of a single instruction.
+struct InstAlloc {
+    Location dest, arg1, arg2, arg3;
+    bool coalesced = false; // ASSIGN whose source and destination share a register
+};
+
+struct RegAllocResult {
+    int numRegs = 0;
+    int spillSlots = 0;     // frame slots used for spilled values
+    int spillCount = 0;     // number of values that were spilled
+    int spillStores = 0;    // definitions written to a frame slot
+    int spillReloads = 0;   // operand reads served from a frame slot
+    int coalescedMoves = 0;
+
+    std::vector<LiveInterval> intervals;
+    std::vector<InstAlloc> insts;           // parallel to the allocated TAC
+    std::map<std::string, Location> inputs;  // where live-in values must be placed
+    std::map<std::string, Location> outputs; // where live-out variables end up
+};
+
+class RegisterAllocator {
+public:
+    static const int DEFAULT_REGS = 16;
+
+    // Allocate values of tac onto numRegs registers.
+    static RegAllocResult allocate(const std::vector<TacInst> &tac, int numRegs = DEFAULT_REGS);
+
+    // Print allocated TAC (r<N> registers, [s<N>] frame slots) and spill statistics.
+    static void print(const std::vector<TacInst> &tac, const RegAllocResult &res,
+                      std::ostream &out = std::cout);
+};
+
+#endif // REGALLOC_H
@@ -0,0 +1,226 @@
+#include "scheduler.h"
+#include <unordered_map>
+#include <unordered_set>
+#include <set>
+#include <algorithm>
+
+using namespace std;
+
+int LatencyTable::of(TACOp op) const {
+    auto it = latency.find(op);
+    return it != latency.end() ? it->second : defaultLatency;
+}
+
+LatencyTable LatencyTable::defaults() {
+    LatencyTable t;
+    t.latency[TACOp::LOAD_CONST] = 1;
+    t.latency[TACOp::ASSIGN] = 1;
+    t.latency[TACOp::ADD] = 4;
+    t.latency[TACOp::SUB] = 4;
+    t.latency[TACOp::MUL] = 4;
+    t.latency[TACOp::DIV] = 14;
+    t.latency[TACOp::FMA] = 4;
+    t.latency[TACOp::GUARD_NONZERO] = 1;
+    t.latency[TACOp::GUARD_FINITE] = 1;
+    t.latency[TACOp::NOP] = 0;
+    return t;
+}
+
+// Instruction that produced each operand (-1 for inputs), by reaching definition.
+static void reachingDefs(const vector<TacInst> &tac, vector<int> &prod1, vector<int> &prod2, vector<int> &prod3) {
+    unordered_map<string, int> lastDef;
+    prod1.assign(tac.size(), -1);
+    prod2.assign(tac.size(), -1);
+    prod3.assign(tac.size(), -1);
+    for (size_t i = 0; i < tac.size(); ++i) {
+        const TacInst &inst = tac[i];
+        vector<string> uses = usesOf(inst);
+        if (uses.size() > 0 && lastDef.count(uses[0])) prod1[i] = lastDef[uses[0]];
+        if (uses.size() > 1 && lastDef.count(uses[1])) prod2[i] = lastDef[uses[1]];
+        if (uses.size() > 2 && lastDef.count(uses[2])) prod3[i] = lastDef[uses[2]];
+        if (!inst.dest.empty()) lastDef[inst.dest] = (int)i;
+    }
+}
+
+int InstructionScheduler::estimateCycles(const vector<TacInst> &tac, const LatencyTable &lat) {
+    vector<int> prod1, prod2, prod3;
+    reachingDefs(tac, prod1, prod2, prod3);
+    vector<int> issue(tac.size(), 0);
+    int prev = -1, total = 0;
+    for (size_t i = 0; i < tac.size(); ++i) {
+        int ready = prev + 1;
+        for (int p : {prod1[i], prod2[i], prod3[i]})
+            if (p >= 0) ready = max(ready, issue[p] + lat.of(tac[p].op));
+        issue[i] = prev = ready;
+        total = max(total, ready + lat.of(tac[i].op));
+    }
+    return total;
+}
+
+ScheduleStats InstructionScheduler::schedule(vector<TacInst> &tac, const LatencyTable &lat, int maxLiveTemps) {
+    ScheduleStats st;
+    const int n = (int)tac.size();
+    st.cyclesBefore = st.cyclesAfter = estimateCycles(tac, lat);
+    {
+        unordered_set<string> names;
+        for (const auto &i : tac) if (isTempName(i.dest)) names.insert(i.dest);
+        st.tempsBefore = st.tempsAfter = (int)names.size();
+    }
+    if (n < 2) return st;
+
+    // ---- dependence DAG ----
+    vector<int> prod1, prod2, prod3;
+    reachingDefs(tac, prod1, prod2, prod3);
+    vector<vector<pair<int, int>>> succ(n); // (successor, latency)
+    vector<int> preds(n, 0);
+    auto edge = [&](int from, int to, int l) {
+        if (from < 0 || from == to) return;
+        succ[from].push_back({to, l});
+        preds[to]++;
+    };
+
+    unordered_map<string, int> lastVarDef;
+    unordered_map<string, vector<int>> readers; // program variable -> reads since its last def
+    unordered_map<string, int> guardOf;         // "name@producer" -> GUARD_NONZERO on that value
+    for (int i = 0; i < n; ++i) {
+        const TacInst &inst = tac[i];
+        edge(prod1[i], i, prod1[i] >= 0 ? lat.of(tac[prod1[i]].op) : 0);
+        edge(prod2[i], i, prod2[i] >= 0 ? lat.of(tac[prod2[i]].op) : 0);
+        edge(prod3[i], i, prod3[i] >= 0 ? lat.of(tac[prod3[i]].op) : 0);
+        for (const auto &u : usesOf(inst)) if (!isTempName(u)) readers[u].push_back(i);
+        // a division stays behind the guard that checks its divisor
+        if (inst.op == TACOp::GUARD_NONZERO) guardOf[inst.arg1 + "@" + to_string(prod1[i])] = i;
+        if (inst.op == TACOp::DIV) {
+            auto g = guardOf.find(inst.arg2 + "@" + to_string(prod2[i]));
+            if (g != guardOf.end()) edge(g->second, i, lat.of(TACOp::GUARD_NONZERO));
+        }
+
+        if (inst.dest.empty() || isTempName(inst.dest)) continue;
+        for (int r : readers[inst.dest]) edge(r, i, 0); // anti dependence
+        auto ld = lastVarDef.find(inst.dest);
+        if (ld != lastVarDef.end()) edge(ld->second, i, 0); // output dependence
+        readers[inst.dest].clear();
+        lastVarDef[inst.dest] = i;
+    }
+
+    vector<int> height(n, 0);
+    for (int i = n - 1; i >= 0; --i) {
+        height[i] = lat.of(tac[i].op);
+        for (const auto &s : succ[i]) height[i] = max(height[i], s.second + height[s.first]);
+    }
+
+    // ---- register pressure bookkeeping (temps only) ----
+    vector<int> usesLeft(n, 0);
+    for (int i = 0; i < n; ++i)
+        for (int p : {prod1[i], prod2[i], prod3[i]}) if (p >= 0) usesLeft[p]++;
+    auto definesTemp = [&](int i) { return isTempName(tac[i].dest); };
+    auto pressureDelta = [&](int i, const vector<int> &left) {
+        int d = (definesTemp(i) && usesLeft[i] > 0) ? 1 : 0;
+        // a temp dies here when this instruction performs all of its remaining reads
+        const int p[3] = {prod1[i], prod2[i], prod3[i]};
+        for (int k = 0; k < 3; ++k) {
+            if (p[k] < 0 || !definesTemp(p[k]) || (k > 0 && p[k] == p[0]) || (k > 1 && p[k] == p[1])) continue;
+            int reads = 1;
+            for (int j = k + 1; j < 3; ++j) reads += p[j] == p[k];
+            if (left[p[k]] == reads) d--;
+        }
+        return d;
+    };
+
+    if (maxLiveTemps <= 0) {
+        vector<int> left = usesLeft;
+        int live = 0;
+        for (int i = 0; i < n; ++i) {
+            live += pressureDelta(i, left);
+            for (int p : {prod1[i], prod2[i], prod3[i]}) if (p >= 0) left[p]--;
+            maxLiveTemps = max(maxLiveTemps, live);
+        }
+        maxLiveTemps = max(maxLiveTemps, 1);
+    }
+    st.maxLiveTemps = maxLiveTemps;
+
+    // ---- cycle-driven list scheduling ----
+    vector<int> earliest(n, 0), order;
+    vector<char> done(n, 0);
+    vector<int> left = usesLeft;
+    int cycle = 0, live = 0;
+    while ((int)order.size() < n) {
+        int best = -1;
+        bool constrained = live >= maxLiveTemps;
+        // under pressure: any ready instruction that does not add a live temp
+        if (constrained) {
+            for (int i = 0; i < n; ++i) {
+                if (done[i] || preds[i] > 0 || pressureDelta(i, left) > 0) continue;
+                if (best < 0 || earliest[i] < earliest[best] ||
+                    (earliest[i] == earliest[best] && height[i] > height[best])) best = i;
+            }
+        }
+        if (best < 0) {
+            int soonest = -1;
+            for (int i = 0; i < n; ++i) {
+                if (done[i] || preds[i] > 0) continue;
+                if (soonest < 0 || earliest[i] < earliest[soonest]) soonest = i;
+                if (earliest[i] > cycle) continue;
+                if (best < 0 || height[i] > height[best]) best = i;
+            }
+            if (best < 0) best = soonest; // everything is waiting: stall until the first is ready
+        }
+
+        int issue = max(cycle, earliest[best]);
+        cycle = issue + 1;
+        done[best] = 1;
+        order.push_back(best);
+        live += pressureDelta(best, left);
+        for (int p : {prod1[best], prod2[best], prod3[best]}) if (p >= 0) left[p]--;
+        for (const auto &s : succ[best]) {
+            earliest[s.first] = max(earliest[s.first], issue + s.second);
+            preds[s.first]--;
+        }
+    }
+
+    // ---- rebuild with re-minimized temps ----
+    // temps read before any definition (e.g. a prologue's results read by a stream
+    // body) keep their names, so none of their numbers may be handed out
+    set<int> liveIn;
+    for (int i = 0; i < n; ++i) {
+        const TacInst &inst = tac[i];
+        if (prod1[i] < 0 && isTempName(inst.arg1)) liveIn.insert(stoi(inst.arg1.substr(1)));
+        if (prod2[i] < 0 && isTempName(inst.arg2)) liveIn.insert(stoi(inst.arg2.substr(1)));
+        if (prod3[i] < 0 && isTempName(inst.arg3)) liveIn.insert(stoi(inst.arg3.substr(1)));
+    }
+    int cyclesNew = 0;
+    vector<TacInst> out;
+    out.reserve(n);
+    vector<string> newName(n);
+    set<int> freeIdx;
+    int nextIdx = 0, tempsNew = 0;
+    left = usesLeft;
+    for (int i : order) {
+        TacInst inst = tac[i];
+        if (prod1[i] >= 0 && definesTemp(prod1[i])) inst.arg1 = newName[prod1[i]];
+        if (prod2[i] >= 0 && definesTemp(prod2[i])) inst.arg2 = newName[prod2[i]];
+        if (prod3[i] >= 0 && definesTemp(prod3[i])) inst.arg3 = newName[prod3[i]];
+        for (int p : {prod1[i], prod2[i], prod3[i]}) {
+            if (p < 0) continue;
+            if (--left[p] == 0 && definesTemp(p)) freeIdx.insert(stoi(newName[p].substr(1)));
+        }
+        if (definesTemp(i)) {
+            int idx;
+            if (!freeIdx.empty()) { idx = *freeIdx.begin(); freeIdx.erase(freeIdx.begin()); }
+            else {
+                while (liveIn.count(nextIdx)) ++nextIdx;
+                idx = nextIdx++;
+                ++tempsNew;
+            }
+            inst.dest = newName[i] = "t" + to_string(idx);
+            if (usesLeft[i] == 0) freeIdx.insert(idx);
+        }
+        out.push_back(inst);
+    }
+    cyclesNew = estimateCycles(out, lat);
+    if (cyclesNew >= st.cyclesBefore) return st; // never ship a slower order
+    tac.swap(out);
+    st.tempsAfter = tempsNew;
+    st.cyclesAfter = cyclesNew;
+    return st;
+}
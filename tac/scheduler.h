@@ -0,0 +1,57 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include "tac.h"
+#include <vector>
+#include <map>
+
+/*
+ * LatencyTable
+ *  - Result latency (cycles) of each TACOp; defaults are typical of scalar double
+ *    arithmetic on current x86-64 cores (divide is an order of magnitude slower).
+ */
+struct LatencyTable {
+    std::map<TACOp, int> latency;
+    int defaultLatency = 1;
+
+    int of(TACOp op) const;
+    static LatencyTable defaults();
+};
+
+struct ScheduleStats {
+    int cyclesBefore = 0; // estimated cycles per sample in parse order
+    int cyclesAfter = 0;  // estimated cycles per sample after scheduling
+    int tempsBefore = 0;  // distinct temp names before
+    int tempsAfter = 0;   // distinct temp names after
+    int maxLiveTemps = 0; // pressure limit the scheduler worked under
+};
+
+/*
+ * InstructionScheduler
+ *  - List scheduler for straight-line TAC (the whole program is one block).
+ *  - Dependencies: true dependences on every value, plus anti/output dependences on
+ *    program variables. Temps are renamed while scheduling, so recycled temp names
+ *    (TACGenerator's temp minimization) do not serialize independent statements.
+ *  - Priority is the latency-weighted height of an instruction in the dependence
+ *    DAG, so long DIV/MUL chains are started early and independent statements fill
+ *    their latency.
+ *  - Register-pressure aware: while the number of live temps is at the limit (by
+ *    default the peak of the input order) only instructions that do not raise it
+ *    are picked. Temps are re-minimized afterwards the same way TACGenerator does,
+ *    skipping the numbers of temps the block reads before defining (live-in temps).
+ *  - Cycle estimates use an in-order, single-issue pipeline model in which an
+ *    instruction waits for its operands' latencies.
+ */
+class InstructionScheduler {
+public:
+    // Reorder tac in place. maxLiveTemps <= 0 keeps the pressure of the input order.
+    static ScheduleStats schedule(std::vector<TacInst> &tac,
+                                  const LatencyTable &lat = LatencyTable::defaults(),
+                                  int maxLiveTemps = 0);
+
+    // In-order single-issue estimate of the cycles needed for one sample.
+    static int estimateCycles(const std::vector<TacInst> &tac,
+                              const LatencyTable &lat = LatencyTable::defaults());
+};
+
+#endif // SCHEDULER_H
@@ -0,0 +1,94 @@
+#include "slicer.h"
+#include <unordered_set>
+
+using namespace std;
+
+// One backward pass: keep what roots need; collect upward-exposed reads of the slice.
+static vector<char> backwardSlice(const vector<TacInst> &tac, const set<string> &roots,
+                                  unordered_set<string> &exposed) {
+    vector<char> keep(tac.size(), 0);
+    unordered_set<string> live(roots.begin(), roots.end());
+    for (int i = (int)tac.size() - 1; i >= 0; --i) {
+        const TacInst &inst = tac[i];
+        bool needed = isGuard(inst.op) ? live.count(inst.arg1) > 0
+                                       : !inst.dest.empty() && live.count(inst.dest) > 0;
+        if (!needed) continue;
+        keep[i] = 1;
+        if (!inst.dest.empty()) live.erase(inst.dest);
+        for (const auto &u : usesOf(inst)) live.insert(u);
+    }
+    exposed.insert(live.begin(), live.end());
+    return keep;
+}
+
+vector<TacInst> OutputSlicer::compute(const vector<TacInst> &tac, const set<string> &outputs,
+                                      const SymbolTable *sym, SliceStats *stats) {
+    TacInterface iface = describeInterface(tac, sym);
+    set<string> roots;
+    vector<string> unknown;
+    for (const auto &o : outputs) {
+        if (iface.isOutput(o)) roots.insert(o);
+        else unknown.push_back(o);
+    }
+
+    vector<char> keep;
+    int stateAdded = 0;
+    for (;;) {
+        unordered_set<string> exposed;
+        keep = backwardSlice(tac, roots, exposed);
+        // a state variable read by the slice must also be updated by it
+        bool grew = false;
+        for (const auto &s : iface.state)
+            if (exposed.count(s) && iface.isOutput(s) && roots.insert(s).second) {
+                grew = true;
+                stateAdded++;
+            }
+        if (!grew) break;
+    }
+
+    vector<TacInst> out;
+    for (size_t i = 0; i < tac.size(); ++i)
+        if (keep[i]) out.push_back(tac[i]);
+    if (stats) {
+        stats->instructionsBefore = (int)tac.size();
+        stats->instructionsAfter = (int)out.size();
+        stats->stateAdded = stateAdded;
+        stats->unknown = unknown;
+    }
+    return out;
+}
+
+OutputSlicer::OutputSlicer(const vector<TacInst> &tac, const SymbolTable *sym) : sym(sym) {
+    reset(tac);
+}
+
+void OutputSlicer::reset(const vector<TacInst> &tac) {
+    program = tac;
+    iface = describeInterface(program, sym);
+    cache.clear();
+}
+
+const vector<TacInst> &OutputSlicer::slice(const set<string> &outputs, SliceStats *stats) {
+    // key on the outputs that actually exist so misspelled extras share an entry
+    set<string> key;
+    vector<string> unknown;
+    for (const auto &o : outputs) {
+        if (iface.isOutput(o)) key.insert(o);
+        else unknown.push_back(o);
+    }
+
+    auto it = cache.find(key);
+    if (it != cache.end()) {
+        hits++;
+    } else {
+        misses++;
+        Entry e;
+        e.tac = compute(program, key, sym, &e.stats);
+        it = cache.emplace(key, std::move(e)).first;
+    }
+    if (stats) {
+        *stats = it->second.stats;
+        stats->unknown = unknown; // the cached entry was keyed without them
+    }
+    return it->second.tac;
+}
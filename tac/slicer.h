@@ -0,0 +1,62 @@
+#ifndef SLICER_H
+#define SLICER_H
+
+#include "tac.h"
+#include "tacInfo.h"
+#include "../symbolTable/symbolTable.h"
+#include <vector>
+#include <set>
+#include <map>
+#include <string>
+
+/*
+ * OutputSlicer
+ *  - Backward slice of a TAC program for a subset of its outputs: only the
+ *    instructions the requested outputs depend on are kept (in program order).
+ *  - Guards are kept when the value they check is part of the slice.
+ *  - State variables read by the slice are added to the requested set (to a
+ *    fixpoint), so the slice still carries them to the next sample.
+ *  - Slices are cached per output set; the cache is dropped when the program is
+ *    replaced with reset().
+ */
+struct SliceStats {
+    int instructionsBefore = 0;
+    int instructionsAfter = 0;
+    int stateAdded = 0; // state variables pulled in by the fixpoint
+    std::vector<std::string> unknown; // requested names that are not outputs (ignored)
+};
+
+class OutputSlicer {
+public:
+    explicit OutputSlicer(const std::vector<TacInst> &tac, const SymbolTable *sym = nullptr);
+
+    // Replace the program being sliced (e.g. after re-specialization); clears the cache.
+    void reset(const std::vector<TacInst> &tac);
+
+    // Slice for outputs, served from the cache when the same set was requested before.
+    // Names that are not outputs of the program are ignored and listed in stats->unknown.
+    const std::vector<TacInst> &slice(const std::set<std::string> &outputs, SliceStats *stats = nullptr);
+
+    size_t cacheSize() const { return cache.size(); }
+    int cacheHits() const { return hits; }
+    int cacheMisses() const { return misses; }
+
+    // Uncached slice of tac for outputs.
+    static std::vector<TacInst> compute(const std::vector<TacInst> &tac, const std::set<std::string> &outputs,
+                                        const SymbolTable *sym = nullptr, SliceStats *stats = nullptr);
+
+private:
+    struct Entry {
+        std::vector<TacInst> tac;
+        SliceStats stats;
+    };
+
+    std::vector<TacInst> program;
+    const SymbolTable *sym;
+    TacInterface iface;
+    std::map<std::set<std::string>, Entry> cache;
+    int hits = 0;
+    int misses = 0;
+};
+
+#endif // SLICER_H
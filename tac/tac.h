@@ -4,24 +4,114 @@
 #include <string>
 #include <vector>
 #include <iostream>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
 
 enum class TACOp {
     LOAD_CONST, // dest = const (literal stored in arg1Literal)
     ASSIGN,     // dest = arg1
     ADD, SUB, MUL, DIV, // dest = arg1 op arg2
+    FMA,        // dest = arg1 * arg2 + arg3, rounded once
+    GUARD_NONZERO, // runtime check: arg1 != 0 (no dest)
+    GUARD_FINITE,  // runtime check: arg1 is neither NaN nor +-inf (no dest)
     NOP
 };
 
+// Precision a backend should compute an instruction in (set by PrecisionAnalyzer).
+enum class TacPrecision { F64, F32 };
+
 struct TacInst {
     TACOp op;
     std::string dest;   // destination variable/temp
     std::string arg1;   // operand 1 (var/temp)
     std::string arg2;   // operand 2 (var/temp) if any
+    std::string arg3;   // addend of FMA
     std::string arg1Literal; // used when op==LOAD_CONST (literal text)
+    TacPrecision prec;       // F32 when proven safe to demote from double
 
-    TacInst() : op(TACOp::NOP) {}
+    TacInst() : op(TACOp::NOP), prec(TacPrecision::F64) {}
 };
 
+// Guards have no destination and must never be removed as dead code.
+static inline bool isGuard(TACOp op) {
+    return op == TACOp::GUARD_NONZERO || op == TACOp::GUARD_FINITE;
+}
+
+// Temporaries produced by TACGenerator are named t<digits>; anything else is a
+// program variable (note: a user variable may well be called "temp").
+static inline bool isTempName(const std::string &name) {
+    if (name.size() < 2 || name[0] != 't') return false;
+    for (size_t k = 1; k < name.size(); ++k)
+        if (name[k] < '0' || name[k] > '9') return false;
+    return true;
+}
+
+// First temp number not used anywhere in tac; passes that introduce new temps
+// count up from here so they never collide with TACGenerator's names.
+static inline int nextTempIndex(const std::vector<TacInst> &tac) {
+    int next = 0;
+    auto bump = [&next](const std::string &name) {
+        if (isTempName(name)) next = std::max(next, std::stoi(name.substr(1)) + 1);
+    };
+    for (const auto &i : tac) { bump(i.dest); bump(i.arg1); bump(i.arg2); bump(i.arg3); }
+    return next;
+}
+
+// Numeric value of a LOAD_CONST literal.
+static inline double literalValue(const std::string &lit) {
+    return std::strtod(lit.c_str(), nullptr);
+}
+
+// Value a LOAD_CONST leaves in its destination: its literal, rounded to float32 when F32.
+static inline double constValue(const TacInst &i) {
+    double v = literalValue(i.arg1Literal);
+    return i.prec == TacPrecision::F32 ? (double)(float)v : v;
+}
+
+// Shortest literal text that reads back as exactly v (plain notation whenever
+// %g can avoid an exponent, so 10 prints as "10.0" rather than "1e+01").
+static inline std::string formatLiteral(double v) {
+    char buf[32];
+    double mag = v < 0 ? -v : v;
+    bool plain = mag >= 1e-4 && mag < 1e17;
+    for (int prec = 1; prec <= 17; ++prec) {
+        std::snprintf(buf, sizeof(buf), "%.*g", prec, v);
+        if (std::strtod(buf, nullptr) != v) continue;
+        if (!plain || std::string(buf).find('e') == std::string::npos) break;
+    }
+    std::string s = buf;
+    if (s.find_first_of(".eEni") == std::string::npos) s += ".0";
+    return s;
+}
+
+// Names read by an instruction, in operand order.
+static inline std::vector<std::string> usesOf(const TacInst &i) {
+    std::vector<std::string> res;
+    switch (i.op) {
+        case TACOp::ASSIGN:
+        case TACOp::GUARD_NONZERO:
+        case TACOp::GUARD_FINITE:
+            if (!i.arg1.empty()) res.push_back(i.arg1);
+            break;
+        case TACOp::ADD:
+        case TACOp::SUB:
+        case TACOp::MUL:
+        case TACOp::DIV:
+            if (!i.arg1.empty()) res.push_back(i.arg1);
+            if (!i.arg2.empty()) res.push_back(i.arg2);
+            break;
+        case TACOp::FMA:
+            if (!i.arg1.empty()) res.push_back(i.arg1);
+            if (!i.arg2.empty()) res.push_back(i.arg2);
+            if (!i.arg3.empty()) res.push_back(i.arg3);
+            break;
+        default:
+            break;
+    }
+    return res;
+}
+
 static inline std::string opToString(TACOp op) {
     switch (op) {
         case TACOp::LOAD_CONST: return "LOAD_CONST";
@@ -30,26 +120,39 @@ static inline std::string opToString(TACOp op) {
         case TACOp::SUB: return "SUB";
         case TACOp::MUL: return "MUL";
         case TACOp::DIV: return "DIV";
+        case TACOp::FMA: return "FMA";
+        case TACOp::GUARD_NONZERO: return "GUARD_NONZERO";
+        case TACOp::GUARD_FINITE: return "GUARD_FINITE";
         default: return "NOP";
     }
 }
 
 static inline void printTacLine(const TacInst &i, std::ostream &out = std::cout) {
+    const char *eol = i.prec == TacPrecision::F32 ? "\t(f32)\n" : "\n";
     switch (i.op) {
         case TACOp::LOAD_CONST:
-            out << i.dest << " = " << i.arg1Literal << "\n";
+            out << i.dest << " = " << i.arg1Literal << eol;
             break;
         case TACOp::ASSIGN:
-            out << i.dest << " = " << i.arg1 << "\n";
+            out << i.dest << " = " << i.arg1 << eol;
             break;
         case TACOp::ADD:
         case TACOp::SUB:
         case TACOp::MUL:
         case TACOp::DIV: {
             std::string sym = (i.op==TACOp::ADD? "+" : i.op==TACOp::SUB ? "-" : i.op==TACOp::MUL ? "*" : "/");
-            out << i.dest << " = " << i.arg1 << " " << sym << " " << i.arg2 << "\n";
+            out << i.dest << " = " << i.arg1 << " " << sym << " " << i.arg2 << eol;
             break;
         }
+        case TACOp::FMA:
+            out << i.dest << " = fma(" << i.arg1 << ", " << i.arg2 << ", " << i.arg3 << ")" << eol;
+            break;
+        case TACOp::GUARD_NONZERO:
+            out << "check " << i.arg1 << " != 0\n";
+            break;
+        case TACOp::GUARD_FINITE:
+            out << "check isfinite(" << i.arg1 << ")\n";
+            break;
         default:
             out << "// NOP\n";
     }
@@ -129,8 +129,8 @@ bool TACGenerator::parseExpression(vector<TacInst> &out, string &result) {
         if (op == TokenKind::PLUS) emitBinary(out, TACOp::ADD, dest, left, right);
         else emitBinary(out, TACOp::SUB, dest, left, right);
         // release temps (if left/right were temps we can push them back)
-        if (left.size()>0 && left[0]=='t') freeTemps.push(left);
-        if (right.size()>0 && right[0]=='t') freeTemps.push(right);
+        if (isTempName(left)) freeTemps.push(left);
+        if (isTempName(right)) freeTemps.push(right);
         left = dest;
     }
     result = left;
@@ -153,8 +153,8 @@ bool TACGenerator::parseTerm(vector<TacInst> &out, string &result) {
         string dest = newTemp();
         if (op == TokenKind::STAR) emitBinary(out, TACOp::MUL, dest, left, right);
         else emitBinary(out, TACOp::DIV, dest, left, right);
-        if (left.size()>0 && left[0]=='t') freeTemps.push(left);
-        if (right.size()>0 && right[0]=='t') freeTemps.push(right);
+        if (isTempName(left)) freeTemps.push(left);
+        if (isTempName(right)) freeTemps.push(right);
         left = dest;
     }
     result = left;
@@ -0,0 +1,37 @@
+#include "tacInfo.h"
+#include <unordered_set>
+#include <algorithm>
+
+using namespace std;
+
+static bool contains(const vector<string> &v, const string &name) {
+    return find(v.begin(), v.end(), name) != v.end();
+}
+
+bool TacInterface::isInput(const string &name) const { return contains(inputs, name); }
+bool TacInterface::isOutput(const string &name) const { return contains(outputs, name); }
+bool TacInterface::isState(const string &name) const { return contains(state, name); }
+
+TacInterface describeInterface(const vector<TacInst> &tac, const SymbolTable *sym) {
+    TacInterface res;
+    unordered_set<string> defined, exposed;
+    vector<string> exposedOrder;
+
+    for (const auto &inst : tac) {
+        for (const auto &u : usesOf(inst)) {
+            if (defined.count(u) || exposed.count(u)) continue;
+            exposed.insert(u);
+            exposedOrder.push_back(u);
+        }
+        if (inst.dest.empty()) continue;
+        if (!isTempName(inst.dest) && !defined.count(inst.dest)) res.outputs.push_back(inst.dest);
+        defined.insert(inst.dest);
+    }
+
+    for (const auto &name : exposedOrder) {
+        const SymbolEntry *e = sym ? sym->lookup(name) : nullptr;
+        if (e && e->is_state) res.state.push_back(name);
+        else res.inputs.push_back(name);
+    }
+    return res;
+}
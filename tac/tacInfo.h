@@ -0,0 +1,30 @@
+#ifndef TACINFO_H
+#define TACINFO_H
+
+#include "tac.h"
+#include "../symbolTable/symbolTable.h"
+#include <vector>
+#include <string>
+
+/*
+ * TacInterface
+ *  - Describes what a straight-line TAC program reads and writes per sample.
+ *  - inputs : names read before any definition (values fed by in() per sample)
+ *  - outputs: program variables defined by the program (in first-definition order)
+ *  - state  : read-before-defined names whose symbol is_state; they keep their
+ *             value from the previous sample instead of being fed as inputs
+ */
+struct TacInterface {
+    std::vector<std::string> inputs;
+    std::vector<std::string> outputs;
+    std::vector<std::string> state;
+
+    bool isInput(const std::string &name) const;
+    bool isOutput(const std::string &name) const;
+    bool isState(const std::string &name) const;
+};
+
+// Build the interface of tac. sym is optional; without it nothing is treated as state.
+TacInterface describeInterface(const std::vector<TacInst> &tac, const SymbolTable *sym = nullptr);
+
+#endif // TACINFO_H
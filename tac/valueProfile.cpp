@@ -0,0 +1,151 @@
+#include "valueProfile.h"
+#include "partialEval.h"
+#include <unordered_set>
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+using namespace std;
+
+static bool sameBits(double a, double b) { return memcmp(&a, &b, sizeof(double)) == 0; }
+
+ValueProfiler::ValueProfiler(const vector<TacInst> &tac, const SymbolTable *sym) : slotOf(2 * tac.size(), -1) {
+    // state is read before it is defined too, but carries the previous sample's value
+    const TacInterface iface = describeInterface(tac, sym);
+    unordered_set<string> defined(iface.state.begin(), iface.state.end());
+    for (size_t i = 0; i < tac.size(); ++i) {
+        const TacInst &inst = tac[i];
+        if (inst.op != TACOp::LOAD_CONST && inst.op != TACOp::NOP) {
+            const string *args[2] = {&inst.arg1, inst.op == TACOp::ASSIGN || isGuard(inst.op) ? nullptr : &inst.arg2};
+            for (int k = 0; k < 2; ++k) {
+                if (!args[k] || args[k]->empty() || defined.count(*args[k])) continue;
+                OperandProfile p;
+                p.inst = (int)i;
+                p.operand = k + 1;
+                p.name = *args[k];
+                slotOf[2 * i + k] = (int)slots.size();
+                slots.push_back(p);
+            }
+        }
+        if (!inst.dest.empty()) defined.insert(inst.dest);
+    }
+}
+
+void ValueProfiler::observe(int inst, int operand, double value) {
+    size_t key = 2 * (size_t)inst + (operand - 1);
+    if (inst < 0 || operand < 1 || operand > 2 || key >= slotOf.size() || slotOf[key] < 0) return;
+    OperandProfile &p = slots[slotOf[key]];
+    if (p.votes == 0) {
+        // adopt a new candidate (Boyer-Moore majority vote)
+        p.candidate = value;
+        p.votes = 1;
+        p.matches = 1;
+        p.since = 1;
+        return;
+    }
+    if (sameBits(value, p.candidate)) {
+        p.votes++;
+        p.matches++;
+    } else {
+        p.votes--;
+    }
+    p.since++;
+}
+
+void ValueProfiler::observeSample(const map<string, double> &inputs) {
+    sampleCount++;
+    for (const auto &p : slots) {
+        auto it = inputs.find(p.name);
+        if (it != inputs.end()) observe(p.inst, p.operand, it->second);
+    }
+}
+
+void ValueProfiler::reset() {
+    for (auto &p : slots) p.candidate = 0, p.votes = p.matches = p.since = 0;
+    sampleCount = 0;
+}
+
+map<string, double> ValueProfiler::stableInputs(double minRatio, long long minSamples) const {
+    map<string, double> stable;
+    map<string, bool> ok;
+    for (const auto &p : slots) {
+        bool good = p.since >= minSamples && p.matches >= minRatio * p.since;
+        auto seen = ok.find(p.name);
+        if (seen == ok.end()) {
+            ok[p.name] = good;
+            stable[p.name] = p.candidate;
+        } else if (!good || !sameBits(stable[p.name], p.candidate)) {
+            seen->second = false;
+        }
+    }
+    for (const auto &o : ok)
+        if (!o.second) stable.erase(o.first);
+    return stable;
+}
+
+void ValueProfiler::print(ostream &out) const {
+    out << "samples=" << sampleCount << "\n";
+    for (const auto &p : slots) {
+        out << p.inst << "." << p.operand << "\t" << p.name << "\tcandidate=" << p.candidate
+            << "\tseen " << p.matches << "/" << p.since << "\n";
+    }
+}
+
+SpecializedKernel::SpecializedKernel(const vector<TacInst> &generic, const SymbolTable &sym,
+                                     const map<string, double> &bindings, DeoptPolicy policy)
+    : generic(generic), sym(sym), policy(policy), iface(describeInterface(generic, &sym)) {
+    respecialize(bindings);
+}
+
+void SpecializedKernel::respecialize(const map<string, double> &b) {
+    bindings = b;
+    specialized = bindings.empty() ? generic : PartialEvaluator::specialize(generic, sym, bindings);
+    deopt = bindings.empty();
+    windowRuns = windowFailures = 0;
+    checks.clear();
+    for (const auto &b : bindings) {
+        auto it = find(iface.inputs.begin(), iface.inputs.end(), b.first);
+        if (it == iface.inputs.end()) // state or unread: folding it in would go unchecked
+            throw invalid_argument("cannot specialize on '" + b.first + "': not an input of the program");
+        Check c;
+        c.slot = it - iface.inputs.begin();
+        memcpy(&c.bits, &b.second, sizeof(double));
+        checks.push_back(c);
+    }
+}
+
+const vector<TacInst> &SpecializedKernel::select(const double *inputs) {
+    if (deopt) {
+        genRuns++;
+        return generic;
+    }
+    bool hit = true;
+    for (const auto &c : checks) {
+        uint64_t bits;
+        memcpy(&bits, &inputs[c.slot], sizeof(double));
+        if (bits != c.bits) { hit = false; break; }
+    }
+    windowRuns++;
+    if (!hit) {
+        failures++;
+        windowFailures++;
+    }
+    if (windowRuns >= policy.window) {
+        if (windowFailures > policy.maxFailureRate * windowRuns) deopt = true;
+        windowRuns = windowFailures = 0;
+    }
+    if (hit) {
+        specRuns++;
+        return specialized;
+    }
+    genRuns++;
+    return generic;
+}
+
+void SpecializedKernel::print(ostream &out) const {
+    out << "guards:";
+    for (const auto &b : bindings) out << " " << b.first << "==" << formatLiteral(b.second);
+    out << "\ngeneric=" << generic.size() << " instructions, specialized=" << specialized.size()
+        << " instructions\nruns: specialized=" << specRuns << " generic=" << genRuns
+        << " guard failures=" << failures << (deopt ? " (deoptimized)" : "") << "\n";
+}
@@ -0,0 +1,120 @@
+#ifndef VALUEPROFILE_H
+#define VALUEPROFILE_H
+
+#include "tac.h"
+#include "tacInfo.h"
+#include "../symbolTable/symbolTable.h"
+#include <vector>
+#include <map>
+#include <string>
+#include <iostream>
+#include <cstdint>
+
+/*
+ * ValueProfiler
+ *  - Records the values an executing program sees in each instruction operand
+ *    that reads a program input (a gain knob, a mode flag, ...). With sym, state
+ *    variables are not inputs and are never profiled.
+ *  - Each operand keeps one candidate value (majority vote) and how often the
+ *    candidate was seen since it was adopted; an input is stable when all its
+ *    operands agree on a candidate seen in at least minRatio of the samples.
+ *    Values are compared by bit pattern, as SpecializedKernel checks them.
+ */
+struct OperandProfile {
+    int inst = -1;         // instruction index
+    int operand = 0;       // 1 = arg1, 2 = arg2
+    std::string name;      // input read by the operand
+    double candidate = 0;  // value voted most frequent
+    long long votes = 0;   // majority-vote counter
+    long long matches = 0; // samples equal to candidate since it was adopted
+    long long since = 0;   // samples since candidate was adopted
+};
+
+class ValueProfiler {
+public:
+    explicit ValueProfiler(const std::vector<TacInst> &tac, const SymbolTable *sym = nullptr);
+
+    // Record one operand value; inst/operand not reading an input are ignored.
+    void observe(int inst, int operand, double value);
+
+    // Record one sample given the values of the program inputs.
+    void observeSample(const std::map<std::string, double> &inputs);
+    // Count a sample whose operands were recorded with observe().
+    void nextSample() { sampleCount++; }
+
+    long long samples() const { return sampleCount; }
+    void reset();
+
+    // Inputs whose value was stable enough to specialize on.
+    std::map<std::string, double> stableInputs(double minRatio = 0.99, long long minSamples = 100) const;
+
+    const std::vector<OperandProfile> &operands() const { return slots; }
+    void print(std::ostream &out = std::cout) const;
+
+private:
+    std::vector<OperandProfile> slots;
+    std::vector<int> slotOf; // 2*inst + (operand-1) -> slot, -1 if not an input read
+    long long sampleCount = 0;
+};
+
+/*
+ * SpecializedKernel
+ *  - A generic kernel plus a copy specialized (PartialEvaluator) on profiled input
+ *    values. select() checks the specialized values with one bit-pattern comparison
+ *    per bound input (so -0.0 never selects a kernel specialized on +0.0) and falls
+ *    back to the generic kernel when any differs. The input slot of every check is
+ *    resolved once, when the kernel is (re)specialized. A binding that is not an
+ *    input (state, or a name never read) could not be checked and throws
+ *    invalid_argument.
+ *  - Guard failures are counted per window of selections; once a window fails more
+ *    than maxFailureRate of the time the kernel deoptimizes and only the generic
+ *    kernel is used until respecialize() is called.
+ */
+struct DeoptPolicy {
+    long long window = 1000;
+    double maxFailureRate = 0.05;
+};
+
+class SpecializedKernel {
+public:
+    SpecializedKernel(const std::vector<TacInst> &generic, const SymbolTable &sym,
+                      const std::map<std::string, double> &bindings, DeoptPolicy policy = DeoptPolicy());
+
+    // Kernel to run for a sample; inputs in inputNames() order.
+    const std::vector<TacInst> &select(const double *inputs);
+    const std::vector<std::string> &inputNames() const { return iface.inputs; }
+
+    // Rebuild the specialized kernel for new bindings and leave the deoptimized state.
+    void respecialize(const std::map<std::string, double> &bindings);
+
+    const std::vector<TacInst> &genericKernel() const { return generic; }
+    const std::vector<TacInst> &specializedKernel() const { return specialized; }
+    const std::map<std::string, double> &guards() const { return bindings; }
+
+    bool deoptimized() const { return deopt; }
+    long long specializedRuns() const { return specRuns; }
+    long long genericRuns() const { return genRuns; }
+    long long guardFailures() const { return failures; }
+
+    void print(std::ostream &out = std::cout) const;
+
+private:
+    std::vector<TacInst> generic;
+    std::vector<TacInst> specialized;
+    const SymbolTable &sym;
+    std::map<std::string, double> bindings;
+    DeoptPolicy policy;
+    TacInterface iface; // of the generic kernel
+
+    struct Check {
+        size_t slot;   // index into the input row
+        uint64_t bits; // bit pattern of the bound value
+    };
+    std::vector<Check> checks;
+
+    bool deopt = false;
+    long long specRuns = 0, genRuns = 0, failures = 0;
+    long long windowRuns = 0, windowFailures = 0;
+};
+
+#endif // VALUEPROFILE_H